@@ -0,0 +1,201 @@
+#!/usr/bin/perl
+#
+# Copyright (c) 2026 Tama Communications Corporation
+#
+# This file is part of GNU GLOBAL.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Run the benchmark of GLOBAL on a synthetic source tree.
+#
+# usage: bench.pl [options]
+#
+#	--bindir=DIR	top of the build directory (default .)
+#	--workdir=DIR	directory for the source tree (default bench.work)
+#	--output=FILE	write the results to FILE (default standard output)
+#	--edits=N	number of files edited before gtags -i (default 10)
+#	--queries=N	number of symbols looked up by each query (default 20)
+#	--repeat=N	number of times each step is run (default 1)
+#	--no-htags	don't run htags
+#	--keep		keep the work directory
+#
+# The other options (--files, --symbols, --refs, --langs and --seed)
+# are passed to gentree.pl. The results are printed in JSON, like follows.
+# The time of a step is the best of the repeated runs.
+#
+#	{"config": {"files": 1000, ...},
+#	 "results": [
+#	  {"name": "gtags", "seconds": 1.234, "runs": 1},
+#	  ...
+#	 ],
+#	 "sizes": {"GGEN": 2, "GLINES": 131072, "GPATH": 98304, ...}}
+#
+use strict;
+use Getopt::Long;
+use Cwd;
+use File::Basename;
+use Time::HiRes qw(gettimeofday tv_interval);
+
+my %gen = (files => 1000, symbols => 50, refs => 5, langs => 'c,cpp,java,php', seed => 1);
+my $bindir = '.';
+my $workdir = 'bench.work';
+my $output;
+my $edits = 10;
+my $queries = 20;
+my $repeat = 1;
+my $nohtags = 0;
+my $keep = 0;
+GetOptions(
+	'files=i' => \$gen{files},
+	'symbols=i' => \$gen{symbols},
+	'refs=i' => \$gen{refs},
+	'langs=s' => \$gen{langs},
+	'seed=i' => \$gen{seed},
+	'bindir=s' => \$bindir,
+	'workdir=s' => \$workdir,
+	'output=s' => \$output,
+	'edits=i' => \$edits,
+	'queries=i' => \$queries,
+	'repeat=i' => \$repeat,
+	'no-htags' => \$nohtags,
+	'keep' => \$keep,
+) || die("usage: bench.pl [options]\n");
+$bindir = Cwd::abs_path($bindir);
+my $gtags = "$bindir/gtags/gtags";
+my $global = "$bindir/global/global";
+my $htags = "$bindir/htags/htags";
+foreach ($gtags, $global) {
+	die("bench.pl: '$_' not found. Please build GLOBAL first.\n") unless -x $_;
+}
+$nohtags = 1 unless -x $htags;
+my $gentree = dirname(Cwd::abs_path($0)) . '/gentree.pl';
+delete $ENV{GTAGSLABEL};
+delete $ENV{GTAGSROOT};
+delete $ENV{GTAGSDBPATH};
+# htags invokes gtags and global.
+$ENV{PATH} = "$bindir/gtags:$bindir/global:$ENV{PATH}";
+
+my @results;
+sub run {
+	my($cmd) = @_;
+	system("$cmd >/dev/null 2>&1") == 0 || die("bench.pl: '$cmd' failed.\n");
+}
+#
+# step: run a step and record the best time.
+#
+#	$name	name of the step
+#	$setup	called before each run (not timed)
+#	$body	the step
+#
+sub step {
+	my($name, $setup, $body) = @_;
+	my $best;
+	for (my $i = 0; $i < $repeat; $i++) {
+		$setup->() if $setup;
+		my $start = [gettimeofday];
+		$body->();
+		my $t = tv_interval($start);
+		$best = $t if !defined($best) || $t < $best;
+	}
+	push(@results, sprintf('{"name": "%s", "seconds": %.6f, "runs": %d}', $name, $best, $repeat));
+	print STDERR sprintf("%-12s %10.3f sec\n", $name, $best);
+}
+
+system('rm', '-rf', $workdir);
+my $args = join(' ', map { "--$_=$gen{$_}" } sort keys %gen);
+run("$^X $gentree $args $workdir");
+chdir($workdir) || die("bench.pl: cannot move to '$workdir'.\n");
+#
+# Tag files are made with the default configuration,
+# not with the one of the user.
+#
+open(CONF, '>gtags.conf') || die("bench.pl: cannot make gtags.conf.\n");
+print CONF "default:\\\n\t:skip=SYMBOLS,gtags.conf:\n";
+close(CONF);
+$ENV{GTAGSCONF} = Cwd::getcwd() . '/gtags.conf';
+open(SYMBOLS, 'SYMBOLS') || die("bench.pl: SYMBOLS not found.\n");
+my @symbols = <SYMBOLS>;
+close(SYMBOLS);
+chomp(@symbols);
+srand($gen{seed});
+my @picked = map { $symbols[int(rand(@symbols))] } (1 .. $queries);
+my @sources = split(/\n/, `find . -type f -name 'f*'`);
+my @tagfiles = ('GTAGS', 'GRTAGS', 'GPATH', 'GTAGS.bloom', 'GLINES', 'GGEN');
+
+#
+# Making tag files.
+#
+step('gtags', sub { unlink(@tagfiles) }, sub { run($gtags) });
+step('gtags-c', sub { unlink(@tagfiles) }, sub { run("$gtags -c") });
+my %sizes = map { $_ => (-s $_ || 0) } @tagfiles;
+#
+# Incremental updating after editing files.
+#
+my $seq = 0;
+step('gtags-i', sub {
+	for (my $i = 0; $i < $edits; $i++) {
+		my $path = $sources[int(rand(@sources))];
+		next if $path =~ /\.php$/;
+		open(my $fh, ">>$path") || die("bench.pl: cannot edit '$path'.\n");
+		$seq++;
+		print $fh $path =~ /\.java$/ ? "class Edited$seq {}\n" : "int edited$seq;\n";
+		close($fh);
+	}
+	# make sure that the modification time differs from the tag files.
+	sleep(1);
+}, sub { run("$gtags -i") });
+step('gtags-i-nop', undef, sub { run("$gtags -i") });
+#
+# Queries.
+#
+my %queries = (
+	'global-x' => '-x',
+	'global-r' => '-rx',
+	'global-s' => '-sx',
+	'global-c' => '-c',
+);
+foreach my $name (sort keys %queries) {
+	my $opt = $queries{$name};
+	step($name, undef, sub {
+		foreach (@picked) {
+			my $arg = $opt eq '-c' ? substr($_, 0, length($_) - 1) : $_;
+			run("$global $opt $arg");
+		}
+	});
+}
+step('global-g', undef, sub {
+	foreach (@picked[0 .. ($queries > 3 ? 3 : $queries) - 1]) {
+		run("$global -gx $_");
+	}
+});
+step('global-regex', undef, sub { run("$global -x 'sym1.*_0'") });
+#
+# Hypertext.
+#
+unless ($nohtags) {
+	step('htags', sub { system('rm', '-rf', 'HTML') }, sub { run("$htags -q") });
+}
+chdir('..');
+system('rm', '-rf', $workdir) unless $keep;
+
+my $config = join(', ', map { $gen{$_} =~ /^\d+$/ ? "\"$_\": $gen{$_}" : "\"$_\": \"$gen{$_}\"" } sort keys %gen);
+$config .= ", \"edits\": $edits, \"queries\": $queries, \"repeat\": $repeat";
+my $sizes = join(', ', map { "\"$_\": $sizes{$_}" } sort keys %sizes);
+my $fh = \*STDOUT;
+if ($output) {
+	open($fh, ">$output") || die("bench.pl: cannot make '$output'.\n");
+}
+print $fh "{\"config\": {$config},\n \"results\": [\n  ", join(",\n  ", @results), "\n ],\n \"sizes\": {$sizes}}\n";
+close($fh) if $output;
+exit 0;
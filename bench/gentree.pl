@@ -0,0 +1,153 @@
+#!/usr/bin/perl
+#
+# Copyright (c) 2026 Tama Communications Corporation
+#
+# This file is part of GNU GLOBAL.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Generate a synthetic source tree for benchmarking.
+#
+# usage: gentree.pl [options] directory
+#
+#	--files=N	number of source files (default 1000)
+#	--symbols=N	number of definitions in a file (default 50)
+#	--refs=N	number of references in a definition (default 5)
+#	--langs=LIST	comma separated languages: c, cpp, java, php (default all)
+#	--seed=N	seed of the random numbers (default 1)
+#
+# The same options always make the same tree. The names of the defined
+# symbols are written to 'SYMBOLS' in the directory, one per line.
+#
+use strict;
+use Getopt::Long;
+
+my $files = 1000;
+my $symbols = 50;
+my $refs = 5;
+my $langs = 'c,cpp,java,php';
+my $seed = 1;
+GetOptions(
+	'files=i' => \$files,
+	'symbols=i' => \$symbols,
+	'refs=i' => \$refs,
+	'langs=s' => \$langs,
+	'seed=i' => \$seed,
+) && @ARGV == 1 || die("usage: gentree.pl [--files=N] [--symbols=N] [--refs=N] [--langs=LIST] [--seed=N] directory\n");
+my $top = $ARGV[0];
+my @langs = split(/,/, $langs);
+my %suffix = (c => 'c', cpp => 'cpp', java => 'java', php => 'php');
+foreach (@langs) {
+	die("gentree.pl: unknown language '$_'.\n") unless $suffix{$_};
+}
+srand($seed);
+#
+# Files are placed in a tree whose directories have at most 50 files
+# and 10 subdirectories.
+#
+sub dirname {
+	my($n) = @_;
+	my $dir = '';
+	$n = int($n / 50);
+	while ($n > 0) {
+		$dir = sprintf("/d%d", $n % 10) . $dir;
+		$n = int($n / 10);
+	}
+	"$top$dir";
+}
+sub mkpath {
+	my($dir) = @_;
+	my $path = '';
+	foreach (split(/\//, $dir)) {
+		$path .= "$_/";
+		mkdir($path) unless -d $path;
+	}
+}
+#
+# The name of the j-th symbol in the i-th file.
+# References point to symbols of any file, as in a real project.
+#
+sub name {
+	my($i, $j) = @_;
+	sprintf("sym%d_%d", $i, $j);
+}
+sub randref {
+	name(int(rand($files)), int(rand($symbols)));
+}
+sub body {
+	my($lang) = @_;
+	my @calls;
+	for (my $k = 0; $k < $refs; $k++) {
+		my $ref = randref();
+		push(@calls, $lang eq 'php' ? "\t\$x += $ref(\$x);" : "\tx += $ref(x);");
+	}
+	join("\n", @calls) . "\n";
+}
+sub gen_c {
+	my($i, $fh) = @_;
+	print $fh "#include <stdio.h>\n#define MAX_$i 100\n\nstatic int count_$i;\n\n";
+	for (my $j = 0; $j < $symbols; $j++) {
+		my $name = name($i, $j);
+		print $fh "int\n$name(int x)\n{\n", body('c'), "\tcount_$i++;\n\treturn x + MAX_$i;\n}\n";
+	}
+}
+sub gen_cpp {
+	my($i, $fh) = @_;
+	print $fh "namespace ns$i {\nclass Class$i {\npublic:\n";
+	for (my $j = 0; $j < $symbols; $j++) {
+		print $fh "\tint ", name($i, $j), "(int x);\n";
+	}
+	print $fh "};\n";
+	for (my $j = 0; $j < $symbols; $j++) {
+		my $name = name($i, $j);
+		print $fh "int\nClass$i\::$name(int x)\n{\n", body('cpp'), "\treturn x;\n}\n";
+	}
+	print $fh "}\n";
+}
+sub gen_java {
+	my($i, $fh) = @_;
+	print $fh "package p$i;\n\npublic class Class$i {\n\tprivate int count;\n";
+	for (my $j = 0; $j < $symbols; $j++) {
+		my $name = name($i, $j);
+		my $body = body('java');
+		$body =~ s/^/\t/mg;
+		print $fh "\tpublic int $name(int x) {\n", $body, "\t\tcount++;\n\t\treturn x;\n\t}\n";
+	}
+	print $fh "}\n";
+}
+sub gen_php {
+	my($i, $fh) = @_;
+	print $fh "<?php\n\$count$i = 0;\n";
+	for (my $j = 0; $j < $symbols; $j++) {
+		my $name = name($i, $j);
+		print $fh "function $name(\$x)\n{\n", body('php'), "\treturn \$x;\n}\n";
+	}
+	print $fh "?>\n";
+}
+my %gen = (c => \&gen_c, cpp => \&gen_cpp, java => \&gen_java, php => \&gen_php);
+
+mkpath($top);
+open(SYMBOLS, ">$top/SYMBOLS") || die("gentree.pl: cannot make '$top/SYMBOLS'.\n");
+for (my $i = 0; $i < $files; $i++) {
+	my $lang = $langs[$i % @langs];
+	my $dir = dirname($i);
+	my $path = "$dir/f$i.$suffix{$lang}";
+	mkpath($dir);
+	open(my $fh, ">$path") || die("gentree.pl: cannot make '$path'.\n");
+	$gen{$lang}->($i, $fh);
+	close($fh);
+	print SYMBOLS name($i, 0), "\n";
+}
+close(SYMBOLS);
+exit 0;
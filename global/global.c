@@ -57,6 +57,7 @@ int decide_tag_by_context(const char *, const char *, int);
 int main(int, char **);
 int completion_tags(const char *, const char *, const char *, int);
 void completion(const char *, const char *, const char *, int);
+static int completion_shards(const char *, const char *, int);
 void completion_idutils(const char *, const char *, const char *);
 void completion_path(const char *, const char *);
 void idutils(const char *, const char *);
@@ -64,6 +65,8 @@ void grep(const char *, char *const *, const char *);
 void pathlist(const char *, const char *);
 void parsefile(char *const *, const char *, const char *, const char *, int);
 int search(const char *, const char *, const char *, const char *, int);
+static int search_shards(const char *, const char *, const char *, int);
+static void unfold_lines(const char *, int, VARRAY *);
 void tagsearch(const char *, const char *, const char *, const char *, int);
 void encode(char *, int, const char *);
 
@@ -105,6 +108,8 @@ int match_part;				/**< match part only	*/
 const char *cwd;			/**< current directory	*/
 const char *root;			/**< root of source tree	*/
 const char *dbpath;			/**< dbpath directory	*/
+SHARDS *shards;				/**< shards of the tag files, or NULL */
+DBOP *merge;				/**< results of the shards being merged */
 char *context_file;
 char *context_lineno;
 char *file_list;
@@ -214,33 +219,53 @@ decide_tag_by_context(const char *tag, const char *file, int lineno)
 	STRBUF *sb = NULL;
 	char path[MAXPATHLEN], s_fid[MAXFIDLEN];
 	const char *tagline, *p;
+	const char *tagdbpath = dbpath;
 	DBOP *dbop;
 	int db = GSYMS;
-	int iscompline = 0;
+	int iscompline = 0, isbinary = 0;
+	unsigned int fid;
 
 	if (normalize(file, get_root_with_slash(), cwd, path, sizeof(path)) == NULL)
 		die("'%s' is out of the source project.", file);
+	/*
+	 * The context is looked up in the shard of the file.
+	 */
+	if (shards)
+		tagdbpath = shard_dbpath(shards, shard_lookup(shards, path));
 	/*
 	 * get file id
 	 */
-	if (gpath_open(dbpath, 0) < 0)
+	if (gpath_open(tagdbpath, 0) < 0)
 		die("GPATH not found.");
 	if ((p = gpath_path2fid(path, NULL)) == NULL)
 		die("path name in the context is not found.");
 	strlimcpy(s_fid, p, sizeof(s_fid));
+	fid = atoi(s_fid);
 	gpath_close();
 	/*
 	 * read btree records directly to avoid the overhead.
 	 */
-	dbop = dbop_open(makepath(dbpath, dbname(GTAGS), NULL), 0, 0, 0);
+	dbop = dbop_open(makepath(tagdbpath, dbname(GTAGS), NULL), 0, 0, DBOP_BLOOM);
 	if (dbop == NULL)
 		die("cannot open GTAGS.");
 	if (dbop_getoption(dbop, COMPLINEKEY))
 		iscompline = 1;
+	if (dbop_getoption(dbop, BINARYKEY))
+		isbinary = 1;
 	tagline = dbop_first(dbop, tag, NULL, 0);
 	if (tagline) {
 		db = GTAGS;
 		for (; tagline; tagline = dbop_next(dbop)) {
+			if (isbinary) {
+				GTREC rec;
+
+				gtags_decode(tagline, dbop->lastsize, GTAGS_BINARY, &rec);
+				if (rec.fid == fid && rec.lineno == lineno) {
+					db = GRTAGS;
+					goto finish;
+				}
+				continue;
+			}
 			/*
 			 * examine whether the definition record include the context.
 			 */
@@ -296,6 +321,8 @@ decide_tag_by_context(const char *tag, const char *file, int lineno)
 	}
 finish:
 	dbop_close(dbop);
+	if (db == GSYMS && shards && shard_defined(shards, tag))
+		db = GTAGS;
 	if (db == GSYMS && getenv("GTAGSLIBPATH")) {
 		char libdbpath[MAXPATHLEN];
 		char *libdir = NULL, *nextp = NULL;
@@ -309,7 +336,7 @@ finish:
 				continue;
 			if (!strcmp(dbpath, libdbpath))
 				continue;
-			dbop = dbop_open(makepath(libdbpath, dbname(GTAGS), NULL), 0, 0, 0);
+			dbop = dbop_open(makepath(libdbpath, dbname(GTAGS), NULL), 0, 0, DBOP_BLOOM);
 			if (dbop == NULL)
 				continue;
 			tagline = dbop_first(dbop, tag, NULL, 0);
@@ -607,6 +634,7 @@ main(int argc, char **argv)
 		cwd = get_cwd();
 		root = get_root();
 		dbpath = get_dbpath();
+		shards = shard_open(dbpath);
 	}
 	/*
 	 * print dbpath or rootdir.
@@ -760,6 +788,23 @@ main(int argc, char **argv)
 	}
 	return 0;
 }
+/**
+ * put_tag: print a word of the completion list
+ *
+ *	@param[in]	tag	tag name
+ *
+ * While the shards are searched, the word is saved to be merged.
+ */
+static void
+put_tag(const char *tag)
+{
+	if (merge) {
+		dbop_put(merge, tag, "");
+	} else {
+		fputs(tag, stdout);
+		fputc('\n', stdout);
+	}
+}
 /**
  * completion_tags: print completion list of specified @a prefix
  *
@@ -777,59 +822,20 @@ completion_tags(const char *dbpath, const char *root, const char *prefix, int db
 	GTP *gtp;
 	int count = 0;
 
-	if (prefix && isalpha(*prefix) && iflag) {
-		/*
-		 * If the -i option is specified, we use both of regular
-		 * expression and prefix read for performance. It is done
-		 * by connecting two prefix reading.
-		 */
-		STRBUF *sb = strbuf_open(0);
-		regex_t	preg;
-		int i, firstchar[2];
-
-		flags |= GTOP_NOREGEX;
+	if (merge)			/* in a shard */
+		gtop->shards = shards;
+	flags |= GTOP_NOREGEX;
+	if (prefix)
 		flags |= GTOP_PREFIX;
-		/*
-		 * make regular expression.
-		 */
-		strbuf_putc(sb, '^');
-		strbuf_puts(sb, prefix);
-		if (regcomp(&preg, strbuf_value(sb), REG_ICASE) != 0)
-			die("invalid regular expression.");
-		/*
-		 * Two prefix reading:
-		 *
-		 * prefix = 'main'
-		 * v
-		 * firstchar[0] = 'M';		/^M/	the first time
-		 * firstchar[1] = 'm';		/^m/	the second time
-		 */
-		firstchar[0] = firstchar[1] = *prefix;
-		if (isupper(firstchar[0]))
-			firstchar[1] = tolower(firstchar[0]);
-		else
-			firstchar[0] = toupper(firstchar[0]);
-		for (i = 0; i < 2; i++) {
-			strbuf_reset(sb);
-			strbuf_putc(sb, firstchar[i]);
-			for (gtp = gtags_first(gtop, strbuf_value(sb), flags); gtp; gtp = gtags_next(gtop)) {
-				if (regexec(&preg, gtp->tag, 0, 0, 0) == 0) {
-					fputs(gtp->tag, stdout);
-					fputc('\n', stdout);
-					count++;
-				}
-			}
-		}
-		strbuf_close(sb);
-	} else {
-		flags |= GTOP_NOREGEX;
-		if (prefix)
-			flags |= GTOP_PREFIX;
-		for (gtp = gtags_first(gtop, prefix, flags); gtp; gtp = gtags_next(gtop)) {
-			fputs(gtp->tag, stdout);
-			fputc('\n', stdout);
-			count++;
-		}
+	/*
+	 * If the -i option is specified, the names which start with the
+	 * prefix in any case are read by key range (see dbop_fold()).
+	 */
+	if (prefix && iflag)
+		flags |= GTOP_IGNORECASE;
+	for (gtp = gtags_first(gtop, prefix, flags); gtp; gtp = gtags_next(gtop)) {
+		put_tag(gtp->tag);
+		count++;
 	}
 	gtags_close(gtop);
 	return count;
@@ -850,7 +856,10 @@ completion(const char *dbpath, const char *root, const char *prefix, int db)
 
 	if (prefix && *prefix == 0)	/* In the case global -c '' */
 		prefix = NULL;
-	count = completion_tags(dbpath, root, prefix, db);
+	if (shards)
+		count = completion_shards(root, prefix, db);
+	else
+		count = completion_tags(dbpath, root, prefix, db);
 	/*
 	 * search in library path.
 	 */
@@ -883,6 +892,37 @@ completion(const char *dbpath, const char *root, const char *prefix, int db)
 	}
 	/* return total; */
 }
+/**
+ * completion_shards: print completion list of all the shards
+ *
+ *	@param[in]	root	root directory
+ *	@param[in]	prefix	prefix of primary key
+ *	@param[in]	db	#GTAGS,#GRTAGS,#GSYMS
+ *	@return		number of words
+ *
+ * The words found in more than one shard are printed only once.
+ */
+static int
+completion_shards(const char *root, const char *prefix, int db)
+{
+	const char *tag;
+	int i, count = 0;
+
+	merge = dbop_open(NULL, 1, 0600, DBOP_RAW);
+	if (merge == NULL)
+		die("cannot open temporary file.");
+	for (i = 0; i < shards->count; i++)
+		if (shard_exist(shards, i))
+			(void)completion_tags(shard_dbpath(shards, i), root, prefix, db);
+	for (tag = dbop_first(merge, NULL, NULL, DBOP_KEY); tag != NULL; tag = dbop_next(merge)) {
+		fputs(tag, stdout);
+		fputc('\n', stdout);
+		count++;
+	}
+	dbop_close(merge);
+	merge = NULL;
+	return count;
+}
 /**
  * completion_idutils: print completion list of specified @a prefix
  *
@@ -1398,7 +1438,7 @@ put_syms(int type, const char *tag, int lno, const char *path, const char *line_
 			key = tag;
 		}
 		if (data->target == TARGET_REF || data->target == TARGET_SYM) {
-			if (dbop_get(data->dbop, key) != NULL) {
+			if (data->dbop ? dbop_get(data->dbop, key) != NULL : shard_defined(shards, key)) {
 				if (!(data->target & TARGET_REF))
 					return;
 			} else {
@@ -1450,8 +1490,8 @@ parsefile(char *const *argv, const char *cwd, const char *root, const char *dbpa
 	data.cv = convert_open(type, format, root, cwd, dbpath, stdout, db);
 	if (gpath_open(dbpath, 0) < 0)
 		die("GPATH not found.");
-	if (data.target == TARGET_REF || data.target == TARGET_SYM) {
-		data.dbop = dbop_open(makepath(dbpath, dbname(GTAGS), NULL), 0, 0, 0);
+	if ((data.target == TARGET_REF || data.target == TARGET_SYM) && !shards) {
+		data.dbop = dbop_open(makepath(dbpath, dbname(GTAGS), NULL), 0, 0, DBOP_BLOOM);
 		if (data.dbop == NULL)
 			die("%s not found.", dbname(GTAGS));
 	} else {
@@ -1494,7 +1534,7 @@ parsefile(char *const *argv, const char *cwd, const char *root, const char *dbpa
 		{
 			static char s_fid[MAXFIDLEN];
 			int type = 0;
-			const char *p = gpath_path2fid(path, &type);
+			const char *p = shards ? shard_path2fid(shards, path, &type) : gpath_path2fid(path, &type);
 
 			if (!p || type != GPATH_SOURCE) {
 				if (!qflag)
@@ -1525,6 +1565,122 @@ parsefile(char *const *argv, const char *cwd, const char *root, const char *dbpa
 		fprintf(stderr, " (no index used).\n");
 	}
 }
+/**
+ * @name Merging the shards
+ *
+ * While the shards are searched, the results are saved in a temporary
+ * database instead of being printed, and printed at last in the usual
+ * order: tag name, path name and line number.
+ *
+ * @code{.txt}
+ * key	= <tag name> ^A <path name> ^A <line number (10 digits)>
+ * data	= <file id> ^A <tag name> ^A <path name> ^A <line image>
+ * @endcode
+ * The tag name in the data may be longer than the key, like @CODE{Class::method}
+ * for @CODE{method}. The key is used only for the order, so the tag name and
+ * the path name in it are cut so as not to exceed #MAXKEYLEN.
+ */
+/** @{ */
+#define MERGESEP	'\001'
+/** length of the line number part of a key (with its separator) */
+#define MERGELINENO	11
+/**
+ * put_using: print a tag record, or save it while the shards are searched.
+ */
+static void
+put_using(CONVERT *cv, const char *key, const char *tag, const char *path, int lineno, const char *image, const char *fid)
+{
+	STATIC_STRBUF(kb);
+	STATIC_STRBUF(db);
+
+	if (merge == NULL) {
+		convert_put_using(cv, tag, path, lineno, image, fid);
+		return;
+	}
+	strbuf_clear(kb);
+	strbuf_puts(kb, key);
+	strbuf_putc(kb, MERGESEP);
+	strbuf_puts(kb, path);
+	if (strbuf_getlen(kb) > MAXKEYLEN - MERGELINENO)
+		strbuf_setlen(kb, MAXKEYLEN - MERGELINENO);
+	strbuf_putc(kb, MERGESEP);
+	strbuf_sprintf(kb, "%010d", lineno);
+	strbuf_clear(db);
+	strbuf_puts(db, fid ? fid : "0");
+	strbuf_putc(db, MERGESEP);
+	strbuf_puts(db, tag);
+	strbuf_putc(db, MERGESEP);
+	strbuf_puts(db, path);
+	strbuf_putc(db, MERGESEP);
+	strbuf_puts(db, image);
+	dbop_put(merge, strbuf_value(kb), strbuf_value(db));
+}
+/**
+ * put_path: print a path name, or save it while the shards are searched.
+ */
+static void
+put_path(CONVERT *cv, const char *path)
+{
+	if (merge)
+		dbop_put(merge, path, "");
+	else
+		convert_put_path(cv, path);
+}
+/**
+ * search_shards: search all the shards and merge the results.
+ *
+ *	@param[in]	pattern		search pattern
+ *	@param[in]	root		root of source tree
+ *	@param[in]	cwd		current directory
+ *	@param[in]	db		#GTAGS,#GRTAGS,#GSYMS
+ *	@return			count of output lines
+ */
+static int
+search_shards(const char *pattern, const char *root, const char *cwd, int db)
+{
+	CONVERT *cv;
+	STRBUF *ib = strbuf_open(0);
+	const char *dat;
+	int i, count = 0;
+
+	merge = dbop_open(NULL, 1, 0600, format == FORMAT_PATH ? DBOP_RAW : DBOP_RAW|DBOP_DUP);
+	if (merge == NULL)
+		die("cannot open temporary file.");
+	for (i = 0; i < shards->count; i++)
+		if (shard_exist(shards, i))
+			(void)search(pattern, root, cwd, shard_dbpath(shards, i), db);
+	cv = convert_open(type, format, root, cwd, dbpath, stdout, db);
+	for (dat = dbop_first(merge, NULL, NULL, 0); dat != NULL; dat = dbop_next(merge)) {
+		const char *lineno;
+		char *path, *fid, *tag, *image;
+
+		if (format == FORMAT_PATH) {
+			convert_put_path(cv, merge->lastkey);
+			count++;
+			continue;
+		}
+		strbuf_reset(ib);
+		strbuf_puts(ib, dat);
+		lineno = strrchr(merge->lastkey, MERGESEP);
+		fid = strbuf_value(ib);
+		tag = strchr(fid, MERGESEP);
+		path = tag ? strchr(++tag, MERGESEP) : NULL;
+		image = path ? strchr(++path, MERGESEP) : NULL;
+		if (lineno == NULL || image == NULL)
+			die("illegal merged record.");
+		tag[-1] = '\0';
+		path[-1] = '\0';
+		*image++ = '\0';
+		convert_put_using(cv, tag, path, atoi(lineno + 1), image, fid);
+		count++;
+	}
+	convert_close(cv);
+	dbop_close(merge);
+	merge = NULL;
+	strbuf_close(ib);
+	return count;
+}
+/** @} */
 /**
  * @fn int search(const char *pattern, const char *root, const char *cwd, const char *dbpath, int db)
  *
@@ -1544,6 +1700,62 @@ parsefile(char *const *argv, const char *cwd, const char *root, const char *dbpa
                 for (n = 0; isdigit(*p); p++)                                  \
                         n = n * 10 + (*p - '0');                                \
         } while (0)
+/**
+ * unfold_lines: get the line numbers of a record of compact format.
+ *
+ *	@param[in]	p	line numbers of the record
+ *	@param[in]	compline	#GTAGS_COMPLINE is set
+ *	@param[out]	vb	line numbers (int)
+ */
+static void
+unfold_lines(const char *p, int compline, VARRAY *vb)
+{
+	int n = 0;
+
+	varray_reset(vb);
+	if (compline) {
+		/*
+		 *
+		 * If GTAGS_COMPLINE flag is set, each line number is expressed as
+		 * the difference from the previous line number except for the head.
+		 * Please see flush_pool() in libutil/gtagsop.c for the details.
+		 */
+		int last = 0, cont = 0;
+
+		while (*p || cont > 0) {
+			if (cont > 0) {
+				n = last + 1;
+				if (n > cont) {
+					cont = 0;
+					continue;
+				}
+			} else if (isdigit(*p)) {
+				GET_NEXT_NUMBER(p);
+			}  else if (*p == '-') {
+				GET_NEXT_NUMBER(p);
+				cont = n + last;
+				n = last + 1;
+			} else if (*p == ',') {
+				GET_NEXT_NUMBER(p);
+				n += last;
+			}
+			*(int *)varray_append(vb) = last = n;
+		}
+	} else {
+		/*
+		 * In fact, when GTAGS_COMPACT is set, GTAGS_COMPLINE is allways set.
+		 * Therefore, the following code are not actually used.
+		 * However, it is left for some test.
+		 */
+		while (*p) {
+			for (n = 0; isdigit(*p); p++)
+				n = n * 10 + *p - '0';
+			if (*p == ',')
+				p++;
+			*(int *)varray_append(vb) = n;
+		}
+	}
+}
 int
 search(const char *pattern, const char *root, const char *cwd, const char *dbpath, int db)
 {
@@ -1555,6 +1767,8 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 	STRBUF *sb = NULL, *ib = NULL;
 	char curpath[MAXPATHLEN], curtag[IDENTLEN];
 	FILE *fp = NULL;
+	LINEINDEX *li = NULL;
+	VARRAY *lb = NULL;
 	const char *src = "";
 	int lineno, last_lineno;
 
@@ -1564,6 +1778,8 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 	 * open tag file.
 	 */
 	gtop = gtags_open(dbpath, root, db, GTAGS_READ, 0);
+	if (merge)			/* in a shard */
+		gtop->shards = shards;
 	cv = convert_open(type, format, root, cwd, dbpath, stdout, db);
 	/*
 	 * search through tag file.
@@ -1584,13 +1800,17 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 		flags |= GTOP_BASICREGEX;
 	if (format == FORMAT_PATH)
 		flags |= GTOP_PATH;
-	if (gtop->format & GTAGS_COMPACT)
+	if (gtop->format & GTAGS_COMPACT) {
 		ib = strbuf_open(0);
+		lb = varray_open(sizeof(int), 100);
+		if (!nosource)
+			li = lineindex_open(dbpath, 0);
+	}
 	for (gtp = gtags_first(gtop, pattern, flags); gtp; gtp = gtags_next(gtop)) {
 		if (lflag && !locatestring(gtp->path, localprefix, MATCH_AT_FIRST))
 			continue;
 		if (format == FORMAT_PATH) {
-			convert_put_path(cv, gtp->path);
+			put_path(cv, gtp->path);
 			count++;
 		} else if (gtop->format & GTAGS_COMPACT) {
 			/*
@@ -1600,7 +1820,7 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 			 */
 			char *p = (char *)gtp->tagline;
 			const char *fid, *tagname;
-			int n = 0;
+			int i, n;
 
 			fid = p;
 			while (*p != ' ')
@@ -1617,15 +1837,22 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 				if (strcmp(gtp->path, curpath) != 0) {
 					if (curpath[0] != '\0' && fp != NULL)
 						fclose(fp);
+					fp = NULL;
 					strlimcpy(curtag, tagname, sizeof(curtag));
 					strlimcpy(curpath, gtp->path, sizeof(curpath));
 					/*
-					 * Use absolute path name to support GTAGSROOT
-					 * environment variable.
+					 * If the line offsets of the file are available,
+					 * only the lines needed are read.
 					 */
-					fp = fopen(makepath(root, curpath, NULL), "r");
-					if (fp == NULL)
-						warning("source file '%s' is not available.", curpath);
+					if (li == NULL || lineindex_load(li, fid, root, curpath) < 0) {
+						/*
+						 * Use absolute path name to support GTAGSROOT
+						 * environment variable.
+						 */
+						fp = fopen(makepath(root, curpath, NULL), "r");
+						if (fp == NULL)
+							warning("source file '%s' is not available.", curpath);
+					}
 					last_lineno = lineno = 0;
 				} else if (strcmp(gtp->tag, curtag) != 0) {
 					strlimcpy(curtag, gtp->tag, sizeof(curtag));
@@ -1641,63 +1868,26 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 			 */
 			if (!isdigit(*p))
 				die("illegal compact format.");
-			if (gtop->format & GTAGS_COMPLINE) {
-				/*
-				 *
-				 * If GTAGS_COMPLINE flag is set, each line number is expressed as
-				 * the difference from the previous line number except for the head.
-				 * Please see flush_pool() in libutil/gtagsop.c for the details.
-				 */
-				int last = 0, cont = 0;
-
-				while (*p || cont > 0) {
-					if (cont > 0) {
-						n = last + 1;
-						if (n > cont) {
-							cont = 0;
-							continue;
-						}
-					} else if (isdigit(*p)) {
-						GET_NEXT_NUMBER(p);
-					}  else if (*p == '-') {
-						GET_NEXT_NUMBER(p);
-						cont = n + last;
-						n = last + 1;
-					} else if (*p == ',') {
-						GET_NEXT_NUMBER(p);
-						n += last;
-					}
-					if (last_lineno != n && fp) {
-						while (lineno < n) {
-							if (!(src = strbuf_fgets(ib, fp, STRBUF_NOCRLF))) {
-								src = "";
-								fclose(fp);
-								fp = NULL;
-								break;
-							}
-							lineno++;
-						}
-					}
-					if (gtop->format & GTAGS_COMPNAME)
-						tagname = (char *)uncompress(tagname, gtp->tag);
-					convert_put_using(cv, tagname, gtp->path, n, src, fid);
-					count++;
-					last_lineno = last = n;
-				}
-			} else {
+			unfold_lines(p, gtop->format & GTAGS_COMPLINE, lb);
+			/*
+			 * The line numbers are sorted. Tell the system the range
+			 * of the lines which will be read.
+			 */
+			if (li && li->fd >= 0 && lb->length > 0)
+				lineindex_willneed(li, *(int *)varray_assign(lb, 0, 0),
+					*(int *)varray_assign(lb, lb->length - 1, 0));
+			for (i = 0; i < lb->length; i++) {
+				n = *(int *)varray_assign(lb, i, 0);
 				/*
 				 * In fact, when GTAGS_COMPACT is set, GTAGS_COMPLINE is allways set.
-				 * Therefore, the following code are not actually used.
-				 * However, it is left for some test.
+				 * Without GTAGS_COMPLINE, a line is printed only once.
 				 */
-				while (*p) {
-					for (n = 0; isdigit(*p); p++)
-						n = n * 10 + *p - '0';
-					if (*p == ',')
-						p++;
-					if (last_lineno == n)
-						continue;
-					if (last_lineno != n && fp) {
+				if (!(gtop->format & GTAGS_COMPLINE) && last_lineno == n)
+					continue;
+				if (last_lineno != n) {
+					if (li && li->fd >= 0) {
+						src = lineindex_get(li, n);
+					} else if (fp) {
 						while (lineno < n) {
 							if (!(src = strbuf_fgets(ib, fp, STRBUF_NOCRLF))) {
 								src = "";
@@ -1708,45 +1898,39 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 							lineno++;
 						}
 					}
-					if (gtop->format & GTAGS_COMPNAME)
-						tagname = (char *)uncompress(tagname, gtp->tag);
-					convert_put_using(cv, tagname, gtp->path, n, src, fid);
-					count++;
-					last_lineno = n;
 				}
+				if (gtop->format & GTAGS_COMPNAME)
+					tagname = (char *)uncompress(tagname, gtp->tag);
+				put_using(cv, gtp->tag, tagname, gtp->path, n, src, fid);
+				count++;
+				last_lineno = n;
 			}
 		} else {
 			/*
 			 * Standard format:
-			 *                    a          b         c
 			 * tagline = <file id> <tag name> <line no> <line image>
+			 * (See gtags_decode() for the binary record.)
 			 */
-			char *p = (char *)gtp->tagline;
-			char namebuf[IDENTLEN];
-			const char *fid, *tagname, *image;
+			GTREC rec;
+			char fid[MAXFIDLEN], namebuf[IDENTLEN];
+			const char *image;
+			int len;
 
-			fid = p;
-			while (*p != ' ')
-				p++;
-			*p++ = '\0';			/* a */
-			tagname = p;
-			while (*p != ' ')
-				p++;
-			*p++ = '\0';			/* b */
-			if (gtop->format & GTAGS_COMPNAME) {
-				strlimcpy(namebuf, (char *)uncompress(tagname, gtp->tag), sizeof(namebuf));
-				tagname = namebuf;
-			}
+			gtags_decode(gtp->tagline, strlen(gtp->tagline) + 1, gtop->format, &rec);
+			snprintf(fid, sizeof(fid), "%u", rec.fid);
+			len = rec.namelen < sizeof(namebuf) ? rec.namelen : sizeof(namebuf) - 1;
+			memcpy(namebuf, rec.name, len);
+			namebuf[len] = '\0';
+			if (gtop->format & GTAGS_COMPNAME)
+				strlimcpy(namebuf, (char *)uncompress(namebuf, gtp->tag), sizeof(namebuf));
 			if (nosource) {
 				image = " ";
 			} else {
-				while (*p != ' ')
-					p++;
-				image = p + 1;		/* c + 1 */
+				image = rec.image;
 				if (gtop->format & GTAGS_COMPRESS)
 					image = (char *)uncompress(image, gtp->tag);
 			}
-			convert_put_using(cv, tagname, gtp->path, gtp->lineno, image, fid);
+			put_using(cv, gtp->tag, namebuf, gtp->path, gtp->lineno, image, fid);
 			count++;
 		}
 	}
@@ -1757,6 +1941,10 @@ search(const char *pattern, const char *root, const char *cwd, const char *dbpat
 		strbuf_close(ib);
 	if (fp)
 		fclose(fp);
+	if (lb)
+		varray_close(lb);
+	if (li)
+		lineindex_close(li);
 	gtags_close(gtop);
 	return count;
 }
@@ -1778,7 +1966,10 @@ tagsearch(const char *pattern, const char *cwd, const char *root, const char *db
 	/*
 	 * search in current source tree.
 	 */
-	count = search(pattern, root, cwd, dbpath, db);
+	if (shards)
+		count = search_shards(pattern, root, cwd, db);
+	else
+		count = search(pattern, root, cwd, dbpath, db);
 	total += count;
 	/*
 	 * search in library path.
@@ -19,6 +19,15 @@ const char *help_const = "Options:\n\
        The argument file can  be set to - to accept a list of\n\
        files from the standard input.\n\
        File names must be separated by newline.\n\
+--git-index\n\
+       Take the list of source files from the git index (.git/index)\n\
+       instead of traversing the source tree, when the current directory\n\
+       is the top of a git working tree.\n\
+       The object names of the contents recorded in the index are also used\n\
+       to know whether a file has been changed without reading it.\n\
+       Untracked files are ignored unless the --untracked option is specified.\n\
+       If the index is not available or not supported, gtags traverses\n\
+       the source tree as usual.\n\
 --gtagsconf file\n\
        Set the GTAGSCONF environment variable to file.\n\
 --gtagslabel label\n\
@@ -28,25 +37,72 @@ const char *help_const = "Options:\n\
 -i, --incremental\n\
        Update tag files incrementally. You had better use\n\
        global(1) with the -u option.\n\
+--jobs number\n\
+       Parse source files with number processes in parallel.\n\
+       The default is 1.\n\
+       The tag files are the same as those made without this option.\n\
 -O, --objdir\n\
        Use BSD-style objdir as the location of tag files.\n\
        If $MAKEOBJDIRPREFIX directory exists, gtags creates\n\
        $MAKEOBJDIRPREFIX/<current directory> directory and makes\n\
        tag files in it.\n\
        If dbpath is specified, this option is ignored.\n\
+--profile file\n\
+       Write the profile of parsing to file.\n\
+       For each file parsed, a line is written with the parse time\n\
+       in seconds, the size, the number of tag records, the language,\n\
+       the parser and the path name, separated by tabs.\n\
+       The argument file can be set to - to write it to\n\
+       the standard output.\n\
+       At the end, the slowest files are reported to the standard\n\
+       error output. It helps to tune the skip list and the langmap.\n\
+--shard[=dir]\n\
+       Divide tag files into shards, one for each directory\n\
+       at the top of the source tree. The shards are made in the\n\
+       GSHARDS directory and are updated independently by\n\
+       the -i option. Global merges the results of all the shards.\n\
+       If dir is specified, only the shard of the directory\n\
+       is made or remade, and the other shards are left as they are.\n\
+       Files in a directory which has no shard belong to the root shard.\n\
+       Running gtags without this option removes the shards.\n\
+       Htags does not support sharded tag files.\n\
 --single-update file\n\
        Update tag files for single file.\n\
        It is considered that file was added or updated,\n\
        and there is no change in other files.\n\
        This option implies the -i option.\n\
---statistics\n\
+--statistics[=style]\n\
        Print statistics information.\n\
+       The style is one of 'table' (the default), 'list'\n\
+       and 'json'. The 'json' style prints the time and the\n\
+       counters of each period to the standard output: the number of\n\
+       files and bytes parsed and their rates per second, the number of\n\
+       definitions and references, the number of dbop_put calls,\n\
+       and the number of page splits, cache hits, cache misses and\n\
+       cache evictions of the B-tree.\n\
 -q, --quiet\n\
        Quiet mode.\n\
+--untracked\n\
+       Also accept files which are not tracked by git.\n\
+       They are found by traversing the source tree with the skip list.\n\
+       The exclude files of git (.gitignore) are not read,\n\
+       so ignored files are accepted as well.\n\
+       This option implies the --git-index option.\n\
 -v, --verbose\n\
        Verbose mode.\n\
 -w, --warning\n\
        Print warning messages.\n\
+--watch\n\
+       After making or updating tag files, keep watching the source tree\n\
+       and update them whenever source files are added, changed or removed.\n\
+       Changes made in a short time are applied at a time.\n\
+       The skip list and the language mapping in the configuration file\n\
+       are applied as well as the -i option.\n\
+       Gtags stops after finishing the current update\n\
+       when it receives SIGINT, SIGTERM or SIGHUP.\n\
+       This option implies the -i option, and is available only on\n\
+       systems which support inotify(7).\n\
+       It cannot be used with the --shard option.\n\
 dbpath\n\
        The directory in which tag files are generated.\n\
        The default is the current directory.\n\
@@ -49,11 +49,17 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
 #include "getopt.h"
 
 #include "global.h"
 #include "parser.h"
 #include "const.h"
+#include "parallel.h"
+#include "profile.h"
+#include "watch.h"
 
 /**
  @file
@@ -63,9 +69,14 @@
 static void usage(void);
 static void help(void);
 int main(int, char **);
-int incremental(const char *, const char *);
+int incremental(const char *, const char *, STRBUF *);
+static int modified(const char *, time_t);
 void updatetags(const char *, const char *, IDSET *, STRBUF *);
 void createtags(const char *, const char *);
+static void watchtags(const char *, const char *);
+static int update(const char *, const char *, STRBUF *);
+static void makeshards(const char *, const char *);
+static void removeshards(const char *, STRBUF *);
 int printconf(const char *);
 
 int cflag;					/**< compact format */
@@ -86,6 +97,15 @@ const char *file_list;
 const char *dump_target;
 char *single_update;
 int statistics = STATISTICS_STYLE_NONE;
+int jobs = 1;					/**< number of parsing processes */
+int watching;					/**< keep updating (--watch) */
+const char *profile_file;			/**< profile of parsing (--profile) */
+int use_gitindex;				/**< read the git index (--git-index) */
+int untracked;					/**< read untracked files too (--untracked) */
+int sharding;					/**< make sharded tag files (--shard) */
+const char *shard_only;				/**< make only this shard (--shard=dir) */
+static SHARDS *shards;				/**< shards of the tag files */
+static int cur_shard;				/**< shard being made or updated */
 
 #define GTAGSFILES "gtags.files"
 
@@ -98,6 +118,7 @@ int convert_type = PATH_RELATIVE;
 /** @} */
 
 int extractmethod;
+int indexes;					/**< optional indexes of the tag files (#GTAGS_TRIGRAM, #GTAGS_FOLD) */
 int total;
 
 static void
@@ -145,11 +166,17 @@ static struct option const long_options[] = {
 #define OPT_SINGLE_UPDATE	132
 #define OPT_ENCODE_PATH		133
 #define OPT_ACCEPT_DOTFILES	134
+#define OPT_JOBS		135
+#define OPT_STATISTICS		136
+#define OPT_PROFILE		137
+#define OPT_SHARD		138
 	/* flag value */
 	{"accept-dotfiles", no_argument, NULL, OPT_ACCEPT_DOTFILES},
 	{"debug", no_argument, &debug, 1},
-	{"statistics", no_argument, &statistics, STATISTICS_STYLE_TABLE},
+	{"git-index", no_argument, &use_gitindex, 1},
+	{"untracked", no_argument, &untracked, 1},
 	{"version", no_argument, &show_version, 1},
+	{"watch", no_argument, &watching, 1},
 	{"help", no_argument, &show_help, 1},
 
 	/* accept value */
@@ -157,8 +184,12 @@ static struct option const long_options[] = {
 	{"encode-path", required_argument, NULL, OPT_ENCODE_PATH},
 	{"gtagsconf", required_argument, NULL, OPT_GTAGSCONF},
 	{"gtagslabel", required_argument, NULL, OPT_GTAGSLABEL},
+	{"jobs", required_argument, NULL, OPT_JOBS},
 	{"path", required_argument, NULL, OPT_PATH},
+	{"profile", required_argument, NULL, OPT_PROFILE},
+	{"shard", optional_argument, NULL, OPT_SHARD},
 	{"single-update", required_argument, NULL, OPT_SINGLE_UPDATE},
+	{"statistics", optional_argument, NULL, OPT_STATISTICS},
 	{ 0 }
 };
 
@@ -217,6 +248,27 @@ main(int argc, char **argv)
 		case OPT_ACCEPT_DOTFILES:
 			set_accept_dotfiles();
 			break;
+		case OPT_JOBS:
+			jobs = atoi(optarg);
+			if (jobs < 1)
+				die("--jobs: the number of jobs must be a positive integer.");
+			break;
+		case OPT_PROFILE:
+			profile_file = optarg;
+			break;
+		case OPT_SHARD:
+			sharding = 1;
+			if (optarg) {
+				if (*optarg == '\0' || strchr(optarg, '/') || *optarg == '.')
+					die("--shard: '%s' is not a top level directory.", optarg);
+				shard_only = optarg;
+			}
+			break;
+		case OPT_STATISTICS:
+			statistics = optarg ? statistics_style(optarg) : STATISTICS_STYLE_TABLE;
+			if (statistics < 0)
+				die("--statistics: unknown style '%s'.", optarg);
+			break;
 		case 'c':
 			cflag++;
 			break;
@@ -273,6 +325,17 @@ main(int argc, char **argv)
 		version(NULL, vflag);
 	if (show_help)
 		help();
+	if (untracked)
+		use_gitindex = 1;
+	if (watching) {
+		if (single_update)
+			die("--watch and --single-update cannot be used together.");
+		if (sharding)
+			die("--watch and --shard cannot be used together.");
+		iflag++;
+	}
+	if (sharding && iflag)
+		die("--shard cannot be used with the -i option. The shards are updated by -i.");
 
 	argc -= optind;
         argv += optind;
@@ -324,7 +387,7 @@ main(int argc, char **argv)
 		 */
 		DBOP *dbop = NULL;
 		const char *dat = 0;
-		int is_gpath = 0;
+		int is_gpath = 0, is_binary = 0;
 
 		if (!test("f", dump_target))
 			die("file '%s' not found.", dump_target);
@@ -335,10 +398,21 @@ main(int argc, char **argv)
 		 */
 		if (dbop_get(dbop, NEXTKEY))
 			is_gpath = 1;
+		/*
+		 * Binary records are printed in the text form.
+		 */
+		if (dbop_getoption(dbop, BINARYKEY))
+			is_binary = 1;
 		for (dat = dbop_first(dbop, NULL, NULL, 0); dat != NULL; dat = dbop_next(dbop)) {
 			const char *flag = is_gpath ? dbop_getflag(dbop) : "";
 
-			if (*flag)
+			if (is_binary && *dbop->lastkey != ' ') {
+				GTREC rec;
+
+				gtags_decode(dat, dbop->lastsize, GTAGS_BINARY, &rec);
+				printf("%s\t%u %.*s %d %s\n", dbop->lastkey,
+					rec.fid, rec.namelen, rec.name, rec.lineno, rec.image);
+			} else if (*flag)
 				printf("%s\t%s\t%s\n", dbop->lastkey, dat, flag);
 			else
 				printf("%s\t%s\n", dbop->lastkey, dat);
@@ -444,6 +518,10 @@ main(int argc, char **argv)
 	openconf();
 	if (getconfb("extractmethod"))
 		extractmethod = 1;
+	if (getconfb("trigram_index"))
+		indexes |= GTAGS_TRIGRAM;
+	if (getconfb("icase_index"))
+		indexes |= GTAGS_FOLD;
 	strbuf_reset(sb);
 	if (getconfs("langmap", sb))
 		langmap = check_strdup(strbuf_value(sb));
@@ -462,6 +540,14 @@ main(int argc, char **argv)
 	 * Start statistics.
 	 */
 	init_statistics();
+	if (profile_file)
+		profile_open(profile_file);
+	/*
+	 * Start watching before the first update not to miss the changes
+	 * made during it.
+	 */
+	if (watching && watch_open(cwd, dbpath) < 0)
+		die("--watch is not supported on this system.");
 	/*
 	 * incremental update.
 	 */
@@ -470,7 +556,7 @@ main(int argc, char **argv)
 		 * Version check. If existing tag files are old enough
 		 * gtagsopen() abort with error message.
 		 */
-		GTOP *gtop = gtags_open(dbpath, cwd, GTAGS, GTAGS_MODIFY, 0);
+		GTOP *gtop = gtags_open(dbpath, cwd, GTAGS, GTAGS_READ, 0);
 		gtags_close(gtop);
 		/*
 		 * GPATH is needed for incremental updating.
@@ -479,14 +565,25 @@ main(int argc, char **argv)
 		 */
 		if (!test("f", makepath(dbpath, dbname(GPATH), NULL)))
 			die("Old version tag file found. Please remake it.");
-		(void)incremental(dbpath, cwd);
+		shards = shard_open(dbpath);
+		(void)update(dbpath, cwd, NULL);
+		if (watching)
+			watchtags(dbpath, cwd);
+		if (profile_file)
+			profile_close();
+		parser_exit();
 		print_statistics(statistics);
 		exit(0);
 	}
 	/*
 	 * create GTAGS and GRTAGS
 	 */
-	createtags(dbpath, cwd);
+	if (sharding) {
+		makeshards(dbpath, cwd);
+	} else {
+		removeshards(dbpath, NULL);
+		createtags(dbpath, cwd);
+	}
 	/*
 	 * create idutils index.
 	 */
@@ -517,21 +614,185 @@ main(int argc, char **argv)
 	}
 	if (vflag)
 		fprintf(stderr, "[%s] Done.\n", now());
+	if (watching)
+		watchtags(dbpath, cwd);
+	if (profile_file)
+		profile_close();
+	parser_exit();
 	closeconf();
 	strbuf_close(sb);
 	print_statistics(statistics);
 
 	return 0;
 }
+/**
+ * open_gitindex: load the git index if requested
+ *
+ *	@param[in]	root	root directory of source tree
+ *	@return		git index, or @VAR{NULL} if not requested or not available
+ *
+ * The index is loaded for each updating, since it may have been
+ * changed by git in the meantime.
+ */
+static GITINDEX *
+open_gitindex(const char *root)
+{
+	GITINDEX *gi;
+
+	if (!use_gitindex)
+		return NULL;
+	gi = gitindex_open(root);
+	if (gi == NULL) {
+		if (vflag)
+			fprintf(stderr, " Git index not available. Traversing the source tree.\n");
+		return NULL;
+	}
+	gpath_set_gitindex(gi);
+	return gi;
+}
+/**
+ * close_gitindex: unload the git index
+ *
+ *	@param[in]	gi	git index
+ */
+static void
+close_gitindex(GITINDEX *gi)
+{
+	if (gi == NULL)
+		return;
+	gpath_set_gitindex(NULL);
+	gitindex_close(gi);
+}
+/**
+ * in_shard: whether or not a path belongs to the current shard
+ *
+ *	@param[in]	path	path name
+ *	@return		1: belongs, 0: doesn't belong
+ */
+static int
+in_shard(const char *path)
+{
+	return shards == NULL || shard_lookup(shards, path) == cur_shard;
+}
+/**
+ * open_files: start reading the files of the project
+ *
+ *	@param[in]	root	root directory of source tree
+ *	@param[in]	gi	git index, or @VAR{NULL}
+ *
+ * If the tag files are sharded, only the files of the current shard are read
+ * by read_file(). The traversal of a shard starts at its directory.
+ */
+static void
+open_files(const char *root, GITINDEX *gi)
+{
+	char start[MAXPATHLEN];
+
+	if (file_list)
+		find_open_filelist(file_list, root);
+	else if (gi)
+		find_open_gitindex(gi, untracked);
+	else if (shards && cur_shard > 0
+	    && snprintf(start, sizeof(start), "./%s/", shard_name(shards, cur_shard)) < sizeof(start)
+	    && test("d", start))
+		find_open(start);
+	else
+		find_open(NULL);
+}
+/**
+ * read_file: read a file of the project
+ *
+ *	@return		path name (a blank at the head means 'NOT SOURCE')
+ */
+static const char *
+read_file(void)
+{
+	const char *path;
+
+	while ((path = find_read()) != NULL)
+		if (in_shard(*path == ' ' ? path + 1 : path))
+			break;
+	return path;
+}
+/**
+ * modified: check whether a source file has been changed since it was parsed
+ *
+ *	@param[in]	path	path name
+ *	@param[in]	gtags_mtime	modified time of GTAGS
+ *	@return		1: modified, 0: not modified
+ *
+ * The size, modified time and inode number of a file are compared with the
+ * status recorded in GPATH. If only the time or the inode number differs,
+ * as after @CODE{touch} or @CODE{git checkout}, the contents are compared
+ * by the hash value, and the new status is recorded for the next time.
+ * A file modified in the same second as it was recorded cannot be
+ * distinguished by the time, so its contents are always compared.
+ * If no status is recorded, the modified time is compared with GTAGS.
+ * With the @OPTION{--git-index} option, the object names of the contents
+ * taken from the git index are compared instead of the hash values.
+ * The file is read only when the contents must be compared by the hash
+ * values, and it is regarded as modified if no hash value is recorded.
+ */
+static int refreshed;		/**< the status of a file was recorded again */
+static int
+modified(const char *path, time_t gtags_mtime)
+{
+	FILESTAT old, cur;
+
+	if (gpath_filestat(path, &cur) < 0)
+		die("stat failed '%s'.", path);
+	if (gpath_getstat(path, &old) < 0)
+		return (unsigned long)gtags_mtime < cur.mtime;
+	if (cur.size != old.size)
+		return 1;
+	/*
+	 * If the git index knows the contents of the file, they can be
+	 * compared by the object names without reading the file.
+	 */
+	if (cur.blob[0] && old.blob[0]) {
+		if (strcmp(cur.blob, old.blob))
+			return 1;
+		if (cur.mtime != old.mtime || cur.ino != old.ino) {
+			cur.hash = old.hash;
+			cur.hashed = old.hashed;
+			gpath_putstat(path, &cur);
+			refreshed = 1;
+		}
+		return 0;
+	}
+	if (cur.mtime == old.mtime && cur.ino == old.ino && old.mtime < (unsigned long)gtags_mtime) {
+		/*
+		 * Record the object name for the next time.
+		 */
+		if (cur.blob[0]) {
+			cur.hash = old.hash;
+			cur.hashed = old.hashed;
+			gpath_putstat(path, &cur);
+			refreshed = 1;
+		}
+		return 0;
+	}
+	if (!old.hashed || gpath_filehash(path, &cur) < 0)
+		return 1;
+	if (cur.hash != old.hash)
+		return 1;
+	if (cur.mtime != old.mtime || cur.ino != old.ino) {
+		gpath_putstat(path, &cur);
+		refreshed = 1;
+	}
+	return 0;
+}
 /**
  * incremental: incremental update
  *
  *	@param[in]	dbpath	dbpath directory
  *	@param[in]	root	root directory of source tree
+ *	@param[in]	files	list of the path names which may have been changed <br>
+ *			If @VAR{NULL}, all files in the project are inspected.
  *	@return		0: not updated, 1: updated
  */
 int
-incremental(const char *dbpath, const char *root)
+incremental(const char *dbpath, const char *root, STRBUF *files)
 {
 	STATISTICS_TIME *tim;
 	struct stat statp;
@@ -540,7 +801,8 @@ incremental(const char *dbpath, const char *root)
 	STRBUF *deletelist = strbuf_open(0);
 	STRBUF *addlist_other = strbuf_open(0);
 	IDSET *deleteset, *findset;
-	int updated = 0;
+	GITINDEX *gi;
+	int db, updated = 0;
 	const char *path;
 	unsigned int id, limit;
 
@@ -556,9 +818,11 @@ incremental(const char *dbpath, const char *root)
 	if (stat(path, &statp) < 0)
 		die("stat failed '%s'.", path);
 	gtags_mtime = statp.st_mtime;
+	refreshed = 0;
 
 	if (gpath_open(dbpath, 2) < 0)
 		die("GPATH not found.");
+	gi = open_gitindex(root);
 	/*
 	 * deleteset:
 	 *	The list of the path name which should be deleted from GPATH.
@@ -598,37 +862,65 @@ incremental(const char *dbpath, const char *root)
 			strbuf_puts0(addlist, single_update);
 			total++;
 		}
+	} else if (files) {
+		const char *start = strbuf_value(files);
+		const char *end = start + strbuf_getlen(files);
+		const char *fid;
+		int type;
+
+		for (path = start; path < end; path += strlen(path) + 1) {
+			if (!in_shard(path))
+				continue;
+			fid = gpath_path2fid(path, &type);
+			if (!test("f", path)) {
+				/* removed file */
+				if (fid) {
+					strbuf_puts0(deletelist, path);
+					if (type == GPATH_SOURCE)
+						idset_add(deleteset, atoi(fid));
+				}
+			} else if (fid == NULL) {
+				/* new file */
+				if (issourcefile(path)) {
+					strbuf_puts0(addlist, path);
+					total++;
+				} else if (!test("b", path))
+					strbuf_puts0(addlist_other, path);
+			} else if (type == GPATH_SOURCE) {
+				if (modified(path, gtags_mtime)) {
+					strbuf_puts0(addlist, path);
+					total++;
+					idset_add(deleteset, atoi(fid));
+				}
+			} else if (test("b", path)) {
+				strbuf_puts0(deletelist, path);
+			}
+		}
 	} else {
-		if (file_list)
-			find_open_filelist(file_list, root);
-		else
-			find_open(NULL);
-		while ((path = find_read()) != NULL) {
+		open_files(root, gi);
+		while ((path = read_file()) != NULL) {
 			const char *fid;
 			int n_fid = 0;
 			int other = 0;
 
 			/* a blank at the head of path means 'NOT SOURCE'. */
 			if (*path == ' ') {
-				if (test("b", ++path))
-					continue;
+				path++;
 				other = 1;
 			}
-			if (stat(path, &statp) < 0)
-				die("stat failed '%s'.", path);
 			fid = gpath_path2fid(path, NULL);
 			if (fid) { 
 				n_fid = atoi(fid);
 				idset_add(findset, n_fid);
 			}
 			if (other) {
-				if (fid == NULL)
+				if (fid == NULL && !test("b", path))
 					strbuf_puts0(addlist_other, path);
 			} else {
 				if (fid == NULL) {
 					strbuf_puts0(addlist, path);
 					total++;
-				} else if (gtags_mtime < statp.st_mtime) {
+				} else if (modified(path, gtags_mtime)) {
 					strbuf_puts0(addlist, path);
 					total++;
 					idset_add(deleteset, n_fid);
@@ -654,12 +946,15 @@ incremental(const char *dbpath, const char *root)
 			/*
 			 * The file which does not exist in the findset is treated
 			 * assuming that it does not exist in the file system.
+			 * The files in the findset have been found as regular
+			 * files by find_read(), so they are not examined again,
+			 * but an other file which has become binary is removed.
 			 */
 			if (type == GPATH_OTHER) {
-				if (!idset_contains(findset, id) || !test("f", path) || test("b", path))
+				if (!idset_contains(findset, id) || test("b", path))
 					strbuf_puts0(deletelist, path);
 			} else {
-				if (!idset_contains(findset, id) || !test("f", path)) {
+				if (!idset_contains(findset, id)) {
 					strbuf_puts0(deletelist, path);
 					idset_add(deleteset, id);
 				}
@@ -673,7 +968,6 @@ incremental(const char *dbpath, const char *root)
 	if ((!idset_empty(deleteset) || strbuf_getlen(addlist) > 0) ||
 	    (strbuf_getlen(deletelist) + strbuf_getlen(addlist_other) > 0))
 	{
-		int db;
 		updated = 1;
 		tim = statistics_time_start("Time of updating %s and %s.", dbname(GTAGS), dbname(GRTAGS));
 		if (!idset_empty(deleteset) || strbuf_getlen(addlist) > 0)
@@ -701,12 +995,6 @@ incremental(const char *dbpath, const char *root)
 			}
 			/* gpath_close(); */
 		}
-		/*
-		 * Update modification time of tag files
-		 * because they may have no definitions.
-		 */
-		for (db = GTAGS; db < GTAGLIM; db++)
-			utime(makepath(dbpath, dbname(db), NULL), NULL);
 		statistics_time_end(tim);
 	}
 exit:
@@ -720,12 +1008,179 @@ exit:
 	strbuf_close(addlist);
 	strbuf_close(deletelist);
 	strbuf_close(addlist_other);
+	close_gitindex(gi);
 	gpath_close();
+	/*
+	 * The updated tag files replace the old ones at once.
+	 */
+	if (updated) {
+		dbop_publish();
+		/*
+		 * Update modification time of tag files
+		 * because they may have no definitions.
+		 */
+		for (db = GTAGS; db < GTAGLIM; db++)
+			utime(makepath(dbpath, dbname(db), NULL), NULL);
+	} else if (refreshed) {
+		/*
+		 * Only the status of some files was recorded again in GPATH.
+		 * Keep it, so that their contents are not compared next time.
+		 */
+		dbop_publish();
+	} else
+		dbop_discard();
 	idset_close(deleteset);
 	idset_close(findset);
 
 	return updated;
 }
+/**
+ * update: incremental update of the tag files
+ *
+ *	@param[in]	dbpath	dbpath directory
+ *	@param[in]	root	root directory of source tree
+ *	@param[in]	files	list of the path names which may have been changed <br>
+ *			If @VAR{NULL}, all files in the project are inspected.
+ *	@return		0: not updated, 1: updated
+ *
+ * If the tag files are sharded, each shard is updated independently.
+ * A shard whose tag files are missing is made again.
+ */
+static int
+update(const char *dbpath, const char *root, STRBUF *files)
+{
+	int i, updated = 0;
+
+	if (shards == NULL)
+		return incremental(dbpath, root, files);
+	for (i = 0; i < shards->count; i++) {
+		if (single_update && shard_lookup(shards, single_update) != i)
+			continue;
+		cur_shard = i;
+		if (vflag && i > 0)
+			fprintf(stderr, " Shard '%s'.\n", shard_name(shards, i));
+		if (!shard_exist(shards, i)) {
+			createtags(shard_dbpath(shards, i), root);
+			updated = 1;
+		} else if (incremental(shard_dbpath(shards, i), root, files)) {
+			updated = 1;
+		}
+	}
+	return updated;
+}
+/**
+ * makeshards: create sharded tag files
+ *
+ *	@param[in]	dbpath	dbpath directory
+ *	@param[in]	root	root directory of source tree
+ *
+ * A shard is made for each top level directory which is not skipped, and
+ * the other files go to the root shard in @a dbpath.
+ * With the @OPTION{--shard=dir} option, only the shard of the directory is
+ * made, and its files are removed from the root shard.
+ */
+static void
+makeshards(const char *dbpath, const char *root)
+{
+	STRBUF *names = strbuf_open(0);
+	const char *name, *end;
+	char path[MAXPATHLEN];
+
+	if (shard_only) {
+		snprintf(path, sizeof(path), "./%s/", shard_only);
+		if (!test("d", path) || skipthisfile(path))
+			die("--shard: '%s' is not a top level directory.", shard_only);
+		strbuf_puts0(names, shard_only);
+	} else {
+		DIR *dirp;
+		struct dirent *dp;
+
+		if ((dirp = opendir(root)) == NULL)
+			die("cannot open directory '%s'.", root);
+		while ((dp = readdir(dirp)) != NULL) {
+			if (!strcmp(dp->d_name, ".") || !strcmp(dp->d_name, ".."))
+				continue;
+			snprintf(path, sizeof(path), "./%s/", dp->d_name);
+			if (test("d", path) && !skipthisfile(path))
+				strbuf_puts0(names, dp->d_name);
+		}
+		(void)closedir(dirp);
+		removeshards(dbpath, names);
+	}
+	end = strbuf_value(names) + strbuf_getlen(names);
+	for (name = strbuf_value(names); name < end; name += strlen(name) + 1) {
+		snprintf(path, sizeof(path), "%s/%s", GSHARDS, name);
+		if (makedirectories(dbpath, path, vflag) < 0)
+			die("cannot make directory '%s'.", makepath(dbpath, path, NULL));
+	}
+	shards = shard_open(dbpath);
+	for (name = strbuf_value(names); name < end; name += strlen(name) + 1) {
+		snprintf(path, sizeof(path), "./%s/", name);
+		cur_shard = shard_lookup(shards, path);
+		if (vflag)
+			fprintf(stderr, " Shard '%s'.\n", name);
+		createtags(shard_dbpath(shards, cur_shard), root);
+	}
+	/*
+	 * The root shard.
+	 */
+	cur_shard = 0;
+	if (shard_only && shard_exist(shards, 0))
+		(void)incremental(dbpath, root, NULL);
+	else
+		createtags(dbpath, root);
+	strbuf_close(names);
+}
+/**
+ * removeshards: remove the shards of the tag files
+ *
+ *	@param[in]	dbpath	dbpath directory
+ *	@param[in]	keep	names of the shards to keep (separated by NUL), or @VAR{NULL}
+ */
+static void
+removeshards(const char *dbpath, STRBUF *keep)
+{
+	SHARDS *old = shard_open(dbpath);
+	int i, db;
+
+	if (old == NULL)
+		return;
+	for (i = 1; i < old->count; i++) {
+		const char *dir = shard_dbpath(old, i);
+
+		if (keep) {
+			const char *name = strbuf_value(keep);
+			const char *end = name + strbuf_getlen(keep);
+
+			for (; name < end; name += strlen(name) + 1)
+				if (!strcmp(name, shard_name(old, i)))
+					break;
+			if (name < end)
+				continue;
+		}
+		if (vflag)
+			fprintf(stderr, " Removing shard '%s'.\n", shard_name(old, i));
+		for (db = GPATH; db < GTAGLIM; db++) {
+			(void)unlink(makepath(dir, dbname(db), NULL));
+			(void)unlink(makepath(dir, dbname(db), DBOP_DELTA_SUFFIX));
+		}
+		(void)unlink(makepath(dir, dbname(GTAGS), BLOOM_SUFFIX));
+		(void)unlink(makepath(dir, dbname(GTAGS), TRIGRAM_SUFFIX));
+		(void)unlink(makepath(dir, dbname(GRTAGS), TRIGRAM_SUFFIX));
+		(void)unlink(makepath(dir, dbname(GTAGS), DBOP_FOLD_SUFFIX));
+		(void)unlink(makepath(dir, dbname(GRTAGS), DBOP_FOLD_SUFFIX));
+		(void)unlink(makepath(dir, dbname(GTAGS), DBOP_FOLD_SUFFIX DBOP_DELTA_SUFFIX));
+		(void)unlink(makepath(dir, dbname(GRTAGS), DBOP_FOLD_SUFFIX DBOP_DELTA_SUFFIX));
+		(void)unlink(makepath(dir, DBOP_GENERATION, NULL));
+		(void)unlink(makepath(dir, LINEINDEX_NAME, NULL));
+		(void)unlink(makepath(dir, LINEINDEX_NAME, DBOP_DELTA_SUFFIX));
+		if (rmdir(dir) < 0)
+			warning("cannot remove directory '%s'.", dir);
+	}
+	if (keep == NULL && rmdir(makepath(dbpath, GSHARDS, NULL)) < 0)
+		warning("cannot remove directory '%s'.", makepath(dbpath, GSHARDS, NULL));
+	shard_close(old);
+}
 /**
  * @fn static void put_syms(int type, const char *tag, int lno, const char *path, const char *line_image, void *arg)
  *
@@ -734,27 +1189,102 @@ exit:
 struct put_func_data {
 	GTOP *gtop[GTAGLIM];
 	const char *fid;
+	unsigned long size;		/**< size of the file */
+	unsigned long records;		/**< records of the file */
 };
 static void
 put_syms(int type, const char *tag, int lno, const char *path, const char *line_image, void *arg)
 {
-	const struct put_func_data *data = arg;
+	struct put_func_data *data = arg;
 	GTOP *gtop;
 
+	data->records++;
 	switch (type) {
 	case PARSER_DEF:
 		gtop = data->gtop[GTAGS];
+		statistics_count(STATISTICS_DEFS, 1);
 		break;
 	case PARSER_REF_SYM:
 		gtop = data->gtop[GRTAGS];
 		if (gtop == NULL)
 			return;
+		statistics_count(STATISTICS_REFS, 1);
 		break;
 	default:
 		return;
 	}
 	gtags_put_using(gtop, tag, lno, data->fid, line_image);
 }
+/**
+ * @fn static void start_file(const char *path, const char *fid, void *arg)
+ * @fn static void end_file(const char *path, const char *fid, void *arg)
+ *
+ * callback functions called before and after the tag records of a file.
+ * See parallel_parse().
+ */
+static void
+start_file(const char *path, const char *fid, void *arg)
+{
+	struct put_func_data *data = arg;
+
+	data->fid = fid;
+	data->records = 0;
+	data->size = 0;
+	statistics_count(STATISTICS_FILES, 1);
+	/*
+	 * The size of a file is needed only for the statistics and the profile.
+	 */
+	if (statistics != STATISTICS_STYLE_NONE || profile_file) {
+		struct stat st;
+
+		if (stat(path, &st) == 0)
+			data->size = st.st_size;
+		statistics_count(STATISTICS_BYTES, data->size);
+	}
+}
+static void
+end_file(const char *path, const char *fid, void *arg)
+{
+	struct put_func_data *data = arg;
+
+	gtags_flush(data->gtop[GTAGS], fid);
+	if (data->gtop[GRTAGS] != NULL)
+		gtags_flush(data->gtop[GRTAGS], fid);
+	if (profile_file)
+		profile_put(path, data->size, data->records, parallel_parse_time());
+}
+/**
+ * put_source: register a source file which is to be parsed
+ *
+ *	@param[in]	lines	line offsets
+ *	@param[in]	path	path name
+ *	@return		file id
+ *
+ * The file is read once for both the line offsets and the hash value of
+ * the contents, which is recorded in GPATH for the next incremental
+ * updating. If the git index knows the contents, the hash value is not
+ * needed.
+ */
+static const char *
+put_source(LINEINDEX *lines, const char *path)
+{
+	static char fid[MAXFIDLEN];
+	const char *p;
+	FILESTAT st;
+
+	gpath_put(path, GPATH_SOURCE);
+	p = gpath_path2fid(path, NULL);
+	if (p == NULL)
+		die("GPATH is corrupted.('%s' not found)", path);
+	strlimcpy(fid, p, sizeof(fid));
+	if (gpath_getstat(path, &st) < 0)
+		st.blob[0] = '\0';
+	if (st.blob[0])
+		lineindex_put(lines, fid, path, NULL);
+	else if (lineindex_put(lines, fid, path, &st) == 0)
+		gpath_putstat(path, &st);
+	return fid;
+}
 /**
  * updatetags: update tag file.
  *
@@ -767,17 +1297,29 @@ void
 updatetags(const char *dbpath, const char *root, IDSET *deleteset, STRBUF *addlist)
 {
 	struct put_func_data data;
+	LINEINDEX *lines;
 	int seqno, flags;
 	const char *path, *start, *end;
 
 	if (vflag)
 		fprintf(stderr, "[%s] Updating '%s' and '%s'.\n", now(), dbname(GTAGS), dbname(GRTAGS));
+	flags = 0;
+	if (vflag)
+		flags |= PARSER_VERBOSE;
+	if (debug)
+		flags |= PARSER_DEBUG;
+	if (wflag)
+		flags |= PARSER_WARNING;
+	/*
+	 * Start parsing processes before opening tag files.
+	 */
+	parallel_open(jobs, flags, put_syms, start_file, end_file, &data);
 	/*
 	 * Open tag files.
 	 */
-	data.gtop[GTAGS] = gtags_open(dbpath, root, GTAGS, GTAGS_MODIFY, 0);
+	data.gtop[GTAGS] = gtags_open(dbpath, root, GTAGS, GTAGS_MODIFY, indexes);
 	if (test("f", makepath(dbpath, dbname(GRTAGS), NULL))) {
-		data.gtop[GRTAGS] = gtags_open(dbpath, root, GRTAGS, GTAGS_MODIFY, 0);
+		data.gtop[GRTAGS] = gtags_open(dbpath, root, GRTAGS, GTAGS_MODIFY, indexes);
 	} else {
 		/*
 		 * If you set NULL to data.gtop[GRTAGS], parse_file() doesn't write to
@@ -785,6 +1327,7 @@ updatetags(const char *dbpath, const char *root, IDSET *deleteset, STRBUF *addli
 		 */
 		data.gtop[GRTAGS] = NULL;
 	}
+	lines = lineindex_open(dbpath, 2);
 	/*
 	 * Delete tags from GTAGS.
 	 */
@@ -806,6 +1349,15 @@ updatetags(const char *dbpath, const char *root, IDSET *deleteset, STRBUF *addli
 		gtags_delete(data.gtop[GTAGS], deleteset);
 		if (data.gtop[GRTAGS] != NULL)
 			gtags_delete(data.gtop[GRTAGS], deleteset);
+		{
+			char fid[MAXFIDLEN];
+			unsigned int id;
+
+			for (id = idset_first(deleteset); id != END_OF_ID; id = idset_next(deleteset)) {
+				snprintf(fid, sizeof(fid), "%d", id);
+				lineindex_delete(lines, fid);
+			}
+		}
 	}
 	/*
 	 * Set flags.
@@ -814,13 +1366,6 @@ updatetags(const char *dbpath, const char *root, IDSET *deleteset, STRBUF *addli
 	if (extractmethod)
 		data.gtop[GTAGS]->flags |= GTAGS_EXTRACTMETHOD;
 	data.gtop[GRTAGS]->flags = data.gtop[GTAGS]->flags;
-	flags = 0;
-	if (vflag)
-		flags |= PARSER_VERBOSE;
-	if (debug)
-		flags |= PARSER_DEBUG;
-	if (wflag)
-		flags |= PARSER_WARNING;
 	/*
 	 * Add tags to GTAGS and GRTAGS.
 	 */
@@ -828,18 +1373,13 @@ updatetags(const char *dbpath, const char *root, IDSET *deleteset, STRBUF *addli
 	end = start + strbuf_getlen(addlist);
 	seqno = 0;
 	for (path = start; path < end; path += strlen(path) + 1) {
-		gpath_put(path, GPATH_SOURCE);
-		data.fid = gpath_path2fid(path, NULL);
-		if (data.fid == NULL)
-			die("GPATH is corrupted.('%s' not found)", path);
+		data.fid = put_source(lines, path);
 		if (vflag)
 			fprintf(stderr, " [%d/%d] extracting tags of %s\n", ++seqno, total, path + 2);
-		parse_file(path, flags, put_syms, &data);
-		gtags_flush(data.gtop[GTAGS], data.fid);
-		if (data.gtop[GRTAGS] != NULL)
-			gtags_flush(data.gtop[GRTAGS], data.fid);
+		parallel_parse(path, data.fid);
 	}
-	parser_exit();
+	parallel_close();
+	lineindex_close(lines);
 	gtags_close(data.gtop[GTAGS]);
 	if (data.gtop[GRTAGS] != NULL)
 		gtags_close(data.gtop[GRTAGS]);
@@ -856,19 +1396,14 @@ createtags(const char *dbpath, const char *root)
 	STATISTICS_TIME *tim;
 	STRBUF *sb = strbuf_open(0);
 	struct put_func_data data;
+	LINEINDEX *lines;
+	GITINDEX *gi;
 	int openflags, flags, seqno;
 	const char *path;
 
 	tim = statistics_time_start("Time of creating %s and %s.", dbname(GTAGS), dbname(GRTAGS));
 	if (vflag)
 		fprintf(stderr, "[%s] Creating '%s' and '%s'.\n", now(), dbname(GTAGS), dbname(GRTAGS));
-	openflags = cflag ? GTAGS_COMPACT : 0;
-	data.gtop[GTAGS] = gtags_open(dbpath, root, GTAGS, GTAGS_CREATE, openflags);
-	data.gtop[GTAGS]->flags = 0;
-	if (extractmethod)
-		data.gtop[GTAGS]->flags |= GTAGS_EXTRACTMETHOD;
-	data.gtop[GRTAGS] = gtags_open(dbpath, root, GRTAGS, GTAGS_CREATE, openflags);
-	data.gtop[GRTAGS]->flags = data.gtop[GTAGS]->flags;
 	flags = 0;
 	if (vflag)
 		flags |= PARSER_VERBOSE;
@@ -876,39 +1411,47 @@ createtags(const char *dbpath, const char *root)
 		flags |= PARSER_DEBUG;
 	if (wflag)
 		flags |= PARSER_WARNING;
+	/*
+	 * Start parsing processes before opening tag files.
+	 */
+	parallel_open(jobs, flags, put_syms, start_file, end_file, &data);
+	openflags = (cflag ? GTAGS_COMPACT : 0) | indexes;
+	data.gtop[GTAGS] = gtags_open(dbpath, root, GTAGS, GTAGS_CREATE, openflags);
+	data.gtop[GTAGS]->flags = 0;
+	if (extractmethod)
+		data.gtop[GTAGS]->flags |= GTAGS_EXTRACTMETHOD;
+	data.gtop[GRTAGS] = gtags_open(dbpath, root, GRTAGS, GTAGS_CREATE, openflags);
+	data.gtop[GRTAGS]->flags = data.gtop[GTAGS]->flags;
+	lines = lineindex_open(dbpath, 1);
 	/*
 	 * Add tags to GTAGS and GRTAGS.
 	 */
-	if (file_list)
-		find_open_filelist(file_list, root);
-	else
-		find_open(NULL);
+	gi = open_gitindex(root);
+	open_files(root, gi);
 	seqno = 0;
-	while ((path = find_read()) != NULL) {
+	while ((path = read_file()) != NULL) {
 		if (*path == ' ') {
 			path++;
 			if (!test("b", path))
 				gpath_put(path, GPATH_OTHER);
 			continue;
 		}
-		gpath_put(path, GPATH_SOURCE);
-		data.fid = gpath_path2fid(path, NULL);
-		if (data.fid == NULL)
-			die("GPATH is corrupted.('%s' not found)", path);
+		data.fid = put_source(lines, path);
 		seqno++;
 		if (vflag)
 			fprintf(stderr, " [%d] extracting tags of %s\n", seqno, path + 2);
-		parse_file(path, flags, put_syms, &data);
-		gtags_flush(data.gtop[GTAGS], data.fid);
-		gtags_flush(data.gtop[GRTAGS], data.fid);
+		parallel_parse(path, data.fid);
 	}
 	total = seqno;
-	parser_exit();
+	parallel_close();
+	lineindex_close(lines);
 	find_close();
+	close_gitindex(gi);
 	statistics_time_end(tim);
 	tim = statistics_time_start("Time of flushing B-tree cache");
 	gtags_close(data.gtop[GTAGS]);
 	gtags_close(data.gtop[GRTAGS]);
+	dbop_publish();
 	statistics_time_end(tim);
 	strbuf_reset(sb);
 	if (getconfs("GTAGS_extra", sb)) {
@@ -926,6 +1469,55 @@ createtags(const char *dbpath, const char *root)
 	}
 	strbuf_close(sb);
 }
+/**
+ * @name Watch mode
+ */
+/** @{ */
+static volatile sig_atomic_t stop_watching;
+static void
+onsignal(int signo)
+{
+	stop_watching = 1;
+}
+/**
+ * watchtags: keep tag files up to date until a signal is caught.
+ *
+ *	@param[in]	dbpath	dbpath directory
+ *	@param[in]	root	root directory of source tree
+ *
+ * The changed files are applied to the tag files in the same way as
+ * the @OPTION{-i} option, a batch at a time. The tag files are never
+ * left half-updated, since a signal only stops the loop.
+ */
+static void
+watchtags(const char *dbpath, const char *root)
+{
+	STRBUF *files = strbuf_open(0);
+	int found;
+
+	signal(SIGINT, onsignal);
+	signal(SIGTERM, onsignal);
+	signal(SIGHUP, onsignal);
+	while (!stop_watching) {
+		if (vflag)
+			fprintf(stderr, "[%s] Watching '%s'.\n", now(), root);
+		strbuf_reset(files);
+		found = watch_read(files, WATCHDELAY);
+		if (found == WATCH_NONE)
+			continue;
+		/*
+		 * The files not listed in the file list are ignored by
+		 * inspecting the whole project.
+		 */
+		if (found == WATCH_ALL || file_list)
+			(void)update(dbpath, root, NULL);
+		else
+			(void)update(dbpath, root, files);
+	}
+	watch_close();
+	strbuf_close(files);
+}
+/** @} */
 /**
  * printconf: print configuration data.
  *
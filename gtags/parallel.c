@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#elif HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "checkalloc.h"
+#include "die.h"
+#include "gparam.h"
+#include "parser.h"
+#include "parallel.h"
+
+/**
+ @file
+ Parallel parsing for @NAME{gtags}.
+
+ Source files are parsed by worker processes, and the tag records are sent
+ back to @NAME{gtags} through pipes. Since only @NAME{gtags} itself writes to
+ the tag files, no locking is needed for them.
+
+ @code{.txt}
+	gtags					worker
+	---------------------------------------------------------------
+	path\0  ================================> parse_file()
+	callback <================================ (type, lno, tag, image) ...
+	                                           (end of file)
+ @endcode
+
+ The records of a file are handed to the callback routine in the order in
+ which the files were given to parallel_parse(), regardless of which worker
+ parsed them. Therefore the tag files are the same as those made by serial
+ processing.
+*/
+
+/**
+ * Max number of files queued for a worker.
+ */
+#define MAXQUEUE	8
+
+/**
+ * Record header sent from a worker.
+ * The tag name and the line image follow it. A header whose type is 0
+ * means the end of a file, and its lno is the parse time in microseconds.
+ */
+struct record {
+	int type;
+	int lno;
+	int taglen;
+	int imagelen;
+};
+struct worker {
+	int pid;			/**< process id */
+	int out;			/**< pipe for requests (gtags => worker) */
+	FILE *in;			/**< pipe for records (worker => gtags) */
+	int queued;			/**< number of files queued */
+};
+struct request {
+	int worker;			/**< index of worker */
+	char *path;			/**< path name */
+	char *fid;			/**< file id */
+};
+
+static struct worker *workers;
+static int nworkers;
+static int parser_flags;
+static PARSER_CALLBACK put_proc;
+static PARALLEL_CALLBACK start_proc;
+static PARALLEL_CALLBACK end_proc;
+static void *proc_arg;
+static double parse_time;		/**< parse time of the current file */
+/*
+ * Queue of requests in the order of parallel_parse().
+ */
+static struct request *queue;
+static int queue_size;
+static int queue_head;
+static int queue_count;
+
+/**
+ * timed_parse: parse a file and measure the time.
+ *
+ *	@param[in]	path	path name
+ *	@param[in]	put	callback routine for each tag record
+ *	@param[in]	arg	argument for callback routine
+ *	@return		elapsed time in seconds
+ */
+static double
+timed_parse(const char *path, PARSER_CALLBACK put, void *arg)
+{
+#if HAVE_GETTIMEOFDAY
+	struct timeval start, end;
+
+	gettimeofday(&start, NULL);
+	parse_file(path, parser_flags, put, arg);
+	gettimeofday(&end, NULL);
+	return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6;
+#else
+	time_t start = time(NULL);
+
+	parse_file(path, parser_flags, put, arg);
+	return time(NULL) - start;
+#endif
+}
+
+#if (defined(_WIN32) && !defined(__CYGWIN__)) || defined(__DJGPP__)
+/*
+ * Fork(2) is not available. We always process files serially.
+ */
+static void
+start_workers(int jobs)
+{
+	warning("--jobs is not supported on this system. Ignored.");
+	nworkers = 0;
+}
+static void
+stop_workers(void)
+{
+	return;
+}
+static void
+send_request(struct worker *w, const char *path)
+{
+	return;
+}
+#else
+#include <sys/wait.h>
+
+static FILE *record_out;
+
+/**
+ * put_record: callback routine for the parser in a worker.
+ */
+static void
+put_record(int type, const char *tag, int lno, const char *path, const char *line_image, void *arg)
+{
+	struct record rec;
+
+	if (line_image == NULL)
+		line_image = "";
+	rec.type = type;
+	rec.lno = lno;
+	rec.taglen = strlen(tag);
+	rec.imagelen = strlen(line_image);
+	if (fwrite(&rec, sizeof(rec), 1, record_out) != 1
+	    || fwrite(tag, 1, rec.taglen, record_out) != rec.taglen
+	    || fwrite(line_image, 1, rec.imagelen, record_out) != rec.imagelen)
+		_exit(1);
+}
+/**
+ * worker_main: main loop of a worker process.
+ *
+ *	@param[in]	in	pipe for requests
+ *	@param[in]	out	pipe for records
+ */
+static void
+worker_main(int in, int out)
+{
+	FILE *ip;
+	char *path = NULL;
+	int size = 0, len, c;
+	struct record eof;
+	double t;
+
+	if ((ip = fdopen(in, "r")) == NULL || (record_out = fdopen(out, "w")) == NULL)
+		_exit(1);
+	memset(&eof, 0, sizeof(eof));
+	for (;;) {
+		len = 0;
+		while ((c = getc(ip)) != EOF && c != '\0') {
+			if (len + 1 >= size) {
+				size = size ? size * 2 : MAXPATHLEN;
+				path = check_realloc(path, size);
+			}
+			path[len++] = c;
+		}
+		if (c == EOF)
+			break;
+		path[len] = '\0';
+		t = timed_parse(path, put_record, NULL);
+		eof.lno = (t * 1e6 < INT_MAX) ? (int)(t * 1e6) : INT_MAX;
+		if (fwrite(&eof, sizeof(eof), 1, record_out) != 1 || fflush(record_out) == EOF)
+			_exit(1);
+	}
+	_exit(0);
+}
+/**
+ * start_workers: fork worker processes.
+ *
+ *	@param[in]	jobs	number of workers
+ */
+static void
+start_workers(int jobs)
+{
+	int i, j;
+
+	/*
+	 * If a worker dies, write(2) should return EPIPE instead of killing us.
+	 */
+	signal(SIGPIPE, SIG_IGN);
+	workers = (struct worker *)check_calloc(sizeof(struct worker), jobs);
+	for (i = 0; i < jobs; i++) {
+		struct worker *w = &workers[i];
+		int opipe[2], ipipe[2];
+
+		if (pipe(opipe) < 0 || pipe(ipipe) < 0)
+			die("pipe(2) failed.");
+		/*
+		 * Flush stdio buffers not to output them twice.
+		 */
+		fflush(NULL);
+		w->pid = fork();
+		if (w->pid < 0)
+			die("fork(2) failed.");
+		if (w->pid == 0) {
+			/* worker process */
+			for (j = 0; j < i; j++) {
+				close(workers[j].out);
+				fclose(workers[j].in);
+			}
+			close(opipe[1]);
+			close(ipipe[0]);
+			worker_main(opipe[0], ipipe[1]);
+		}
+		close(opipe[0]);
+		close(ipipe[1]);
+		/*
+		 * Other child processes like sort(1) must not keep the pipes open.
+		 */
+		fcntl(opipe[1], F_SETFD, FD_CLOEXEC);
+		fcntl(ipipe[0], F_SETFD, FD_CLOEXEC);
+		w->out = opipe[1];
+		w->in = fdopen(ipipe[0], "r");
+		if (w->in == NULL)
+			die("fdopen(3) failed.");
+	}
+	nworkers = jobs;
+}
+/**
+ * stop_workers: wait for the termination of worker processes.
+ */
+static void
+stop_workers(void)
+{
+	int i, status;
+
+	for (i = 0; i < nworkers; i++)
+		close(workers[i].out);
+	for (i = 0; i < nworkers; i++) {
+		fclose(workers[i].in);
+		while (waitpid(workers[i].pid, &status, 0) < 0)
+			if (errno != EINTR)
+				die("waitpid(2) failed.");
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			die("worker process (pid %d) failed.", workers[i].pid);
+	}
+}
+/**
+ * send_request: send a path name to a worker.
+ */
+static void
+send_request(struct worker *w, const char *path)
+{
+	const char *p = path;
+	int len = strlen(path) + 1;
+	int n;
+
+	while (len > 0) {
+		if ((n = write(w->out, p, len)) < 0) {
+			if (errno == EINTR)
+				continue;
+			die("worker process (pid %d) died unexpectedly.", w->pid);
+		}
+		p += n;
+		len -= n;
+	}
+}
+#endif
+/**
+ * receive_records: receive tag records of the file at the head of the queue.
+ */
+static void
+receive_records(void)
+{
+	static char *tag, *image;
+	static int tagsize, imagesize;
+	struct request *req = &queue[queue_head];
+	struct worker *w = &workers[req->worker];
+	struct record rec;
+
+	(*start_proc)(req->path, req->fid, proc_arg);
+	for (;;) {
+		if (fread(&rec, sizeof(rec), 1, w->in) != 1)
+			die("worker process (pid %d) died unexpectedly.", w->pid);
+		if (rec.type == 0) {
+			parse_time = rec.lno * 1e-6;
+			break;
+		}
+		if (rec.taglen >= tagsize) {
+			tagsize = rec.taglen + 1;
+			tag = check_realloc(tag, tagsize);
+		}
+		if (rec.imagelen >= imagesize) {
+			imagesize = rec.imagelen + 1;
+			image = check_realloc(image, imagesize);
+		}
+		if (fread(tag, 1, rec.taglen, w->in) != rec.taglen
+		    || fread(image, 1, rec.imagelen, w->in) != rec.imagelen)
+			die("worker process (pid %d) died unexpectedly.", w->pid);
+		tag[rec.taglen] = '\0';
+		image[rec.imagelen] = '\0';
+		(*put_proc)(rec.type, tag, rec.lno, req->path, image, proc_arg);
+	}
+	(*end_proc)(req->path, req->fid, proc_arg);
+	w->queued--;
+	free(req->path);
+	free(req->fid);
+	queue_head = (queue_head + 1) % queue_size;
+	queue_count--;
+}
+/**
+ * parallel_open: start parallel parsing.
+ *
+ *	@param[in]	jobs	number of worker processes <br>
+ *			If 1 is specified then files are parsed by @NAME{gtags} itself.
+ *	@param[in]	flags	flags for parse_file()
+ *	@param[in]	put	callback routine for each tag record
+ *	@param[in]	start	callback routine called before the records of a file
+ *	@param[in]	end	callback routine called after the records of a file
+ *	@param[in]	arg	argument for callback routines
+ *
+ * @note Call this function before opening tag files, since the worker
+ *	processes must not inherit the descriptors for them.
+ */
+void
+parallel_open(int jobs, int flags, PARSER_CALLBACK put, PARALLEL_CALLBACK start, PARALLEL_CALLBACK end, void *arg)
+{
+	parser_flags = flags;
+	put_proc = put;
+	start_proc = start;
+	end_proc = end;
+	proc_arg = arg;
+	nworkers = 0;
+	if (jobs > 1)
+		start_workers(jobs);
+	if (nworkers > 0) {
+		queue_size = nworkers * MAXQUEUE;
+		queue = (struct request *)check_calloc(sizeof(struct request), queue_size);
+		queue_head = queue_count = 0;
+	}
+}
+/**
+ * parallel_parse: parse a file.
+ *
+ *	@param[in]	path	path name
+ *	@param[in]	fid	file id
+ *
+ * The callback routines may be called later for this file.
+ */
+void
+parallel_parse(const char *path, const char *fid)
+{
+	struct request *req;
+	int i, min;
+
+	if (nworkers == 0) {
+		(*start_proc)(path, fid, proc_arg);
+		parse_time = timed_parse(path, put_proc, proc_arg);
+		(*end_proc)(path, fid, proc_arg);
+		return;
+	}
+	/*
+	 * Select the least loaded worker. If all workers are busy,
+	 * process the records of the oldest request at first.
+	 */
+	for (;;) {
+		min = 0;
+		for (i = 1; i < nworkers; i++)
+			if (workers[i].queued < workers[min].queued)
+				min = i;
+		if (workers[min].queued < MAXQUEUE)
+			break;
+		receive_records();
+	}
+	req = &queue[(queue_head + queue_count) % queue_size];
+	req->worker = min;
+	req->path = check_strdup(path);
+	req->fid = check_strdup(fid);
+	queue_count++;
+	workers[min].queued++;
+	send_request(&workers[min], path);
+}
+/**
+ * parallel_parse_time: parse time of a file
+ *
+ *	@return		time in seconds
+ *
+ * It is valid in the callback routine called after the records of a file,
+ * and is the time spent by the parser itself, even if the file was parsed
+ * by a worker process.
+ */
+double
+parallel_parse_time(void)
+{
+	return parse_time;
+}
+/**
+ * parallel_close: wait for all requests and stop worker processes.
+ */
+void
+parallel_close(void)
+{
+	if (nworkers == 0)
+		return;
+	while (queue_count > 0)
+		receive_records();
+	stop_workers();
+	free(queue);
+	free(workers);
+	queue = NULL;
+	workers = NULL;
+	nworkers = 0;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include "parser.h"
+
+typedef void (*PARALLEL_CALLBACK)(const char *, const char *, void *);
+
+void parallel_open(int, int, PARSER_CALLBACK, PARALLEL_CALLBACK, PARALLEL_CALLBACK, void *);
+void parallel_parse(const char *, const char *);
+double parallel_parse_time(void);
+void parallel_close(void);
+
+#endif /* ! _PARALLEL_H_ */
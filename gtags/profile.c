@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include "checkalloc.h"
+#include "die.h"
+#include "gparam.h"
+#include "parser.h"
+#include "profile.h"
+
+/**
+ @file
+ Profile of parsing for @NAME{gtags} @OPTION{--profile}.
+
+ A line is written to the profile for each file parsed, like follows.
+ The time is spent by the parser itself, and the records are the tag
+ records emitted by it.
+
+ @code{.txt}
+ # time[sec]	size	records	language	parser	path
+ 0.001204	13020	402	c	C	./libutil/strbuf.c
+ @endcode
+
+ At the end, the #PROFILETOP slowest files are reported to the standard
+ error output, so that they can be excluded by the skip list or mapped
+ to another parser by the langmap.
+*/
+
+struct profile_entry {
+	char *path;
+	const char *lang;
+	const char *parser;
+	unsigned long size;
+	unsigned long records;
+	double time;
+};
+
+static FILE *op;
+static struct profile_entry top[PROFILETOP];	/**< slowest files in descending order */
+static int ntop;
+static unsigned long total_files, total_size, total_records;
+static double total_time;
+
+/**
+ * profile_open: start profiling.
+ *
+ *	@param[in]	file	profile file <br>
+ *			When @FILE{-} is specified, write to standard output.
+ */
+void
+profile_open(const char *file)
+{
+	if (!strcmp(file, "-"))
+		op = stdout;
+	else if ((op = fopen(file, "w")) == NULL)
+		die("cannot open profile file '%s'.", file);
+	fputs("# time[sec]\tsize\trecords\tlanguage\tparser\tpath\n", op);
+	ntop = 0;
+	total_files = total_size = total_records = 0;
+	total_time = 0;
+}
+/**
+ * profile_put: record the profile of a file.
+ *
+ *	@param[in]	path	path name
+ *	@param[in]	size	size of the file
+ *	@param[in]	records	number of tag records
+ *	@param[in]	time	parse time in seconds
+ */
+void
+profile_put(const char *path, unsigned long size, unsigned long records, double time)
+{
+	const char *lang = NULL, *parser;
+	int i;
+
+	parser = parser_lookup(path, &lang);
+	if (parser == NULL)
+		lang = parser = "-";
+	fprintf(op, "%.6f\t%lu\t%lu\t%s\t%s\t%s\n", time, size, records, lang, parser, path);
+	total_files++;
+	total_size += size;
+	total_records += records;
+	total_time += time;
+	/*
+	 * Insert into the slowest files.
+	 */
+	for (i = ntop; i > 0 && top[i - 1].time < time; i--)
+		;
+	if (i >= PROFILETOP)
+		return;
+	if (ntop == PROFILETOP)
+		free(top[--ntop].path);
+	memmove(&top[i + 1], &top[i], sizeof(top[0]) * (ntop - i));
+	ntop++;
+	top[i].path = check_strdup(path);
+	top[i].lang = lang;
+	top[i].parser = parser;
+	top[i].size = size;
+	top[i].records = records;
+	top[i].time = time;
+}
+/**
+ * profile_close: finish profiling and report the slowest files.
+ */
+void
+profile_close(void)
+{
+	int i;
+
+	if (op != stdout)
+		fclose(op);
+	else
+		fflush(op);
+	op = NULL;
+	fprintf(stderr, "The slowest %d of %lu files (%lu bytes, %lu records, %.3f sec):\n",
+		ntop, total_files, total_size, total_records, total_time);
+	fprintf(stderr, "%10s %10s %8s %5s  %-10s %-10s %s\n",
+		"time[sec]", "size", "records", "%time", "language", "parser", "path");
+	for (i = 0; i < ntop; i++) {
+		fprintf(stderr, "%10.6f %10lu %8lu %5.1f  %-10s %-10s %s\n",
+			top[i].time, top[i].size, top[i].records,
+			total_time > 0 ? top[i].time * 100 / total_time : 0.0,
+			top[i].lang, top[i].parser, top[i].path);
+		free(top[i].path);
+	}
+	ntop = 0;
+}
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "strbuf.h"
+#include "watch.h"
+
+/**
+ @file
+ Watching the source tree for @NAME{gtags} @OPTION{--watch}.
+
+ Every directory of the project except for those in the skip list is
+ watched with @XREF{inotify,7}. Watch_read() waits for events, and collects
+ the path names of the changed files until no event arrives for a while,
+ so that a series of writes by an editor or @CODE{git checkout} is handled
+ at a time. If a directory is removed or renamed, the files in it cannot be
+ known from the events, so the whole project should be inspected again.
+
+ The tag files and the files made with them are written by the updates
+ themselves, so the events of them are ignored, and the dbpath directory
+ is not watched if it is in the project.
+*/
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#include <poll.h>
+#include <time.h>
+
+#include "checkalloc.h"
+#include "die.h"
+#include "find.h"
+#include "gparam.h"
+#include "path.h"
+#include "shard.h"
+#include "strhash.h"
+#include "strlimcpy.h"
+
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#else
+#define dirent direct
+#ifdef HAVE_SYS_NDIR_H
+#include <sys/ndir.h>
+#endif
+#ifdef HAVE_SYS_DIR_H
+#include <sys/dir.h>
+#endif
+#ifdef HAVE_NDIR_H
+#include <ndir.h>
+#endif
+#endif
+
+#define WATCH_MASK	(IN_CLOSE_WRITE|IN_MODIFY|IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO)
+/**
+ * A batch is closed after this number of quiet periods at the latest,
+ * even if files are being written continuously.
+ */
+#define WATCH_MAXPERIODS 20
+
+static int fd = -1;			/**< inotify descriptor */
+static char **dirs;			/**< directory path (ends with '/') for each watch */
+static int ndirs;			/**< allocated size of @a dirs */
+static STRHASH *changed;		/**< path names already listed in a batch */
+static char dbdir[MAXPATHLEN];		/**< dbpath directory in the project (starts with './', ends with '/') */
+static char shardsdir[MAXPATHLEN];	/**< directory of the shards in the project */
+
+/**
+ * ignored: check whether a change of a path should be ignored.
+ *
+ *	@param[in]	path	path name (a directory ends with @FILE{/})
+ *	@return		1: ignored, 0: not ignored
+ *
+ * The path names in the skip list, tag files and the files under the
+ * dbpath directory are ignored.
+ */
+static int
+ignored(const char *path)
+{
+	const char *name;
+
+	if (*dbdir && !strncmp(path, dbdir, strlen(dbdir)))
+		return 1;
+	if (*shardsdir && !strncmp(path, shardsdir, strlen(shardsdir)))
+		return 1;
+	if ((name = strrchr(path, '/')) != NULL && istagfile(name + 1))
+		return 1;
+	return skipthisfile(path);
+}
+/**
+ * add_dir: watch a directory and its subdirectories.
+ *
+ *	@param[in]	dir	directory path (@STRONG{must} start with @FILE{./} and end with @FILE{/})
+ *	@param[out]	sb	the source files in the directories are appended <br>
+ *			If @VAR{NULL}, they are not listed.
+ */
+static void
+add_dir(const char *dir, STRBUF *sb)
+{
+	char path[MAXPATHLEN];
+	struct dirent *dp;
+	struct stat st;
+	DIR *dirp;
+	int wd;
+
+	if ((wd = inotify_add_watch(fd, dir, WATCH_MASK|IN_ONLYDIR)) < 0) {
+		if (errno == ENOSPC)
+			warning("too many directories to watch. '%s' is ignored. (see /proc/sys/fs/inotify/max_user_watches)", trimpath(dir));
+		else
+			warning("cannot watch directory '%s'. ignored.", trimpath(dir));
+		return;
+	}
+	/*
+	 * The same descriptor is returned for the same directory.
+	 * It means a symbolic link to a directory already watched.
+	 */
+	if (wd < ndirs && dirs[wd] != NULL)
+		return;
+	if (wd >= ndirs) {
+		int n = ndirs;
+
+		ndirs = wd + 64;
+		dirs = (char **)check_realloc(dirs, sizeof(char *) * ndirs);
+		while (n < ndirs)
+			dirs[n++] = NULL;
+	}
+	dirs[wd] = check_strdup(dir);
+	if ((dirp = opendir(dir)) == NULL)
+		return;
+	while ((dp = readdir(dirp)) != NULL) {
+		if (!strcmp(dp->d_name, ".") || !strcmp(dp->d_name, ".."))
+			continue;
+		snprintf(path, sizeof(path), "%s%s", dir, dp->d_name);
+		if (stat(path, &st) < 0)
+			continue;
+		if (S_ISDIR(st.st_mode)) {
+			strlimcpy(path + strlen(path), "/", sizeof(path) - strlen(path));
+			if (!ignored(path))
+				add_dir(path, sb);
+		} else if (sb && S_ISREG(st.st_mode)) {
+			if (!ignored(path) && strhash_assign(changed, path, 0) == NULL) {
+				strhash_assign(changed, path, 1);
+				strbuf_puts0(sb, path);
+			}
+		}
+	}
+	(void)closedir(dirp);
+}
+/**
+ * remove_all: stop watching all directories.
+ */
+static void
+remove_all(void)
+{
+	int i;
+
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+	for (i = 0; i < ndirs; i++) {
+		if (dirs[i]) {
+			free(dirs[i]);
+			dirs[i] = NULL;
+		}
+	}
+}
+/**
+ * watch_restart: watch all the directories of the source tree again.
+ */
+static int
+watch_restart(void)
+{
+#ifdef IN_CLOEXEC
+	fd = inotify_init1(IN_CLOEXEC);
+#else
+	fd = inotify_init();
+#endif
+	if (fd < 0)
+		return -1;
+	if (changed == NULL)
+		changed = strhash_open(256);
+	add_dir("./", NULL);
+	return 0;
+}
+/**
+ * watch_open: start watching the source tree.
+ *
+ *	@param[in]	root	root directory of source tree
+ *	@param[in]	dbpath	dbpath directory
+ *	@return		0: succeeded, -1: not supported
+ *
+ * The current directory is assumed to be the root of the source tree.
+ */
+int
+watch_open(const char *root, const char *dbpath)
+{
+	int len = strlen(root);
+
+	dbdir[0] = shardsdir[0] = '\0';
+	if (!strncmp(dbpath, root, len) && (dbpath[len] == '/' || dbpath[len] == '\0')) {
+		if (dbpath[len] == '/')
+			snprintf(dbdir, sizeof(dbdir), ".%s/", dbpath + len);
+		snprintf(shardsdir, sizeof(shardsdir), ".%s/%s/", dbpath + len, GSHARDS);
+	}
+	return watch_restart();
+}
+/**
+ * watch_read: wait for changes of the source tree.
+ *
+ *	@param[out]	sb	the path names of the changed files are appended <br>
+ *			Each path name starts with @FILE{./} and ends with @CODE{'\\0'}.
+ *	@param[in]	delay	quiet period in milliseconds
+ *	@return		#WATCH_FILES, #WATCH_ALL or #WATCH_NONE
+ *
+ * This function returns when no event has arrived for @a delay milliseconds
+ * since the last change, or when a signal is caught.
+ * The files listed may have been created, modified or removed.
+ */
+int
+watch_read(STRBUF *sb, int delay)
+{
+	union {
+		struct inotify_event ev;
+		char buf[sizeof(struct inotify_event) + MAXPATHLEN + 1];
+	} u;
+	char path[MAXPATHLEN];
+	struct inotify_event *ev;
+	struct pollfd pfd;
+	time_t start = 0;
+	int found = WATCH_NONE;
+	int n, len;
+	char *p;
+
+	strhash_reset(changed);
+	for (;;) {
+		if (found != WATCH_NONE && time(NULL) - start > (time_t)delay * WATCH_MAXPERIODS / 1000)
+			break;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		n = poll(&pfd, 1, found == WATCH_NONE ? -1 : delay);
+		if (n < 0) {
+			if (errno == EINTR)
+				break;
+			die("poll(2) failed.");
+		}
+		if (n == 0)
+			break;
+		if ((n = read(fd, u.buf, sizeof(u.buf))) < 0) {
+			if (errno == EINTR)
+				break;
+			die("cannot read events of inotify.");
+		}
+		for (p = u.buf; p < u.buf + n; p += sizeof(struct inotify_event) + ev->len) {
+			ev = (struct inotify_event *)p;
+			if (ev->mask & IN_Q_OVERFLOW) {
+				found = WATCH_ALL;
+				continue;
+			}
+			if (ev->wd < 0 || ev->wd >= ndirs || dirs[ev->wd] == NULL)
+				continue;
+			if (ev->mask & IN_IGNORED) {
+				free(dirs[ev->wd]);
+				dirs[ev->wd] = NULL;
+				continue;
+			}
+			if (ev->len == 0)
+				continue;
+			snprintf(path, sizeof(path), "%s%s", dirs[ev->wd], ev->name);
+			if (ev->mask & IN_ISDIR) {
+				len = strlen(path);
+				strlimcpy(path + len, "/", sizeof(path) - len);
+				if (ignored(path))
+					continue;
+				/*
+				 * The files under a removed or renamed directory
+				 * are unknown, and the watches for its subdirectories
+				 * have stale path names.
+				 */
+				if (ev->mask & (IN_DELETE|IN_MOVED_FROM))
+					found = WATCH_ALL;
+				else if (ev->mask & (IN_CREATE|IN_MOVED_TO))
+					add_dir(path, sb);
+			} else {
+				if (ignored(path))
+					continue;
+				if (strhash_assign(changed, path, 0) == NULL) {
+					strhash_assign(changed, path, 1);
+					strbuf_puts0(sb, path);
+				}
+			}
+			if (found == WATCH_NONE)
+				found = WATCH_FILES;
+		}
+		if (found != WATCH_NONE && start == 0)
+			start = time(NULL);
+	}
+	if (found == WATCH_ALL) {
+		remove_all();
+		if (watch_restart() < 0)
+			die("cannot restart watching.");
+	}
+	return found;
+}
+/**
+ * watch_close: stop watching the source tree.
+ */
+void
+watch_close(void)
+{
+	remove_all();
+	if (dirs) {
+		free(dirs);
+		dirs = NULL;
+		ndirs = 0;
+	}
+	if (changed) {
+		strhash_close(changed);
+		changed = NULL;
+	}
+}
+#else /* ! HAVE_SYS_INOTIFY_H */
+int
+watch_open(const char *root, const char *dbpath)
+{
+	return -1;
+}
+int
+watch_read(STRBUF *sb, int delay)
+{
+	return WATCH_NONE;
+}
+void
+watch_close(void)
+{
+	return;
+}
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _WATCH_H_
+#define _WATCH_H_
+
+#include "strbuf.h"
+
+/**
+ * @name Return values of watch_read()
+ */
+/** @{ */
+#define WATCH_NONE	0	/**< interrupted with no change */
+#define WATCH_FILES	1	/**< the changed files are listed */
+#define WATCH_ALL	2	/**< the whole project should be inspected */
+/** @} */
+
+int watch_open(const char *, const char *);
+int watch_read(STRBUF *, int);
+void watch_close(void);
+
+#endif /* ! _WATCH_H_ */
@@ -2024,6 +2024,11 @@ main(int argc, char **argv)
 		message(" GRTAGS is empty.");
 	if (gpath_open(get_dbpath(), 0) < 0)
 		die("GPATH not found.");
+	/*
+	 * The file ids of the shards conflict with each other.
+	 */
+	if (test("d", makepath(get_dbpath(), GSHARDS, NULL)))
+		die("sharded tag files are not supported. Please make tag files without the --shard option.");
 	if (!w32) {
 		/* UNDER CONSTRUCTION */
 	}
@@ -1116,11 +1116,11 @@ YY_RULE_SETUP
 				char tmp[MAXPATHLEN];
 				char normalized_path[MAXPATHLEN];
 
-				snprintf(tmp, sizeof(tmp), "%s/%s", get_current_dir(), path);
 				/*
 				 * pick up the file only when it exists.
 				 */
-				if (normalize(tmp, get_root_with_slash(), get_cwd(), normalized_path, sizeof(normalized_path))
+				if (snprintf(tmp, sizeof(tmp), "%s/%s", get_current_dir(), path) < sizeof(tmp)
+					&& normalize(tmp, get_root_with_slash(), get_cwd(), normalized_path, sizeof(normalized_path))
 					&& test("f", normalized_path))
 					put_include_anchor_direct(normalized_path, path);
 				else
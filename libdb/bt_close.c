@@ -109,6 +109,11 @@ __bt_close(dbp, abandon)
 		t->bt_rdata.size = 0;
 		t->bt_rdata.data = NULL;
 	}
+	if (t->bt_pkey.data) {
+		free(t->bt_pkey.data);
+		t->bt_pkey.size = 0;
+		t->bt_pkey.data = NULL;
+	}
 
 	fd = t->bt_fd;
 	free(t);
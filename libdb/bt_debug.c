@@ -212,6 +212,10 @@ __bt_dpage(h)
 				    "big key page %lu size %u/",
 				    (long unsigned int)*(pgno_t *)bl->bytes,
 				    (unsigned int)*(u_int32_t *)(bl->bytes + sizeof(pgno_t)));
+			else if (bl->flags & P_PFXKEY)
+				(void)fprintf(stderr, "+%u %.*s/",
+				    (unsigned int)(u_char)bl->bytes[0],
+				    (int)bl->ksize - 1, bl->bytes + 1);
 			else if (bl->ksize)
 				(void)fprintf(stderr, "%s/", bl->bytes);
 			if (bl->flags & P_BIGDATA)
@@ -41,6 +41,9 @@ static char sccsid[] = "@(#)bt_delete.c	8.13 (Berkeley) 7/28/94";
 
 #include <errno.h>
 #include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
 #ifdef HAVE_STRING_H
 #include <string.h>
 #else
@@ -52,6 +55,7 @@ static char sccsid[] = "@(#)bt_delete.c	8.13 (Berkeley) 7/28/94";
 
 static int __bt_bdelete(BTREE *, const DBT *);
 static int __bt_curdel(BTREE *, const DBT *, PAGE *, u_int);
+static int bt_ljoin(PAGE *, u_int, char **, u_int32_t *);
 static int __bt_pdelete(BTREE *, PAGE *);
 static int __bt_relink(BTREE *, PAGE *);
 static int __bt_stkacq(BTREE *, PAGE **, CURSOR *);
@@ -87,6 +91,9 @@ __bt_delete(dbp, key, flags)
 		return (RET_ERROR);
 	}
 
+	/* The key in bt_rkey may no longer be on the page. */
+	t->bt_rkeypos.pgno = P_INVALID;
+
 	switch (flags) {
 	case 0:
 		status = __bt_bdelete(t, key);
@@ -473,10 +480,8 @@ __bt_dleaf(t, key, h, index)
 	u_int index;
 {
 	BLEAF *bl;
-	indx_t cnt, *ip, offset;
 	u_int32_t nbytes;
-	void *to;
-	char *from;
+	char *next;
 
 	/* If this record is referenced by the cursor, delete the cursor. */
 	if (F_ISSET(&t->bt_cursor, CURS_INIT) &&
@@ -485,28 +490,31 @@ __bt_dleaf(t, key, h, index)
 	    __bt_curdel(t, key, h, index))
 		return (RET_ERROR);
 
-	/* If the entry uses overflow pages, make them available for reuse. */
-	to = bl = GETBLEAF(h, index);
-	if (bl->flags & P_BIGKEY && __ovfl_delete(t, bl->bytes) == RET_ERROR)
+	/*
+	 * If the next key is stored relative to this one, it must be
+	 * rewritten.
+	 */
+	next = NULL;
+	if (F_ISSET(t, B_PFXKEY) && index + 1 < NEXTINDEX(h) &&
+	    bt_ljoin(h, index, &next, &nbytes) == RET_ERROR)
 		return (RET_ERROR);
-	if (bl->flags & P_BIGDATA &&
-	    __ovfl_delete(t, bl->bytes + bl->ksize) == RET_ERROR)
+
+	/* If the entry uses overflow pages, make them available for reuse. */
+	bl = GETBLEAF(h, index);
+	if ((bl->flags & P_BIGKEY && __ovfl_delete(t, bl->bytes) == RET_ERROR) ||
+	    (bl->flags & P_BIGDATA &&
+	    __ovfl_delete(t, bl->bytes + bl->ksize) == RET_ERROR)) {
+		if (next != NULL)
+			free(next);
 		return (RET_ERROR);
+	}
 
-	/* Pack the remaining key/data items at the end of the page. */
-	nbytes = NBLEAF(bl);
-	from = (char *)h + h->upper;
-	memmove(from + nbytes, from, (char *)to - from);
-	h->upper += nbytes;
-
-	/* Adjust the indices' offsets, shift the indices down. */
-	offset = h->linp[index];
-	for (cnt = index, ip = &h->linp[0]; cnt--; ++ip)
-		if (ip[0] < offset)
-			ip[0] += nbytes;
-	for (cnt = NEXTINDEX(h) - index; --cnt; ++ip)
-		ip[0] = ip[1] < offset ? ip[1] + nbytes : ip[1];
-	h->lower -= sizeof(indx_t);
+	__bt_lremove(h, index);
+	if (next != NULL) {
+		__bt_lremove(h, index);
+		memmove(__bt_linsert(h, index, nbytes), next, nbytes);
+		free(next);
+	}
 
 	/* If the cursor is on this page, adjust it as necessary. */
 	if (F_ISSET(&t->bt_cursor, CURS_INIT) &&
@@ -517,6 +525,67 @@ __bt_dleaf(t, key, h, index)
 	return (RET_SUCCESS);
 }
 
+/**
+ * BT_LJOIN -- Make the item next to a leaf item being deleted independent
+ *	of its key.
+ *
+ *	@param h	page
+ *	@param index	index of the item being deleted
+ *	@param nextp	new image of the next item, or @CODE{NULL} if it
+ *			needn't be changed (output, to be freed by the caller)
+ *	@param nbytesp	size of @a nextp (output)
+ *
+ * @return #RET_SUCCESS, #RET_ERROR.
+ *
+ * A prefix compressed key which follows the deleted item gets the bytes
+ * it shared with the deleted key, as far as they are not shared with the
+ * key before the deleted one.  The new image is never larger than the
+ * deleted item, so it always fits in the page.
+ */
+static int
+bt_ljoin(h, index, nextp, nbytesp)
+	PAGE *h;
+	u_int index;
+	char **nextp;
+	u_int32_t *nbytesp;
+{
+	BLEAF *bl, *nl;
+	u_int32_t ksize, nbytes;
+	u_int len, plen, nplen;
+	char *p;
+
+	*nextp = NULL;
+	bl = GETBLEAF(h, index);
+	nl = GETBLEAF(h, index + 1);
+	if (!(nl->flags & P_PFXKEY))
+		return (RET_SUCCESS);
+	plen = bl->flags & P_PFXKEY ? (u_char)bl->bytes[0] : 0;
+	nplen = (u_char)nl->bytes[0];
+	if (plen >= nplen)
+		return (RET_SUCCESS);
+
+	/* Bytes plen .. nplen of the deleted key go to the next key. */
+	len = nplen - plen;
+	ksize = (plen ? 1 : 0) + len + nl->ksize - 1;
+	nbytes = NBLEAFDBT(ksize, nl->dsize);
+	if ((p = malloc(nbytes)) == NULL)
+		return (RET_ERROR);
+	*nextp = p;
+	*nbytesp = nbytes;
+	*(u_int32_t *)p = ksize;
+	p += sizeof(u_int32_t);
+	*(u_int32_t *)p = nl->dsize;
+	p += sizeof(u_int32_t);
+	*(u_char *)p = plen ? nl->flags : nl->flags & ~P_PFXKEY;
+	p += sizeof(u_char);
+	if (plen)
+		*(u_char *)p++ = plen;
+	memmove(p, bl->bytes + (plen ? 1 : 0), len);
+	p += len;
+	memmove(p, nl->bytes + 1, nl->ksize - 1 + nl->dsize);
+	return (RET_SUCCESS);
+}
+
 /**
  * __bt_curdel --
  *	Delete the cursor.
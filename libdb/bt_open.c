@@ -98,6 +98,9 @@ static int tmp(void);
  *
  * @return @CODE{NULL} on failure, pointer to #DB on success.
  *
+ * If @CODE{openinfo->overlay} is given, the file is opened for reading only,
+ * and the pages are written to the overlay (made if it doesn't exist) and
+ * read from it once written. See mpool_overlay().
  */
 DB *
 __bt_open(fname, flags, mode, openinfo, dflags)
@@ -110,11 +113,13 @@ __bt_open(fname, flags, mode, openinfo, dflags)
 	BTREE *t;
 	BTREEINFO b;
 	DB *dbp;
+	void *p;
 	pgno_t ncache;
 	ssize_t nr;
-	int machine_lorder;
+	int machine_lorder, ofd;
 
 	t = NULL;
+	ofd = -1;
 
 	/*
 	 * Intention is to make sure all of the user's selections are okay
@@ -165,6 +170,7 @@ __bt_open(fname, flags, mode, openinfo, dflags)
 		b.minkeypage = DEFMINKEYPAGE;
 		b.prefix = __bt_defpfx;
 		b.psize = 0;
+		b.overlay = NULL;
 	}
 
 	/* Check for the ubiquitous PDP-11. */
@@ -214,7 +220,14 @@ __bt_open(fname, flags, mode, openinfo, dflags)
 			goto einval;
 		}
 		
-		if ((t->bt_fd = open(fname, flags, mode)) < 0)
+		if (b.overlay != NULL) {
+			if ((t->bt_fd = open(fname,
+			    (flags & ~(O_ACCMODE | O_CREAT | O_TRUNC)) | O_RDONLY, mode)) < 0)
+				goto err;
+			if ((ofd = open(b.overlay, F_ISSET(t, B_RDONLY) ?
+			    O_RDONLY | O_BINARY : O_RDWR | O_CREAT | O_BINARY, mode)) < 0)
+				goto err;
+		} else if ((t->bt_fd = open(fname, flags, mode)) < 0)
 			goto err;
 
 	} else {
@@ -289,6 +302,9 @@ __bt_open(fname, flags, mode, openinfo, dflags)
 		if (!(b.flags & R_DUP))
 			F_SET(t, B_NODUPS);
 
+		/* New trees have prefix compressed leaf pages. */
+		F_SET(t, B_PFXKEY);
+
 		t->bt_free = P_INVALID;
 		t->bt_nrecs = 0;
 		F_SET(t, B_METADIRTY);
@@ -328,6 +344,41 @@ __bt_open(fname, flags, mode, openinfo, dflags)
 		goto err;
 	if (!F_ISSET(t, B_INMEM))
 		mpool_filter(t->bt_mp, __bt_pgin, __bt_pgout, t);
+	/*
+	 * An overlay which is not for the file is out of date. It is not
+	 * used for reading, and is made again for writing.
+	 */
+	if (ofd != -1) {
+#if !defined(_WIN32) && !defined(__DJGPP__)
+		if (fcntl(ofd, F_SETFD, 1) == -1)
+			goto err;
+#endif
+		if (mpool_overlay(t->bt_mp, ofd) == RET_ERROR) {
+			if (errno != EFTYPE)
+				goto err;
+			if (F_ISSET(t, B_RDONLY)) {
+				(void)close(ofd);
+			} else if (ftruncate(ofd, 0) ||
+			    mpool_overlay(t->bt_mp, ofd) == RET_ERROR)
+				goto err;
+		}
+		ofd = -1;
+	}
+	/*
+	 * A read only tree in the native byte order is read from the
+	 * mapping of the file (the page in filter does nothing for it).
+	 */
+	if (F_ISSET(t, B_RDONLY) && !F_ISSET(t, B_INMEM | B_NEEDSWAP))
+		(void)mpool_map(t->bt_mp);
+	/* The meta data may have been written to the overlay. */
+	if (t->bt_mp->noverlay > 0) {
+		if ((p = mpool_get(t->bt_mp, P_META, 0)) == NULL)
+			goto err;
+		memmove(&m, p, sizeof(BTMETA));
+		mpool_put(t->bt_mp, p, 0);
+		t->bt_free = m.free;
+		t->bt_nrecs = m.nrecs;
+	}
 
 	/* Create a root page if new tree. */
 	if (nroot(t) == RET_ERROR)
@@ -356,9 +407,40 @@ err:	if (t) {
 			(void)close(t->bt_fd);
 		free(t);
 	}
+	if (ofd != -1)
+		(void)close(ofd);
 	return (NULL);
 }
 
+/**
+ * __BT_MERGE -- Write the pages in an overlay to a copy of the tree file.
+ *
+ *	@param fname	copy of the tree file
+ *	@param overlay	overlay of the tree file
+ *
+ * After this, the copy is the tree with the overlay.
+ *
+ * @return #RET_ERROR, #RET_SUCCESS
+ */
+int
+__bt_merge(fname, overlay)
+	const char *fname, *overlay;
+{
+	int fd, ofd, status;
+
+	if ((fd = open(fname, O_RDWR | O_BINARY)) < 0)
+		return (RET_ERROR);
+	if ((ofd = open(overlay, O_RDONLY | O_BINARY)) < 0) {
+		(void)close(fd);
+		return (RET_ERROR);
+	}
+	status = mpool_merge(fd, ofd);
+	(void)close(ofd);
+	if (close(fd))
+		status = RET_ERROR;
+	return (status);
+}
+
 /**
  * NROOT -- Create the root of a new tree.
  *
@@ -54,6 +54,8 @@ static char sccsid[] = "@(#)bt_put.c	8.8 (Berkeley) 7/26/94";
 #include "btree.h"
 
 static EPG *bt_fast(BTREE *, const DBT *, const DBT *, int *);
+static int bt_lput(BTREE *, PAGE *, u_int, const DBT *, const DBT *, int);
+static int bt_ovfl(BTREE *, DBT **, const DBT **, DBT *, DBT *, char *, char *);
 
 /**
  * __BT_PUT -- Add a btree item to the tree.
@@ -79,7 +81,6 @@ __bt_put(dbp, key, data, flags)
 	EPG *e = NULL;
 	PAGE *h;
 	indx_t index, nxtindex;
-	pgno_t pg;
 	u_int32_t nbytes;
 	int dflags, exact, status;
 	char *dest, db[NOVFLSIZE], kb[NOVFLSIZE];
@@ -98,6 +99,9 @@ __bt_put(dbp, key, data, flags)
 		return (RET_ERROR);
 	}
 
+	/* The key in bt_rkey may no longer be on the page. */
+	t->bt_rkeypos.pgno = P_INVALID;
+
 	switch (flags) {
 	case 0:
 	case R_NOOVERWRITE:
@@ -119,39 +123,13 @@ __bt_put(dbp, key, data, flags)
 
 	/*
 	 * If the key/data pair won't fit on a page, store it on overflow
-	 * pages.  Only put the key on the overflow page if the pair are
-	 * still too big after moving the data to an overflow page.
+	 * pages.
 	 *
 	 * XXX
 	 * If the insert fails later on, the overflow pages aren't recovered.
 	 */
-	dflags = 0;
-	if (key->size + data->size > t->bt_ovflsize) {
-		if (key->size > t->bt_ovflsize) {
-storekey:		if (__ovfl_put(t, key, &pg) == RET_ERROR)
-				return (RET_ERROR);
-			tkey.data = kb;
-			tkey.size = NOVFLSIZE;
-			memmove(kb, &pg, sizeof(pgno_t));
-			memmove(kb + sizeof(pgno_t),
-			    &key->size, sizeof(u_int32_t));
-			dflags |= P_BIGKEY;
-			key = &tkey;
-		}
-		if (key->size + data->size > t->bt_ovflsize) {
-			if (__ovfl_put(t, data, &pg) == RET_ERROR)
-				return (RET_ERROR);
-			tdata.data = db;
-			tdata.size = NOVFLSIZE;
-			memmove(db, &pg, sizeof(pgno_t));
-			memmove(db + sizeof(pgno_t),
-			    &data->size, sizeof(u_int32_t));
-			dflags |= P_BIGDATA;
-			data = &tdata;
-		}
-		if (key->size + data->size > t->bt_ovflsize)
-			goto storekey;
-	}
+	if ((dflags = bt_ovfl(t, &key, &data, &tkey, &tdata, kb, db)) < 0)
+		return (RET_ERROR);
 
 	/* Replace the cursor. */
 	if (flags == R_CURSOR) {
@@ -205,22 +183,32 @@ delete:		if (__bt_dleaf(t, key, h, index) == RET_ERROR) {
 	 * into the offset array, shift the pointers up.
 	 */
 	nbytes = NBLEAFDBT(key->size, data->size);
-	if (h->upper - h->lower < nbytes + sizeof(indx_t)) {
+	if (F_ISSET(t, B_PFXKEY)) {
+		if ((status = bt_lput(t,
+		    h, index, key, data, dflags)) == RET_ERROR) {
+			mpool_put(t->bt_mp, h, 0);
+			return (RET_ERROR);
+		}
+	} else if (h->upper - h->lower < nbytes + sizeof(indx_t))
+		status = RET_SPECIAL;
+	else {
+		if (index < (nxtindex = NEXTINDEX(h)))
+			memmove(h->linp + index + 1, h->linp + index,
+			    (nxtindex - index) * sizeof(indx_t));
+		h->lower += sizeof(indx_t);
+
+		h->linp[index] = h->upper -= nbytes;
+		dest = (char *)h + h->upper;
+		WR_BLEAF(dest, key, data, dflags);
+		status = RET_SUCCESS;
+	}
+	if (status == RET_SPECIAL) {
 		if ((status = __bt_split(t, h, key,
 		    data, dflags, nbytes, index)) != RET_SUCCESS)
 			return (status);
 		goto success;
 	}
 
-	if (index < (nxtindex = NEXTINDEX(h)))
-		memmove(h->linp + index + 1, h->linp + index,
-		    (nxtindex - index) * sizeof(indx_t));
-	h->lower += sizeof(indx_t);
-
-	h->linp[index] = h->upper -= nbytes;
-	dest = (char *)h + h->upper;
-	WR_BLEAF(dest, key, data, dflags);
-
 	/* If the cursor is on this page, adjust it as necessary. */
 	if (F_ISSET(&t->bt_cursor, CURS_INIT) &&
 	    !F_ISSET(&t->bt_cursor, CURS_ACQUIRE) &&
@@ -252,6 +240,100 @@ success:
 	return (RET_SUCCESS);
 }
 
+/**
+ * BT_LPUT -- Insert a key/data pair into a leaf page of a tree with
+ *	prefix compressed keys.
+ *
+ *	@param t	tree
+ *	@param h	leaf page
+ *	@param index	index of the new item
+ *	@param key	key
+ *	@param data	data
+ *	@param dflags	#P_BIGKEY/#P_BIGDATA flags
+ *
+ * @return
+ *	#RET_SUCCESS, #RET_ERROR and #RET_SPECIAL if the page must be split.
+ *
+ * The new key is stored relative to the previous key, and the next key,
+ * if it was stored relative to the previous key, is stored again relative
+ * to the new key.  A run of prefix compressed items never gets longer
+ * than #PFX_CHAIN.
+ */
+static int
+bt_lput(t, h, index, key, data, dflags)
+	BTREE *t;
+	PAGE *h;
+	u_int index;
+	const DBT *key, *data;
+	int dflags;
+{
+	BLEAF *bl;
+	DBT prev;
+	LITEM item, next;
+	size_t bufsz;
+	u_int chain, i, plen, nplen, top;
+	u_int32_t nbytes, nnbytes;
+	int room;
+	void *buf;
+	char *image;
+
+	item.key = *key;
+	item.data = *data;
+	item.flags = dflags;
+	top = NEXTINDEX(h);
+
+	/* Count the run of prefix compressed items around the new one. */
+	for (chain = 0, i = index; i > 0 &&
+	    GETBLEAF(h, i - 1)->flags & P_PFXKEY; --i)
+		++chain;
+	for (i = index; i < top && GETBLEAF(h, i)->flags & P_PFXKEY; ++i)
+		++chain;
+
+	plen = 0;
+	nbytes = NBLEAFDBT(key->size, data->size);
+	if (index > 0 && chain < PFX_CHAIN &&
+	    !(GETBLEAF(h, index - 1)->flags & P_BIGKEY)) {
+		if (__bt_lkey(h, index - 1,
+		    &prev, &t->bt_pkey.data, &t->bt_pkey.size))
+			return (RET_ERROR);
+		nbytes = __bt_lsize(&prev, &item, &plen);
+	}
+	room = (int)(h->upper - h->lower) - (int)(nbytes + sizeof(indx_t));
+
+	image = NULL;
+	nnbytes = 0;
+	if (index < top && (bl = GETBLEAF(h, index))->flags & P_PFXKEY) {
+		buf = NULL;
+		bufsz = 0;
+		if (__bt_lkey(h, index, &next.key, &buf, &bufsz))
+			return (RET_ERROR);
+		next.data.data = bl->bytes + bl->ksize;
+		next.data.size = bl->dsize;
+		next.flags = bl->flags & ~P_PFXKEY;
+		nnbytes = __bt_lsize(dflags & P_BIGKEY ? NULL : key,
+		    &next, &nplen);
+		room -= (int)nnbytes - (int)NBLEAF(bl);
+		if (room >= 0) {
+			if ((image = malloc(nnbytes)) == NULL) {
+				free(buf);
+				return (RET_ERROR);
+			}
+			__bt_lwrite(image, &next, nplen);
+		}
+		free(buf);
+	}
+	if (room < 0)
+		return (RET_SPECIAL);
+
+	if (image != NULL) {
+		__bt_lremove(h, index);
+		memmove(__bt_linsert(h, index, nnbytes), image, nnbytes);
+		free(image);
+	}
+	__bt_lwrite(__bt_linsert(h, index, nbytes), &item, plen);
+	return (RET_SUCCESS);
+}
+
 u_long bt_cache_hit, bt_cache_miss;
 
 /**
@@ -320,3 +402,432 @@ miss:
 	mpool_put(t->bt_mp, h, 0);
 	return (NULL);
 }
+
+/**
+ * BT_OVFL -- Store a big key/data pair on overflow pages.
+ *
+ *	@param t	tree
+ *	@param keyp	pointer to key, replaced with @a tkey if the key is stored
+ *	@param datap	pointer to data, replaced with @a tdata if the data is stored
+ *	@param tkey	reference to the overflow key
+ *	@param tdata	reference to the overflow data
+ *	@param kb	buffer for @a tkey (#NOVFLSIZE bytes)
+ *	@param db	buffer for @a tdata (#NOVFLSIZE bytes)
+ *
+ * @return #P_BIGKEY and #P_BIGDATA flags, -1 on error.
+ *
+ * If the key/data pair won't fit on a page, store it on overflow pages.
+ * Only put the key on the overflow page if the pair are still too big
+ * after moving the data to an overflow page.
+ */
+static int
+bt_ovfl(t, keyp, datap, tkey, tdata, kb, db)
+	BTREE *t;
+	DBT **keyp;
+	const DBT **datap;
+	DBT *tkey, *tdata;
+	char *kb, *db;
+{
+	DBT *key = *keyp;
+	const DBT *data = *datap;
+	pgno_t pg;
+	int dflags;
+
+	dflags = 0;
+	if (key->size + data->size > t->bt_ovflsize) {
+		if (key->size > t->bt_ovflsize) {
+storekey:		if (__ovfl_put(t, key, &pg) == RET_ERROR)
+				return (-1);
+			tkey->data = kb;
+			tkey->size = NOVFLSIZE;
+			memmove(kb, &pg, sizeof(pgno_t));
+			memmove(kb + sizeof(pgno_t),
+			    &key->size, sizeof(u_int32_t));
+			dflags |= P_BIGKEY;
+			key = tkey;
+		}
+		if (key->size + data->size > t->bt_ovflsize) {
+			if (__ovfl_put(t, data, &pg) == RET_ERROR)
+				return (-1);
+			tdata->data = db;
+			tdata->size = NOVFLSIZE;
+			memmove(db, &pg, sizeof(pgno_t));
+			memmove(db + sizeof(pgno_t),
+			    &data->size, sizeof(u_int32_t));
+			dflags |= P_BIGDATA;
+			data = tdata;
+		}
+		if (key->size + data->size > t->bt_ovflsize)
+			goto storekey;
+	}
+	*keyp = key;
+	*datap = data;
+	return (dflags);
+}
+
+/** Max height of a tree made by #__bt_bulkload (the depth of the parent stack). */
+#define	BL_MAXLEVEL	(sizeof(((BTREE *)0)->bt_stack) / sizeof(EPGNO))
+
+/** State of #__bt_bulkload. */
+typedef struct {
+	BTREE	 *t;			/**< tree */
+	u_int32_t limit;		/**< bytes to be filled in a page */
+	int	  nlevels;		/**< number of levels */
+	PAGE	 *level[BL_MAXLEVEL];	/**< last (pinned) page of each level, 0 is the leaf level */
+} BULK;
+
+static PAGE *bl_new(BULK *, PAGE *, u_int32_t);
+static int bl_full(BULK *, PAGE *, u_int32_t);
+static int bl_post(BULK *, int, pgno_t, const void *, u_int32_t, pgno_t, int);
+
+/**
+ * __BT_BULKLOAD -- Build a btree from the bottom up.
+ *
+ *	@param dbp	pointer to access method
+ *	@param next	routine to read the next key/data pair. It returns
+ *			#RET_SUCCESS, #RET_SPECIAL at the end or #RET_ERROR.
+ *	@param arg	argument for @a next
+ *	@param ffactor	percentage of each page to be filled (1-100).
+ *			Other values mean 100.
+ *
+ * @return #RET_ERROR, #RET_SUCCESS
+ *
+ * The tree must be empty, and the key/data pairs must be read in the
+ * order of the tree.  Leaf pages are filled one after another and the key
+ * of each new page is added to the last page of the parent level, so no
+ * page is ever split or searched.  When all pairs are loaded, the top
+ * page is moved onto the root page.  If the pairs are not sorted, #RET_ERROR
+ * is returned with @CODE{errno} set to @CODE{EINVAL}; the tree is broken then.
+ */
+int
+__bt_bulkload(dbp, next, arg, ffactor)
+	DB *dbp;
+	int (*next)(void *, DBT *, DBT *);
+	void *arg;
+	int ffactor;
+{
+	BTREE *t;
+	BULK b;
+	BLEAF *bl, *tbl;
+	DBT last, rkey, rdata, tkey, tdata, pa, pb, *key;
+	const DBT *data;
+	EPG e;
+	LITEM item;
+	PAGE *h, *l, *p, *root, *tp;
+	pgno_t lpgno;
+	size_t lbufsz;
+	u_int32_t nbytes, nksize;
+	void *lbuf, *nb;
+	u_int chain, plen;
+	int cmp, dflags, lv, status;
+	char db[NOVFLSIZE], kb[NOVFLSIZE];
+
+	t = dbp->internal;
+
+	/* Toss any page pinned across calls. */
+	if (t->bt_pinned != NULL) {
+		mpool_put(t->bt_mp, t->bt_pinned, 0);
+		t->bt_pinned = NULL;
+	}
+
+	/* Check for change to a read-only tree. */
+	if (F_ISSET(t, B_RDONLY)) {
+		errno = EPERM;
+		return (RET_ERROR);
+	}
+
+	/* The key in bt_rkey may no longer be on the page. */
+	t->bt_rkeypos.pgno = P_INVALID;
+
+	/* The tree must be empty. */
+	if ((root = mpool_get(t->bt_mp, P_ROOT, 0)) == NULL)
+		return (RET_ERROR);
+	if (F_ISSET(t, R_RECNO) || !(root->flags & P_BLEAF) ||
+	    NEXTINDEX(root) != 0 || t->bt_free != P_INVALID) {
+		mpool_put(t->bt_mp, root, 0);
+		errno = EINVAL;
+		return (RET_ERROR);
+	}
+
+	if (ffactor <= 0 || ffactor > 100)
+		ffactor = 100;
+	b.t = t;
+	b.limit = (t->bt_psize - BTDATAOFF) * ffactor / 100;
+	b.nlevels = 0;
+	last.data = lbuf = NULL;
+	lbufsz = 0;
+	chain = 0;
+
+	while ((status = (*next)(arg, &rkey, &rdata)) == RET_SUCCESS) {
+		h = b.nlevels > 0 ? b.level[0] : NULL;
+
+		/* The pairs must be in the order of the tree. */
+		if (h != NULL) {
+			if (last.data != NULL)
+				cmp = (*t->bt_cmp)(&rkey, &last);
+			else {
+				e.page = h;
+				e.index = NEXTINDEX(h) - 1;
+				cmp = __bt_cmp(t, &rkey, &e);
+			}
+			if (cmp < 0 || (cmp == 0 && F_ISSET(t, B_NODUPS))) {
+				errno = EINVAL;
+				goto err;
+			}
+		}
+
+		key = &rkey;
+		data = &rdata;
+		if ((dflags = bt_ovfl(t, &key, &data, &tkey, &tdata, kb, db)) < 0)
+			goto err;
+		item.key = *key;
+		item.data = *data;
+		item.flags = dflags;
+		nbytes = NBLEAFDBT(key->size, data->size);
+
+		/* Store the key relative to the previous one if possible. */
+		plen = 0;
+		if (h != NULL && last.data != NULL && chain < PFX_CHAIN)
+			nbytes = __bt_lsize(&last, &item, &plen);
+
+		/* Start the leaf level or a new leaf page. */
+		l = NULL;
+		if (h == NULL) {
+			if ((h = bl_new(&b, NULL, P_BLEAF)) == NULL)
+				goto err;
+			b.level[0] = h;
+			b.nlevels = 1;
+		} else if (bl_full(&b, h, nbytes)) {
+			l = h;
+			if ((h = bl_new(&b, l, P_BLEAF)) == NULL)
+				goto err;
+			plen = 0;
+			nbytes = NBLEAFDBT(key->size, data->size);
+		}
+
+		h->linp[NEXTINDEX(h)] = h->upper -= nbytes;
+		h->lower += sizeof(indx_t);
+		__bt_lwrite((char *)h + h->upper, &item, plen);
+		chain = plen ? chain + 1 : 0;
+
+		/* Keep the whole key for the next pair. */
+		last.data = NULL;
+		if (F_ISSET(t, B_PFXKEY) && !(dflags & P_BIGKEY)) {
+			if (key->size > lbufsz) {
+				if ((nb = lbuf == NULL ? malloc(key->size) :
+				    realloc(lbuf, key->size)) == NULL)
+					goto err;
+				lbuf = nb;
+				lbufsz = key->size;
+			}
+			memmove(lbuf, key->data, key->size);
+			last.data = lbuf;
+			last.size = key->size;
+		}
+		if (l == NULL)
+			continue;
+
+		/*
+		 * Add the key of the new page to the parent level.  The key
+		 * is shortened in the same way as __bt_split does.
+		 */
+		bl = GETBLEAF(h, 0);
+		nksize = bl->ksize;
+		p = b.nlevels > 1 ? b.level[1] : NULL;
+		if (t->bt_pfx && !(bl->flags & P_BIGKEY) &&
+		    p != NULL && (p->prevpg != P_INVALID || NEXTINDEX(p) > 1)) {
+			tbl = GETBLEAF(l, NEXTINDEX(l) - 1);
+			if (tbl->flags & P_PFXKEY) {
+				if (__bt_lkey(l, NEXTINDEX(l) - 1, &pa,
+				    &t->bt_pkey.data, &t->bt_pkey.size))
+					goto err;
+			} else {
+				pa.size = tbl->ksize;
+				pa.data = tbl->bytes;
+			}
+			pb.size = bl->ksize;
+			pb.data = bl->bytes;
+			nbytes = t->bt_pfx(&pa, &pb);
+			if (NBINTERNAL(nbytes) < NBINTERNAL(nksize))
+				nksize = nbytes;
+		}
+		/*
+		 * If the key is on an overflow page, mark the overflow chain
+		 * so it isn't deleted when the leaf copy of the key is deleted.
+		 */
+		if (bl->flags & P_BIGKEY) {
+			if ((tp = mpool_get(t->bt_mp,
+			    *(pgno_t *)bl->bytes, 0)) == NULL)
+				goto err;
+			tp->flags |= P_PRESERVE;
+			mpool_put(t->bt_mp, tp, MPOOL_DIRTY);
+		}
+		lpgno = l->pgno;
+		mpool_put(t->bt_mp, l, MPOOL_DIRTY);
+		b.level[0] = h;
+		if (bl_post(&b, 1, lpgno, bl->bytes, nksize,
+		    h->pgno, bl->flags & P_BIGKEY) == RET_ERROR)
+			goto err;
+	}
+	if (status == RET_ERROR)
+		goto err;
+
+	/*
+	 * Move the top page onto the root page.  The page which held it
+	 * is put on the free list.
+	 */
+	if (b.nlevels > 0) {
+		for (lv = 0; lv < b.nlevels - 1; lv++)
+			mpool_put(t->bt_mp, b.level[lv], MPOOL_DIRTY);
+		h = b.level[b.nlevels - 1];
+		memmove(root, h, t->bt_psize);
+		root->pgno = P_ROOT;
+		if (__bt_free(t, h) == RET_ERROR) {
+			mpool_put(t->bt_mp, root, 0);
+			__dbpanic(dbp);
+			return (RET_ERROR);
+		}
+		F_SET(t, B_MODIFIED);
+	}
+	mpool_put(t->bt_mp, root, MPOOL_DIRTY);
+	if (lbuf != NULL)
+		free(lbuf);
+	return (RET_SUCCESS);
+
+err:	if (lbuf != NULL)
+		free(lbuf);
+	for (lv = 0; lv < b.nlevels; lv++)
+		mpool_put(t->bt_mp, b.level[lv], 0);
+	mpool_put(t->bt_mp, root, 0);
+	__dbpanic(dbp);
+	return (RET_ERROR);
+}
+
+/**
+ * BL_NEW -- Get a new page for #__bt_bulkload.
+ *
+ *	@param b	state of #__bt_bulkload
+ *	@param prev	left sibling or @CODE{NULL}
+ *	@param type	#P_BLEAF or #P_BINTERNAL
+ *
+ * @return Pointer to a (pinned) page, @CODE{NULL} on error.
+ */
+static PAGE *
+bl_new(b, prev, type)
+	BULK *b;
+	PAGE *prev;
+	u_int32_t type;
+{
+	PAGE *h;
+	pgno_t npg;
+
+	if ((h = __bt_new(b->t, &npg)) == NULL)
+		return (NULL);
+	h->pgno = npg;
+	h->prevpg = prev != NULL ? prev->pgno : P_INVALID;
+	h->nextpg = P_INVALID;
+	h->lower = BTDATAOFF;
+	h->upper = b->t->bt_psize;
+	h->flags = type;
+	if (prev != NULL)
+		prev->nextpg = npg;
+	return (h);
+}
+
+/**
+ * BL_FULL -- Check whether an item should go to the next page.
+ *
+ *	@param b	state of #__bt_bulkload
+ *	@param h	page
+ *	@param nbytes	size of the item
+ *
+ * @return 1: full, 0: not full
+ *
+ * Every page gets at least #DEFMINKEYPAGE items if they fit, so that
+ * the tree never grows taller than the number of pages requires.
+ */
+static int
+bl_full(b, h, nbytes)
+	BULK *b;
+	PAGE *h;
+	u_int32_t nbytes;
+{
+	if (h->upper - h->lower < nbytes + sizeof(indx_t))
+		return (1);
+	if (NEXTINDEX(h) < DEFMINKEYPAGE)
+		return (0);
+	return (b->t->bt_psize - h->upper + (h->lower - BTDATAOFF) +
+	    nbytes + sizeof(indx_t) > b->limit);
+}
+
+/**
+ * BL_POST -- Add a key to an internal level for #__bt_bulkload.
+ *
+ *	@param b	state of #__bt_bulkload
+ *	@param lv	level (1 or more)
+ *	@param lpgno	left sibling of @a pgno
+ *	@param key	key
+ *	@param ksize	size of @a key
+ *	@param pgno	page the key refers to
+ *	@param flags	#P_BIGKEY
+ *
+ * @return #RET_ERROR, #RET_SUCCESS
+ *
+ * If the level doesn't exist yet, @a lpgno is the first page of the level
+ * below, and it becomes the left-most item of the new level.  The btree
+ * comparison code guarantees that the left-most key on any level is never
+ * used, so it is left empty.
+ */
+static int
+bl_post(b, lv, lpgno, key, ksize, pgno, flags)
+	BULK *b;
+	int lv;
+	pgno_t lpgno;
+	const void *key;
+	u_int32_t ksize;
+	pgno_t pgno;
+	int flags;
+{
+	BTREE *t;
+	PAGE *h, *l;
+	u_int32_t nbytes;
+	char *dest;
+
+	t = b->t;
+	if (lv == b->nlevels) {
+		if (lv == BL_MAXLEVEL) {
+			errno = EINVAL;
+			return (RET_ERROR);
+		}
+		if ((h = bl_new(b, NULL, P_BINTERNAL)) == NULL)
+			return (RET_ERROR);
+		h->linp[0] = h->upper -= NBINTERNAL(0);
+		h->lower += sizeof(indx_t);
+		dest = (char *)h + h->upper;
+		WR_BINTERNAL(dest, 0, lpgno, 0);
+		b->level[lv] = h;
+		b->nlevels++;
+	}
+	h = b->level[lv];
+	nbytes = NBINTERNAL(ksize);
+	l = NULL;
+	if (bl_full(b, h, nbytes)) {
+		l = h;
+		if ((h = bl_new(b, l, P_BINTERNAL)) == NULL)
+			return (RET_ERROR);
+	}
+	h->linp[NEXTINDEX(h)] = h->upper -= nbytes;
+	h->lower += sizeof(indx_t);
+	dest = (char *)h + h->upper;
+	WR_BINTERNAL(dest, ksize, pgno, flags);
+	memmove(dest, key, ksize);
+	if (l == NULL)
+		return (RET_SUCCESS);
+
+	/* The first item of the new page goes up to the parent level. */
+	lpgno = l->pgno;
+	mpool_put(t->bt_mp, l, MPOOL_DIRTY);
+	b->level[lv] = h;
+	return (bl_post(b, lv + 1, lpgno,
+	    GETBINTERNAL(h, 0)->bytes, ksize, h->pgno, flags));
+}
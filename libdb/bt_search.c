@@ -40,10 +40,19 @@ static char sccsid[] = "@(#)bt_search.c	8.8 (Berkeley) 7/31/94";
 #include <sys/types.h>
 
 #include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
 
 #include "db.h"
 #include "btree.h"
 
+static int __bt_lsearch(BTREE *, PAGE *, const DBT *, indx_t *);
 static int __bt_snext(BTREE *, PAGE *, const DBT *, int *);
 static int __bt_sprev(BTREE *, PAGE *, const DBT *, int *);
 
@@ -78,6 +87,15 @@ __bt_search(t, key, exactp)
 
 		/* Do a binary search on the current page. */
 		t->bt_cur.page = h;
+		if (h->flags & P_BLEAF && F_ISSET(t, B_PFXKEY)) {
+			if ((cmp = __bt_lsearch(t, h, key, &base)) < 0)
+				return (NULL);
+			if (cmp) {
+				t->bt_cur.index = base;
+				*exactp = 1;
+				return (&t->bt_cur);
+			}
+		} else
 		for (base = 0, lim = NEXTINDEX(h); lim; lim >>= 1) {
 			t->bt_cur.index = index = base + (lim >> 1);
 			if ((cmp = __bt_cmp(t, key, &t->bt_cur)) == 0) {
@@ -132,6 +150,105 @@ next:		BT_PUSH(t, h->pgno, index);
 	}
 }
 
+/**
+ * __bt_lsearch --
+ *	Search a leaf page of prefix compressed keys.
+ *
+ *	@param[in] t	tree
+ *	@param[in] h	leaf page
+ *	@param[in] key	key to find
+ *	@param[out] indexp	index of the matching record, or the location of
+ *			the key if it were inserted into the page
+ *
+ * @return
+ *	1 if an exact match found, 0 if not found, -1 on error.
+ *
+ * The binary search only looks at the items which have the whole key.
+ * The few items between two of them are compared one by one, rebuilding
+ * each key from the previous one.
+ */
+static int
+__bt_lsearch(t, h, key, indexp)
+	BTREE *t;
+	PAGE *h;
+	const DBT *key;
+	indx_t *indexp;
+{
+	BLEAF *bl;
+	DBT k2;
+	EPG e;
+	size_t size;
+	u_int plen;
+	int cmp, hi, index, lo, mid, inbuf;
+	void *p;
+
+	/* The key of lo is less than key, the key of hi is greater. */
+	e.page = h;
+	lo = -1;
+	hi = NEXTINDEX(h);
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		for (index = mid; index > lo &&
+		    GETBLEAF(h, index)->flags & P_PFXKEY; --index)
+			;
+		if (index == lo)
+			break;
+		e.index = index;
+		if ((cmp = __bt_cmp(t, key, &e)) == 0) {
+			*indexp = index;
+			return (1);
+		}
+		if (cmp > 0)
+			lo = index;
+		else
+			hi = index;
+	}
+
+	k2.data = NULL;
+	k2.size = 0;
+	if (lo >= 0) {
+		bl = GETBLEAF(h, lo);
+		k2.data = bl->bytes;
+		k2.size = bl->ksize;
+	}
+	for (index = lo + 1; index < hi; ++index) {
+		bl = GETBLEAF(h, index);
+		if (bl->flags & P_PFXKEY) {
+			plen = (u_char)bl->bytes[0];
+			size = plen + bl->ksize - 1;
+			inbuf = k2.data == t->bt_pkey.data;
+			if (size > t->bt_pkey.size) {
+				p = (void *)(t->bt_pkey.data == NULL ?
+				    malloc(size) : realloc(t->bt_pkey.data, size));
+				if (p == NULL)
+					return (-1);
+				t->bt_pkey.data = p;
+				t->bt_pkey.size = size;
+			}
+			if (!inbuf)
+				memmove(t->bt_pkey.data, k2.data, plen);
+			memmove((char *)t->bt_pkey.data + plen,
+			    bl->bytes + 1, bl->ksize - 1);
+			k2.data = t->bt_pkey.data;
+			k2.size = size;
+			cmp = (*t->bt_cmp)(key, &k2);
+		} else {
+			e.index = index;
+			cmp = __bt_cmp(t, key, &e);
+			k2.data = bl->bytes;
+			k2.size = bl->ksize;
+		}
+		if (cmp == 0) {
+			*indexp = index;
+			return (1);
+		}
+		if (cmp < 0)
+			break;
+	}
+	*indexp = index;
+	return (0);
+}
+
 /**
  * __bt_snext --
  *	Check for an exact match after the @a key.
@@ -38,6 +38,8 @@ static char sccsid[] = "@(#)bt_split.c	8.9 (Berkeley) 7/26/94";
 #include <config.h>
 #endif
 #include <sys/types.h>
+
+#include <errno.h>
 #ifdef HAVE_LIMITS_H
 #include <limits.h>
 #endif
@@ -55,10 +57,16 @@ static char sccsid[] = "@(#)bt_split.c	8.9 (Berkeley) 7/26/94";
 #include "btree.h"
 
 static int	 bt_broot(BTREE *, PAGE *, PAGE *, PAGE *);
-static PAGE	*bt_page(BTREE *, PAGE *, PAGE **, PAGE **, indx_t *, size_t);
+static void	 bt_lfill(PAGE *, const LITEM *, u_int, u_int);
+static u_int32_t bt_lnext(const LITEM *, u_int, u_int, u_int *, u_int *);
+static PAGE	*bt_lpsplit(BTREE *, PAGE *, PAGE *, PAGE *, indx_t *, const LITEM *);
+static PAGE	*bt_page(BTREE *, PAGE *, PAGE **, PAGE **, indx_t *, size_t,
+		    const LITEM *);
 static int	 bt_preserve(BTREE *, pgno_t);
-static PAGE	*bt_psplit(BTREE *, PAGE *, PAGE *, PAGE *, indx_t *, size_t);
-static PAGE	*bt_root(BTREE *, PAGE *, PAGE **, PAGE **, indx_t *, size_t);
+static PAGE	*bt_psplit(BTREE *, PAGE *, PAGE *, PAGE *, indx_t *, size_t,
+		    const LITEM *);
+static PAGE	*bt_root(BTREE *, PAGE *, PAGE **, PAGE **, indx_t *, size_t,
+		    const LITEM *);
 static int	 bt_rroot(BTREE *, PAGE *, PAGE *, PAGE *);
 static recno_t	 rec_total(PAGE *);
 
@@ -91,6 +99,7 @@ __bt_split(t, sp, key, data, flags, ilen, argskip)
 	BLEAF *bl = NULL, *tbl;
 	DBT a, b;
 	EPGNO *parent;
+	LITEM li, *item;
 	PAGE *h, *l, *r, *lchild, *rchild;
 	indx_t nxtindex;
 	u_int16_t skip;
@@ -105,22 +114,32 @@ __bt_split(t, sp, key, data, flags, ilen, argskip)
 	 * are pinned.
 	 */
 	skip = argskip;
+	item = NULL;
+	if (F_ISSET(t, B_PFXKEY) && sp->flags & P_BLEAF) {
+		li.key = *key;
+		li.data = *data;
+		li.flags = flags;
+		item = &li;
+	}
 	h = sp->pgno == P_ROOT ?
-	    bt_root(t, sp, &l, &r, &skip, ilen) :
-	    bt_page(t, sp, &l, &r, &skip, ilen);
+	    bt_root(t, sp, &l, &r, &skip, ilen, item) :
+	    bt_page(t, sp, &l, &r, &skip, ilen, item);
 	if (h == NULL)
 		return (RET_ERROR);
 
 	/*
 	 * Insert the new key/data pair into the leaf page.  (Key inserts
-	 * always cause a leaf page to split first.)
+	 * always cause a leaf page to split first.)  A page of prefix
+	 * compressed keys has it already.
 	 */
-	h->linp[skip] = h->upper -= ilen;
-	dest = (char *)h + h->upper;
-	if (F_ISSET(t, R_RECNO))
-		WR_RLEAF(dest, data, flags)
-	else
-		WR_BLEAF(dest, key, data, flags)
+	if (item == NULL) {
+		h->linp[skip] = h->upper -= ilen;
+		dest = (char *)h + h->upper;
+		if (F_ISSET(t, R_RECNO))
+			WR_RLEAF(dest, data, flags)
+		else
+			WR_BLEAF(dest, key, data, flags)
+	}
 
 	/* If the root page was split, make it look right. */
 	if (sp->pgno == P_ROOT &&
@@ -190,8 +209,18 @@ __bt_split(t, sp, key, data, flags, ilen, argskip)
 			if (t->bt_pfx && !(bl->flags & P_BIGKEY) &&
 			    (h->prevpg != P_INVALID || skip > 1)) {
 				tbl = GETBLEAF(lchild, NEXTINDEX(lchild) - 1);
-				a.size = tbl->ksize;
-				a.data = tbl->bytes;
+				if (tbl->flags & P_PFXKEY) {
+					if (__bt_lkey(lchild,
+					    NEXTINDEX(lchild) - 1, &a,
+					    &t->bt_pkey.data,
+					    &t->bt_pkey.size)) {
+						mpool_put(t->bt_mp, h, 0);
+						goto err1;
+					}
+				} else {
+					a.size = tbl->ksize;
+					a.data = tbl->bytes;
+				}
 				b.size = bl->ksize;
 				b.data = bl->bytes;
 				nksize = t->bt_pfx(&a, &b);
@@ -218,8 +247,8 @@ __bt_split(t, sp, key, data, flags, ilen, argskip)
 		if (h->upper - h->lower < nbytes + sizeof(indx_t)) {
 			sp = h;
 			h = h->pgno == P_ROOT ?
-			    bt_root(t, h, &l, &r, &skip, nbytes) :
-			    bt_page(t, h, &l, &r, &skip, nbytes);
+			    bt_root(t, h, &l, &r, &skip, nbytes, NULL) :
+			    bt_page(t, h, &l, &r, &skip, nbytes, NULL);
 			if (h == NULL)
 				goto err1;
 			parentsplit = 1;
@@ -335,23 +364,24 @@ err2:	mpool_put(t->bt_mp, l, 0);
  *	@param rp	pointer to right page pointer
  *	@param skip	pointer to index to leave open
  *	@param ilen	insert length
+ *	@param item	new item of a leaf page of prefix compressed keys,
+ *			which is inserted here, or @CODE{NULL}
  *
  * @return
  *	Pointer to page in which to insert or @CODE{NULL} on error.
  */
 static PAGE *
-bt_page(t, h, lp, rp, skip, ilen)
+bt_page(t, h, lp, rp, skip, ilen, item)
 	BTREE *t;
 	PAGE *h, **lp, **rp;
 	indx_t *skip;
 	size_t ilen;
+	const LITEM *item;
 {
 	PAGE *l, *r, *tp;
 	pgno_t npg;
 
-#ifdef STATISTICS
 	++bt_split;
-#endif
 	/* Put the new right page for the split into place. */
 	if ((r = __bt_new(t, &npg)) == NULL)
 		return (NULL);
@@ -379,6 +409,10 @@ bt_page(t, h, lp, rp, skip, ilen)
 		h->nextpg = r->pgno;
 		r->lower = BTDATAOFF + sizeof(indx_t);
 		*skip = 0;
+		if (item != NULL) {
+			r->linp[0] = r->upper -= ilen;
+			__bt_lwrite((char *)r + r->upper, item, 0);
+		}
 		*lp = h;
 		*rp = r;
 		return (r);
@@ -417,7 +451,11 @@ bt_page(t, h, lp, rp, skip, ilen)
 	 * the left page in place.  Since the left page can't change, we have
 	 * to swap the original and the allocated left page after the split.
 	 */
-	tp = bt_psplit(t, h, l, r, skip, ilen);
+	if ((tp = bt_psplit(t, h, l, r, skip, ilen, item)) == NULL) {
+		free(l);
+		mpool_put(t->bt_mp, r, 0);
+		return (NULL);
+	}
 
 	/* Move the new left page onto the old left page. */
 	memmove(h, l, t->bt_psize);
@@ -439,22 +477,25 @@ bt_page(t, h, lp, rp, skip, ilen)
  *	@param rp	pointer to right page pointer
  *	@param skip	pointer to index to leave open
  *	@param ilen	insert length
+ *	@param item	new item of a leaf page of prefix compressed keys,
+ *			which is inserted here, or @CODE{NULL}
  *
  * @return
  *	Pointer to page in which to insert or @CODE{NULL} on error.
  */
 static PAGE *
-bt_root(t, h, lp, rp, skip, ilen)
+bt_root(t, h, lp, rp, skip, ilen, item)
 	BTREE *t;
 	PAGE *h, **lp, **rp;
 	indx_t *skip;
 	size_t ilen;
+	const LITEM *item;
 {
 	PAGE *l, *r, *tp;
 	pgno_t lnpg, rnpg;
 
-#ifdef STATISTICS
 	++bt_split;
+#ifdef STATISTICS
 	++bt_rootsplit;
 #endif
 	/* Put the new left and right pages for the split into place. */
@@ -471,7 +512,11 @@ bt_root(t, h, lp, rp, skip, ilen)
 	l->flags = r->flags = h->flags & P_TYPE;
 
 	/* Split the root page. */
-	tp = bt_psplit(t, h, l, r, skip, ilen);
+	if ((tp = bt_psplit(t, h, l, r, skip, ilen, item)) == NULL) {
+		mpool_put(t->bt_mp, l, 0);
+		mpool_put(t->bt_mp, r, 0);
+		return (NULL);
+	}
 
 	*lp = l;
 	*rp = r;
@@ -600,16 +645,19 @@ bt_broot(t, h, l, r)
  *	@param r	page to put upper half of data
  *	@param pskip	pointer to index to leave open
  *	@param ilen	insert length
+ *	@param item	new item of a leaf page of prefix compressed keys,
+ *			which is inserted here, or @CODE{NULL}
  *
  * @return
- *	Pointer to page in which to insert.
+ *	Pointer to page in which to insert, @CODE{NULL} on error.
  */
 static PAGE *
-bt_psplit(t, h, l, r, pskip, ilen)
+bt_psplit(t, h, l, r, pskip, ilen, item)
 	BTREE *t;
 	PAGE *h, *l, *r;
 	indx_t *pskip;
 	size_t ilen;
+	const LITEM *item;
 {
 	BINTERNAL *bi;
 	BLEAF *bl;
@@ -621,6 +669,9 @@ bt_psplit(t, h, l, r, pskip, ilen)
 	u_int32_t nbytes;
 	int bigkeycnt, isbigkey;
 
+	if (item != NULL)
+		return (bt_lpsplit(t, h, l, r, pskip, item));
+
 	/*
 	 * Split the data to the left and right pages.  Leave the skip index
 	 * open.  Additionally, make some effort not to split on an overflow
@@ -767,6 +818,189 @@ bt_psplit(t, h, l, r, pskip, ilen)
 	return (rval);
 }
 
+/**
+ * BT_LPSPLIT -- Split a leaf page of prefix compressed keys.
+ *
+ *	@param t	tree
+ *	@param h	page to be split
+ *	@param l	page to put lower half of data
+ *	@param r	page to put upper half of data
+ *	@param pskip	pointer to index of the new item
+ *	@param item	new item
+ *
+ * @return
+ *	Pointer to page in which the new item was inserted, @CODE{NULL} on
+ *	error.
+ *
+ * Unlike bt_psplit(), the new item is written too, because the keys after
+ * it are stored relative to it.  The keys are rebuilt, and written again to
+ * both pages, so that the first key of the right page is a whole key.
+ */
+static PAGE *
+bt_lpsplit(t, h, l, r, pskip, item)
+	BTREE *t;
+	PAGE *h, *l, *r;
+	indx_t *pskip;
+	const LITEM *item;
+{
+	BLEAF *bl;
+	CURSOR *c;
+	DBT prev;
+	LITEM *items, *ip;
+	PAGE *rval;
+	u_int chain, i, nxt, plen, skip, top;
+	u_int32_t full, half, nbytes, size, used;
+	char *arena;
+
+	skip = *pskip;
+	top = NEXTINDEX(h) + 1;
+
+	/* Rebuild the keys and put the new item in place. */
+	for (size = 0, i = 0; i < top - 1; ++i) {
+		bl = GETBLEAF(h, i);
+		if (bl->flags & P_PFXKEY)
+			size += BLEAF_KSIZE(bl);
+	}
+	if ((items = malloc(top * sizeof(LITEM) + size)) == NULL)
+		return (NULL);
+	arena = (char *)(items + top);
+	prev.data = NULL;
+	prev.size = 0;
+	for (ip = items, i = 0; i < top - 1; ++ip, ++i) {
+		if (i == skip)
+			*ip++ = *item;
+		bl = GETBLEAF(h, i);
+		if (bl->flags & P_PFXKEY) {
+			plen = (u_char)bl->bytes[0];
+			memmove(arena, prev.data, plen);
+			memmove(arena + plen, bl->bytes + 1, bl->ksize - 1);
+			ip->key.data = arena;
+			ip->key.size = plen + bl->ksize - 1;
+			arena += ip->key.size;
+		} else {
+			ip->key.data = bl->bytes;
+			ip->key.size = bl->ksize;
+		}
+		ip->data.data = bl->bytes + bl->ksize;
+		ip->data.size = bl->dsize;
+		ip->flags = bl->flags & ~P_PFXKEY;
+		prev = ip->key;
+	}
+	if (skip == top - 1)
+		*ip = *item;
+
+	/*
+	 * Fill the left page up to half, leaving at least one item to the
+	 * right page, and move more items to the left page while the right
+	 * page overflows.
+	 */
+	full = t->bt_psize - BTDATAOFF;
+	half = full / 2;
+	chain = 0;
+	for (used = 0, nxt = 0; nxt < top - 1; ) {
+		nbytes = bt_lnext(items, 0, nxt, &chain, &plen) + sizeof(indx_t);
+		if (nxt > 0 && used + nbytes > full)
+			break;
+		used += nbytes;
+		++nxt;
+		if (used >= half)
+			break;
+	}
+	for (;;) {
+		for (size = 0, chain = 0, i = nxt; i < top; ++i)
+			size += bt_lnext(items, nxt, i, &chain, &plen) +
+			    sizeof(indx_t);
+		if (size <= full)
+			break;
+		if (nxt == top - 1) {
+			free(items);
+			errno = EINVAL;
+			return (NULL);
+		}
+		++nxt;
+	}
+
+	bt_lfill(l, items, 0, nxt);
+	bt_lfill(r, items, nxt, top);
+	free(items);
+
+	/*
+	 * If splitting the page that the cursor was on, the cursor has to be
+	 * adjusted to point to the same record as before the split.
+	 */
+	c = &t->bt_cursor;
+	if (F_ISSET(c, CURS_INIT) && c->pg.pgno == h->pgno) {
+		if (c->pg.index >= skip)
+			++c->pg.index;
+		if (c->pg.index < nxt)			/* Left page. */
+			c->pg.pgno = l->pgno;
+		else {					/* Right page. */
+			c->pg.pgno = r->pgno;
+			c->pg.index -= nxt;
+		}
+	}
+
+	if (skip < nxt)
+		rval = l;
+	else {
+		rval = r;
+		*pskip -= nxt;
+	}
+	return (rval);
+}
+
+/**
+ * BT_LNEXT -- Get the size of a leaf item written after the previous one.
+ *
+ *	@param items	items
+ *	@param first	index of the first item on the page
+ *	@param i	index of the item
+ *	@param chainp	length of the run of prefix compressed items (in/out)
+ *	@param plenp	length of the shared prefix (output)
+ *
+ * @return
+ *	Number of bytes of the item on the page.
+ */
+static u_int32_t
+bt_lnext(items, first, i, chainp, plenp)
+	const LITEM *items;
+	u_int first, i;
+	u_int *chainp, *plenp;
+{
+	u_int32_t nbytes;
+
+	nbytes = __bt_lsize(i == first || *chainp >= PFX_CHAIN ||
+	    items[i - 1].flags & P_BIGKEY ? NULL : &items[i - 1].key,
+	    &items[i], plenp);
+	*chainp = *plenp ? *chainp + 1 : 0;
+	return (nbytes);
+}
+
+/**
+ * BT_LFILL -- Write leaf items to an empty page.
+ *
+ *	@param h	page
+ *	@param items	items
+ *	@param first	index of the first item
+ *	@param top	index after the last item
+ */
+static void
+bt_lfill(h, items, first, top)
+	PAGE *h;
+	const LITEM *items;
+	u_int first, top;
+{
+	u_int chain, i, plen;
+	u_int32_t nbytes;
+
+	for (chain = 0, i = first; i < top; ++i) {
+		nbytes = bt_lnext(items, first, i, &chain, &plen);
+		h->linp[i - first] = h->upper -= nbytes;
+		__bt_lwrite((char *)h + h->upper, &items[i], plen);
+	}
+	h->lower += (top - first) * sizeof(indx_t);
+}
+
 /**
  * BT_PRESERVE -- Mark a chain of pages as used by an internal node.
  *
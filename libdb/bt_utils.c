@@ -37,6 +37,7 @@ static char sccsid[] = "@(#)bt_utils.c	8.8 (Berkeley) 7/20/94";
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#include <errno.h>
 #include <stdio.h>
 #ifdef STDC_HEADERS
 #include <stdlib.h>
@@ -90,6 +91,28 @@ __bt_ret(t, e, key, rkey, data, rdata, copy)
 		    &key->size, &rkey->data, &rkey->size))
 			return (RET_ERROR);
 		key->data = rkey->data;
+	} else if (bl->flags & P_PFXKEY) {
+		/*
+		 * In a sequential scan, the previous key is still in the
+		 * buffer, and only the rest of the key has to be copied.
+		 */
+		if (rkey == &t->bt_rkey &&
+		    t->bt_rkeypos.pgno == e->page->pgno &&
+		    t->bt_rkeypos.index + 1 == e->index) {
+			if (BLEAF_KSIZE(bl) > rkey->size) {
+				p = (void *)realloc(rkey->data, BLEAF_KSIZE(bl));
+				if (p == NULL)
+					return (RET_ERROR);
+				rkey->data = p;
+				rkey->size = BLEAF_KSIZE(bl);
+			}
+			memmove((char *)rkey->data + (u_char)bl->bytes[0],
+			    bl->bytes + 1, bl->ksize - 1);
+			key->size = BLEAF_KSIZE(bl);
+			key->data = rkey->data;
+		} else if (__bt_lkey(e->page, e->index,
+		    key, &rkey->data, &rkey->size))
+			return (RET_ERROR);
 	} else if (copy || F_ISSET(t, B_DB_LOCK)) {
 		if (bl->ksize > rkey->size) {
 			p = (void *)(rkey->data == NULL ?
@@ -105,6 +128,11 @@ __bt_ret(t, e, key, rkey, data, rdata, copy)
 	} else {
 		key->size = bl->ksize;
 		key->data = bl->bytes;
+		goto dataonly;
+	}
+	if (rkey == &t->bt_rkey) {
+		t->bt_rkeypos.pgno = e->page->pgno;
+		t->bt_rkeypos.index = e->index;
 	}
 
 dataonly:
@@ -178,7 +206,11 @@ __bt_cmp(t, k1, e)
 		bl = GETBLEAF(h, e->index);
 		if (bl->flags & P_BIGKEY)
 			bigkey = bl->bytes;
-		else {
+		else if (bl->flags & P_PFXKEY) {
+			if (__bt_lkey(h, e->index,
+			    &k2, &t->bt_pkey.data, &t->bt_pkey.size))
+				return (RET_ERROR);
+		} else {
 			k2.data = bl->bytes;
 			k2.size = bl->ksize;
 		}
@@ -257,3 +289,208 @@ __bt_defpfx(a, b)
 	/* a->size must be <= b->size, or they wouldn't be in this order. */
 	return (a->size < b->size ? a->size + 1 : a->size);
 }
+
+/**
+ * __BT_LKEY -- Get the whole key of a leaf item.
+ *
+ *	@param h	leaf page
+ *	@param index	index of the item
+ *	@param key	key (output)
+ *	@param buf	memory area to rebuild a prefix compressed key
+ *	@param bufsz	size of @a buf
+ *
+ * @return
+ *	#RET_SUCCESS, #RET_ERROR.
+ *
+ * The key of an item which doesn't have #P_PFXKEY is returned in place.
+ * It must not be an overflow key.
+ */
+int
+__bt_lkey(h, index, key, buf, bufsz)
+	PAGE *h;
+	u_int index;
+	DBT *key;
+	void **buf;
+	size_t *bufsz;
+{
+	BLEAF *bl;
+	u_int start;
+	size_t size, max;
+	void *p;
+
+	bl = GETBLEAF(h, index);
+	if (!(bl->flags & P_PFXKEY)) {
+		key->data = bl->bytes;
+		key->size = bl->ksize;
+		return (RET_SUCCESS);
+	}
+
+	/* Go back to the item which has the whole key. */
+	for (max = 0, start = index;; --start) {
+		bl = GETBLEAF(h, start);
+		size = BLEAF_KSIZE(bl);
+		if (size > max)
+			max = size;
+		if (!(bl->flags & P_PFXKEY))
+			break;
+		if (start == 0) {
+			errno = EFTYPE;
+			return (RET_ERROR);
+		}
+	}
+	if (max > *bufsz) {
+		p = (void *)(*buf == NULL ? malloc(max) : realloc(*buf, max));
+		if (p == NULL)
+			return (RET_ERROR);
+		*buf = p;
+		*bufsz = max;
+	}
+	for (; start <= index; ++start) {
+		bl = GETBLEAF(h, start);
+		if (bl->flags & P_PFXKEY) {
+			memmove((char *)*buf + (u_char)bl->bytes[0],
+			    bl->bytes + 1, bl->ksize - 1);
+			size = (u_char)bl->bytes[0] + bl->ksize - 1;
+		} else {
+			memmove(*buf, bl->bytes, bl->ksize);
+			size = bl->ksize;
+		}
+	}
+	key->data = *buf;
+	key->size = size;
+	return (RET_SUCCESS);
+}
+
+/**
+ * __BT_LSIZE -- Get the size of a leaf item written after a key.
+ *
+ *	@param prev	whole key of the previous item, or @CODE{NULL} if the
+ *			item must have the whole key
+ *	@param item	item
+ *	@param plenp	length of the shared prefix, 0 for the whole key (output)
+ *
+ * @return
+ *	Number of bytes of the item on the page.
+ */
+u_int32_t
+__bt_lsize(prev, item, plenp)
+	const DBT *prev;
+	const LITEM *item;
+	u_int *plenp;
+{
+	register u_char *p1, *p2;
+	register u_int plen, len;
+
+	plen = 0;
+	if (prev != NULL && !(item->flags & P_BIGKEY)) {
+		len = MIN(prev->size, item->key.size);
+		if (len > PFX_MAXLEN)
+			len = PFX_MAXLEN;
+		for (p1 = prev->data, p2 = item->key.data;
+		    plen < len && *p1 == *p2; ++p1, ++p2)
+			++plen;
+		if (plen < PFX_MINLEN)
+			plen = 0;
+	}
+	*plenp = plen;
+	return (NBLEAFDBT(plen ?
+	    item->key.size - plen + 1 : item->key.size, item->data.size));
+}
+
+/**
+ * __BT_LWRITE -- Copy a leaf item to the page.
+ *
+ *	@param p	place of the item
+ *	@param item	item
+ *	@param plen	length of the shared prefix (see __bt_lsize())
+ */
+void
+__bt_lwrite(p, item, plen)
+	char *p;
+	const LITEM *item;
+	u_int plen;
+{
+	const DBT *key, *data;
+
+	key = &item->key;
+	data = &item->data;
+	if (plen == 0) {
+		WR_BLEAF(p, key, data, item->flags);
+		return;
+	}
+	*(u_int32_t *)p = key->size - plen + 1;
+	p += sizeof(u_int32_t);
+	*(u_int32_t *)p = data->size;
+	p += sizeof(u_int32_t);
+	*(u_char *)p = item->flags | P_PFXKEY;
+	p += sizeof(u_char);
+	*(u_char *)p = plen;
+	p += sizeof(u_char);
+	memmove(p, (char *)key->data + plen, key->size - plen);
+	p += key->size - plen;
+	memmove(p, data->data, data->size);
+}
+
+/**
+ * __BT_LINSERT -- Make room for a leaf item on the page.
+ *
+ *	@param h	page
+ *	@param index	index of the new item
+ *	@param nbytes	size of the item
+ *
+ * @return
+ *	Place to write the item.
+ *
+ * The caller must make sure that the item fits in the page.
+ */
+char *
+__bt_linsert(h, index, nbytes)
+	PAGE *h;
+	u_int index;
+	u_int32_t nbytes;
+{
+	indx_t nxtindex;
+
+	if (index < (nxtindex = NEXTINDEX(h)))
+		memmove(h->linp + index + 1, h->linp + index,
+		    (nxtindex - index) * sizeof(indx_t));
+	h->lower += sizeof(indx_t);
+	h->linp[index] = h->upper -= nbytes;
+	return ((char *)h + h->upper);
+}
+
+/**
+ * __BT_LREMOVE -- Remove a leaf item from the page.
+ *
+ *	@param h	page
+ *	@param index	index of the item
+ *
+ * Only the page is changed; overflow pages and the cursor are left to
+ * the caller.
+ */
+void
+__bt_lremove(h, index)
+	PAGE *h;
+	u_int index;
+{
+	BLEAF *bl;
+	indx_t cnt, *ip, offset;
+	u_int32_t nbytes;
+	char *from;
+
+	/* Pack the remaining key/data items at the end of the page. */
+	bl = GETBLEAF(h, index);
+	nbytes = NBLEAF(bl);
+	from = (char *)h + h->upper;
+	memmove(from + nbytes, from, (char *)bl - from);
+	h->upper += nbytes;
+
+	/* Adjust the indices' offsets, shift the indices down. */
+	offset = h->linp[index];
+	for (cnt = index, ip = &h->linp[0]; cnt--; ++ip)
+		if (ip[0] < offset)
+			ip[0] += nbytes;
+	for (cnt = NEXTINDEX(h) - index; --cnt; ++ip)
+		ip[0] = ip[1] < offset ? ip[1] + nbytes : ip[1];
+	h->lower -= sizeof(indx_t);
+}
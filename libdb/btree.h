@@ -139,6 +139,8 @@ typedef struct _binternal {
 #define	P_BIGDATA	0x01
 		/** overflow key */
 #define	P_BIGKEY	0x02
+		/** prefix compressed key (leaf pages only, see #BLEAF) */
+#define	P_PFXKEY	0x04
 	u_char	flags;
 	char	bytes[1];		/**< data */
 } BINTERNAL;
@@ -185,14 +187,47 @@ typedef struct _rinternal {
 	*(pgno_t *)p = pgno;						\
 }
 
-/** For the btree leaf pages, the item is a key and data pair. */
+/**
+ * For the btree leaf pages, the item is a key and data pair.
+ *
+ * In a tree with #B_PFXKEY, the key of an item which has #P_PFXKEY is stored
+ * relative to the key of the previous item on the same page: @CODE{bytes[0]}
+ * is the length of the shared prefix (#PFX_MINLEN .. #PFX_MAXLEN), and the
+ * rest of the key follows it. @link _bleaf::ksize ksize @endlink is the number
+ * of the stored bytes, so the data is always at @CODE{bytes + ksize}.
+ * A key equal to the previous one (a duplicate key) takes only one byte.
+ * The first item of a page never has #P_PFXKEY, and at most #PFX_CHAIN items
+ * in a row have it, so that any key can be rebuilt by looking at a few items.
+ */
 typedef struct _bleaf {
-	u_int32_t	ksize;		/**< size of key */
+	u_int32_t	ksize;		/**< size of key (as stored) */
 	u_int32_t	dsize;		/**< size of data */
-	u_char	flags;			/**< #P_BIGDATA, #P_BIGKEY */
+	u_char	flags;			/**< #P_BIGDATA, #P_BIGKEY, #P_PFXKEY */
 	char	bytes[1];		/**< data */
 } BLEAF;
 
+/** Minimum length of a shared prefix worth storing. */
+#define	PFX_MINLEN	2
+/** Maximum length of a shared prefix (it is stored in a byte). */
+#define	PFX_MAXLEN	255
+/** Maximum number of prefix compressed items in a row. */
+#define	PFX_CHAIN	15
+
+/** Get the size of the whole key of a #BLEAF entry. */
+#define	BLEAF_KSIZE(p)							\
+	((p)->flags & P_PFXKEY ?					\
+	    (u_char)(p)->bytes[0] + (p)->ksize - 1 : (p)->ksize)
+
+/**
+ * A leaf item being written to a page of a tree with #B_PFXKEY.
+ * The key is the whole key (or the overflow reference).
+ */
+typedef struct _litem {
+	DBT	key;			/**< key */
+	DBT	data;			/**< data */
+	u_char	flags;			/**< #P_BIGDATA, #P_BIGKEY */
+} LITEM;
+
 /** Get the page's #BLEAF structure at index indx. */
 #define	GETBLEAF(pg, indx)						\
 	((BLEAF *)((char *)(pg) + (pg)->linp[indx]))
@@ -319,7 +354,7 @@ typedef struct _btmeta {
 	u_int32_t	free;		/**< page number of first free page */
 	u_int32_t	nrecs;		/**< R: number of records */
 
-#define	SAVEMETA	(B_NODUPS | R_RECNO)
+#define	SAVEMETA	(B_NODUPS | B_PFXKEY | R_RECNO)
 	u_int32_t	flags;		/**< bt_flags \& #SAVEMETA */
 } BTMETA;
 
@@ -345,7 +380,9 @@ typedef struct _btree {
 	EPGNO	 *bt_sp;		/**< current stack pointer */
 
 	DBT	  bt_rkey;		/**< returned key */
+	EPGNO	  bt_rkeypos;		/**< item whose whole key is in #bt_rkey */
 	DBT	  bt_rdata;		/**< returned data */
+	DBT	  bt_pkey;		/**< rebuilt prefix compressed key */
 
 	int	  bt_fd;		/**< tree file descriptor */
 
@@ -378,7 +415,7 @@ typedef struct _btree {
 
 /*
  * NB:
- * B_NODUPS and R_RECNO are stored on disk, and may not be changed.
+ * B_NODUPS, B_PFXKEY and R_RECNO are stored on disk, and may not be changed.
  */
 		/** in-memory tree */
 #define	B_INMEM		0x00001
@@ -420,6 +457,10 @@ typedef struct _btree {
 #define	B_DB_SHMEM	0x08000
 		/** #DB_TXN specified. */
 #define	B_DB_TXN	0x10000
+
+/** keys of leaf pages are prefix compressed (see #BLEAF).
+    @note #B_PFXKEY is stored on disk, and may not be changed. */
+#define	B_PFXKEY	0x20000
 	u_int32_t flags;
 } BTREE;
 
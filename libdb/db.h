@@ -146,6 +146,11 @@ typedef struct __db {
 	int (*fd)	(const struct __db *);
 } DB;
 
+/**
+ * Counters of all the databases, for the statistics of the application.
+ */
+extern u_long bt_split, mpool_cachehit, mpool_cachemiss, mpool_evicted;
+
 /** @name */
 /** @{ */
 #define	BTREEMAGIC	0x053162
@@ -166,6 +171,7 @@ typedef struct {
 	size_t	(*prefix)	/**< prefix function */
 	   (const DBT *, const DBT *);
 	int	lorder;		/**< byte order */
+	const char *overlay;	/**< file to write the pages to instead of the tree file */
 } BTREEINFO;
 
 #define	HASHMAGIC	0x061561
@@ -255,6 +261,8 @@ typedef struct {
 DB	*dbopen(const char *, int, int, DBTYPE, const void *);
 
 DB	*__bt_open(const char *, int, int, const BTREEINFO *, int);
+int	 __bt_bulkload(DB *, int (*)(void *, DBT *, DBT *), void *, int);
+int	 __bt_merge(const char *, const char *);
 DB	*__hash_open(const char *, int, int, const HASHINFO *, int);
 DB	*__rec_open(const char *, int, int, const RECNOINFO *, int);
 void	 __dbpanic(DB *dbp);
@@ -29,6 +29,7 @@
  *	@(#)extern.h	8.10 (Berkeley) 7/20/94
  */
 
+int	 __bt_bulkload(DB *, int (*)(void *, DBT *, DBT *), void *, int);
 int	 __bt_close(DB *, int);
 int	 __bt_cmp(BTREE *, const DBT *, EPG *);
 int	 __bt_crsrdel(BTREE *, EPGNO *);
@@ -39,6 +40,11 @@ int	 __bt_dleaf(BTREE *, const DBT *, PAGE *, u_int);
 int	 __bt_fd(const DB *);
 int	 __bt_free(BTREE *, PAGE *);
 int	 __bt_get(const DB *, const DBT *, DBT *, u_int);
+char	*__bt_linsert(PAGE *, u_int, u_int32_t);
+int	 __bt_lkey(PAGE *, u_int, DBT *, void **, size_t *);
+void	 __bt_lremove(PAGE *, u_int);
+u_int32_t __bt_lsize(const DBT *, const LITEM *, u_int *);
+void	 __bt_lwrite(char *, const LITEM *, u_int);
 PAGE	*__bt_new(BTREE *, pgno_t *);
 void	 __bt_pgin(void *, pgno_t, void *);
 void	 __bt_pgout(void *, pgno_t, void *);
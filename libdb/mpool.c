@@ -49,6 +49,9 @@ static char sccsid[] = "@(#)mpool.c	8.5 (Berkeley) 7/26/94";
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #if (defined(_WIN32) && !defined(__CYGWIN__))
 #define fsync _commit
@@ -60,9 +63,18 @@ static char sccsid[] = "@(#)mpool.c	8.5 (Berkeley) 7/26/94";
 #define	__MPOOLINTERFACE_PRIVATE
 #include "mpool.h"
 
+u_long mpool_cachehit, mpool_cachemiss, mpool_evicted;
+
 static BKT *mpool_bkt(MPOOL *);
+static BKT *mpool_victim(struct _lqh *);
+static void mpool_ghost(MPOOL *, pgno_t);
 static BKT *mpool_look(MPOOL *, pgno_t);
+static int  mpool_rehash(MPOOL *, pgno_t);
 static int  mpool_write(MPOOL *, BKT *);
+static int  mpool_slot(MPOOL *, pgno_t);
+static int  mpool_trailer(MPOOL *);
+static ssize_t mpool_pread(int, void *, size_t, off_t);
+static ssize_t mpool_pwrite(int, const void *, size_t, off_t);
 
 /**
  * mpool_open --
@@ -81,7 +93,7 @@ mpool_open(key, fd, pagesize, maxcache)
 {
 	struct stat sb;
 	MPOOL *mp;
-	int entry;
+	pgno_t hashsize;
 
 	/*
 	 * Get information about the file.
@@ -100,12 +112,20 @@ mpool_open(key, fd, pagesize, maxcache)
 	if ((mp = (MPOOL *)calloc(1, sizeof(MPOOL))) == NULL)
 		return (NULL);
 	CIRCLEQ_INIT(&mp->lqh);
-	for (entry = 0; entry < HASHSIZE; ++entry)
-		CIRCLEQ_INIT(&mp->hqh[entry]);
+	CIRCLEQ_INIT(&mp->hotq);
+	CIRCLEQ_INIT(&mp->ghostq);
+	/* A hash chain has about one page when the cache is full. */
+	for (hashsize = HASHSIZE; hashsize < maxcache; hashsize <<= 1)
+		;
+	if (mpool_rehash(mp, hashsize) == RET_ERROR) {
+		free(mp);
+		return (NULL);
+	}
 	mp->maxcache = maxcache;
 	mp->npages = sb.st_size / pagesize;
 	mp->pagesize = pagesize;
 	mp->fd = fd;
+	mp->ofd = -1;
 	return (mp);
 }
 
@@ -129,7 +149,156 @@ mpool_filter(mp, pgin, pgout, pgcookie)
 	mp->pgout = pgout;
 	mp->pgcookie = pgcookie;
 }
-	
+
+/**
+ * mpool_map --
+ *	Map the whole file into memory for reading.
+ *
+ *	@param mp
+ *
+ * After this, mpool_get() returns the pages in the mapping without
+ * copying and without the cache, and the page in filter is not called.
+ * So, it can be used only for a file which is opened for reading and
+ * needs no conversion. If the file cannot be mapped, the pages are read
+ * into the cache as usual.
+ */
+int
+mpool_map(mp)
+	MPOOL *mp;
+{
+#ifdef HAVE_MMAP
+	struct stat sb;
+	void *map;
+	pgno_t npages;
+
+	/* The pages in the overlay are read into the cache. */
+	if (fstat(mp->fd, &sb))
+		return (RET_ERROR);
+	npages = sb.st_size / mp->pagesize;
+	if (npages == 0 || npages > (size_t)-1 / mp->pagesize)
+		return (RET_ERROR);
+	map = mmap(NULL, mp->pagesize * npages, PROT_READ, MAP_SHARED, mp->fd, 0);
+	if (map == MAP_FAILED)
+		return (RET_ERROR);
+	mp->map = (char *)map;
+	mp->nmap = npages;
+	return (RET_SUCCESS);
+#else
+	return (RET_ERROR);
+#endif
+}
+
+/**
+ * mpool_overlay --
+ *	Write the pages to an overlay instead of the file.
+ *
+ *	@param mp
+ *	@param ofd	file descriptor of the overlay (empty, or made for the file)
+ *
+ * The pages already in the overlay are read from it instead of the file.
+ * The descriptor is closed by mpool_close().
+ * If the overlay is not for the file, @CODE{errno} is set to #EFTYPE.
+ */
+int
+mpool_overlay(mp, ofd)
+	MPOOL *mp;
+	int ofd;
+{
+	struct stat sb, ob;
+	OVERLAY ov;
+	pgno_t *pgnos, i;
+
+	if (fstat(mp->fd, &sb) || fstat(ofd, &ob))
+		return (RET_ERROR);
+	if (ob.st_size == 0) {
+		mp->ofd = ofd;
+		return (RET_SUCCESS);
+	}
+	if (ob.st_size < sizeof(OVERLAY) ||
+	    mpool_pread(ofd, &ov, sizeof(OVERLAY), ob.st_size - sizeof(OVERLAY)) != sizeof(OVERLAY))
+		goto eftype;
+	if (ov.magic != OVERLAYMAGIC || ov.psize != mp->pagesize ||
+	    ov.size != sb.st_size || ov.ino != sb.st_ino || ov.noverlay > ov.npages ||
+	    (off_t)ov.noverlay * (mp->pagesize + sizeof(pgno_t)) + sizeof(OVERLAY) != ob.st_size)
+		goto eftype;
+	if ((pgnos = (pgno_t *)malloc(sizeof(pgno_t) * (ov.noverlay + 1))) == NULL)
+		return (RET_ERROR);
+	if ((mp->slot = (pgno_t *)calloc(ov.npages + 1, sizeof(pgno_t))) == NULL) {
+		free(pgnos);
+		return (RET_ERROR);
+	}
+	mp->nslot = ov.npages + 1;
+	if (mpool_pread(ofd, pgnos, sizeof(pgno_t) * ov.noverlay,
+	    (off_t)mp->pagesize * ov.noverlay) != sizeof(pgno_t) * ov.noverlay)
+		goto bad;
+	for (i = 0; i < ov.noverlay; i++) {
+		if (pgnos[i] >= ov.npages || mp->slot[pgnos[i]] != 0)
+			goto bad;
+		mp->slot[pgnos[i]] = i + 1;
+	}
+	free(pgnos);
+	if (mp->npages < ov.npages)
+		mp->npages = ov.npages;
+	mp->noverlay = ov.noverlay;
+	mp->ofd = ofd;
+	return (RET_SUCCESS);
+
+bad:	free(pgnos);
+	free(mp->slot);
+	mp->slot = NULL;
+	mp->nslot = 0;
+eftype:	errno = EFTYPE;
+	return (RET_ERROR);
+}
+
+/**
+ * mpool_merge --
+ *	Write the pages in an overlay to a copy of the file.
+ *
+ *	@param fd	file descriptor of the copy
+ *	@param ofd	file descriptor of the overlay
+ */
+int
+mpool_merge(fd, ofd)
+	int fd, ofd;
+{
+	struct stat ob;
+	OVERLAY ov;
+	pgno_t *pgnos, i;
+	char *page;
+	int status = RET_ERROR;
+
+	if (fstat(ofd, &ob))
+		return (RET_ERROR);
+	if (ob.st_size == 0)
+		return (RET_SUCCESS);
+	if (ob.st_size < sizeof(OVERLAY) ||
+	    mpool_pread(ofd, &ov, sizeof(OVERLAY), ob.st_size - sizeof(OVERLAY)) != sizeof(OVERLAY) ||
+	    ov.magic != OVERLAYMAGIC ||
+	    (off_t)ov.noverlay * (ov.psize + sizeof(pgno_t)) + sizeof(OVERLAY) != ob.st_size) {
+		errno = EFTYPE;
+		return (RET_ERROR);
+	}
+	pgnos = (pgno_t *)malloc(sizeof(pgno_t) * (ov.noverlay + 1));
+	page = (char *)malloc(ov.psize);
+	if (pgnos == NULL || page == NULL)
+		goto done;
+	if (mpool_pread(ofd, pgnos, sizeof(pgno_t) * ov.noverlay,
+	    (off_t)ov.psize * ov.noverlay) != sizeof(pgno_t) * ov.noverlay)
+		goto done;
+	for (i = 0; i < ov.noverlay; i++)
+		if (mpool_pread(ofd, page, ov.psize, (off_t)ov.psize * i) != ov.psize ||
+		    mpool_pwrite(fd, page, ov.psize, (off_t)ov.psize * pgnos[i]) != ov.psize)
+			goto done;
+	if (fsync(fd) == 0)
+		status = RET_SUCCESS;
+done:	if (pgnos)
+		free(pgnos);
+	if (page)
+		free(page);
+	return (status);
+}
+
 /**
  * mpool_new --
  *	Get a new page of memory.
@@ -162,7 +331,7 @@ mpool_new(mp, pgnoaddr)
 	*pgnoaddr = bp->pgno = mp->npages++;
 	bp->flags = MPOOL_PINNED;
 
-	head = &mp->hqh[HASHKEY(bp->pgno)];
+	head = &mp->hqh[HASHKEY(mp, bp->pgno)];
 	CIRCLEQ_INSERT_HEAD(head, bp, hq);
 	CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
 	return (bp->page);
@@ -185,7 +354,7 @@ mpool_get(mp, pgno, flags)
 	struct _hqh *head;
 	BKT *bp;
 	off_t off;
-	int nr;
+	int fd, nr, hot = 0;
 
 	/* Check for attempt to retrieve a non-existent page. */
 	if (pgno >= mp->npages) {
@@ -196,9 +365,12 @@ mpool_get(mp, pgno, flags)
 #ifdef STATISTICS
 	++mp->pageget;
 #endif
+	/* The page in the mapping. */
+	if (mp->map != NULL && pgno < mp->nmap && !OVERLAID(mp, pgno))
+		return (mp->map + mp->pagesize * pgno);
 
 	/* Check for a page that is cached. */
-	if ((bp = mpool_look(mp, pgno)) != NULL) {
+	if ((bp = mpool_look(mp, pgno)) != NULL && !(bp->flags & MPOOL_GHOST)) {
 #ifdef DEBUG
 		if (bp->flags & MPOOL_PINNED) {
 			(void)fprintf(stderr,
@@ -207,20 +379,36 @@ mpool_get(mp, pgno, flags)
 		}
 #endif
 		/*
-		 * Move the page to the head of the hash chain and the tail
-		 * of the lru chain.
+		 * Move the page to the head of the hash chain. A page on
+		 * the hot queue is moved to its tail. A page on the probation
+		 * queue stays where it is, because references in a short time
+		 * (like the ones of a sequential scan) don't make it hot.
 		 */
-		head = &mp->hqh[HASHKEY(bp->pgno)];
+		head = &mp->hqh[HASHKEY(mp, bp->pgno)];
 		CIRCLEQ_REMOVE(head, bp, hq);
 		CIRCLEQ_INSERT_HEAD(head, bp, hq);
-		CIRCLEQ_REMOVE(&mp->lqh, bp, q);
-		CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
+		if (bp->flags & MPOOL_HOT) {
+			CIRCLEQ_REMOVE(&mp->hotq, bp, q);
+			CIRCLEQ_INSERT_TAIL(&mp->hotq, bp, q);
+		}
 
 		/* Return a pinned page. */
 		bp->flags |= MPOOL_PINNED;
 		return (bp->page);
 	}
 
+	/*
+	 * A page which was pushed out of the probation queue recently
+	 * is used again. It goes to the hot queue.
+	 */
+	if (bp != NULL) {
+		CIRCLEQ_REMOVE(&mp->hqh[HASHKEY(mp, bp->pgno)], bp, hq);
+		CIRCLEQ_REMOVE(&mp->ghostq, bp, q);
+		--mp->nghost;
+		free(bp);
+		hot = 1;
+	}
+
 	/* Get a page from the cache. */
 	if ((bp = mpool_bkt(mp)) == NULL)
 		return (NULL);
@@ -229,22 +417,19 @@ mpool_get(mp, pgno, flags)
 #ifdef STATISTICS
 	++mp->pageread;
 #endif
-	off = mp->pagesize * pgno;
-#ifdef HAVE_PREAD
-	if ((nr = pread(mp->fd, bp->page, mp->pagesize, off)) != mp->pagesize) {
-		if (nr >= 0)
-			errno = EFTYPE;
-		return (NULL);
+	/* A page written is in the overlay. */
+	if (OVERLAID(mp, pgno)) {
+		fd = mp->ofd;
+		off = mp->pagesize * (mp->slot[pgno] - 1);
+	} else {
+		fd = mp->fd;
+		off = mp->pagesize * pgno;
 	}
-#else
-	if (lseek(mp->fd, off, SEEK_SET) != off)
-		return (NULL);
-	if ((nr = read(mp->fd, bp->page, mp->pagesize)) != mp->pagesize) {
+	if ((nr = mpool_pread(fd, bp->page, mp->pagesize, off)) != mp->pagesize) {
 		if (nr >= 0)
 			errno = EFTYPE;
 		return (NULL);
 	}
-#endif
 
 	/* Set the page number, pin the page. */
 	bp->pgno = pgno;
@@ -252,11 +437,16 @@ mpool_get(mp, pgno, flags)
 
 	/*
 	 * Add the page to the head of the hash chain and the tail
-	 * of the lru chain.
+	 * of the hot or probation queue.
 	 */
-	head = &mp->hqh[HASHKEY(bp->pgno)];
+	head = &mp->hqh[HASHKEY(mp, bp->pgno)];
 	CIRCLEQ_INSERT_HEAD(head, bp, hq);
-	CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
+	if (hot) {
+		bp->flags |= MPOOL_HOT;
+		++mp->nhot;
+		CIRCLEQ_INSERT_TAIL(&mp->hotq, bp, q);
+	} else
+		CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
 
 	/* Run through the user's filter. */
 	if (mp->pgin != NULL)
@@ -284,6 +474,9 @@ mpool_put(mp, page, flags)
 #ifdef STATISTICS
 	++mp->pageput;
 #endif
+	if (mp->map != NULL && (char *)page >= mp->map &&
+	    (char *)page < mp->map + mp->pagesize * mp->nmap)
+		return (RET_SUCCESS);
 	bp = (BKT *)((char *)page - sizeof(BKT));
 #ifdef DEBUG
 	if (!(bp->flags & MPOOL_PINNED)) {
@@ -309,13 +502,30 @@ mpool_close(mp)
 {
 	BKT *bp;
 
-	/* Free up any space allocated to the lru pages. */
+#ifdef HAVE_MMAP
+	if (mp->map != NULL)
+		(void)munmap(mp->map, mp->pagesize * mp->nmap);
+#endif
+	if (mp->ofd != -1)
+		(void)close(mp->ofd);
+	if (mp->slot != NULL)
+		free(mp->slot);
+	/* Free up any space allocated to the pages and the ghosts. */
 	while ((bp = mp->lqh.cqh_first) != (void *)&mp->lqh) {
 		CIRCLEQ_REMOVE(&mp->lqh, mp->lqh.cqh_first, q);
 		free(bp);
 	}
+	while ((bp = mp->hotq.cqh_first) != (void *)&mp->hotq) {
+		CIRCLEQ_REMOVE(&mp->hotq, mp->hotq.cqh_first, q);
+		free(bp);
+	}
+	while ((bp = mp->ghostq.cqh_first) != (void *)&mp->ghostq) {
+		CIRCLEQ_REMOVE(&mp->ghostq, mp->ghostq.cqh_first, q);
+		free(bp);
+	}
 
 	/* Free the MPOOL cookie. */
+	free(mp->hqh);
 	free(mp);
 	return (RET_SUCCESS);
 }
@@ -332,14 +542,21 @@ mpool_sync(mp)
 {
 	BKT *bp;
 
-	/* Walk the lru chain, flushing any dirty pages to disk. */
+	/* Walk the queues, flushing any dirty pages to disk. */
 	for (bp = mp->lqh.cqh_first;
 	    bp != (void *)&mp->lqh; bp = bp->q.cqe_next)
 		if (bp->flags & MPOOL_DIRTY &&
 		    mpool_write(mp, bp) == RET_ERROR)
 			return (RET_ERROR);
+	for (bp = mp->hotq.cqh_first;
+	    bp != (void *)&mp->hotq; bp = bp->q.cqe_next)
+		if (bp->flags & MPOOL_DIRTY &&
+		    mpool_write(mp, bp) == RET_ERROR)
+			return (RET_ERROR);
 
 	/* Sync the file descriptor. */
+	if (mp->ofd != -1)
+		return (mpool_trailer(mp) == RET_ERROR || fsync(mp->ofd) ? RET_ERROR : RET_SUCCESS);
 	return (fsync(mp->fd) ? RET_ERROR : RET_SUCCESS);
 }
 
@@ -353,7 +570,7 @@ static BKT *
 mpool_bkt(mp)
 	MPOOL *mp;
 {
-	struct _hqh *head;
+	struct _lqh *queue;
 	BKT *bp;
 
 	/* If under the max cached, always create a new page. */
@@ -361,34 +578,44 @@ mpool_bkt(mp)
 		goto new;
 
 	/*
-	 * If the cache is max'd out, walk the lru list for a buffer we
-	 * can flush.  If we find one, write it (if necessary) and take it
-	 * off any lists.  If we don't find anything we grow the cache anyway.
-	 * The cache never shrinks.
+	 * If the cache is max'd out, look for a buffer we can flush.  It is
+	 * taken from the head of the probation queue while the queue has
+	 * more than a quarter of the cache, and from the head of the hot
+	 * queue otherwise.  If we don't find anything in either queue we grow
+	 * the cache anyway.  The cache never shrinks.
 	 */
-	for (bp = mp->lqh.cqh_first;
-	    bp != (void *)&mp->lqh; bp = bp->q.cqe_next)
-		if (!(bp->flags & MPOOL_PINNED)) {
-			/* Flush if dirty. */
-			if (bp->flags & MPOOL_DIRTY &&
-			    mpool_write(mp, bp) == RET_ERROR)
-				return (NULL);
+	if (mp->curcache - mp->nhot > mp->maxcache / 4) {
+		if ((bp = mpool_victim(queue = &mp->lqh)) == NULL)
+			bp = mpool_victim(queue = &mp->hotq);
+	} else {
+		if ((bp = mpool_victim(queue = &mp->hotq)) == NULL)
+			bp = mpool_victim(queue = &mp->lqh);
+	}
+	if (bp != NULL) {
+		/* Flush if dirty. */
+		if (bp->flags & MPOOL_DIRTY &&
+		    mpool_write(mp, bp) == RET_ERROR)
+			return (NULL);
 #ifdef STATISTICS
-			++mp->pageflush;
+		++mp->pageflush;
 #endif
-			/* Remove from the hash and lru queues. */
-			head = &mp->hqh[HASHKEY(bp->pgno)];
-			CIRCLEQ_REMOVE(head, bp, hq);
-			CIRCLEQ_REMOVE(&mp->lqh, bp, q);
+		++mpool_evicted;
+		/* Remove from the hash and replacement queues. */
+		CIRCLEQ_REMOVE(&mp->hqh[HASHKEY(mp, bp->pgno)], bp, hq);
+		CIRCLEQ_REMOVE(queue, bp, q);
+		if (bp->flags & MPOOL_HOT)
+			--mp->nhot;
+		else
+			mpool_ghost(mp, bp->pgno);
 #ifdef DEBUG
-			{ void *spage;
-				spage = bp->page;
-				memset(bp, 0xff, sizeof(BKT) + mp->pagesize);
-				bp->page = spage;
-			}
-#endif
-			return (bp);
+		{ void *spage;
+			spage = bp->page;
+			memset(bp, 0xff, sizeof(BKT) + mp->pagesize);
+			bp->page = spage;
 		}
+#endif
+		return (bp);
+	}
 
 new:	if ((bp = (BKT *)malloc(sizeof(BKT) + mp->pagesize)) == NULL)
 		return (NULL);
@@ -400,9 +627,99 @@ new:	if ((bp = (BKT *)malloc(sizeof(BKT) + mp->pagesize)) == NULL)
 #endif
 	bp->page = (char *)bp + sizeof(BKT);
 	++mp->curcache;
+	/* Keep the hash chains short. It's not fatal if it fails. */
+	if (mp->curcache + mp->nghost > mp->hashsize * 2)
+		(void)mpool_rehash(mp, mp->hashsize * 2);
 	return (bp);
 }
 
+/**
+ * mpool_victim
+ *	Find a page which can be flushed in a replacement queue.
+ *
+ *	@param queue
+ */
+static BKT *
+mpool_victim(queue)
+	struct _lqh *queue;
+{
+	BKT *bp;
+
+	for (bp = queue->cqh_first;
+	    bp != (void *)queue; bp = bp->q.cqe_next)
+		if (!(bp->flags & MPOOL_PINNED))
+			return (bp);
+	return (NULL);
+}
+
+/**
+ * mpool_ghost
+ *	Remember a page pushed out of the probation queue.
+ *
+ *	@param mp
+ *	@param pgno
+ *
+ * The ghosts are limited to half of the cache; the oldest one is reused.
+ */
+static void
+mpool_ghost(mp, pgno)
+	MPOOL *mp;
+	pgno_t pgno;
+{
+	BKT *gp;
+
+	if (mp->nghost >= mp->maxcache / 2 && mp->nghost > 0) {
+		gp = mp->ghostq.cqh_first;
+		CIRCLEQ_REMOVE(&mp->hqh[HASHKEY(mp, gp->pgno)], gp, hq);
+		CIRCLEQ_REMOVE(&mp->ghostq, gp, q);
+	} else {
+		if (mp->maxcache / 2 == 0 || (gp = (BKT *)malloc(sizeof(BKT))) == NULL)
+			return;
+		++mp->nghost;
+	}
+	gp->page = NULL;
+	gp->pgno = pgno;
+	gp->flags = MPOOL_GHOST;
+	CIRCLEQ_INSERT_HEAD(&mp->hqh[HASHKEY(mp, pgno)], gp, hq);
+	CIRCLEQ_INSERT_TAIL(&mp->ghostq, gp, q);
+}
+
+/**
+ * mpool_rehash
+ *	Resize the hash table.
+ *
+ *	@param mp
+ *	@param hashsize	new size (power of 2)
+ */
+static int
+mpool_rehash(mp, hashsize)
+	MPOOL *mp;
+	pgno_t hashsize;
+{
+	struct _hqh *hqh;
+	struct _lqh *queues[3];
+	BKT *bp;
+	pgno_t entry;
+	int i;
+
+	if ((hqh = (struct _hqh *)malloc(sizeof(struct _hqh) * hashsize)) == NULL)
+		return (RET_ERROR);
+	for (entry = 0; entry < hashsize; ++entry)
+		CIRCLEQ_INIT(&hqh[entry]);
+	if (mp->hqh != NULL)
+		free(mp->hqh);
+	mp->hqh = hqh;
+	mp->hashsize = hashsize;
+	queues[0] = &mp->lqh;
+	queues[1] = &mp->hotq;
+	queues[2] = &mp->ghostq;
+	for (i = 0; i < 3; i++)
+		for (bp = queues[i]->cqh_first;
+		    bp != (void *)queues[i]; bp = bp->q.cqe_next)
+			CIRCLEQ_INSERT_HEAD(&hqh[HASHKEY(mp, bp->pgno)], bp, hq);
+	return (RET_SUCCESS);
+}
+
 /**
  * mpool_write
  *	Write a page to disk.
@@ -416,6 +733,7 @@ mpool_write(mp, bp)
 	BKT *bp;
 {
 	off_t off;
+	int fd;
 
 #ifdef STATISTICS
 	++mp->pagewrite;
@@ -425,24 +743,135 @@ mpool_write(mp, bp)
 	if (mp->pgout)
 		(mp->pgout)(mp->pgcookie, bp->pgno, bp->page);
 
-	off = mp->pagesize * bp->pgno;
-#ifdef HAVE_PWRITE
-	if (pwrite(mp->fd, bp->page, mp->pagesize, off) != mp->pagesize)
+	/* A page is written to the overlay, in a new slot at first. */
+	if (mp->ofd != -1) {
+		if (!OVERLAID(mp, bp->pgno) && mpool_slot(mp, bp->pgno) == RET_ERROR)
+			return (RET_ERROR);
+		fd = mp->ofd;
+		off = mp->pagesize * (mp->slot[bp->pgno] - 1);
+	} else {
+		fd = mp->fd;
+		off = mp->pagesize * bp->pgno;
+	}
+	if (mpool_pwrite(fd, bp->page, mp->pagesize, off) != mp->pagesize)
 		return (RET_ERROR);
-#else
-	if (lseek(mp->fd, off, SEEK_SET) != off)
+
+	bp->flags &= ~MPOOL_DIRTY;
+	return (RET_SUCCESS);
+}
+
+/**
+ * mpool_slot
+ *	Assign the next slot of the overlay to a page.
+ *
+ *	@param mp
+ *	@param pgno
+ */
+static int
+mpool_slot(mp, pgno)
+	MPOOL *mp;
+	pgno_t pgno;
+{
+	pgno_t *slot, nslot;
+
+	if (pgno >= mp->nslot) {
+		for (nslot = mp->nslot ? mp->nslot : 256; nslot <= pgno; nslot <<= 1)
+			;
+		if ((slot = (pgno_t *)realloc(mp->slot, sizeof(pgno_t) * nslot)) == NULL)
+			return (RET_ERROR);
+		memset(slot + mp->nslot, 0, sizeof(pgno_t) * (nslot - mp->nslot));
+		mp->slot = slot;
+		mp->nslot = nslot;
+	}
+	mp->slot[pgno] = ++mp->noverlay;
+	return (RET_SUCCESS);
+}
+
+/**
+ * mpool_trailer
+ *	Write the page numbers of the slots and the trailer of the overlay.
+ *
+ *	@param mp
+ */
+static int
+mpool_trailer(mp)
+	MPOOL *mp;
+{
+	struct stat sb;
+	OVERLAY ov;
+	pgno_t *pgnos, pgno;
+	off_t off;
+	size_t size;
+	int status = RET_ERROR;
+
+	if (fstat(mp->fd, &sb))
 		return (RET_ERROR);
-	if (write(mp->fd, bp->page, mp->pagesize) != mp->pagesize)
+	size = sizeof(pgno_t) * mp->noverlay;
+	if ((pgnos = (pgno_t *)malloc(size + 1)) == NULL)
 		return (RET_ERROR);
+	for (pgno = 0; pgno < mp->nslot; pgno++)
+		if (mp->slot[pgno] != 0)
+			pgnos[mp->slot[pgno] - 1] = pgno;
+	memset(&ov, 0, sizeof(OVERLAY));
+	ov.magic = OVERLAYMAGIC;
+	ov.psize = mp->pagesize;
+	ov.npages = mp->npages;
+	ov.noverlay = mp->noverlay;
+	ov.size = sb.st_size;
+	ov.ino = sb.st_ino;
+	off = (off_t)mp->pagesize * mp->noverlay;
+	if (mpool_pwrite(mp->ofd, pgnos, size, off) == size &&
+	    mpool_pwrite(mp->ofd, &ov, sizeof(OVERLAY), off + size) == sizeof(OVERLAY) &&
+	    ftruncate(mp->ofd, off + size + sizeof(OVERLAY)) == 0)
+		status = RET_SUCCESS;
+	free(pgnos);
+	return (status);
+}
+
+/**
+ * mpool_pread
+ *	Read from a position of a file.
+ */
+static ssize_t
+mpool_pread(fd, buf, size, off)
+	int fd;
+	void *buf;
+	size_t size;
+	off_t off;
+{
+#ifdef HAVE_PREAD
+	return (pread(fd, buf, size, off));
+#else
+	if (lseek(fd, off, SEEK_SET) != off)
+		return (-1);
+	return (read(fd, buf, size));
 #endif
+}
 
-	bp->flags &= ~MPOOL_DIRTY;
-	return (RET_SUCCESS);
+/**
+ * mpool_pwrite
+ *	Write to a position of a file.
+ */
+static ssize_t
+mpool_pwrite(fd, buf, size, off)
+	int fd;
+	const void *buf;
+	size_t size;
+	off_t off;
+{
+#ifdef HAVE_PWRITE
+	return (pwrite(fd, buf, size, off));
+#else
+	if (lseek(fd, off, SEEK_SET) != off)
+		return (-1);
+	return (write(fd, buf, size));
+#endif
 }
 
 /**
  * mpool_look
  *	Lookup a page in the cache.
+ *	A ghost bucket of the page is returned too, but it counts as a miss.
  *
  *	@param mp
  *	@param pgno
@@ -455,18 +884,22 @@ mpool_look(mp, pgno)
 	struct _hqh *head;
 	BKT *bp;
 
-	head = &mp->hqh[HASHKEY(pgno)];
+	head = &mp->hqh[HASHKEY(mp, pgno)];
 	for (bp = head->cqh_first; bp != (void *)head; bp = bp->hq.cqe_next)
 		if (bp->pgno == pgno) {
+			if (bp->flags & MPOOL_GHOST)
+				break;
 #ifdef STATISTICS
 			++mp->cachehit;
 #endif
+			++mpool_cachehit;
 			return (bp);
 		}
 #ifdef STATISTICS
 	++mp->cachemiss;
 #endif
-	return (NULL);
+	++mpool_cachemiss;
+	return (bp == (void *)head ? NULL : bp);
 }
 
 #ifdef STATISTICS
@@ -481,7 +914,7 @@ mpool_stat(mp)
 	MPOOL *mp;
 {
 	BKT *bp;
-	int cnt;
+	int cnt, i;
 	char *sep;
 
 	(void)fprintf(stderr, "%lu pages in the file\n", (long unsigned int)mp->npages);
@@ -500,21 +933,30 @@ mpool_stat(mp)
 	(void)fprintf(stderr, "%lu page reads, %lu page writes\n",
 	    mp->pageread, mp->pagewrite);
 
+	(void)fprintf(stderr, "%lu hot pages, %lu ghosts, hash table size %lu\n",
+	    (long unsigned int)mp->nhot, (long unsigned int)mp->nghost,
+	    (long unsigned int)mp->hashsize);
+
 	sep = "";
 	cnt = 0;
-	for (bp = mp->lqh.cqh_first;
-	    bp != (void *)&mp->lqh; bp = bp->q.cqe_next) {
-		(void)fprintf(stderr, "%s%d", sep, bp->pgno);
-		if (bp->flags & MPOOL_DIRTY)
-			(void)fprintf(stderr, "d");
-		if (bp->flags & MPOOL_PINNED)
-			(void)fprintf(stderr, "P");
-		if (++cnt == 10) {
-			sep = "\n";
-			cnt = 0;
-		} else
-			sep = ", ";
-			
+	for (i = 0; i < 2; i++) {
+		struct _lqh *queue = (i == 0) ? &mp->lqh : &mp->hotq;
+
+		for (bp = queue->cqh_first;
+		    bp != (void *)queue; bp = bp->q.cqe_next) {
+			(void)fprintf(stderr, "%s%d", sep, bp->pgno);
+			if (bp->flags & MPOOL_DIRTY)
+				(void)fprintf(stderr, "d");
+			if (bp->flags & MPOOL_PINNED)
+				(void)fprintf(stderr, "P");
+			if (bp->flags & MPOOL_HOT)
+				(void)fprintf(stderr, "H");
+			if (++cnt == 10) {
+				sep = "\n";
+				cnt = 0;
+			} else
+				sep = ", ";
+		}
 	}
 	(void)fprintf(stderr, "\n");
 }
@@ -34,19 +34,55 @@
 /**
  * The memory pool scheme is a simple one.  Each in-memory page is referenced
  * by a bucket which is threaded in up to two of three ways.  All active pages
- * are threaded on a hash chain (hashed by page number) and an lru chain.
- * Inactive pages are threaded on a free chain.  Each reference to a memory
- * pool is handed an opaque #MPOOL cookie which stores all of this information.
+ * are threaded on a hash chain (hashed by page number) and one of the two
+ * replacement queues.  Each reference to a memory pool is handed an opaque
+ * #MPOOL cookie which stores all of this information.
+ *
+ * Replacement follows the 2Q algorithm.  A page read for the first time is
+ * put on the probation queue (first in, first out).  When it is pushed out
+ * of the probation queue, its page number is remembered as a ghost bucket
+ * (a bucket without a page).  If the page is read again while the ghost is
+ * alive, it is put on the hot queue (least recently used).  So, pages which
+ * are used again and again, like the internal pages of a B-tree, stay on the
+ * hot queue, and a long sequential scan flows through the probation queue
+ * without pushing them out.
+ */
+#define	HASHSIZE	128		/**< minimum size of the hash table */
+#define	HASHKEY(mp, pgno)	(((pgno) - 1) & ((mp)->hashsize - 1))
+
+/**
+ * The pages of a file can be written to another file (an overlay) instead,
+ * leaving the file itself as it is. A page written is appended to the overlay
+ * at its first writing (it takes the next slot), and is written again in
+ * the same slot later. The page numbers of the slots and a trailer follow
+ * the pages:
+ *
+ * @code{.txt}
+ * <page of slot 0> ... <page of slot n-1>
+ * <page number of slot 0> ... <page number of slot n-1>
+ * <OVERLAY>
+ * @endcode
+ *
+ * The size and the inode number of the file are recorded in the trailer,
+ * and an overlay is not used with another file.
  */
-#define	HASHSIZE	128
-#define	HASHKEY(pgno)	((pgno - 1) % HASHSIZE)
+#define	OVERLAYMAGIC	0x4f564c31
+typedef struct {
+	u_int32_t magic;		/**< #OVERLAYMAGIC */
+	u_int32_t psize;		/**< page size */
+	pgno_t	npages;			/**< number of pages of the file with the overlay */
+	pgno_t	noverlay;		/**< number of pages in the overlay */
+	off_t	size;			/**< size of the file */
+	ino_t	ino;			/**< inode number of the file */
+} OVERLAY;
+#define	OVERLAID(mp, pgno)	((pgno) < (mp)->nslot && (mp)->slot[pgno] != 0)
 
 /** The BKT structures are the elements of the queues. */
 typedef struct _bkt {
 
 #ifndef IS__DOXYGEN_
 	CIRCLEQ_ENTRY(_bkt) hq;		/**< hash queue */
-	CIRCLEQ_ENTRY(_bkt) q;		/**< lru queue */
+	CIRCLEQ_ENTRY(_bkt) q;		/**< replacement (or ghost) queue */
 #else
 	struct {
 		struct _bkt *cqe_next;
@@ -55,7 +91,7 @@ typedef struct _bkt {
 	struct {
 		struct _bkt *cqe_next;
 		struct _bkt *cqe_prev;
-	} q;						/**< lru queue */
+	} q;						/**< replacement (or ghost) queue */
 #endif
 	void    *page;			/**< page */
 	pgno_t   pgno;			/**< page number */
@@ -64,30 +100,47 @@ typedef struct _bkt {
 #define	MPOOL_DIRTY	0x01
 			/** page is pinned into memory */
 #define	MPOOL_PINNED	0x02
+			/** page is on the hot queue */
+#define	MPOOL_HOT	0x04
+			/** ghost bucket (no page) */
+#define	MPOOL_GHOST	0x08
 	u_int8_t flags;			/**< flags */
 } BKT;
 
 typedef struct MPOOL {
 
 #ifndef IS__DOXYGEN_
-	CIRCLEQ_HEAD(_lqh, _bkt) lqh;	/**< lru queue head */
+	CIRCLEQ_HEAD(_lqh, _bkt) lqh;	/**< probation queue head */
+	struct _lqh hotq;		/**< hot queue head */
+	struct _lqh ghostq;		/**< ghost queue head */
 					/** hash queue array */
-	CIRCLEQ_HEAD(_hqh, _bkt) hqh[HASHSIZE];
+	CIRCLEQ_HEAD(_hqh, _bkt) *hqh;
 #else
 	struct _lqh {
 		struct _bkt *cqh_first;
 		struct _bkt *cqh_last;
-	} lqh;							/**< lru queue head */
+	} lqh;							/**< probation queue head */
+	struct _lqh hotq;				/**< hot queue head */
+	struct _lqh ghostq;				/**< ghost queue head */
 	struct _hqh {
 		struct _bkt *cqh_first;
 		struct _bkt *cqh_last;
-	} hqh[HASHSIZE];				/**< hash queue array */
+	} *hqh;						/**< hash queue array */
 #endif
+	pgno_t	hashsize;		/**< size of the hash table (power of 2) */
 	pgno_t	curcache;		/**< current number of cached pages */
 	pgno_t	maxcache;		/**< max number of cached pages */
+	pgno_t	nhot;			/**< number of pages on the hot queue */
+	pgno_t	nghost;			/**< number of ghost buckets */
 	pgno_t	npages;			/**< number of pages in the file */
 	u_long	pagesize;		/**< file page size */
 	int	fd;			/**< file descriptor */
+	char	*map;			/**< mapped file (read only), or NULL */
+	pgno_t	nmap;			/**< number of pages in the mapping */
+	int	ofd;			/**< file descriptor of the overlay, or -1 */
+	pgno_t	*slot;			/**< slot of each page in the overlay + 1, or 0 */
+	pgno_t	nslot;			/**< size of the slot array */
+	pgno_t	noverlay;		/**< number of pages in the overlay */
 					/** page in conversion routine */
 	void    (*pgin)(void *, pgno_t, void *);
 					/** page out conversion routine */
@@ -109,6 +162,9 @@ typedef struct MPOOL {
 MPOOL	*mpool_open(void *, int, pgno_t, pgno_t);
 void	 mpool_filter(MPOOL *, void (*)(void *, pgno_t, void *),
 	    void (*)(void *, pgno_t, void *), void *);
+int	 mpool_map(MPOOL *);
+int	 mpool_overlay(MPOOL *, int);
+int	 mpool_merge(int, int);
 void	*mpool_new(MPOOL *, pgno_t *);
 void	*mpool_get(MPOOL *, pgno_t, u_int);
 int	 mpool_put(MPOOL *, void *, u_int);
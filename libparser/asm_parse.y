@@ -39,7 +39,7 @@
 
 #undef PUT
 #define PUT(type, tag, lno) do {					\
-	const char *line_image = linetable_get(lno, NULL);		\
+	const char *line_image = linetable_get(param->ctx->lt, lno, NULL);\
 	char *nl = strchr(line_image, '\n');				\
 	if (nl != NULL)							\
 		*nl = '\0';						\
@@ -48,15 +48,17 @@
 		*nl = '\n';						\
 } while (0)
 
-#define GET_SYM(offset) (assert((offset) < strbuf_getlen(asm_symtable)),\
-			 &strbuf_value(asm_symtable)[offset])
+#define GET_SYM(offset) (assert((offset) < strbuf_getlen(param->ctx->symtable)),\
+			 &strbuf_value(param->ctx->symtable)[offset])
 
-STRBUF *asm_symtable;
-
-static void yyerror(const struct parser_param *, const char *);
+static void yyerror(YYLTYPE *, const struct parser_param *, void *, const char *);
 
 %}
 
+%code {
+int asm_lex(YYSTYPE *, YYLTYPE *, void *);
+}
+
 %token ASM_CONST		/* number, string, character */
 
 %token ASM_CALL			/* call, jsr */
@@ -74,9 +76,11 @@ static void yyerror(const struct parser_param *, const char *);
 
 %start input
 %name-prefix="asm_"
+%define api.pure
 
 %parse-param { const struct parser_param *param }
-%lex-param { const struct parser_param *param }
+%parse-param { void *scanner }
+%lex-param { void *scanner }
 
 %%
 
@@ -88,7 +92,7 @@ line:	ASM_ENTRY '(' ASM_SYMBOL ')' error '\n'
 		{
 			PUT(PARSER_REF_SYM, GET_SYM($1), @1);
 			PUT(PARSER_DEF, GET_SYM($3), @3);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| ASM_CALL ASM_SYMBOL error '\n'
 		{
@@ -100,46 +104,46 @@ line:	ASM_ENTRY '(' ASM_SYMBOL ')' error '\n'
 				if (isalpha(c) || c == '_' || c >= 0x80)
 					PUT(PARSER_REF_SYM, &sym[1], @2);
 			}
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| ASM_CALL ASM_EXT '(' ASM_SYMBOL ')' error '\n'
 		{
 			PUT(PARSER_REF_SYM, GET_SYM($2), @2);
 			PUT(PARSER_REF_SYM, GET_SYM($4), @4);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| "#define" ASM_SYMBOL error '\n'
 		{
 			PUT(PARSER_DEF, GET_SYM($2), @2);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| "#undef" ASM_SYMBOL error '\n'
 		{
 			PUT(PARSER_DEF, GET_SYM($2), @2);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| ASM_MACRO ASM_SYMBOL error '\n'
 		{
 			PUT(PARSER_DEF, GET_SYM($2), @2);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| ASM_LABEL ASM_MACRO error '\n'
 		{
 			PUT(PARSER_DEF, GET_SYM($1), @1);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| ASM_EQU ASM_SYMBOL ',' error '\n'
 		{
 			PUT(PARSER_DEF, GET_SYM($2), @2);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| ASM_LABEL ASM_EQU error '\n'
 		{
 			PUT(PARSER_DEF, GET_SYM($1), @1);
-			strbuf_reset(asm_symtable);
+			strbuf_reset(param->ctx->symtable);
 		}
 	| error '\n'
-		{ strbuf_reset(asm_symtable); }
+		{ strbuf_reset(param->ctx->symtable); }
 ;
 
 %%
@@ -147,20 +151,23 @@ line:	ASM_ENTRY '(' ASM_SYMBOL ')' error '\n'
 void
 assembly(const struct parser_param *param)
 {
-	if (linetable_open(param->file) == -1)
+	void *scanner;
+
+	if ((param->ctx->lt = linetable_open(param->file)) == NULL)
 		die("'%s' cannot open.", param->file);
 
-	asm_symtable = strbuf_open(0);
-	asm_initscan();
+	param->ctx->symtable = strbuf_open(0);
+	scanner = asm_initscan(param);
 
-	asm_parse(param);
+	asm_parse(param, scanner);
 
-	strbuf_close(asm_symtable);
-	linetable_close();
+	asm_closescan(scanner);
+	strbuf_close(param->ctx->symtable);
+	linetable_close(param->ctx->lt);
 }
 
 static void
-yyerror(const struct parser_param *param, const char *s)
+yyerror(YYLTYPE *llocp, const struct parser_param *param, void *scanner, const char *s)
 {
 
 }
@@ -6,25 +6,6 @@
 
 /* A lexical scanner generated by flex */
 
-#define yy_create_buffer asm__create_buffer
-#define yy_delete_buffer asm__delete_buffer
-#define yy_flex_debug asm__flex_debug
-#define yy_init_buffer asm__init_buffer
-#define yy_flush_buffer asm__flush_buffer
-#define yy_load_buffer_state asm__load_buffer_state
-#define yy_switch_to_buffer asm__switch_to_buffer
-#define yyin asm_in
-#define yyleng asm_leng
-#define yylex asm_lex
-#define yylineno asm_lineno
-#define yyout asm_out
-#define yyrestart asm_restart
-#define yytext asm_text
-#define yywrap asm_wrap
-#define yyalloc asm_alloc
-#define yyrealloc asm_realloc
-#define yyfree asm_free
-
 #define FLEX_SCANNER
 #define YY_FLEX_MAJOR_VERSION 2
 #define YY_FLEX_MINOR_VERSION 5
@@ -137,24 +118,43 @@ typedef unsigned int flex_uint32_t;
  */
 #define YY_SC_TO_UI(c) ((unsigned int) (unsigned char) c)
 
+/* An opaque pointer. */
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+/* For convenience, these vars (plus the bison vars far below)
+   are macros in the reentrant scanner. */
+#define yyin yyg->yyin_r
+#define yyout yyg->yyout_r
+#define yyextra yyg->yyextra_r
+#define yyleng yyg->yyleng_r
+#define yytext yyg->yytext_r
+#define yylineno (YY_CURRENT_BUFFER_LVALUE->yy_bs_lineno)
+#define yycolumn (YY_CURRENT_BUFFER_LVALUE->yy_bs_column)
+#define yy_flex_debug yyg->yy_flex_debug_r
+
+int asm_lex_init (yyscan_t* scanner);
+
 /* Enter a start condition.  This macro really ought to take a parameter,
  * but we do it the disgusting crufty way forced on us by the ()-less
  * definition of BEGIN.
  */
-#define BEGIN (yy_start) = 1 + 2 *
+#define BEGIN yyg->yy_start = 1 + 2 *
 
 /* Translate the current start state into a value that can be later handed
  * to BEGIN to return to the state.  The YYSTATE alias is for lex
  * compatibility.
  */
-#define YY_START (((yy_start) - 1) / 2)
+#define YY_START ((yyg->yy_start - 1) / 2)
 #define YYSTATE YY_START
 
 /* Action number for EOF rule of a given start state. */
 #define YY_STATE_EOF(state) (YY_END_OF_BUFFER + state + 1)
 
 /* Special action meaning "start processing a new file". */
-#define YY_NEW_FILE asm_restart(asm_in  )
+#define YY_NEW_FILE asm_restart(yyin ,yyscanner)
 
 #define YY_END_OF_BUFFER_CHAR 0
 
@@ -172,10 +172,6 @@ typedef unsigned int flex_uint32_t;
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 #endif
 
-extern int asm_leng;
-
-extern FILE *asm_in, *asm_out;
-
 #define EOB_ACT_CONTINUE_SCAN 0
 #define EOB_ACT_END_OF_FILE 1
 #define EOB_ACT_LAST_MATCH 2
@@ -184,32 +180,32 @@ extern FILE *asm_in, *asm_out;
      *       access to the local variable yy_act. Since yyless() is a macro, it would break
      *       existing scanners that call yyless() from OUTSIDE asm_lex. 
      *       One obvious solution it to make yy_act a global. I tried that, and saw
-     *       a 5% performance hit in a non-asm_lineno scanner, because yy_act is
+     *       a 5% performance hit in a non-yylineno scanner, because yy_act is
      *       normally declared as a register variable-- so it is not worth it.
      */
     #define  YY_LESS_LINENO(n) \
             do { \
                 int yyl;\
-                for ( yyl = n; yyl < asm_leng; ++yyl )\
-                    if ( asm_text[yyl] == '\n' )\
-                        --asm_lineno;\
+                for ( yyl = n; yyl < yyleng; ++yyl )\
+                    if ( yytext[yyl] == '\n' )\
+                        --yylineno;\
             }while(0)
     
 /* Return all but the first "n" matched characters back to the input stream. */
 #define yyless(n) \
 	do \
 		{ \
-		/* Undo effects of setting up asm_text. */ \
+		/* Undo effects of setting up yytext. */ \
         int yyless_macro_arg = (n); \
         YY_LESS_LINENO(yyless_macro_arg);\
-		*yy_cp = (yy_hold_char); \
+		*yy_cp = yyg->yy_hold_char; \
 		YY_RESTORE_YY_MORE_OFFSET \
-		(yy_c_buf_p) = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
-		YY_DO_BEFORE_ACTION; /* set up asm_text again */ \
+		yyg->yy_c_buf_p = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
+		YY_DO_BEFORE_ACTION; /* set up yytext again */ \
 		} \
 	while ( 0 )
 
-#define unput(c) yyunput( c, (yytext_ptr)  )
+#define unput(c) yyunput( c, yyg->yytext_ptr ,yyscanner)
 
 #ifndef YY_TYPEDEF_YY_SIZE_T
 #define YY_TYPEDEF_YY_SIZE_T
@@ -274,78 +270,58 @@ struct yy_buffer_state
 	 *
 	 * When we actually see the EOF, we change the status to "new"
 	 * (via asm_restart()), so that the user can continue scanning by
-	 * just pointing asm_in at a new input file.
+	 * just pointing yyin at a new input file.
 	 */
 #define YY_BUFFER_EOF_PENDING 2
 
 	};
 #endif /* !YY_STRUCT_YY_BUFFER_STATE */
 
-/* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
-
 /* We provide macros for accessing buffer states in case in the
  * future we want to put the buffer states in a more general
  * "scanner state".
  *
  * Returns the top of the stack, or NULL.
  */
-#define YY_CURRENT_BUFFER ( (yy_buffer_stack) \
-                          ? (yy_buffer_stack)[(yy_buffer_stack_top)] \
+#define YY_CURRENT_BUFFER ( yyg->yy_buffer_stack \
+                          ? yyg->yy_buffer_stack[yyg->yy_buffer_stack_top] \
                           : NULL)
 
 /* Same as previous macro, but useful when we know that the buffer stack is not
  * NULL or when we need an lvalue. For internal use only.
  */
-#define YY_CURRENT_BUFFER_LVALUE (yy_buffer_stack)[(yy_buffer_stack_top)]
-
-/* yy_hold_char holds the character lost when asm_text is formed. */
-static char yy_hold_char;
-static int yy_n_chars;		/* number of characters read into yy_ch_buf */
-int asm_leng;
-
-/* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
-
-/* Flag which is used to allow asm_wrap()'s to do buffer switches
- * instead of setting up a fresh asm_in.  A bit of a hack ...
- */
-static int yy_did_buffer_switch_on_eof;
+#define YY_CURRENT_BUFFER_LVALUE yyg->yy_buffer_stack[yyg->yy_buffer_stack_top]
 
-void asm_restart (FILE *input_file  );
-void asm__switch_to_buffer (YY_BUFFER_STATE new_buffer  );
-YY_BUFFER_STATE asm__create_buffer (FILE *file,int size  );
-void asm__delete_buffer (YY_BUFFER_STATE b  );
-void asm__flush_buffer (YY_BUFFER_STATE b  );
-void asm_push_buffer_state (YY_BUFFER_STATE new_buffer  );
-void asm_pop_buffer_state (void );
+void asm_restart (FILE *input_file ,yyscan_t yyscanner );
+void asm__switch_to_buffer (YY_BUFFER_STATE new_buffer ,yyscan_t yyscanner );
+YY_BUFFER_STATE asm__create_buffer (FILE *file,int size ,yyscan_t yyscanner );
+void asm__delete_buffer (YY_BUFFER_STATE b ,yyscan_t yyscanner );
+void asm__flush_buffer (YY_BUFFER_STATE b ,yyscan_t yyscanner );
+void asm_push_buffer_state (YY_BUFFER_STATE new_buffer ,yyscan_t yyscanner );
+void asm_pop_buffer_state (yyscan_t yyscanner );
 
-static void asm_ensure_buffer_stack (void );
-static void asm__load_buffer_state (void );
-static void asm__init_buffer (YY_BUFFER_STATE b,FILE *file  );
+static void asm_ensure_buffer_stack (yyscan_t yyscanner );
+static void asm__load_buffer_state (yyscan_t yyscanner );
+static void asm__init_buffer (YY_BUFFER_STATE b,FILE *file ,yyscan_t yyscanner );
 
-#define YY_FLUSH_BUFFER asm__flush_buffer(YY_CURRENT_BUFFER )
+#define YY_FLUSH_BUFFER asm__flush_buffer(YY_CURRENT_BUFFER ,yyscanner)
 
-YY_BUFFER_STATE asm__scan_buffer (char *base,yy_size_t size  );
-YY_BUFFER_STATE asm__scan_string (yyconst char *yy_str  );
-YY_BUFFER_STATE asm__scan_bytes (yyconst char *bytes,int len  );
+YY_BUFFER_STATE asm__scan_buffer (char *base,yy_size_t size ,yyscan_t yyscanner );
+YY_BUFFER_STATE asm__scan_string (yyconst char *yy_str ,yyscan_t yyscanner );
+YY_BUFFER_STATE asm__scan_bytes (yyconst char *bytes,int len ,yyscan_t yyscanner );
 
-void *asm_alloc (yy_size_t  );
-void *asm_realloc (void *,yy_size_t  );
-void asm_free (void *  );
+void *asm_alloc (yy_size_t ,yyscan_t yyscanner );
+void *asm_realloc (void *,yy_size_t ,yyscan_t yyscanner );
+void asm_free (void * ,yyscan_t yyscanner );
 
 #define yy_new_buffer asm__create_buffer
 
 #define yy_set_interactive(is_interactive) \
 	{ \
 	if ( ! YY_CURRENT_BUFFER ){ \
-        asm_ensure_buffer_stack (); \
+        asm_ensure_buffer_stack (yyscanner ); \
 		YY_CURRENT_BUFFER_LVALUE =    \
-            asm__create_buffer(asm_in,YY_BUF_SIZE ); \
+            asm__create_buffer(yyin,YY_BUF_SIZE ,yyscanner); \
 	} \
 	YY_CURRENT_BUFFER_LVALUE->yy_is_interactive = is_interactive; \
 	}
@@ -353,9 +329,9 @@ void asm_free (void *  );
 #define yy_set_bol(at_bol) \
 	{ \
 	if ( ! YY_CURRENT_BUFFER ){\
-        asm_ensure_buffer_stack (); \
+        asm_ensure_buffer_stack (yyscanner ); \
 		YY_CURRENT_BUFFER_LVALUE =    \
-            asm__create_buffer(asm_in,YY_BUF_SIZE ); \
+            asm__create_buffer(yyin,YY_BUF_SIZE ,yyscanner); \
 	} \
 	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = at_bol; \
 	}
@@ -369,31 +345,24 @@ void asm_free (void *  );
 
 typedef unsigned char YY_CHAR;
 
-FILE *asm_in = (FILE *) 0, *asm_out = (FILE *) 0;
-
 typedef int yy_state_type;
 
-extern int asm_lineno;
-
-int asm_lineno = 1;
-
-extern char *asm_text;
-#define yytext_ptr asm_text
+#define yytext_ptr yytext_r
 
-static yy_state_type yy_get_previous_state (void );
-static yy_state_type yy_try_NUL_trans (yy_state_type current_state  );
-static int yy_get_next_buffer (void );
-static void yy_fatal_error (yyconst char msg[]  );
+static yy_state_type yy_get_previous_state (yyscan_t yyscanner );
+static yy_state_type yy_try_NUL_trans (yy_state_type current_state ,yyscan_t yyscanner );
+static int yy_get_next_buffer (yyscan_t yyscanner );
+static void yy_fatal_error (yyconst char msg[] ,yyscan_t yyscanner );
 
 /* Done after the current pattern has been matched and before the
- * corresponding action - sets up asm_text.
+ * corresponding action - sets up yytext.
  */
 #define YY_DO_BEFORE_ACTION \
-	(yytext_ptr) = yy_bp; \
-	asm_leng = (size_t) (yy_cp - yy_bp); \
-	(yy_hold_char) = *yy_cp; \
+	yyg->yytext_ptr = yy_bp; \
+	yyleng = (size_t) (yy_cp - yy_bp); \
+	yyg->yy_hold_char = *yy_cp; \
 	*yy_cp = '\0'; \
-	(yy_c_buf_p) = yy_cp;
+	yyg->yy_c_buf_p = yy_cp;
 
 #define YY_NUM_RULES 37
 #define YY_END_OF_BUFFER 38
@@ -642,12 +611,6 @@ static yyconst flex_int32_t yy_rule_can_match_eol[38] =
 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 1, 
     1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0, 0,     };
 
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
-
-extern int asm__flex_debug;
-int asm__flex_debug = 0;
-
 /* The intent behind this definition is that it'll catch
  * any uses of REJECT which flex missed.
  */
@@ -655,7 +618,6 @@ int asm__flex_debug = 0;
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
 #define YY_RESTORE_YY_MORE_OFFSET
-char *asm_text;
 #line 1 "asm_scan.l"
 #line 2 "asm_scan.l"
 /*
@@ -695,31 +657,24 @@ char *asm_text;
 #include "linetable.h"
 #include "strbuf.h"
 
-#define lex_symbol_generation_rule(x) asm_ ## x
-#define LEXLEX lex_symbol_generation_rule(lex)
-#define LEXTEXT lex_symbol_generation_rule(text)
-#define LEXLENG lex_symbol_generation_rule(leng)
-#define LEXLINENO lex_symbol_generation_rule(lineno)
-#define LEXRESTART lex_symbol_generation_rule(restart)
-#define LEXLVAL lex_symbol_generation_rule(lval)
-#define LEXLLOC lex_symbol_generation_rule(lloc)
-
-#define YY_DECL	int LEXLEX(const struct parser_param *param)
-
+/*
+ * The scanner is reentrant. The parser parameter is given as the extra data,
+ * and the line table is in the parser context.
+ */
 #define YY_INPUT(buf, result, max_size) do {				\
-	if ((result = linetable_read(buf, max_size)) == -1)		\
+	if ((result = linetable_read(yyextra->ctx->lt, buf, max_size)) == -1)\
 		result = YY_NULL;					\
 } while (0)
 
 #define ADD_SYM(tag, lno) do {						\
-	LEXLVAL = strbuf_getlen(asm_symtable);				\
-	LEXLLOC = (lno);						\
-	strbuf_puts0(asm_symtable, tag);				\
+	*yylval = strbuf_getlen(param->ctx->symtable);			\
+	*yylloc = (lno);						\
+	strbuf_puts0(param->ctx->symtable, tag);			\
 } while (0)
 
 #undef PUT
 #define PUT(type, tag, lno) do {					\
-	const char *line_image = linetable_get(lno, NULL);		\
+	const char *line_image = linetable_get(param->ctx->lt, lno, NULL);\
 	char *nl = strchr(line_image, '\n');				\
 	if (nl != NULL)							\
 		*nl = '\0';						\
@@ -728,11 +683,9 @@ char *asm_text;
 		*nl = '\n';						\
 } while (0)
 
-static int last_directive;
 
 
-
-#line 736 "asm_scan.c"
+#line 689 "asm_scan.c"
 
 #define INITIAL 0
 #define C_COMMENT 1
@@ -749,40 +702,102 @@ static int last_directive;
 #include <unistd.h>
 #endif
 
+#define YY_EXTRA_TYPE const struct parser_param *
+
 #ifndef YY_EXTRA_TYPE
 #define YY_EXTRA_TYPE void *
 #endif
 
-static int yy_init_globals (void );
+/* Holds the entire state of the reentrant scanner. */
+struct yyguts_t
+    {
+
+    /* User-defined. Not touched by flex. */
+    YY_EXTRA_TYPE yyextra_r;
+
+    /* The rest are the same as the globals declared in the non-reentrant scanner. */
+    FILE *yyin_r, *yyout_r;
+    size_t yy_buffer_stack_top; /**< index of top of stack. */
+    size_t yy_buffer_stack_max; /**< capacity of stack. */
+    YY_BUFFER_STATE * yy_buffer_stack; /**< Stack as an array. */
+    char yy_hold_char;
+    int yy_n_chars;
+    int yyleng_r;
+    char *yy_c_buf_p;
+    int yy_init;
+    int yy_start;
+    int yy_did_buffer_switch_on_eof;
+    int yy_start_stack_ptr;
+    int yy_start_stack_depth;
+    int *yy_start_stack;
+    yy_state_type yy_last_accepting_state;
+    char* yy_last_accepting_cpos;
+
+    int yylineno_r;
+    int yy_flex_debug_r;
+
+    char *yytext_r;
+    int yy_more_flag;
+    int yy_more_len;
+
+    YYSTYPE * yylval_r;
+
+    YYLTYPE * yylloc_r;
+
+    }; /* end struct yyguts_t */
+
+static int yy_init_globals (yyscan_t yyscanner );
+
+    /* This must go here because YYSTYPE and YYLTYPE are included
+     * from bison output in section 1.*/
+    #    define yylval yyg->yylval_r
+
+    #    define yylloc yyg->yylloc_r
+
+int asm_lex_init (yyscan_t* scanner);
+
+int asm_lex_init_extra (YY_EXTRA_TYPE user_defined,yyscan_t* scanner);
 
 /* Accessor methods to globals.
    These are made visible to non-reentrant scanners for convenience. */
 
-int asm_lex_destroy (void );
+int asm_lex_destroy (yyscan_t yyscanner );
+
+int asm_get_debug (yyscan_t yyscanner );
+
+void asm_set_debug (int debug_flag ,yyscan_t yyscanner );
+
+YY_EXTRA_TYPE asm_get_extra (yyscan_t yyscanner );
+
+void asm_set_extra (YY_EXTRA_TYPE user_defined ,yyscan_t yyscanner );
+
+FILE *asm_get_in (yyscan_t yyscanner );
 
-int asm_get_debug (void );
+void asm_set_in  (FILE * in_str ,yyscan_t yyscanner );
 
-void asm_set_debug (int debug_flag  );
+FILE *asm_get_out (yyscan_t yyscanner );
 
-YY_EXTRA_TYPE asm_get_extra (void );
+void asm_set_out  (FILE * out_str ,yyscan_t yyscanner );
 
-void asm_set_extra (YY_EXTRA_TYPE user_defined  );
+int asm_get_leng (yyscan_t yyscanner );
 
-FILE *asm_get_in (void );
+char *asm_get_text (yyscan_t yyscanner );
 
-void asm_set_in  (FILE * in_str  );
+int asm_get_lineno (yyscan_t yyscanner );
 
-FILE *asm_get_out (void );
+void asm_set_lineno (int line_number ,yyscan_t yyscanner );
 
-void asm_set_out  (FILE * out_str  );
+int asm_get_column  (yyscan_t yyscanner );
 
-int asm_get_leng (void );
+void asm_set_column (int column_no ,yyscan_t yyscanner );
 
-char *asm_get_text (void );
+YYSTYPE * asm_get_lval (yyscan_t yyscanner );
 
-int asm_get_lineno (void );
+void asm_set_lval (YYSTYPE * yylval_param ,yyscan_t yyscanner );
 
-void asm_set_lineno (int line_number  );
+       YYLTYPE *asm_get_lloc (yyscan_t yyscanner );
+
+        void asm_set_lloc (YYLTYPE * yylloc_param ,yyscan_t yyscanner );
 
 /* Macros after this point can all be overridden by user definitions in
  * section 1.
@@ -790,39 +805,35 @@ void asm_set_lineno (int line_number  );
 
 #ifndef YY_SKIP_YYWRAP
 #ifdef __cplusplus
-extern "C" int asm_wrap (void );
+extern "C" int asm_wrap (yyscan_t yyscanner );
 #else
-extern int asm_wrap (void );
+extern int asm_wrap (yyscan_t yyscanner );
 #endif
 #endif
 
-    static void yyunput (int c,char *buf_ptr  );
+    static void yyunput (int c,char *buf_ptr ,yyscan_t yyscanner );
     
 #ifndef yytext_ptr
-static void yy_flex_strncpy (char *,yyconst char *,int );
+static void yy_flex_strncpy (char *,yyconst char *,int ,yyscan_t yyscanner );
 #endif
 
 #ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * );
+static int yy_flex_strlen (yyconst char * ,yyscan_t yyscanner );
 #endif
 
 #ifndef YY_NO_INPUT
 
 #ifdef __cplusplus
-static int yyinput (void );
+static int yyinput (yyscan_t yyscanner );
 #else
-static int input (void );
+static int input (yyscan_t yyscanner );
 #endif
 
 #endif
 
-        static int yy_start_stack_ptr = 0;
-        static int yy_start_stack_depth = 0;
-        static int *yy_start_stack = NULL;
-    
-    static void yy_push_state (int new_state );
+    static void yy_push_state (int new_state ,yyscan_t yyscanner );
     
-    static void yy_pop_state (void );
+    static void yy_pop_state (yyscan_t yyscanner );
     
 /* Amount of stuff to slurp up with each read. */
 #ifndef YY_READ_BUF_SIZE
@@ -834,7 +845,7 @@ static int input (void );
 /* This used to be an fputs(), but since the string might contain NUL's,
  * we now use fwrite().
  */
-#define ECHO fwrite( asm_text, asm_leng, 1, asm_out )
+#define ECHO fwrite( yytext, yyleng, 1, yyout )
 #endif
 
 /* Gets input and stuffs it into "buf".  number of characters read, or YY_NULL,
@@ -847,18 +858,18 @@ static int input (void );
 		int c = '*'; \
 		int n; \
 		for ( n = 0; n < max_size && \
-			     (c = getc( asm_in )) != EOF && c != '\n'; ++n ) \
+			     (c = getc( yyin )) != EOF && c != '\n'; ++n ) \
 			buf[n] = (char) c; \
 		if ( c == '\n' ) \
 			buf[n++] = (char) c; \
-		if ( c == EOF && ferror( asm_in ) ) \
+		if ( c == EOF && ferror( yyin ) ) \
 			YY_FATAL_ERROR( "input in flex scanner failed" ); \
 		result = n; \
 		} \
 	else \
 		{ \
 		errno=0; \
-		while ( (result = fread(buf, 1, max_size, asm_in))==0 && ferror(asm_in)) \
+		while ( (result = fread(buf, 1, max_size, yyin))==0 && ferror(yyin)) \
 			{ \
 			if( errno != EINTR) \
 				{ \
@@ -866,7 +877,7 @@ static int input (void );
 				break; \
 				} \
 			errno=0; \
-			clearerr(asm_in); \
+			clearerr(yyin); \
 			} \
 		}\
 \
@@ -888,7 +899,7 @@ static int input (void );
 
 /* Report a fatal error. */
 #ifndef YY_FATAL_ERROR
-#define YY_FATAL_ERROR(msg) yy_fatal_error( msg )
+#define YY_FATAL_ERROR(msg) yy_fatal_error( msg ,yyscanner)
 #endif
 
 /* end tables serialization structures and prototypes */
@@ -899,12 +910,14 @@ static int input (void );
 #ifndef YY_DECL
 #define YY_DECL_IS_OURS 1
 
-extern int asm_lex (void);
+extern int asm_lex \
+               (YYSTYPE * yylval_param,YYLTYPE * yylloc_param ,yyscan_t yyscanner);
 
-#define YY_DECL int asm_lex (void)
+#define YY_DECL int asm_lex \
+               (YYSTYPE * yylval_param, YYLTYPE * yylloc_param , yyscan_t yyscanner)
 #endif /* !YY_DECL */
 
-/* Code executed at the beginning of each rule, after asm_text and asm_leng
+/* Code executed at the beginning of each rule, after yytext and yyleng
  * have been set up.
  */
 #ifndef YY_USER_ACTION
@@ -917,9 +930,9 @@ extern int asm_lex (void);
 #endif
 
 #define YY_RULE_SETUP \
-	if ( asm_leng > 0 ) \
+	if ( yyleng > 0 ) \
 		YY_CURRENT_BUFFER_LVALUE->yy_at_bol = \
-				(asm_text[asm_leng - 1] == '\n'); \
+				(yytext[yyleng - 1] == '\n'); \
 	YY_USER_ACTION
 
 /** The main scanner function which does all the work.
@@ -929,52 +942,58 @@ YY_DECL
 	register yy_state_type yy_current_state;
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
-    
-#line 91 "asm_scan.l"
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
 
+#line 83 "asm_scan.l"
+
+	const struct parser_param *param = yyextra;
 
  /* Ignore spaces */
-#line 938 "asm_scan.c"
+#line 953 "asm_scan.c"
+
+    yylval = yylval_param;
 
-	if ( !(yy_init) )
+    yylloc = yylloc_param;
+
+	if ( !yyg->yy_init )
 		{
-		(yy_init) = 1;
+		yyg->yy_init = 1;
 
 #ifdef YY_USER_INIT
 		YY_USER_INIT;
 #endif
 
-		if ( ! (yy_start) )
-			(yy_start) = 1;	/* first start state */
+		if ( ! yyg->yy_start )
+			yyg->yy_start = 1;	/* first start state */
 
-		if ( ! asm_in )
-			asm_in = stdin;
+		if ( ! yyin )
+			yyin = stdin;
 
-		if ( ! asm_out )
-			asm_out = stdout;
+		if ( ! yyout )
+			yyout = stdout;
 
 		if ( ! YY_CURRENT_BUFFER ) {
-			asm_ensure_buffer_stack ();
+			asm_ensure_buffer_stack (yyscanner );
 			YY_CURRENT_BUFFER_LVALUE =
-				asm__create_buffer(asm_in,YY_BUF_SIZE );
+				asm__create_buffer(yyin,YY_BUF_SIZE ,yyscanner);
 		}
 
-		asm__load_buffer_state( );
+		asm__load_buffer_state(yyscanner );
 		}
 
 	while ( 1 )		/* loops until end-of-file is reached */
 		{
-		yy_cp = (yy_c_buf_p);
+		yy_cp = yyg->yy_c_buf_p;
 
-		/* Support of asm_text. */
-		*yy_cp = (yy_hold_char);
+		/* Support of yytext. */
+		*yy_cp = yyg->yy_hold_char;
 
 		/* yy_bp points to the position in yy_ch_buf of the start of
 		 * the current run.
 		 */
 		yy_bp = yy_cp;
 
-		yy_current_state = (yy_start);
+		yy_current_state = yyg->yy_start;
 		yy_current_state += YY_AT_BOL();
 yy_match:
 		do
@@ -982,8 +1001,8 @@ yy_match:
 			register YY_CHAR yy_c = yy_ec[YY_SC_TO_UI(*yy_cp)];
 			if ( yy_accept[yy_current_state] )
 				{
-				(yy_last_accepting_state) = yy_current_state;
-				(yy_last_accepting_cpos) = yy_cp;
+				yyg->yy_last_accepting_state = yy_current_state;
+				yyg->yy_last_accepting_cpos = yy_cp;
 				}
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
@@ -995,8 +1014,8 @@ yy_match:
 			++yy_cp;
 			}
 		while ( yy_current_state != 206 );
-		yy_cp = (yy_last_accepting_cpos);
-		yy_current_state = (yy_last_accepting_state);
+		yy_cp = yyg->yy_last_accepting_cpos;
+		yy_current_state = yyg->yy_last_accepting_state;
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1006,10 +1025,12 @@ yy_find_action:
 		if ( yy_act != YY_END_OF_BUFFER && yy_rule_can_match_eol[yy_act] )
 			{
 			int yyl;
-			for ( yyl = 0; yyl < asm_leng; ++yyl )
-				if ( asm_text[yyl] == '\n' )
+			for ( yyl = 0; yyl < yyleng; ++yyl )
+				if ( yytext[yyl] == '\n' )
 					   
-    asm_lineno++;
+    do{ yylineno++;
+        yycolumn=0;
+    }while(0)
 ;
 			}
 
@@ -1019,55 +1040,55 @@ do_action:	/* This label is used only to access EOF actions. */
 	{ /* beginning of action switch */
 			case 0: /* must back up */
 			/* undo the effects of YY_DO_BEFORE_ACTION */
-			*yy_cp = (yy_hold_char);
-			yy_cp = (yy_last_accepting_cpos);
-			yy_current_state = (yy_last_accepting_state);
+			*yy_cp = yyg->yy_hold_char;
+			yy_cp = yyg->yy_last_accepting_cpos;
+			yy_current_state = yyg->yy_last_accepting_state;
 			goto yy_find_action;
 
 case 1:
 YY_RULE_SETUP
-#line 94 "asm_scan.l"
+#line 87 "asm_scan.l"
 
 	YY_BREAK
 /* C style comment */
 case 2:
 YY_RULE_SETUP
-#line 97 "asm_scan.l"
-{ yy_push_state(C_COMMENT); }
+#line 90 "asm_scan.l"
+{ yy_push_state(C_COMMENT, yyscanner); }
 	YY_BREAK
 
 case 3:
 YY_RULE_SETUP
-#line 99 "asm_scan.l"
+#line 92 "asm_scan.l"
 
 	YY_BREAK
 case 4:
 /* rule 4 can match eol */
 YY_RULE_SETUP
-#line 100 "asm_scan.l"
+#line 93 "asm_scan.l"
 
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 101 "asm_scan.l"
+#line 94 "asm_scan.l"
 
 	YY_BREAK
 case 6:
 /* rule 6 can match eol */
 YY_RULE_SETUP
-#line 102 "asm_scan.l"
+#line 95 "asm_scan.l"
 
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 103 "asm_scan.l"
-{ yy_pop_state(); }
+#line 96 "asm_scan.l"
+{ yy_pop_state(yyscanner); }
 	YY_BREAK
 case YY_STATE_EOF(C_COMMENT):
-#line 104 "asm_scan.l"
+#line 97 "asm_scan.l"
 {
 		if (param->flags & PARSER_WARNING)
-			warning("unexpected eof. [+%d %s]", LEXLINENO, param->file);
+			warning("unexpected eof. [+%d %s]", yylineno, param->file);
 		yyterminate();
 	}
 	YY_BREAK
@@ -1075,179 +1096,179 @@ case YY_STATE_EOF(C_COMMENT):
 /* C++ style line comment */
 case 8:
 YY_RULE_SETUP
-#line 112 "asm_scan.l"
-{ yy_push_state(CPP_COMMENT); }
+#line 105 "asm_scan.l"
+{ yy_push_state(CPP_COMMENT, yyscanner); }
 	YY_BREAK
 
 case 9:
 YY_RULE_SETUP
-#line 114 "asm_scan.l"
+#line 107 "asm_scan.l"
 
 	YY_BREAK
 case 10:
 /* rule 10 can match eol */
 YY_RULE_SETUP
-#line 115 "asm_scan.l"
+#line 108 "asm_scan.l"
 
 	YY_BREAK
 case 11:
 /* rule 11 can match eol */
 YY_RULE_SETUP
-#line 116 "asm_scan.l"
-{ yy_pop_state(); unput('\n'); }
+#line 109 "asm_scan.l"
+{ yy_pop_state(yyscanner); unput('\n'); }
 	YY_BREAK
 
 /* String */
 case 12:
 YY_RULE_SETUP
-#line 120 "asm_scan.l"
-{ yy_push_state(STRING); }
+#line 113 "asm_scan.l"
+{ yy_push_state(STRING, yyscanner); }
 	YY_BREAK
 
 case 13:
 YY_RULE_SETUP
-#line 122 "asm_scan.l"
+#line 115 "asm_scan.l"
 
 	YY_BREAK
 case 14:
 /* rule 14 can match eol */
 YY_RULE_SETUP
-#line 123 "asm_scan.l"
+#line 116 "asm_scan.l"
 
 	YY_BREAK
 case 15:
 /* rule 15 can match eol */
 YY_RULE_SETUP
-#line 124 "asm_scan.l"
-{ yy_pop_state(); unput('\n'); return ASM_CONST; }
+#line 117 "asm_scan.l"
+{ yy_pop_state(yyscanner); unput('\n'); return ASM_CONST; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 125 "asm_scan.l"
-{ yy_pop_state(); return ASM_CONST; }
+#line 118 "asm_scan.l"
+{ yy_pop_state(yyscanner); return ASM_CONST; }
 	YY_BREAK
 
 /* Character */
 case 17:
 YY_RULE_SETUP
-#line 129 "asm_scan.l"
-{ yy_push_state(LITERAL); }
+#line 122 "asm_scan.l"
+{ yy_push_state(LITERAL, yyscanner); }
 	YY_BREAK
 
 case 18:
 YY_RULE_SETUP
-#line 131 "asm_scan.l"
+#line 124 "asm_scan.l"
 
 	YY_BREAK
 case 19:
 /* rule 19 can match eol */
 YY_RULE_SETUP
-#line 132 "asm_scan.l"
+#line 125 "asm_scan.l"
 
 	YY_BREAK
 case 20:
 /* rule 20 can match eol */
 YY_RULE_SETUP
-#line 133 "asm_scan.l"
-{ yy_pop_state(); unput('\n'); return ASM_CONST; }
+#line 126 "asm_scan.l"
+{ yy_pop_state(yyscanner); unput('\n'); return ASM_CONST; }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 134 "asm_scan.l"
-{ yy_pop_state(); return ASM_CONST; }
+#line 127 "asm_scan.l"
+{ yy_pop_state(yyscanner); return ASM_CONST; }
 	YY_BREAK
 
 /* Number */
 case 22:
 YY_RULE_SETUP
-#line 138 "asm_scan.l"
+#line 131 "asm_scan.l"
 { return ASM_CONST; }
 	YY_BREAK
 
 case 23:
 YY_RULE_SETUP
-#line 141 "asm_scan.l"
+#line 134 "asm_scan.l"
 {
-		last_directive = asm_reserved_sharp(LEXTEXT, LEXLENG);
-		switch (last_directive) {
+		param->ctx->last_directive = asm_reserved_sharp(yytext, yyleng);
+		switch (param->ctx->last_directive) {
 		case 0:
-			yy_push_state(CPP_COMMENT);
+			yy_push_state(CPP_COMMENT, yyscanner);
 			break;
 		case SHARP_DEFINE:
-			yy_push_state(PREPROCESSOR_LINE);
+			yy_push_state(PREPROCESSOR_LINE, yyscanner);
 			return ASM_DEFINE;
 		case SHARP_UNDEF:
-			yy_push_state(PREPROCESSOR_LINE);
+			yy_push_state(PREPROCESSOR_LINE, yyscanner);
 			return ASM_UNDEF;
 		default:
-			yy_push_state(PREPROCESSOR_LINE);
+			yy_push_state(PREPROCESSOR_LINE, yyscanner);
 			return ASM_DIRECTIVE;
 		}
 	}
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 158 "asm_scan.l"
+#line 151 "asm_scan.l"
 {
-		last_directive = 0;
-		yy_push_state(PREPROCESSOR_LINE);
+		param->ctx->last_directive = 0;
+		yy_push_state(PREPROCESSOR_LINE, yyscanner);
 		return ASM_DIRECTIVE;
 	}
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 163 "asm_scan.l"
+#line 156 "asm_scan.l"
 { return ASM_CALL; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 164 "asm_scan.l"
+#line 157 "asm_scan.l"
 { return ASM_MACRO; }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 165 "asm_scan.l"
+#line 158 "asm_scan.l"
 { return ASM_EQU; }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 166 "asm_scan.l"
+#line 159 "asm_scan.l"
 {
-		ADD_SYM(LEXTEXT, LEXLINENO); 
+		ADD_SYM(yytext, yylineno); 
 		return ASM_ENTRY;
 	}
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 170 "asm_scan.l"
+#line 163 "asm_scan.l"
 {
-		ADD_SYM(LEXTEXT, LEXLINENO);
+		ADD_SYM(yytext, yylineno);
 		return ASM_EXT;
 	}
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 174 "asm_scan.l"
-{ ADD_SYM(LEXTEXT, LEXLINENO); return ASM_LABEL; }
+#line 167 "asm_scan.l"
+{ ADD_SYM(yytext, yylineno); return ASM_LABEL; }
 	YY_BREAK
 
 
 case 31:
 YY_RULE_SETUP
-#line 178 "asm_scan.l"
+#line 171 "asm_scan.l"
 {
-		switch (last_directive) {
+		switch (param->ctx->last_directive) {
 		case SHARP_IF:
 		case SHARP_ELIF:
-			if (strcmp(LEXTEXT, "defined") == 0)
+			if (strcmp(yytext, "defined") == 0)
 				break;
 			/* FALLTHROUGH */
 		case SHARP_IFDEF:
 		case SHARP_IFNDEF:
-			PUT(PARSER_REF_SYM, LEXTEXT, LEXLINENO);
+			PUT(PARSER_REF_SYM, yytext, yylineno);
 			break;
 		default:
-			ADD_SYM(LEXTEXT, LEXLINENO);
+			ADD_SYM(yytext, yylineno);
 			return ASM_SYMBOL;
 		}
 	}
@@ -1255,38 +1276,38 @@ YY_RULE_SETUP
 case 32:
 /* rule 32 can match eol */
 YY_RULE_SETUP
-#line 194 "asm_scan.l"
-{ yy_pop_state(); return '\n'; }
+#line 187 "asm_scan.l"
+{ yy_pop_state(yyscanner); return '\n'; }
 	YY_BREAK
 
 case 33:
 YY_RULE_SETUP
-#line 197 "asm_scan.l"
-{ ADD_SYM(LEXTEXT, LEXLINENO); return ASM_SYMBOL; }
+#line 190 "asm_scan.l"
+{ ADD_SYM(yytext, yylineno); return ASM_SYMBOL; }
 	YY_BREAK
 case 34:
 /* rule 34 can match eol */
 YY_RULE_SETUP
-#line 199 "asm_scan.l"
+#line 192 "asm_scan.l"
 
 	YY_BREAK
 case 35:
 /* rule 35 can match eol */
 YY_RULE_SETUP
-#line 200 "asm_scan.l"
+#line 193 "asm_scan.l"
 { return '\n'; }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 201 "asm_scan.l"
-{ return LEXTEXT[0]; }
+#line 194 "asm_scan.l"
+{ return yytext[0]; }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 203 "asm_scan.l"
+#line 195 "asm_scan.l"
 ECHO;
 	YY_BREAK
-#line 1290 "asm_scan.c"
+#line 1311 "asm_scan.c"
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(CPP_COMMENT):
 case YY_STATE_EOF(STRING):
@@ -1297,25 +1318,25 @@ case YY_STATE_EOF(PREPROCESSOR_LINE):
 	case YY_END_OF_BUFFER:
 		{
 		/* Amount of text matched not including the EOB char. */
-		int yy_amount_of_matched_text = (int) (yy_cp - (yytext_ptr)) - 1;
+		int yy_amount_of_matched_text = (int) (yy_cp - yyg->yytext_ptr) - 1;
 
 		/* Undo the effects of YY_DO_BEFORE_ACTION. */
-		*yy_cp = (yy_hold_char);
+		*yy_cp = yyg->yy_hold_char;
 		YY_RESTORE_YY_MORE_OFFSET
 
 		if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_NEW )
 			{
 			/* We're scanning a new file or input source.  It's
 			 * possible that this happened because the user
-			 * just pointed asm_in at a new source and called
+			 * just pointed yyin at a new source and called
 			 * asm_lex().  If so, then we have to assure
 			 * consistency between YY_CURRENT_BUFFER and our
 			 * globals.  Here is the right place to do so, because
 			 * this is the first action (other than possibly a
 			 * back-up) that will match for the new input source.
 			 */
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-			YY_CURRENT_BUFFER_LVALUE->yy_input_file = asm_in;
+			yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
+			YY_CURRENT_BUFFER_LVALUE->yy_input_file = yyin;
 			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status = YY_BUFFER_NORMAL;
 			}
 
@@ -1326,13 +1347,13 @@ case YY_STATE_EOF(PREPROCESSOR_LINE):
 		 * end-of-buffer state).  Contrast this with the test
 		 * in input().
 		 */
-		if ( (yy_c_buf_p) <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
+		if ( yyg->yy_c_buf_p <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] )
 			{ /* This was really a NUL. */
 			yy_state_type yy_next_state;
 
-			(yy_c_buf_p) = (yytext_ptr) + yy_amount_of_matched_text;
+			yyg->yy_c_buf_p = yyg->yytext_ptr + yy_amount_of_matched_text;
 
-			yy_current_state = yy_get_previous_state(  );
+			yy_current_state = yy_get_previous_state( yyscanner );
 
 			/* Okay, we're now positioned to make the NUL
 			 * transition.  We couldn't have
@@ -1343,44 +1364,44 @@ case YY_STATE_EOF(PREPROCESSOR_LINE):
 			 * will run more slowly).
 			 */
 
-			yy_next_state = yy_try_NUL_trans( yy_current_state );
+			yy_next_state = yy_try_NUL_trans( yy_current_state ,yyscanner);
 
-			yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+			yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 
 			if ( yy_next_state )
 				{
 				/* Consume the NUL. */
-				yy_cp = ++(yy_c_buf_p);
+				yy_cp = ++yyg->yy_c_buf_p;
 				yy_current_state = yy_next_state;
 				goto yy_match;
 				}
 
 			else
 				{
-				yy_cp = (yy_last_accepting_cpos);
-				yy_current_state = (yy_last_accepting_state);
+				yy_cp = yyg->yy_last_accepting_cpos;
+				yy_current_state = yyg->yy_last_accepting_state;
 				goto yy_find_action;
 				}
 			}
 
-		else switch ( yy_get_next_buffer(  ) )
+		else switch ( yy_get_next_buffer( yyscanner ) )
 			{
 			case EOB_ACT_END_OF_FILE:
 				{
-				(yy_did_buffer_switch_on_eof) = 0;
+				yyg->yy_did_buffer_switch_on_eof = 0;
 
-				if ( asm_wrap( ) )
+				if ( asm_wrap(yyscanner ) )
 					{
 					/* Note: because we've taken care in
 					 * yy_get_next_buffer() to have set up
-					 * asm_text, we can now set up
+					 * yytext, we can now set up
 					 * yy_c_buf_p so that if some total
 					 * hoser (like flex itself) wants to
 					 * call the scanner after we return the
 					 * YY_NULL, it'll still work - another
 					 * YY_NULL will get returned.
 					 */
-					(yy_c_buf_p) = (yytext_ptr) + YY_MORE_ADJ;
+					yyg->yy_c_buf_p = yyg->yytext_ptr + YY_MORE_ADJ;
 
 					yy_act = YY_STATE_EOF(YY_START);
 					goto do_action;
@@ -1388,30 +1409,30 @@ case YY_STATE_EOF(PREPROCESSOR_LINE):
 
 				else
 					{
-					if ( ! (yy_did_buffer_switch_on_eof) )
+					if ( ! yyg->yy_did_buffer_switch_on_eof )
 						YY_NEW_FILE;
 					}
 				break;
 				}
 
 			case EOB_ACT_CONTINUE_SCAN:
-				(yy_c_buf_p) =
-					(yytext_ptr) + yy_amount_of_matched_text;
+				yyg->yy_c_buf_p =
+					yyg->yytext_ptr + yy_amount_of_matched_text;
 
-				yy_current_state = yy_get_previous_state(  );
+				yy_current_state = yy_get_previous_state( yyscanner );
 
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+				yy_cp = yyg->yy_c_buf_p;
+				yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 				goto yy_match;
 
 			case EOB_ACT_LAST_MATCH:
-				(yy_c_buf_p) =
-				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)];
+				yyg->yy_c_buf_p =
+				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars];
 
-				yy_current_state = yy_get_previous_state(  );
+				yy_current_state = yy_get_previous_state( yyscanner );
 
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+				yy_cp = yyg->yy_c_buf_p;
+				yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 				goto yy_find_action;
 			}
 		break;
@@ -1431,20 +1452,21 @@ case YY_STATE_EOF(PREPROCESSOR_LINE):
  *	EOB_ACT_CONTINUE_SCAN - continue scanning from current position
  *	EOB_ACT_END_OF_FILE - end of file
  */
-static int yy_get_next_buffer (void)
+static int yy_get_next_buffer (yyscan_t yyscanner)
 {
-    	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
-	register char *source = (yytext_ptr);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
+	register char *source = yyg->yytext_ptr;
 	register int number_to_move, i;
 	int ret_val;
 
-	if ( (yy_c_buf_p) > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] )
+	if ( yyg->yy_c_buf_p > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars + 1] )
 		YY_FATAL_ERROR(
 		"fatal flex scanner internal error--end of buffer missed" );
 
 	if ( YY_CURRENT_BUFFER_LVALUE->yy_fill_buffer == 0 )
 		{ /* Don't try to fill the buffer, so this is an EOF. */
-		if ( (yy_c_buf_p) - (yytext_ptr) - YY_MORE_ADJ == 1 )
+		if ( yyg->yy_c_buf_p - yyg->yytext_ptr - YY_MORE_ADJ == 1 )
 			{
 			/* We matched a single character, the EOB, so
 			 * treat this as a final EOF.
@@ -1464,7 +1486,7 @@ static int yy_get_next_buffer (void)
 	/* Try to read more data. */
 
 	/* First move last chars to start of buffer. */
-	number_to_move = (int) ((yy_c_buf_p) - (yytext_ptr)) - 1;
+	number_to_move = (int) (yyg->yy_c_buf_p - yyg->yytext_ptr) - 1;
 
 	for ( i = 0; i < number_to_move; ++i )
 		*(dest++) = *(source++);
@@ -1473,7 +1495,7 @@ static int yy_get_next_buffer (void)
 		/* don't do the read, it's not guaranteed to return an EOF,
 		 * just force an EOF
 		 */
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars) = 0;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars = 0;
 
 	else
 		{
@@ -1487,7 +1509,7 @@ static int yy_get_next_buffer (void)
 			YY_BUFFER_STATE b = YY_CURRENT_BUFFER;
 
 			int yy_c_buf_p_offset =
-				(int) ((yy_c_buf_p) - b->yy_ch_buf);
+				(int) (yyg->yy_c_buf_p - b->yy_ch_buf);
 
 			if ( b->yy_is_our_buffer )
 				{
@@ -1500,7 +1522,7 @@ static int yy_get_next_buffer (void)
 
 				b->yy_ch_buf = (char *)
 					/* Include room in for 2 EOB chars. */
-					asm_realloc((void *) b->yy_ch_buf,b->yy_buf_size + 2  );
+					asm_realloc((void *) b->yy_ch_buf,b->yy_buf_size + 2 ,yyscanner);
 				}
 			else
 				/* Can't grow it, we don't own it. */
@@ -1510,7 +1532,7 @@ static int yy_get_next_buffer (void)
 				YY_FATAL_ERROR(
 				"fatal error - scanner input buffer overflow" );
 
-			(yy_c_buf_p) = &b->yy_ch_buf[yy_c_buf_p_offset];
+			yyg->yy_c_buf_p = &b->yy_ch_buf[yy_c_buf_p_offset];
 
 			num_to_read = YY_CURRENT_BUFFER_LVALUE->yy_buf_size -
 						number_to_move - 1;
@@ -1522,17 +1544,17 @@ static int yy_get_next_buffer (void)
 
 		/* Read in more data. */
 		YY_INPUT( (&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[number_to_move]),
-			(yy_n_chars), (size_t) num_to_read );
+			yyg->yy_n_chars, (size_t) num_to_read );
 
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
-	if ( (yy_n_chars) == 0 )
+	if ( yyg->yy_n_chars == 0 )
 		{
 		if ( number_to_move == YY_MORE_ADJ )
 			{
 			ret_val = EOB_ACT_END_OF_FILE;
-			asm_restart(asm_in  );
+			asm_restart(yyin ,yyscanner);
 			}
 
 		else
@@ -1546,40 +1568,41 @@ static int yy_get_next_buffer (void)
 	else
 		ret_val = EOB_ACT_CONTINUE_SCAN;
 
-	if ((yy_size_t) ((yy_n_chars) + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
+	if ((yy_size_t) (yyg->yy_n_chars + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
 		/* Extend the array by 50%, plus the number we really need. */
-		yy_size_t new_size = (yy_n_chars) + number_to_move + ((yy_n_chars) >> 1);
-		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) asm_realloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size  );
+		yy_size_t new_size = yyg->yy_n_chars + number_to_move + (yyg->yy_n_chars >> 1);
+		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) asm_realloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size ,yyscanner);
 		if ( ! YY_CURRENT_BUFFER_LVALUE->yy_ch_buf )
 			YY_FATAL_ERROR( "out of dynamic memory in yy_get_next_buffer()" );
 	}
 
-	(yy_n_chars) += number_to_move;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] = YY_END_OF_BUFFER_CHAR;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] = YY_END_OF_BUFFER_CHAR;
+	yyg->yy_n_chars += number_to_move;
+	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] = YY_END_OF_BUFFER_CHAR;
+	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars + 1] = YY_END_OF_BUFFER_CHAR;
 
-	(yytext_ptr) = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
+	yyg->yytext_ptr = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
 
 	return ret_val;
 }
 
 /* yy_get_previous_state - get the state just before the EOB char was reached */
 
-    static yy_state_type yy_get_previous_state (void)
+    static yy_state_type yy_get_previous_state (yyscan_t yyscanner)
 {
 	register yy_state_type yy_current_state;
 	register char *yy_cp;
-    
-	yy_current_state = (yy_start);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	yy_current_state = yyg->yy_start;
 	yy_current_state += YY_AT_BOL();
 
-	for ( yy_cp = (yytext_ptr) + YY_MORE_ADJ; yy_cp < (yy_c_buf_p); ++yy_cp )
+	for ( yy_cp = yyg->yytext_ptr + YY_MORE_ADJ; yy_cp < yyg->yy_c_buf_p; ++yy_cp )
 		{
 		register YY_CHAR yy_c = (*yy_cp ? yy_ec[YY_SC_TO_UI(*yy_cp)] : 1);
 		if ( yy_accept[yy_current_state] )
 			{
-			(yy_last_accepting_state) = yy_current_state;
-			(yy_last_accepting_cpos) = yy_cp;
+			yyg->yy_last_accepting_state = yy_current_state;
+			yyg->yy_last_accepting_cpos = yy_cp;
 			}
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
@@ -1598,16 +1621,17 @@ static int yy_get_next_buffer (void)
  * synopsis
  *	next_state = yy_try_NUL_trans( current_state );
  */
-    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state )
+    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state , yyscan_t yyscanner)
 {
 	register int yy_is_jam;
-    	register char *yy_cp = (yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner; /* This var may be unused depending upon options. */
+	register char *yy_cp = yyg->yy_c_buf_p;
 
 	register YY_CHAR yy_c = 1;
 	if ( yy_accept[yy_current_state] )
 		{
-		(yy_last_accepting_state) = yy_current_state;
-		(yy_last_accepting_cpos) = yy_cp;
+		yyg->yy_last_accepting_state = yy_current_state;
+		yyg->yy_last_accepting_cpos = yy_cp;
 		}
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
@@ -1621,19 +1645,20 @@ static int yy_get_next_buffer (void)
 	return yy_is_jam ? 0 : yy_current_state;
 }
 
-    static void yyunput (int c, register char * yy_bp )
+    static void yyunput (int c, register char * yy_bp , yyscan_t yyscanner)
 {
 	register char *yy_cp;
-    
-    yy_cp = (yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+    yy_cp = yyg->yy_c_buf_p;
 
-	/* undo effects of setting up asm_text */
-	*yy_cp = (yy_hold_char);
+	/* undo effects of setting up yytext */
+	*yy_cp = yyg->yy_hold_char;
 
 	if ( yy_cp < YY_CURRENT_BUFFER_LVALUE->yy_ch_buf + 2 )
 		{ /* need to shift things up to make room */
 		/* +2 for EOB chars. */
-		register int number_to_move = (yy_n_chars) + 2;
+		register int number_to_move = yyg->yy_n_chars + 2;
 		register char *dest = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[
 					YY_CURRENT_BUFFER_LVALUE->yy_buf_size + 2];
 		register char *source =
@@ -1645,7 +1670,7 @@ static int yy_get_next_buffer (void)
 		yy_cp += (int) (dest - source);
 		yy_bp += (int) (dest - source);
 		YY_CURRENT_BUFFER_LVALUE->yy_n_chars =
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_buf_size;
+			yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_buf_size;
 
 		if ( yy_cp < YY_CURRENT_BUFFER_LVALUE->yy_ch_buf + 2 )
 			YY_FATAL_ERROR( "flex scanner push-back overflow" );
@@ -1654,42 +1679,43 @@ static int yy_get_next_buffer (void)
 	*--yy_cp = (char) c;
 
     if ( c == '\n' ){
-        --asm_lineno;
+        --yylineno;
     }
 
-	(yytext_ptr) = yy_bp;
-	(yy_hold_char) = *yy_cp;
-	(yy_c_buf_p) = yy_cp;
+	yyg->yytext_ptr = yy_bp;
+	yyg->yy_hold_char = *yy_cp;
+	yyg->yy_c_buf_p = yy_cp;
 }
 
 #ifndef YY_NO_INPUT
 #ifdef __cplusplus
-    static int yyinput (void)
+    static int yyinput (yyscan_t yyscanner)
 #else
-    static int input  (void)
+    static int input  (yyscan_t yyscanner)
 #endif
 
 {
 	int c;
-    
-	*(yy_c_buf_p) = (yy_hold_char);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	*yyg->yy_c_buf_p = yyg->yy_hold_char;
 
-	if ( *(yy_c_buf_p) == YY_END_OF_BUFFER_CHAR )
+	if ( *yyg->yy_c_buf_p == YY_END_OF_BUFFER_CHAR )
 		{
 		/* yy_c_buf_p now points to the character we want to return.
 		 * If this occurs *before* the EOB characters, then it's a
 		 * valid NUL; if not, then we've hit the end of the buffer.
 		 */
-		if ( (yy_c_buf_p) < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
+		if ( yyg->yy_c_buf_p < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] )
 			/* This was really a NUL. */
-			*(yy_c_buf_p) = '\0';
+			*yyg->yy_c_buf_p = '\0';
 
 		else
 			{ /* need more input */
-			int offset = (yy_c_buf_p) - (yytext_ptr);
-			++(yy_c_buf_p);
+			int offset = yyg->yy_c_buf_p - yyg->yytext_ptr;
+			++yyg->yy_c_buf_p;
 
-			switch ( yy_get_next_buffer(  ) )
+			switch ( yy_get_next_buffer( yyscanner ) )
 				{
 				case EOB_ACT_LAST_MATCH:
 					/* This happens because yy_g_n_b()
@@ -1703,39 +1729,41 @@ static int yy_get_next_buffer (void)
 					 */
 
 					/* Reset buffer status. */
-					asm_restart(asm_in );
+					asm_restart(yyin ,yyscanner);
 
 					/*FALLTHROUGH*/
 
 				case EOB_ACT_END_OF_FILE:
 					{
-					if ( asm_wrap( ) )
+					if ( asm_wrap(yyscanner ) )
 						return EOF;
 
-					if ( ! (yy_did_buffer_switch_on_eof) )
+					if ( ! yyg->yy_did_buffer_switch_on_eof )
 						YY_NEW_FILE;
 #ifdef __cplusplus
-					return yyinput();
+					return yyinput(yyscanner );
 #else
-					return input();
+					return input(yyscanner );
 #endif
 					}
 
 				case EOB_ACT_CONTINUE_SCAN:
-					(yy_c_buf_p) = (yytext_ptr) + offset;
+					yyg->yy_c_buf_p = yyg->yytext_ptr + offset;
 					break;
 				}
 			}
 		}
 
-	c = *(unsigned char *) (yy_c_buf_p);	/* cast for 8-bit char's */
-	*(yy_c_buf_p) = '\0';	/* preserve asm_text */
-	(yy_hold_char) = *++(yy_c_buf_p);
+	c = *(unsigned char *) yyg->yy_c_buf_p;	/* cast for 8-bit char's */
+	*yyg->yy_c_buf_p = '\0';	/* preserve yytext */
+	yyg->yy_hold_char = *++yyg->yy_c_buf_p;
 
 	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = (c == '\n');
 	if ( YY_CURRENT_BUFFER_LVALUE->yy_at_bol )
 		   
-    asm_lineno++;
+    do{ yylineno++;
+        yycolumn=0;
+    }while(0)
 ;
 
 	return c;
@@ -1744,76 +1772,79 @@ static int yy_get_next_buffer (void)
 
 /** Immediately switch to a different input stream.
  * @param input_file A readable stream.
- * 
+ * @param yyscanner The scanner object.
  * @note This function does not reset the start condition to @c INITIAL .
  */
-    void asm_restart  (FILE * input_file )
+    void asm_restart  (FILE * input_file , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	if ( ! YY_CURRENT_BUFFER ){
-        asm_ensure_buffer_stack ();
+        asm_ensure_buffer_stack (yyscanner );
 		YY_CURRENT_BUFFER_LVALUE =
-            asm__create_buffer(asm_in,YY_BUF_SIZE );
+            asm__create_buffer(yyin,YY_BUF_SIZE ,yyscanner);
 	}
 
-	asm__init_buffer(YY_CURRENT_BUFFER,input_file );
-	asm__load_buffer_state( );
+	asm__init_buffer(YY_CURRENT_BUFFER,input_file ,yyscanner);
+	asm__load_buffer_state(yyscanner );
 }
 
 /** Switch to a different input buffer.
  * @param new_buffer The new input buffer.
- * 
+ * @param yyscanner The scanner object.
  */
-    void asm__switch_to_buffer  (YY_BUFFER_STATE  new_buffer )
+    void asm__switch_to_buffer  (YY_BUFFER_STATE  new_buffer , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	/* TODO. We should be able to replace this entire function body
 	 * with
 	 *		asm_pop_buffer_state();
 	 *		asm_push_buffer_state(new_buffer);
      */
-	asm_ensure_buffer_stack ();
+	asm_ensure_buffer_stack (yyscanner );
 	if ( YY_CURRENT_BUFFER == new_buffer )
 		return;
 
 	if ( YY_CURRENT_BUFFER )
 		{
 		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		*yyg->yy_c_buf_p = yyg->yy_hold_char;
+		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = yyg->yy_c_buf_p;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
 	YY_CURRENT_BUFFER_LVALUE = new_buffer;
-	asm__load_buffer_state( );
+	asm__load_buffer_state(yyscanner );
 
 	/* We don't actually know whether we did this switch during
 	 * EOF (asm_wrap()) processing, but the only time this flag
 	 * is looked at is after asm_wrap() is called, so it's safe
 	 * to go ahead and always set it.
 	 */
-	(yy_did_buffer_switch_on_eof) = 1;
+	yyg->yy_did_buffer_switch_on_eof = 1;
 }
 
-static void asm__load_buffer_state  (void)
+static void asm__load_buffer_state  (yyscan_t yyscanner)
 {
-    	(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-	(yytext_ptr) = (yy_c_buf_p) = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
-	asm_in = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
-	(yy_hold_char) = *(yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
+	yyg->yytext_ptr = yyg->yy_c_buf_p = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
+	yyin = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
+	yyg->yy_hold_char = *yyg->yy_c_buf_p;
 }
 
 /** Allocate and initialize an input buffer state.
  * @param file A readable stream.
  * @param size The character buffer size in bytes. When in doubt, use @c YY_BUF_SIZE.
- * 
+ * @param yyscanner The scanner object.
  * @return the allocated buffer state.
  */
-    YY_BUFFER_STATE asm__create_buffer  (FILE * file, int  size )
+    YY_BUFFER_STATE asm__create_buffer  (FILE * file, int  size , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
     
-	b = (YY_BUFFER_STATE) asm_alloc(sizeof( struct yy_buffer_state )  );
+	b = (YY_BUFFER_STATE) asm_alloc(sizeof( struct yy_buffer_state ) ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "out of dynamic memory in asm__create_buffer()" );
 
@@ -1822,24 +1853,25 @@ static void asm__load_buffer_state  (void)
 	/* yy_ch_buf has to be 2 characters longer than the size given because
 	 * we need to put in 2 end-of-buffer characters.
 	 */
-	b->yy_ch_buf = (char *) asm_alloc(b->yy_buf_size + 2  );
+	b->yy_ch_buf = (char *) asm_alloc(b->yy_buf_size + 2 ,yyscanner);
 	if ( ! b->yy_ch_buf )
 		YY_FATAL_ERROR( "out of dynamic memory in asm__create_buffer()" );
 
 	b->yy_is_our_buffer = 1;
 
-	asm__init_buffer(b,file );
+	asm__init_buffer(b,file ,yyscanner);
 
 	return b;
 }
 
 /** Destroy the buffer.
  * @param b a buffer created with asm__create_buffer()
- * 
+ * @param yyscanner The scanner object.
  */
-    void asm__delete_buffer (YY_BUFFER_STATE  b )
+    void asm__delete_buffer (YY_BUFFER_STATE  b , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	if ( ! b )
 		return;
 
@@ -1847,21 +1879,22 @@ static void asm__load_buffer_state  (void)
 		YY_CURRENT_BUFFER_LVALUE = (YY_BUFFER_STATE) 0;
 
 	if ( b->yy_is_our_buffer )
-		asm_free((void *) b->yy_ch_buf  );
+		asm_free((void *) b->yy_ch_buf ,yyscanner);
 
-	asm_free((void *) b  );
+	asm_free((void *) b ,yyscanner);
 }
 
 /* Initializes or reinitializes a buffer.
  * This function is sometimes called more than once on the same buffer,
  * such as during a asm_restart() or at EOF.
  */
-    static void asm__init_buffer  (YY_BUFFER_STATE  b, FILE * file )
+    static void asm__init_buffer  (YY_BUFFER_STATE  b, FILE * file , yyscan_t yyscanner)
 
 {
 	int oerrno = errno;
-    
-	asm__flush_buffer(b );
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	asm__flush_buffer(b ,yyscanner);
 
 	b->yy_input_file = file;
 	b->yy_fill_buffer = 1;
@@ -1882,11 +1915,12 @@ static void asm__load_buffer_state  (void)
 
 /** Discard all buffered characters. On the next scan, YY_INPUT will be called.
  * @param b the buffer state to be flushed, usually @c YY_CURRENT_BUFFER.
- * 
+ * @param yyscanner The scanner object.
  */
-    void asm__flush_buffer (YY_BUFFER_STATE  b )
+    void asm__flush_buffer (YY_BUFFER_STATE  b , yyscan_t yyscanner)
 {
-    	if ( ! b )
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if ( ! b )
 		return;
 
 	b->yy_n_chars = 0;
@@ -1904,114 +1938,117 @@ static void asm__load_buffer_state  (void)
 	b->yy_buffer_status = YY_BUFFER_NEW;
 
 	if ( b == YY_CURRENT_BUFFER )
-		asm__load_buffer_state( );
+		asm__load_buffer_state(yyscanner );
 }
 
 /** Pushes the new state onto the stack. The new state becomes
  *  the current state. This function will allocate the stack
  *  if necessary.
  *  @param new_buffer The new state.
- *  
+ *  @param yyscanner The scanner object.
  */
-void asm_push_buffer_state (YY_BUFFER_STATE new_buffer )
+void asm_push_buffer_state (YY_BUFFER_STATE new_buffer , yyscan_t yyscanner)
 {
-    	if (new_buffer == NULL)
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if (new_buffer == NULL)
 		return;
 
-	asm_ensure_buffer_stack();
+	asm_ensure_buffer_stack(yyscanner );
 
 	/* This block is copied from asm__switch_to_buffer. */
 	if ( YY_CURRENT_BUFFER )
 		{
 		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		*yyg->yy_c_buf_p = yyg->yy_hold_char;
+		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = yyg->yy_c_buf_p;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
 	/* Only push if top exists. Otherwise, replace top. */
 	if (YY_CURRENT_BUFFER)
-		(yy_buffer_stack_top)++;
+		yyg->yy_buffer_stack_top++;
 	YY_CURRENT_BUFFER_LVALUE = new_buffer;
 
 	/* copied from asm__switch_to_buffer. */
-	asm__load_buffer_state( );
-	(yy_did_buffer_switch_on_eof) = 1;
+	asm__load_buffer_state(yyscanner );
+	yyg->yy_did_buffer_switch_on_eof = 1;
 }
 
 /** Removes and deletes the top of the stack, if present.
  *  The next element becomes the new top.
- *  
+ *  @param yyscanner The scanner object.
  */
-void asm_pop_buffer_state (void)
+void asm_pop_buffer_state (yyscan_t yyscanner)
 {
-    	if (!YY_CURRENT_BUFFER)
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if (!YY_CURRENT_BUFFER)
 		return;
 
-	asm__delete_buffer(YY_CURRENT_BUFFER );
+	asm__delete_buffer(YY_CURRENT_BUFFER ,yyscanner);
 	YY_CURRENT_BUFFER_LVALUE = NULL;
-	if ((yy_buffer_stack_top) > 0)
-		--(yy_buffer_stack_top);
+	if (yyg->yy_buffer_stack_top > 0)
+		--yyg->yy_buffer_stack_top;
 
 	if (YY_CURRENT_BUFFER) {
-		asm__load_buffer_state( );
-		(yy_did_buffer_switch_on_eof) = 1;
+		asm__load_buffer_state(yyscanner );
+		yyg->yy_did_buffer_switch_on_eof = 1;
 	}
 }
 
 /* Allocates the stack if it does not exist.
  *  Guarantees space for at least one push.
  */
-static void asm_ensure_buffer_stack (void)
+static void asm_ensure_buffer_stack (yyscan_t yyscanner)
 {
 	int num_to_alloc;
-    
-	if (!(yy_buffer_stack)) {
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	if (!yyg->yy_buffer_stack) {
 
 		/* First allocation is just for 2 elements, since we don't know if this
 		 * scanner will even need a stack. We use 2 instead of 1 to avoid an
 		 * immediate realloc on the next call.
          */
 		num_to_alloc = 1;
-		(yy_buffer_stack) = (struct yy_buffer_state**)asm_alloc
+		yyg->yy_buffer_stack = (struct yy_buffer_state**)asm_alloc
 								(num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
+								, yyscanner);
+		if ( ! yyg->yy_buffer_stack )
 			YY_FATAL_ERROR( "out of dynamic memory in asm_ensure_buffer_stack()" );
 								  
-		memset((yy_buffer_stack), 0, num_to_alloc * sizeof(struct yy_buffer_state*));
+		memset(yyg->yy_buffer_stack, 0, num_to_alloc * sizeof(struct yy_buffer_state*));
 				
-		(yy_buffer_stack_max) = num_to_alloc;
-		(yy_buffer_stack_top) = 0;
+		yyg->yy_buffer_stack_max = num_to_alloc;
+		yyg->yy_buffer_stack_top = 0;
 		return;
 	}
 
-	if ((yy_buffer_stack_top) >= ((yy_buffer_stack_max)) - 1){
+	if (yyg->yy_buffer_stack_top >= (yyg->yy_buffer_stack_max) - 1){
 
 		/* Increase the buffer to prepare for a possible push. */
 		int grow_size = 8 /* arbitrary grow size */;
 
-		num_to_alloc = (yy_buffer_stack_max) + grow_size;
-		(yy_buffer_stack) = (struct yy_buffer_state**)asm_realloc
-								((yy_buffer_stack),
+		num_to_alloc = yyg->yy_buffer_stack_max + grow_size;
+		yyg->yy_buffer_stack = (struct yy_buffer_state**)asm_realloc
+								(yyg->yy_buffer_stack,
 								num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
+								, yyscanner);
+		if ( ! yyg->yy_buffer_stack )
 			YY_FATAL_ERROR( "out of dynamic memory in asm_ensure_buffer_stack()" );
 
 		/* zero only the new slots.*/
-		memset((yy_buffer_stack) + (yy_buffer_stack_max), 0, grow_size * sizeof(struct yy_buffer_state*));
-		(yy_buffer_stack_max) = num_to_alloc;
+		memset(yyg->yy_buffer_stack + yyg->yy_buffer_stack_max, 0, grow_size * sizeof(struct yy_buffer_state*));
+		yyg->yy_buffer_stack_max = num_to_alloc;
 	}
 }
 
 /** Setup the input buffer state to scan directly from a user-specified character buffer.
  * @param base the character buffer
  * @param size the size in bytes of the character buffer
- * 
+ * @param yyscanner The scanner object.
  * @return the newly allocated buffer state object. 
  */
-YY_BUFFER_STATE asm__scan_buffer  (char * base, yy_size_t  size )
+YY_BUFFER_STATE asm__scan_buffer  (char * base, yy_size_t  size , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
     
@@ -2021,7 +2058,7 @@ YY_BUFFER_STATE asm__scan_buffer  (char * base, yy_size_t  size )
 		/* They forgot to leave room for the EOB's. */
 		return 0;
 
-	b = (YY_BUFFER_STATE) asm_alloc(sizeof( struct yy_buffer_state )  );
+	b = (YY_BUFFER_STATE) asm_alloc(sizeof( struct yy_buffer_state ) ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "out of dynamic memory in asm__scan_buffer()" );
 
@@ -2035,7 +2072,7 @@ YY_BUFFER_STATE asm__scan_buffer  (char * base, yy_size_t  size )
 	b->yy_fill_buffer = 0;
 	b->yy_buffer_status = YY_BUFFER_NEW;
 
-	asm__switch_to_buffer(b  );
+	asm__switch_to_buffer(b ,yyscanner);
 
 	return b;
 }
@@ -2043,25 +2080,25 @@ YY_BUFFER_STATE asm__scan_buffer  (char * base, yy_size_t  size )
 /** Setup the input buffer state to scan a string. The next call to asm_lex() will
  * scan from a @e copy of @a str.
  * @param yystr a NUL-terminated string to scan
- * 
+ * @param yyscanner The scanner object.
  * @return the newly allocated buffer state object.
  * @note If you want to scan bytes that may contain NUL values, then use
  *       asm__scan_bytes() instead.
  */
-YY_BUFFER_STATE asm__scan_string (yyconst char * yystr )
+YY_BUFFER_STATE asm__scan_string (yyconst char * yystr , yyscan_t yyscanner)
 {
     
-	return asm__scan_bytes(yystr,strlen(yystr) );
+	return asm__scan_bytes(yystr,strlen(yystr) ,yyscanner);
 }
 
 /** Setup the input buffer state to scan the given bytes. The next call to asm_lex() will
  * scan from a @e copy of @a bytes.
  * @param bytes the byte buffer to scan
  * @param len the number of bytes in the buffer pointed to by @a bytes.
- * 
+ * @param yyscanner The scanner object.
  * @return the newly allocated buffer state object.
  */
-YY_BUFFER_STATE asm__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
+YY_BUFFER_STATE asm__scan_bytes  (yyconst char * yybytes, int  _yybytes_len , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
 	char *buf;
@@ -2070,7 +2107,7 @@ YY_BUFFER_STATE asm__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
     
 	/* Get memory for full buffer, including space for trailing EOB's. */
 	n = _yybytes_len + 2;
-	buf = (char *) asm_alloc(n  );
+	buf = (char *) asm_alloc(n ,yyscanner);
 	if ( ! buf )
 		YY_FATAL_ERROR( "out of dynamic memory in asm__scan_bytes()" );
 
@@ -2079,7 +2116,7 @@ YY_BUFFER_STATE asm__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
 
 	buf[_yybytes_len] = buf[_yybytes_len+1] = YY_END_OF_BUFFER_CHAR;
 
-	b = asm__scan_buffer(buf,n );
+	b = asm__scan_buffer(buf,n ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "bad buffer in asm__scan_bytes()" );
 
@@ -2091,43 +2128,45 @@ YY_BUFFER_STATE asm__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
 	return b;
 }
 
-    static void yy_push_state (int  new_state )
+    static void yy_push_state (int  new_state , yyscan_t yyscanner)
 {
-    	if ( (yy_start_stack_ptr) >= (yy_start_stack_depth) )
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if ( yyg->yy_start_stack_ptr >= yyg->yy_start_stack_depth )
 		{
 		yy_size_t new_size;
 
-		(yy_start_stack_depth) += YY_START_STACK_INCR;
-		new_size = (yy_start_stack_depth) * sizeof( int );
+		yyg->yy_start_stack_depth += YY_START_STACK_INCR;
+		new_size = yyg->yy_start_stack_depth * sizeof( int );
 
-		if ( ! (yy_start_stack) )
-			(yy_start_stack) = (int *) asm_alloc(new_size  );
+		if ( ! yyg->yy_start_stack )
+			yyg->yy_start_stack = (int *) asm_alloc(new_size ,yyscanner);
 
 		else
-			(yy_start_stack) = (int *) asm_realloc((void *) (yy_start_stack),new_size  );
+			yyg->yy_start_stack = (int *) asm_realloc((void *) yyg->yy_start_stack,new_size ,yyscanner);
 
-		if ( ! (yy_start_stack) )
+		if ( ! yyg->yy_start_stack )
 			YY_FATAL_ERROR( "out of memory expanding start-condition stack" );
 		}
 
-	(yy_start_stack)[(yy_start_stack_ptr)++] = YY_START;
+	yyg->yy_start_stack[yyg->yy_start_stack_ptr++] = YY_START;
 
 	BEGIN(new_state);
 }
 
-    static void yy_pop_state  (void)
+    static void yy_pop_state  (yyscan_t yyscanner)
 {
-    	if ( --(yy_start_stack_ptr) < 0 )
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if ( --yyg->yy_start_stack_ptr < 0 )
 		YY_FATAL_ERROR( "start-condition stack underflow" );
 
-	BEGIN((yy_start_stack)[(yy_start_stack_ptr)]);
+	BEGIN(yyg->yy_start_stack[yyg->yy_start_stack_ptr]);
 }
 
 #ifndef YY_EXIT_FAILURE
 #define YY_EXIT_FAILURE 2
 #endif
 
-static void yy_fatal_error (yyconst char* msg )
+static void yy_fatal_error (yyconst char* msg , yyscan_t yyscanner)
 {
     	(void) fprintf( stderr, "%s\n", msg );
 	exit( YY_EXIT_FAILURE );
@@ -2139,124 +2178,276 @@ static void yy_fatal_error (yyconst char* msg )
 #define yyless(n) \
 	do \
 		{ \
-		/* Undo effects of setting up asm_text. */ \
+		/* Undo effects of setting up yytext. */ \
         int yyless_macro_arg = (n); \
         YY_LESS_LINENO(yyless_macro_arg);\
-		asm_text[asm_leng] = (yy_hold_char); \
-		(yy_c_buf_p) = asm_text + yyless_macro_arg; \
-		(yy_hold_char) = *(yy_c_buf_p); \
-		*(yy_c_buf_p) = '\0'; \
-		asm_leng = yyless_macro_arg; \
+		yytext[yyleng] = yyg->yy_hold_char; \
+		yyg->yy_c_buf_p = yytext + yyless_macro_arg; \
+		yyg->yy_hold_char = *yyg->yy_c_buf_p; \
+		*yyg->yy_c_buf_p = '\0'; \
+		yyleng = yyless_macro_arg; \
 		} \
 	while ( 0 )
 
 /* Accessor  methods (get/set functions) to struct members. */
 
+/** Get the user-defined data for this scanner.
+ * @param yyscanner The scanner object.
+ */
+YY_EXTRA_TYPE asm_get_extra  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyextra;
+}
+
 /** Get the current line number.
- * 
+ * @param yyscanner The scanner object.
  */
-int asm_get_lineno  (void)
+int asm_get_lineno  (yyscan_t yyscanner)
 {
-        
-    return asm_lineno;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        if (! YY_CURRENT_BUFFER)
+            return 0;
+
+    return yylineno;
+}
+
+/** Get the current column number.
+ * @param yyscanner The scanner object.
+ */
+int asm_get_column  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        if (! YY_CURRENT_BUFFER)
+            return 0;
+
+    return yycolumn;
 }
 
 /** Get the input stream.
- * 
+ * @param yyscanner The scanner object.
  */
-FILE *asm_get_in  (void)
+FILE *asm_get_in  (yyscan_t yyscanner)
 {
-        return asm_in;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyin;
 }
 
 /** Get the output stream.
- * 
+ * @param yyscanner The scanner object.
  */
-FILE *asm_get_out  (void)
+FILE *asm_get_out  (yyscan_t yyscanner)
 {
-        return asm_out;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyout;
 }
 
 /** Get the length of the current token.
- * 
+ * @param yyscanner The scanner object.
  */
-int asm_get_leng  (void)
+int asm_get_leng  (yyscan_t yyscanner)
 {
-        return asm_leng;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyleng;
 }
 
 /** Get the current token.
- * 
+ * @param yyscanner The scanner object.
  */
 
-char *asm_get_text  (void)
+char *asm_get_text  (yyscan_t yyscanner)
 {
-        return asm_text;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yytext;
+}
+
+/** Set the user-defined data. This data is never touched by the scanner.
+ * @param user_defined The data to be associated with this scanner.
+ * @param yyscanner The scanner object.
+ */
+void asm_set_extra (YY_EXTRA_TYPE  user_defined , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyextra = user_defined ;
 }
 
 /** Set the current line number.
  * @param line_number
- * 
+ * @param yyscanner The scanner object.
  */
-void asm_set_lineno (int  line_number )
+void asm_set_lineno (int  line_number , yyscan_t yyscanner)
 {
-    
-    asm_lineno = line_number;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        /* lineno is only valid if an input buffer exists. */
+        if (! YY_CURRENT_BUFFER )
+           yy_fatal_error( "asm_set_lineno called with no buffer" , yyscanner);
+
+    yylineno = line_number;
+}
+
+/** Set the current column.
+ * @param line_number
+ * @param yyscanner The scanner object.
+ */
+void asm_set_column (int  column_no , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        /* column is only valid if an input buffer exists. */
+        if (! YY_CURRENT_BUFFER )
+           yy_fatal_error( "asm_set_column called with no buffer" , yyscanner);
+
+    yycolumn = column_no;
 }
 
 /** Set the input stream. This does not discard the current
  * input buffer.
  * @param in_str A readable stream.
- * 
+ * @param yyscanner The scanner object.
  * @see asm__switch_to_buffer
  */
-void asm_set_in (FILE *  in_str )
+void asm_set_in (FILE *  in_str , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyin = in_str ;
+}
+
+void asm_set_out (FILE *  out_str , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyout = out_str ;
+}
+
+int asm_get_debug  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yy_flex_debug;
+}
+
+void asm_set_debug (int  bdebug , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yy_flex_debug = bdebug ;
+}
+
+/* Accessor methods for yylval and yylloc */
+
+YYSTYPE * asm_get_lval  (yyscan_t yyscanner)
 {
-        asm_in = in_str ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yylval;
 }
 
-void asm_set_out (FILE *  out_str )
+void asm_set_lval (YYSTYPE *  yylval_param , yyscan_t yyscanner)
 {
-        asm_out = out_str ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yylval = yylval_param;
 }
 
-int asm_get_debug  (void)
+YYLTYPE *asm_get_lloc  (yyscan_t yyscanner)
 {
-        return asm__flex_debug;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yylloc;
 }
 
-void asm_set_debug (int  bdebug )
+void asm_set_lloc (YYLTYPE *  yylloc_param , yyscan_t yyscanner)
 {
-        asm__flex_debug = bdebug ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yylloc = yylloc_param;
 }
 
-static int yy_init_globals (void)
+/* User-visible API */
+
+/* asm_lex_init is special because it creates the scanner itself, so it is
+ * the ONLY reentrant function that doesn't take the scanner as the last argument.
+ * That's why we explicitly handle the declaration, instead of using our macros.
+ */
+
+int asm_lex_init(yyscan_t* ptr_yy_globals)
+
 {
-        /* Initialization is the same as for the non-reentrant scanner.
+    if (ptr_yy_globals == NULL){
+        errno = EINVAL;
+        return 1;
+    }
+
+    *ptr_yy_globals = (yyscan_t) asm_alloc ( sizeof( struct yyguts_t ), NULL );
+
+    if (*ptr_yy_globals == NULL){
+        errno = ENOMEM;
+        return 1;
+    }
+
+    /* By setting to 0xAA, we expose bugs in yy_init_globals. Leave at 0x00 for releases. */
+    memset(*ptr_yy_globals,0x00,sizeof(struct yyguts_t));
+
+    return yy_init_globals ( *ptr_yy_globals );
+}
+
+/* asm_lex_init_extra has the same functionality as asm_lex_init, but follows the
+ * convention of taking the scanner as the last argument. Note however, that
+ * this is a *pointer* to a scanner, as it will be allocated by this call (and
+ * is the reason, too, why this function also must handle its own declaration).
+ * The user defined value in the first argument will be available to asm_alloc in
+ * the yyextra field.
+ */
+
+int asm_lex_init_extra(YY_EXTRA_TYPE yy_user_defined,yyscan_t* ptr_yy_globals )
+
+{
+    struct yyguts_t dummy_yyguts;
+
+    asm_set_extra (yy_user_defined, &dummy_yyguts);
+
+    if (ptr_yy_globals == NULL){
+        errno = EINVAL;
+        return 1;
+    }
+
+    *ptr_yy_globals = (yyscan_t) asm_alloc ( sizeof( struct yyguts_t ), &dummy_yyguts );
+
+    if (*ptr_yy_globals == NULL){
+        errno = ENOMEM;
+        return 1;
+    }
+
+    /* By setting to 0xAA, we expose bugs in
+    yy_init_globals. Leave at 0x00 for releases. */
+    memset(*ptr_yy_globals,0x00,sizeof(struct yyguts_t));
+
+    asm_set_extra (yy_user_defined, *ptr_yy_globals);
+
+    return yy_init_globals ( *ptr_yy_globals );
+}
+
+static int yy_init_globals (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    /* Initialization is the same as for the non-reentrant scanner.
      * This function is called from asm_lex_destroy(), so don't allocate here.
      */
 
-    /* We do not touch asm_lineno unless the option is enabled. */
-    asm_lineno =  1;
-    
-    (yy_buffer_stack) = 0;
-    (yy_buffer_stack_top) = 0;
-    (yy_buffer_stack_max) = 0;
-    (yy_c_buf_p) = (char *) 0;
-    (yy_init) = 0;
-    (yy_start) = 0;
+    yyg->yy_buffer_stack = 0;
+    yyg->yy_buffer_stack_top = 0;
+    yyg->yy_buffer_stack_max = 0;
+    yyg->yy_c_buf_p = (char *) 0;
+    yyg->yy_init = 0;
+    yyg->yy_start = 0;
 
-    (yy_start_stack_ptr) = 0;
-    (yy_start_stack_depth) = 0;
-    (yy_start_stack) =  NULL;
+    yyg->yy_start_stack_ptr = 0;
+    yyg->yy_start_stack_depth = 0;
+    yyg->yy_start_stack =  NULL;
 
 /* Defined in main.c */
 #ifdef YY_STDINIT
-    asm_in = stdin;
-    asm_out = stdout;
+    yyin = stdin;
+    yyout = stdout;
 #else
-    asm_in = (FILE *) 0;
-    asm_out = (FILE *) 0;
+    yyin = (FILE *) 0;
+    yyout = (FILE *) 0;
 #endif
 
     /* For future reference: Set errno on error, since we are called by
@@ -2266,28 +2457,32 @@ static int yy_init_globals (void)
 }
 
 /* asm_lex_destroy is for both reentrant and non-reentrant scanners. */
-int asm_lex_destroy  (void)
+int asm_lex_destroy  (yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
     /* Pop the buffer stack, destroying each element. */
 	while(YY_CURRENT_BUFFER){
-		asm__delete_buffer(YY_CURRENT_BUFFER  );
+		asm__delete_buffer(YY_CURRENT_BUFFER ,yyscanner );
 		YY_CURRENT_BUFFER_LVALUE = NULL;
-		asm_pop_buffer_state();
+		asm_pop_buffer_state(yyscanner);
 	}
 
 	/* Destroy the stack itself. */
-	asm_free((yy_buffer_stack) );
-	(yy_buffer_stack) = NULL;
+	asm_free(yyg->yy_buffer_stack ,yyscanner);
+	yyg->yy_buffer_stack = NULL;
 
     /* Destroy the start condition stack. */
-        asm_free((yy_start_stack)  );
-        (yy_start_stack) = NULL;
+        asm_free(yyg->yy_start_stack ,yyscanner );
+        yyg->yy_start_stack = NULL;
 
     /* Reset the globals. This is important in a non-reentrant scanner so the next time
      * asm_lex() is called, initialization will occur. */
-    yy_init_globals( );
+    yy_init_globals( yyscanner);
 
+    /* Destroy the main struct (reentrant only). */
+    asm_free ( yyscanner , yyscanner );
+    yyscanner = NULL;
     return 0;
 }
 
@@ -2296,7 +2491,7 @@ int asm_lex_destroy  (void)
  */
 
 #ifndef yytext_ptr
-static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
+static void yy_flex_strncpy (char* s1, yyconst char * s2, int n , yyscan_t yyscanner)
 {
 	register int i;
 	for ( i = 0; i < n; ++i )
@@ -2305,7 +2500,7 @@ static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
 #endif
 
 #ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * s )
+static int yy_flex_strlen (yyconst char * s , yyscan_t yyscanner)
 {
 	register int n;
 	for ( n = 0; s[n]; ++n )
@@ -2315,12 +2510,12 @@ static int yy_flex_strlen (yyconst char * s )
 }
 #endif
 
-void *asm_alloc (yy_size_t  size )
+void *asm_alloc (yy_size_t  size , yyscan_t yyscanner)
 {
 	return (void *) malloc( size );
 }
 
-void *asm_realloc  (void * ptr, yy_size_t  size )
+void *asm_realloc  (void * ptr, yy_size_t  size , yyscan_t yyscanner)
 {
 	/* The cast to (char *) in the following accommodates both
 	 * implementations that use char* generic pointers, and those
@@ -2332,21 +2527,38 @@ void *asm_realloc  (void * ptr, yy_size_t  size )
 	return (void *) realloc( (char *) ptr, size );
 }
 
-void asm_free (void * ptr )
+void asm_free (void * ptr , yyscan_t yyscanner)
 {
 	free( (char *) ptr );	/* see asm_realloc() for (char *) cast */
 }
 
 #define YYTABLES_NAME "yytables"
 
-#line 203 "asm_scan.l"
+#line 195 "asm_scan.l"
 
 
 
+/*
+ * asm_initscan: make a scanner for the parser.
+ *
+ *	@param[in]	param	parser parameter
+ *	@return		scanner
+ */
+void *
+asm_initscan(const struct parser_param *param)
+{
+	yyscan_t scanner;
+
+	if (asm_lex_init_extra(param, &scanner) != 0)
+		die("cannot initialize the scanner.");
+	return scanner;
+}
+/*
+ * asm_closescan: destroy the scanner.
+ */
 void
-asm_initscan(void)
+asm_closescan(void *scanner)
 {
-	LEXRESTART(NULL);
-	LEXLINENO = 1;
+	asm_lex_destroy(scanner);
 }
 
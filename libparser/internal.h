@@ -22,18 +22,58 @@
 #define _INTERNAL_H_
 
 #include "parser.h"
+#include "gparam.h"
+#include "linetable.h"
 #include "strbuf.h"
 #include "token.h"
 
+#define MAXPIFSTACK	100
+
+/**
+ * Context of a built-in parser.
+ *
+ * parse_file() prepares a new one for each invocation and passes it through
+ * @CODE{param->ctx}, so that built-in parsers don't keep their state in
+ * global variables. The scanners generated by flex (php and assembly) are
+ * reentrant, and take the parser parameter as their extra data.
+ */
+struct parser_context {
+	TOKENIZER *tk;			/**< tokenizer (C, yacc, C++ and java) */
+	LINETABLE *lt;			/**< line table (php and assembly) */
+	int level;			/**< brace level */
+	int piflevel;			/**< condition macro level */
+	int externclevel;		/**< @CODE{extern "C"} block level */
+	int namespacelevel;		/**< namespace block level */
+	/**
+	 * @name #ifdef stack.
+	 */
+	struct {
+		short start;		/**< level when @CODE{\#if} block started */
+		short end;		/**< level when @CODE{\#if} block end */
+		short if0only;		/**< @CODE{\#if 0} or notdef only */
+	} pifstack[MAXPIFSTACK], *cur;
+	/** @name php */
+	/** @{ */
+	STRBUF *string;			/**< string */
+	char end_of_here_document[IDENTLEN];
+	int pre_here_document;
+	/** @} */
+	/** @name assembly */
+	/** @{ */
+	STRBUF *symtable;		/**< symbol table */
+	int last_directive;
+	/** @} */
+};
+
 #define PUT(type, tag, lno, line) do {					\
-	DBG_PRINT(level, line);						\
-	param->put(type, tag, lno, curfile, line, param->arg);		\
+	DBG_PRINT(param->ctx->level, line);				\
+	param->put(type, tag, lno, param->file, line, param->arg);	\
 } while (0)
 
 #ifdef DEBUG
 #define DBG_PRINT(level, a) do {					\
 	if (param->flags & PARSER_DEBUG)				\
-		dbg_print(level, a);					\
+		dbg_print(param, level, a);				\
 } while (0)
 #else
 #define DBG_PRINT(level, a) do {} while (0)
@@ -47,10 +87,9 @@ void java(const struct parser_param *);
 void php(const struct parser_param *);
 void assembly(const struct parser_param *);
 
-void dbg_print(int, const char *);
+void dbg_print(const struct parser_param *, int, const char *);
 
-extern STRBUF *asm_symtable;
-void asm_initscan(void);
-int asm_lex(const struct parser_param *);
+void *asm_initscan(const struct parser_param *);
+void asm_closescan(void *);
 
 #endif
@@ -326,6 +326,49 @@ parser_exit(void)
 	free(langmap_saved);
 }
 
+/**
+ * select_parser: select a parser for a file.
+ *
+ *	@param[in]	path	path name
+ *	@param[out]	langp	language name
+ *	@param[out]	suffixp	suffix of the path
+ *	@return		language entry, or @CODE{NULL} if the file is not parsed
+ */
+static const struct lang_entry *
+select_parser(const char *path, const char **langp, const char **suffixp)
+{
+	const char *lang, *suffix;
+
+	/* get suffix of the path. */
+	suffix = locatestring(path, ".", MATCH_LAST);
+	if (suffix == NULL)
+		return NULL;
+	lang = decide_lang(suffix);
+	if (lang == NULL)
+		return NULL;
+	*langp = lang;
+	if (suffixp)
+		*suffixp = suffix;
+	/*
+	 * Select parser.
+	 * If lang == NULL then default parser is selected.
+	 */
+	return get_lang_entry(lang);
+}
+/**
+ * parser_lookup: get the language and the parser of a file.
+ *
+ *	@param[in]	path	path name
+ *	@param[out]	lang	language name
+ *	@return		parser name, or @CODE{NULL} if the file is not parsed
+ */
+const char *
+parser_lookup(const char *path, const char **lang)
+{
+	const struct lang_entry *ent = select_parser(path, lang, NULL);
+
+	return ent ? ent->parser_name : NULL;
+}
 /**
  * parse_file: select and execute a parser.
  *
@@ -342,18 +385,9 @@ parse_file(const char *path, int flags, PARSER_CALLBACK put, void *arg)
 	const struct lang_entry *ent;
 	struct parser_param param;
 
-	/* get suffix of the path. */
-	suffix = locatestring(path, ".", MATCH_LAST);
-	if (suffix == NULL)
-		return;
-	lang = decide_lang(suffix);
-	if (lang == NULL)
+	ent = select_parser(path, &lang, &suffix);
+	if (ent == NULL)
 		return;
-	/*
-	 * Select parser.
-	 * If lang == NULL then default parser is selected.
-	 */
-	ent = get_lang_entry(lang);
 	if (flags & PARSER_DEBUG) {
 		fprintf(stderr, "File '%s' is handled as follows:\n", path);
 		fprintf(stderr, "\tsuffix:   |%s|\n", suffix);
@@ -374,13 +408,15 @@ parse_file(const char *path, int flags, PARSER_CALLBACK put, void *arg)
 	param.die = die;
 	param.warning = warning;
 	param.message = message;
+	param.ctx = (struct parser_context *)check_calloc(sizeof(struct parser_context), 1);
 	ent->parser(&param);
+	free(param.ctx);
 }
 
 void
-dbg_print(int level, const char *s)
+dbg_print(const struct parser_param *param, int level, const char *s)
 {
-	fprintf(stderr, "[%04d]", lineno);
+	fprintf(stderr, "[%04d]", param->ctx->tk ? param->ctx->tk->lineno : 0);
 	for (; level > 0; level--)
 		fprintf(stderr, "    ");
 	fprintf(stderr, "%s\n", s);
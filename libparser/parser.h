@@ -53,6 +53,9 @@ void parser_exit(void);
 typedef void (*PARSER_CALLBACK)(int, const char *, int, const char *, const char *, void *);
 
 void parse_file(const char *, int, PARSER_CALLBACK, void *);
+const char *parser_lookup(const char *, const char **);
+
+struct parser_context;
 
 struct parser_param {
 	int size;		/**< size of this structure */
@@ -65,6 +68,7 @@ struct parser_param {
 	void (*die)(const char *, ...);
 	void (*warning)(const char *, ...);
 	void (*message)(const char *, ...);
+	struct parser_context *ctx;	/**< context of built-in parser */
 };
 
 #endif
@@ -6,25 +6,6 @@
 
 /* A lexical scanner generated by flex */
 
-#define yy_create_buffer php__create_buffer
-#define yy_delete_buffer php__delete_buffer
-#define yy_flex_debug php__flex_debug
-#define yy_init_buffer php__init_buffer
-#define yy_flush_buffer php__flush_buffer
-#define yy_load_buffer_state php__load_buffer_state
-#define yy_switch_to_buffer php__switch_to_buffer
-#define yyin php_in
-#define yyleng php_leng
-#define yylex php_lex
-#define yylineno php_lineno
-#define yyout php_out
-#define yyrestart php_restart
-#define yytext php_text
-#define yywrap php_wrap
-#define yyalloc php_alloc
-#define yyrealloc php_realloc
-#define yyfree php_free
-
 #define FLEX_SCANNER
 #define YY_FLEX_MAJOR_VERSION 2
 #define YY_FLEX_MINOR_VERSION 5
@@ -137,24 +118,43 @@ typedef unsigned int flex_uint32_t;
  */
 #define YY_SC_TO_UI(c) ((unsigned int) (unsigned char) c)
 
+/* An opaque pointer. */
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+/* For convenience, these vars (plus the bison vars far below)
+   are macros in the reentrant scanner. */
+#define yyin yyg->yyin_r
+#define yyout yyg->yyout_r
+#define yyextra yyg->yyextra_r
+#define yyleng yyg->yyleng_r
+#define yytext yyg->yytext_r
+#define yylineno (YY_CURRENT_BUFFER_LVALUE->yy_bs_lineno)
+#define yycolumn (YY_CURRENT_BUFFER_LVALUE->yy_bs_column)
+#define yy_flex_debug yyg->yy_flex_debug_r
+
+int php_lex_init (yyscan_t* scanner);
+
 /* Enter a start condition.  This macro really ought to take a parameter,
  * but we do it the disgusting crufty way forced on us by the ()-less
  * definition of BEGIN.
  */
-#define BEGIN (yy_start) = 1 + 2 *
+#define BEGIN yyg->yy_start = 1 + 2 *
 
 /* Translate the current start state into a value that can be later handed
  * to BEGIN to return to the state.  The YYSTATE alias is for lex
  * compatibility.
  */
-#define YY_START (((yy_start) - 1) / 2)
+#define YY_START ((yyg->yy_start - 1) / 2)
 #define YYSTATE YY_START
 
 /* Action number for EOF rule of a given start state. */
 #define YY_STATE_EOF(state) (YY_END_OF_BUFFER + state + 1)
 
 /* Special action meaning "start processing a new file". */
-#define YY_NEW_FILE php_restart(php_in  )
+#define YY_NEW_FILE php_restart(yyin ,yyscanner)
 
 #define YY_END_OF_BUFFER_CHAR 0
 
@@ -172,10 +172,6 @@ typedef unsigned int flex_uint32_t;
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 #endif
 
-extern int php_leng;
-
-extern FILE *php_in, *php_out;
-
 #define EOB_ACT_CONTINUE_SCAN 0
 #define EOB_ACT_END_OF_FILE 1
 #define EOB_ACT_LAST_MATCH 2
@@ -184,32 +180,32 @@ extern FILE *php_in, *php_out;
      *       access to the local variable yy_act. Since yyless() is a macro, it would break
      *       existing scanners that call yyless() from OUTSIDE php_lex. 
      *       One obvious solution it to make yy_act a global. I tried that, and saw
-     *       a 5% performance hit in a non-php_lineno scanner, because yy_act is
+     *       a 5% performance hit in a non-yylineno scanner, because yy_act is
      *       normally declared as a register variable-- so it is not worth it.
      */
     #define  YY_LESS_LINENO(n) \
             do { \
                 int yyl;\
-                for ( yyl = n; yyl < php_leng; ++yyl )\
-                    if ( php_text[yyl] == '\n' )\
-                        --php_lineno;\
+                for ( yyl = n; yyl < yyleng; ++yyl )\
+                    if ( yytext[yyl] == '\n' )\
+                        --yylineno;\
             }while(0)
     
 /* Return all but the first "n" matched characters back to the input stream. */
 #define yyless(n) \
 	do \
 		{ \
-		/* Undo effects of setting up php_text. */ \
+		/* Undo effects of setting up yytext. */ \
         int yyless_macro_arg = (n); \
         YY_LESS_LINENO(yyless_macro_arg);\
-		*yy_cp = (yy_hold_char); \
+		*yy_cp = yyg->yy_hold_char; \
 		YY_RESTORE_YY_MORE_OFFSET \
-		(yy_c_buf_p) = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
-		YY_DO_BEFORE_ACTION; /* set up php_text again */ \
+		yyg->yy_c_buf_p = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
+		YY_DO_BEFORE_ACTION; /* set up yytext again */ \
 		} \
 	while ( 0 )
 
-#define unput(c) yyunput( c, (yytext_ptr)  )
+#define unput(c) yyunput( c, yyg->yytext_ptr ,yyscanner)
 
 #ifndef YY_TYPEDEF_YY_SIZE_T
 #define YY_TYPEDEF_YY_SIZE_T
@@ -274,78 +270,58 @@ struct yy_buffer_state
 	 *
 	 * When we actually see the EOF, we change the status to "new"
 	 * (via php_restart()), so that the user can continue scanning by
-	 * just pointing php_in at a new input file.
+	 * just pointing yyin at a new input file.
 	 */
 #define YY_BUFFER_EOF_PENDING 2
 
 	};
 #endif /* !YY_STRUCT_YY_BUFFER_STATE */
 
-/* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
-
 /* We provide macros for accessing buffer states in case in the
  * future we want to put the buffer states in a more general
  * "scanner state".
  *
  * Returns the top of the stack, or NULL.
  */
-#define YY_CURRENT_BUFFER ( (yy_buffer_stack) \
-                          ? (yy_buffer_stack)[(yy_buffer_stack_top)] \
+#define YY_CURRENT_BUFFER ( yyg->yy_buffer_stack \
+                          ? yyg->yy_buffer_stack[yyg->yy_buffer_stack_top] \
                           : NULL)
 
 /* Same as previous macro, but useful when we know that the buffer stack is not
  * NULL or when we need an lvalue. For internal use only.
  */
-#define YY_CURRENT_BUFFER_LVALUE (yy_buffer_stack)[(yy_buffer_stack_top)]
+#define YY_CURRENT_BUFFER_LVALUE yyg->yy_buffer_stack[yyg->yy_buffer_stack_top]
 
-/* yy_hold_char holds the character lost when php_text is formed. */
-static char yy_hold_char;
-static int yy_n_chars;		/* number of characters read into yy_ch_buf */
-int php_leng;
+void php_restart (FILE *input_file ,yyscan_t yyscanner );
+void php__switch_to_buffer (YY_BUFFER_STATE new_buffer ,yyscan_t yyscanner );
+YY_BUFFER_STATE php__create_buffer (FILE *file,int size ,yyscan_t yyscanner );
+void php__delete_buffer (YY_BUFFER_STATE b ,yyscan_t yyscanner );
+void php__flush_buffer (YY_BUFFER_STATE b ,yyscan_t yyscanner );
+void php_push_buffer_state (YY_BUFFER_STATE new_buffer ,yyscan_t yyscanner );
+void php_pop_buffer_state (yyscan_t yyscanner );
 
-/* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
-
-/* Flag which is used to allow php_wrap()'s to do buffer switches
- * instead of setting up a fresh php_in.  A bit of a hack ...
- */
-static int yy_did_buffer_switch_on_eof;
+static void php_ensure_buffer_stack (yyscan_t yyscanner );
+static void php__load_buffer_state (yyscan_t yyscanner );
+static void php__init_buffer (YY_BUFFER_STATE b,FILE *file ,yyscan_t yyscanner );
 
-void php_restart (FILE *input_file  );
-void php__switch_to_buffer (YY_BUFFER_STATE new_buffer  );
-YY_BUFFER_STATE php__create_buffer (FILE *file,int size  );
-void php__delete_buffer (YY_BUFFER_STATE b  );
-void php__flush_buffer (YY_BUFFER_STATE b  );
-void php_push_buffer_state (YY_BUFFER_STATE new_buffer  );
-void php_pop_buffer_state (void );
+#define YY_FLUSH_BUFFER php__flush_buffer(YY_CURRENT_BUFFER ,yyscanner)
 
-static void php_ensure_buffer_stack (void );
-static void php__load_buffer_state (void );
-static void php__init_buffer (YY_BUFFER_STATE b,FILE *file  );
+YY_BUFFER_STATE php__scan_buffer (char *base,yy_size_t size ,yyscan_t yyscanner );
+YY_BUFFER_STATE php__scan_string (yyconst char *yy_str ,yyscan_t yyscanner );
+YY_BUFFER_STATE php__scan_bytes (yyconst char *bytes,int len ,yyscan_t yyscanner );
 
-#define YY_FLUSH_BUFFER php__flush_buffer(YY_CURRENT_BUFFER )
-
-YY_BUFFER_STATE php__scan_buffer (char *base,yy_size_t size  );
-YY_BUFFER_STATE php__scan_string (yyconst char *yy_str  );
-YY_BUFFER_STATE php__scan_bytes (yyconst char *bytes,int len  );
-
-void *php_alloc (yy_size_t  );
-void *php_realloc (void *,yy_size_t  );
-void php_free (void *  );
+void *php_alloc (yy_size_t ,yyscan_t yyscanner );
+void *php_realloc (void *,yy_size_t ,yyscan_t yyscanner );
+void php_free (void * ,yyscan_t yyscanner );
 
 #define yy_new_buffer php__create_buffer
 
 #define yy_set_interactive(is_interactive) \
 	{ \
 	if ( ! YY_CURRENT_BUFFER ){ \
-        php_ensure_buffer_stack (); \
+        php_ensure_buffer_stack (yyscanner ); \
 		YY_CURRENT_BUFFER_LVALUE =    \
-            php__create_buffer(php_in,YY_BUF_SIZE ); \
+            php__create_buffer(yyin,YY_BUF_SIZE ,yyscanner); \
 	} \
 	YY_CURRENT_BUFFER_LVALUE->yy_is_interactive = is_interactive; \
 	}
@@ -353,9 +329,9 @@ void php_free (void *  );
 #define yy_set_bol(at_bol) \
 	{ \
 	if ( ! YY_CURRENT_BUFFER ){\
-        php_ensure_buffer_stack (); \
+        php_ensure_buffer_stack (yyscanner ); \
 		YY_CURRENT_BUFFER_LVALUE =    \
-            php__create_buffer(php_in,YY_BUF_SIZE ); \
+            php__create_buffer(yyin,YY_BUF_SIZE ,yyscanner); \
 	} \
 	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = at_bol; \
 	}
@@ -369,31 +345,24 @@ void php_free (void *  );
 
 typedef unsigned char YY_CHAR;
 
-FILE *php_in = (FILE *) 0, *php_out = (FILE *) 0;
-
 typedef int yy_state_type;
 
-extern int php_lineno;
-
-int php_lineno = 1;
-
-extern char *php_text;
-#define yytext_ptr php_text
+#define yytext_ptr yytext_r
 
-static yy_state_type yy_get_previous_state (void );
-static yy_state_type yy_try_NUL_trans (yy_state_type current_state  );
-static int yy_get_next_buffer (void );
-static void yy_fatal_error (yyconst char msg[]  );
+static yy_state_type yy_get_previous_state (yyscan_t yyscanner );
+static yy_state_type yy_try_NUL_trans (yy_state_type current_state ,yyscan_t yyscanner );
+static int yy_get_next_buffer (yyscan_t yyscanner );
+static void yy_fatal_error (yyconst char msg[] ,yyscan_t yyscanner );
 
 /* Done after the current pattern has been matched and before the
- * corresponding action - sets up php_text.
+ * corresponding action - sets up yytext.
  */
 #define YY_DO_BEFORE_ACTION \
-	(yytext_ptr) = yy_bp; \
-	php_leng = (size_t) (yy_cp - yy_bp); \
-	(yy_hold_char) = *yy_cp; \
+	yyg->yytext_ptr = yy_bp; \
+	yyleng = (size_t) (yy_cp - yy_bp); \
+	yyg->yy_hold_char = *yy_cp; \
 	*yy_cp = '\0'; \
-	(yy_c_buf_p) = yy_cp;
+	yyg->yy_c_buf_p = yy_cp;
 
 #define YY_NUM_RULES 39
 #define YY_END_OF_BUFFER 40
@@ -674,12 +643,6 @@ static yyconst flex_int32_t yy_rule_can_match_eol[40] =
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
         };
 
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
-
-extern int php__flex_debug;
-int php__flex_debug = 0;
-
 /* The intent behind this definition is that it'll catch
  * any uses of REJECT which flex missed.
  */
@@ -687,7 +650,6 @@ int php__flex_debug = 0;
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
 #define YY_RESTORE_YY_MORE_OFFSET
-char *php_text;
 #line 1 "php.l"
 #line 2 "php.l"
 /*
@@ -730,14 +692,13 @@ char *php_text;
 #include "strbuf.h"
 #include "php_res.h"
 
-#define lex_symbol_generation_rule(x) php_ ## x
-#define LEXLEX lex_symbol_generation_rule(lex)
-#define LEXTEXT lex_symbol_generation_rule(text)
-#define LEXLENG lex_symbol_generation_rule(leng)
-#define LEXRESTART lex_symbol_generation_rule(restart)
-#define LEXLINENO lex_symbol_generation_rule(lineno)
-
-#define YY_DECL	int LEXLEX(const struct parser_param *param)
+/*
+ * The scanner is reentrant. The parser parameter is given as the extra data,
+ * and the line table is in the parser context.
+ */
+#define LEXTEXT php_get_text(scanner)
+#define LEXLENG php_get_leng(scanner)
+#define LEXLINENO php_get_lineno(scanner)
 
 #define PHP_TOKEN		1
 #define PHP_VARIABLE		2
@@ -752,10 +713,6 @@ char *php_text;
 #define PHP_RBRACK		']'
 
 static void debug_print(const char *, ...);
-static int level;			/* block nest level */
-static STRBUF *string;			/* string */
-static char end_of_here_document[IDENTLEN];
-static int pre_here_document;
 
 /*
  * For debug.
@@ -777,11 +734,11 @@ debug_print(const char *s, ...)
 #define YYLMAX 1024
 
 #undef ECHO
-#define ECHO DBG_PRINT("%s", LEXTEXT)
+#define ECHO DBG_PRINT("%s", yytext)
 
 #undef PUT
 #define PUT(type, tag, lno) do {					\
-	const char *line_image = linetable_get(lno, NULL);		\
+	const char *line_image = linetable_get(param->ctx->lt, lno, NULL);\
 	char *nl = strchr(line_image, '\n');				\
 	if (nl != NULL)							\
 		*nl = '\0';						\
@@ -795,13 +752,13 @@ debug_print(const char *s, ...)
  */
 #define YY_INPUT(buf,result,max_size) \
 	do { \
-		if ((result = linetable_read(buf, max_size)) == -1) \
+		if ((result = linetable_read(yyextra->ctx->lt, buf, max_size)) == -1) \
 			result = YY_NULL; \
 	} while (0)
 /* Definitions */
 /* We accept multi-bytes character */
 
-#line 805 "php.c"
+#line 762 "php.c"
 
 #define INITIAL 0
 #define PHP 1
@@ -817,40 +774,82 @@ debug_print(const char *s, ...)
 #include <unistd.h>
 #endif
 
+#define YY_EXTRA_TYPE const struct parser_param *
+
 #ifndef YY_EXTRA_TYPE
 #define YY_EXTRA_TYPE void *
 #endif
 
-static int yy_init_globals (void );
+/* Holds the entire state of the reentrant scanner. */
+struct yyguts_t
+    {
+
+    /* User-defined. Not touched by flex. */
+    YY_EXTRA_TYPE yyextra_r;
+
+    /* The rest are the same as the globals declared in the non-reentrant scanner. */
+    FILE *yyin_r, *yyout_r;
+    size_t yy_buffer_stack_top; /**< index of top of stack. */
+    size_t yy_buffer_stack_max; /**< capacity of stack. */
+    YY_BUFFER_STATE * yy_buffer_stack; /**< Stack as an array. */
+    char yy_hold_char;
+    int yy_n_chars;
+    int yyleng_r;
+    char *yy_c_buf_p;
+    int yy_init;
+    int yy_start;
+    int yy_did_buffer_switch_on_eof;
+    int yy_start_stack_ptr;
+    int yy_start_stack_depth;
+    int *yy_start_stack;
+    yy_state_type yy_last_accepting_state;
+    char* yy_last_accepting_cpos;
+
+    int yylineno_r;
+    int yy_flex_debug_r;
+
+    char *yytext_r;
+    int yy_more_flag;
+    int yy_more_len;
+
+    }; /* end struct yyguts_t */
+
+static int yy_init_globals (yyscan_t yyscanner );
+
+int php_lex_init_extra (YY_EXTRA_TYPE user_defined,yyscan_t* scanner);
 
 /* Accessor methods to globals.
    These are made visible to non-reentrant scanners for convenience. */
 
-int php_lex_destroy (void );
+int php_lex_destroy (yyscan_t yyscanner );
+
+int php_get_debug (yyscan_t yyscanner );
 
-int php_get_debug (void );
+void php_set_debug (int debug_flag ,yyscan_t yyscanner );
 
-void php_set_debug (int debug_flag  );
+YY_EXTRA_TYPE php_get_extra (yyscan_t yyscanner );
 
-YY_EXTRA_TYPE php_get_extra (void );
+void php_set_extra (YY_EXTRA_TYPE user_defined ,yyscan_t yyscanner );
 
-void php_set_extra (YY_EXTRA_TYPE user_defined  );
+FILE *php_get_in (yyscan_t yyscanner );
 
-FILE *php_get_in (void );
+void php_set_in  (FILE * in_str ,yyscan_t yyscanner );
 
-void php_set_in  (FILE * in_str  );
+FILE *php_get_out (yyscan_t yyscanner );
 
-FILE *php_get_out (void );
+void php_set_out  (FILE * out_str ,yyscan_t yyscanner );
 
-void php_set_out  (FILE * out_str  );
+int php_get_leng (yyscan_t yyscanner );
 
-int php_get_leng (void );
+char *php_get_text (yyscan_t yyscanner );
 
-char *php_get_text (void );
+int php_get_lineno (yyscan_t yyscanner );
 
-int php_get_lineno (void );
+void php_set_lineno (int line_number ,yyscan_t yyscanner );
 
-void php_set_lineno (int line_number  );
+int php_get_column  (yyscan_t yyscanner );
+
+void php_set_column (int column_no ,yyscan_t yyscanner );
 
 /* Macros after this point can all be overridden by user definitions in
  * section 1.
@@ -858,26 +857,26 @@ void php_set_lineno (int line_number  );
 
 #ifndef YY_SKIP_YYWRAP
 #ifdef __cplusplus
-extern "C" int php_wrap (void );
+extern "C" int php_wrap (yyscan_t yyscanner );
 #else
-extern int php_wrap (void );
+extern int php_wrap (yyscan_t yyscanner );
 #endif
 #endif
 
 #ifndef yytext_ptr
-static void yy_flex_strncpy (char *,yyconst char *,int );
+static void yy_flex_strncpy (char *,yyconst char *,int ,yyscan_t yyscanner );
 #endif
 
 #ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * );
+static int yy_flex_strlen (yyconst char * ,yyscan_t yyscanner );
 #endif
 
 #ifndef YY_NO_INPUT
 
 #ifdef __cplusplus
-static int yyinput (void );
+static int yyinput (yyscan_t yyscanner );
 #else
-static int input (void );
+static int input (yyscan_t yyscanner );
 #endif
 
 #endif
@@ -892,7 +891,7 @@ static int input (void );
 /* This used to be an fputs(), but since the string might contain NUL's,
  * we now use fwrite().
  */
-#define ECHO fwrite( php_text, php_leng, 1, php_out )
+#define ECHO fwrite( yytext, yyleng, 1, yyout )
 #endif
 
 /* Gets input and stuffs it into "buf".  number of characters read, or YY_NULL,
@@ -905,18 +904,18 @@ static int input (void );
 		int c = '*'; \
 		int n; \
 		for ( n = 0; n < max_size && \
-			     (c = getc( php_in )) != EOF && c != '\n'; ++n ) \
+			     (c = getc( yyin )) != EOF && c != '\n'; ++n ) \
 			buf[n] = (char) c; \
 		if ( c == '\n' ) \
 			buf[n++] = (char) c; \
-		if ( c == EOF && ferror( php_in ) ) \
+		if ( c == EOF && ferror( yyin ) ) \
 			YY_FATAL_ERROR( "input in flex scanner failed" ); \
 		result = n; \
 		} \
 	else \
 		{ \
 		errno=0; \
-		while ( (result = fread(buf, 1, max_size, php_in))==0 && ferror(php_in)) \
+		while ( (result = fread(buf, 1, max_size, yyin))==0 && ferror(yyin)) \
 			{ \
 			if( errno != EINTR) \
 				{ \
@@ -924,7 +923,7 @@ static int input (void );
 				break; \
 				} \
 			errno=0; \
-			clearerr(php_in); \
+			clearerr(yyin); \
 			} \
 		}\
 \
@@ -946,7 +945,7 @@ static int input (void );
 
 /* Report a fatal error. */
 #ifndef YY_FATAL_ERROR
-#define YY_FATAL_ERROR(msg) yy_fatal_error( msg )
+#define YY_FATAL_ERROR(msg) yy_fatal_error( msg ,yyscanner)
 #endif
 
 /* end tables serialization structures and prototypes */
@@ -957,12 +956,12 @@ static int input (void );
 #ifndef YY_DECL
 #define YY_DECL_IS_OURS 1
 
-extern int php_lex (void);
+extern int php_lex (yyscan_t yyscanner);
 
-#define YY_DECL int php_lex (void)
+#define YY_DECL int php_lex (yyscan_t yyscanner)
 #endif /* !YY_DECL */
 
-/* Code executed at the beginning of each rule, after php_text and php_leng
+/* Code executed at the beginning of each rule, after yytext and yyleng
  * have been set up.
  */
 #ifndef YY_USER_ACTION
@@ -975,9 +974,9 @@ extern int php_lex (void);
 #endif
 
 #define YY_RULE_SETUP \
-	if ( php_leng > 0 ) \
+	if ( yyleng > 0 ) \
 		YY_CURRENT_BUFFER_LVALUE->yy_at_bol = \
-				(php_text[php_leng - 1] == '\n'); \
+				(yytext[yyleng - 1] == '\n'); \
 	YY_USER_ACTION
 
 /** The main scanner function which does all the work.
@@ -987,50 +986,52 @@ YY_DECL
 	register yy_state_type yy_current_state;
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
-    
-#line 124 "php.l"
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+#line 120 "php.l"
 
-#line 994 "php.c"
+	const struct parser_param *param = yyextra;
+#line 995 "php.c"
 
-	if ( !(yy_init) )
+	if ( !yyg->yy_init )
 		{
-		(yy_init) = 1;
+		yyg->yy_init = 1;
 
 #ifdef YY_USER_INIT
 		YY_USER_INIT;
 #endif
 
-		if ( ! (yy_start) )
-			(yy_start) = 1;	/* first start state */
+		if ( ! yyg->yy_start )
+			yyg->yy_start = 1;	/* first start state */
 
-		if ( ! php_in )
-			php_in = stdin;
+		if ( ! yyin )
+			yyin = stdin;
 
-		if ( ! php_out )
-			php_out = stdout;
+		if ( ! yyout )
+			yyout = stdout;
 
 		if ( ! YY_CURRENT_BUFFER ) {
-			php_ensure_buffer_stack ();
+			php_ensure_buffer_stack (yyscanner );
 			YY_CURRENT_BUFFER_LVALUE =
-				php__create_buffer(php_in,YY_BUF_SIZE );
+				php__create_buffer(yyin,YY_BUF_SIZE ,yyscanner);
 		}
 
-		php__load_buffer_state( );
+		php__load_buffer_state(yyscanner );
 		}
 
 	while ( 1 )		/* loops until end-of-file is reached */
 		{
-		yy_cp = (yy_c_buf_p);
+		yy_cp = yyg->yy_c_buf_p;
 
-		/* Support of php_text. */
-		*yy_cp = (yy_hold_char);
+		/* Support of yytext. */
+		*yy_cp = yyg->yy_hold_char;
 
 		/* yy_bp points to the position in yy_ch_buf of the start of
 		 * the current run.
 		 */
 		yy_bp = yy_cp;
 
-		yy_current_state = (yy_start);
+		yy_current_state = yyg->yy_start;
 		yy_current_state += YY_AT_BOL();
 yy_match:
 		do
@@ -1038,8 +1039,8 @@ yy_match:
 			register YY_CHAR yy_c = yy_ec[YY_SC_TO_UI(*yy_cp)];
 			if ( yy_accept[yy_current_state] )
 				{
-				(yy_last_accepting_state) = yy_current_state;
-				(yy_last_accepting_cpos) = yy_cp;
+				yyg->yy_last_accepting_state = yy_current_state;
+				yyg->yy_last_accepting_cpos = yy_cp;
 				}
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
@@ -1051,8 +1052,8 @@ yy_match:
 			++yy_cp;
 			}
 		while ( yy_current_state != 186 );
-		yy_cp = (yy_last_accepting_cpos);
-		yy_current_state = (yy_last_accepting_state);
+		yy_cp = yyg->yy_last_accepting_cpos;
+		yy_current_state = yyg->yy_last_accepting_state;
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1062,10 +1063,12 @@ yy_find_action:
 		if ( yy_act != YY_END_OF_BUFFER && yy_rule_can_match_eol[yy_act] )
 			{
 			int yyl;
-			for ( yyl = 0; yyl < php_leng; ++yyl )
-				if ( php_text[yyl] == '\n' )
+			for ( yyl = 0; yyl < yyleng; ++yyl )
+				if ( yytext[yyl] == '\n' )
 					   
-    php_lineno++;
+    do{ yylineno++;
+        yycolumn=0;
+    }while(0)
 ;
 			}
 
@@ -1075,20 +1078,20 @@ do_action:	/* This label is used only to access EOF actions. */
 	{ /* beginning of action switch */
 			case 0: /* must back up */
 			/* undo the effects of YY_DO_BEFORE_ACTION */
-			*yy_cp = (yy_hold_char);
-			yy_cp = (yy_last_accepting_cpos);
-			yy_current_state = (yy_last_accepting_state);
+			*yy_cp = yyg->yy_hold_char;
+			yy_cp = yyg->yy_last_accepting_cpos;
+			yy_current_state = yyg->yy_last_accepting_state;
 			goto yy_find_action;
 
 case 1:
 /* rule 1 can match eol */
 YY_RULE_SETUP
-#line 125 "php.l"
+#line 122 "php.l"
 {
 				ECHO;
-				if (pre_here_document == 1) {
-					pre_here_document = 0;
-					DBG_PRINT("[BEGIN HEREDOCUMENT:%s]\n", end_of_here_document);
+				if (param->ctx->pre_here_document == 1) {
+					param->ctx->pre_here_document = 0;
+					DBG_PRINT("[BEGIN HEREDOCUMENT:%s]\n", param->ctx->end_of_here_document);
 					BEGIN HEREDOCUMENT;
 				}
 			}
@@ -1096,63 +1099,63 @@ YY_RULE_SETUP
 /* Start PHP */
 case 2:
 YY_RULE_SETUP
-#line 134 "php.l"
+#line 131 "php.l"
 ECHO; BEGIN PHP;
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 135 "php.l"
+#line 132 "php.l"
 ECHO; BEGIN PHP;
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 136 "php.l"
+#line 133 "php.l"
 ECHO; BEGIN PHP;
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 137 "php.l"
+#line 134 "php.l"
 ECHO; BEGIN PHP;
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 138 "php.l"
+#line 135 "php.l"
 ECHO; BEGIN PHP;
 	YY_BREAK
 /* Ignore HTML */
 case 7:
 YY_RULE_SETUP
-#line 140 "php.l"
+#line 137 "php.l"
 ECHO;
 	YY_BREAK
 /* End of PHP */
 case 8:
 YY_RULE_SETUP
-#line 142 "php.l"
+#line 139 "php.l"
 ECHO; BEGIN INITIAL;
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 143 "php.l"
+#line 140 "php.l"
 ECHO; BEGIN INITIAL;
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 144 "php.l"
+#line 141 "php.l"
 ECHO; BEGIN INITIAL;
 	YY_BREAK
 /* Comment */
 case 11:
 YY_RULE_SETUP
-#line 147 "php.l"
+#line 144 "php.l"
 {
 				int c;
 
 				DBG_PRINT("</*");
-				while ((c = input()) != EOF) {
+				while ((c = input(yyscanner)) != EOF) {
 					DBG_PRINT("%c", c);
 					if (c == '*') {
-						while ((c = input()) != EOF && c == '*')
+						while ((c = input(yyscanner)) != EOF && c == '*')
 							DBG_PRINT("%c", c);
 						DBG_PRINT("%c", c);
 						if (c == EOF || c == '/')
@@ -1166,25 +1169,25 @@ YY_RULE_SETUP
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 165 "php.l"
-DBG_PRINT("<%s>", LEXTEXT);
+#line 162 "php.l"
+DBG_PRINT("<%s>", yytext);
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 166 "php.l"
-DBG_PRINT("<%s>", LEXTEXT);
+#line 163 "php.l"
+DBG_PRINT("<%s>", yytext);
 	YY_BREAK
 /* String */
 case 14:
 YY_RULE_SETUP
-#line 169 "php.l"
-{ strbuf_reset(string); BEGIN STRING; }
+#line 166 "php.l"
+{ strbuf_reset(param->ctx->string); BEGIN STRING; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 170 "php.l"
+#line 167 "php.l"
 {
-				DBG_PRINT("<S:%s>", strbuf_value(string));
+				DBG_PRINT("<S:%s>", strbuf_value(param->ctx->string));
 				BEGIN PHP;
 					
 				return PHP_STRING;
@@ -1192,25 +1195,25 @@ YY_RULE_SETUP
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 176 "php.l"
-strbuf_puts(string, LEXTEXT);
+#line 173 "php.l"
+strbuf_puts(param->ctx->string, yytext);
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 177 "php.l"
-strbuf_putc(string, LEXTEXT[0]);
+#line 174 "php.l"
+strbuf_putc(param->ctx->string, yytext[0]);
 	YY_BREAK
 /* Literal */
 case 18:
 YY_RULE_SETUP
-#line 180 "php.l"
-{ strbuf_reset(string); BEGIN LITERAL; }
+#line 177 "php.l"
+{ strbuf_reset(param->ctx->string); BEGIN LITERAL; }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 181 "php.l"
+#line 178 "php.l"
 {
-				DBG_PRINT("<L:%s>", strbuf_value(string));
+				DBG_PRINT("<L:%s>", strbuf_value(param->ctx->string));
 				BEGIN PHP;
 					
 				return PHP_STRING;
@@ -1218,37 +1221,37 @@ YY_RULE_SETUP
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 187 "php.l"
-strbuf_puts(string, LEXTEXT);
+#line 184 "php.l"
+strbuf_puts(param->ctx->string, yytext);
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 188 "php.l"
-strbuf_putc(string, LEXTEXT[0]);
+#line 185 "php.l"
+strbuf_putc(param->ctx->string, yytext[0]);
 	YY_BREAK
 /* Here document */
 case 22:
 YY_RULE_SETUP
-#line 191 "php.l"
+#line 188 "php.l"
 {
-				DBG_PRINT("<L:%s>", LEXTEXT);
+				DBG_PRINT("<L:%s>", yytext);
 				/* extract word and save */
-				if (LEXLENG - 3 > IDENTLEN)
-					die("Too long name '%s'.", LEXTEXT + 3);
-				strcpy(end_of_here_document, LEXTEXT + 3);
+				if (yyleng - 3 > IDENTLEN)
+					die("Too long name '%s'.", yytext + 3);
+				strcpy(param->ctx->end_of_here_document, yytext + 3);
 				/* begin here document from the next line */
-				pre_here_document = 1;
+				param->ctx->pre_here_document = 1;
 			}
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 200 "php.l"
+#line 197 "php.l"
 {
-				const char *keyword = strtrim((const char *)LEXTEXT, TRIM_HEAD, NULL);
+				const char *keyword = strtrim((const char *)yytext, TRIM_HEAD, NULL);
 				ECHO;
-				if (!strcmp(end_of_here_document, keyword)) {
+				if (!strcmp(param->ctx->end_of_here_document, keyword)) {
 					DBG_PRINT("[END HEREDOCUMENT]");
-					end_of_here_document[0] = '\0';
+					param->ctx->end_of_here_document[0] = '\0';
 					BEGIN PHP;
 				}
 			}
@@ -1256,70 +1259,70 @@ YY_RULE_SETUP
 /* Cast */
 case 24:
 YY_RULE_SETUP
-#line 211 "php.l"
+#line 208 "php.l"
 
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 212 "php.l"
+#line 209 "php.l"
 
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 213 "php.l"
+#line 210 "php.l"
 {
 				/*
 				 * 0123456	php_leng = 6
 				 * ${abc}\0
 				 */
 				if (YY_START == STRING)
-					strbuf_puts(string, LEXTEXT);
-				memcpy(LEXTEXT, &LEXTEXT[2], LEXLENG - 3);
-				LEXTEXT[LEXLENG - 3] = '\0';
-				LEXLENG = LEXLENG - 3;
-				DBG_PRINT("<V:%s>", LEXTEXT);
+					strbuf_puts(param->ctx->string, yytext);
+				memcpy(yytext, &yytext[2], yyleng - 3);
+				yytext[yyleng - 3] = '\0';
+				yyleng = yyleng - 3;
+				DBG_PRINT("<V:%s>", yytext);
 
 				return PHP_VARIABLE;
 			}
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 227 "php.l"
+#line 224 "php.l"
 {
 				/*
 				 * 01234	php_leng = 4
 				 * $abc\0
 				 */
 				if (YY_START == STRING)
-					strbuf_puts(string, LEXTEXT);
-				memcpy(LEXTEXT, &LEXTEXT[1], LEXLENG - 1);
-				LEXTEXT[LEXLENG - 1] = '\0';
-				LEXLENG = LEXLENG - 1;
-				DBG_PRINT("<V:%s>", LEXTEXT);
+					strbuf_puts(param->ctx->string, yytext);
+				memcpy(yytext, &yytext[1], yyleng - 1);
+				yytext[yyleng - 1] = '\0';
+				yyleng = yyleng - 1;
+				DBG_PRINT("<V:%s>", yytext);
 
 				return PHP_VARIABLE;
 			}
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 241 "php.l"
+#line 238 "php.l"
 ECHO;
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 243 "php.l"
-DBG_PRINT("<N:%s>", LEXTEXT);
+#line 240 "php.l"
+DBG_PRINT("<N:%s>", yytext);
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 244 "php.l"
+#line 241 "php.l"
 {
-				int id = php_reserved_word(LEXTEXT, LEXLENG);
+				int id = php_reserved_word(yytext, yyleng);
 				if (id) {
-					DBG_PRINT("<Reserved:%s>", LEXTEXT);
+					DBG_PRINT("<Reserved:%s>", yytext);
 					return id;
 				} else {
-					DBG_PRINT("<T:%s>", LEXTEXT);
+					DBG_PRINT("<T:%s>", yytext);
 					return PHP_TOKEN;
 				}
 			}
@@ -1327,61 +1330,61 @@ YY_RULE_SETUP
 /* Operator */
 case 31:
 YY_RULE_SETUP
-#line 255 "php.l"
+#line 252 "php.l"
 {
-				int c = LEXTEXT[0];
+				int c = yytext[0];
 				if (c == PHP_LBRACE)
-					level++;
+					param->ctx->level++;
 				else
-					level--;
-				DBG_PRINT("%c[%d]", c, level);
+					param->ctx->level--;
+				DBG_PRINT("%c[%d]", c, param->ctx->level);
 
 				return c;
 			}
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 265 "php.l"
+#line 262 "php.l"
 {
-				return LEXTEXT[0];
+				return yytext[0];
 			}
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 268 "php.l"
+#line 265 "php.l"
 ECHO;
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 269 "php.l"
+#line 266 "php.l"
 ECHO;
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 270 "php.l"
+#line 267 "php.l"
 ECHO;
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 271 "php.l"
+#line 268 "php.l"
 ECHO;
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 272 "php.l"
+#line 269 "php.l"
 { ECHO; return PHP_DOLLAR; }
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 273 "php.l"
+#line 270 "php.l"
 ECHO;
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 275 "php.l"
+#line 271 "php.l"
 ECHO;
 	YY_BREAK
-#line 1385 "php.c"
+#line 1388 "php.c"
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(PHP):
 case YY_STATE_EOF(STRING):
@@ -1392,25 +1395,25 @@ case YY_STATE_EOF(HEREDOCUMENT):
 	case YY_END_OF_BUFFER:
 		{
 		/* Amount of text matched not including the EOB char. */
-		int yy_amount_of_matched_text = (int) (yy_cp - (yytext_ptr)) - 1;
+		int yy_amount_of_matched_text = (int) (yy_cp - yyg->yytext_ptr) - 1;
 
 		/* Undo the effects of YY_DO_BEFORE_ACTION. */
-		*yy_cp = (yy_hold_char);
+		*yy_cp = yyg->yy_hold_char;
 		YY_RESTORE_YY_MORE_OFFSET
 
 		if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_NEW )
 			{
 			/* We're scanning a new file or input source.  It's
 			 * possible that this happened because the user
-			 * just pointed php_in at a new source and called
+			 * just pointed yyin at a new source and called
 			 * php_lex().  If so, then we have to assure
 			 * consistency between YY_CURRENT_BUFFER and our
 			 * globals.  Here is the right place to do so, because
 			 * this is the first action (other than possibly a
 			 * back-up) that will match for the new input source.
 			 */
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-			YY_CURRENT_BUFFER_LVALUE->yy_input_file = php_in;
+			yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
+			YY_CURRENT_BUFFER_LVALUE->yy_input_file = yyin;
 			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status = YY_BUFFER_NORMAL;
 			}
 
@@ -1421,13 +1424,13 @@ case YY_STATE_EOF(HEREDOCUMENT):
 		 * end-of-buffer state).  Contrast this with the test
 		 * in input().
 		 */
-		if ( (yy_c_buf_p) <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
+		if ( yyg->yy_c_buf_p <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] )
 			{ /* This was really a NUL. */
 			yy_state_type yy_next_state;
 
-			(yy_c_buf_p) = (yytext_ptr) + yy_amount_of_matched_text;
+			yyg->yy_c_buf_p = yyg->yytext_ptr + yy_amount_of_matched_text;
 
-			yy_current_state = yy_get_previous_state(  );
+			yy_current_state = yy_get_previous_state( yyscanner );
 
 			/* Okay, we're now positioned to make the NUL
 			 * transition.  We couldn't have
@@ -1438,44 +1441,44 @@ case YY_STATE_EOF(HEREDOCUMENT):
 			 * will run more slowly).
 			 */
 
-			yy_next_state = yy_try_NUL_trans( yy_current_state );
+			yy_next_state = yy_try_NUL_trans( yy_current_state ,yyscanner);
 
-			yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+			yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 
 			if ( yy_next_state )
 				{
 				/* Consume the NUL. */
-				yy_cp = ++(yy_c_buf_p);
+				yy_cp = ++yyg->yy_c_buf_p;
 				yy_current_state = yy_next_state;
 				goto yy_match;
 				}
 
 			else
 				{
-				yy_cp = (yy_last_accepting_cpos);
-				yy_current_state = (yy_last_accepting_state);
+				yy_cp = yyg->yy_last_accepting_cpos;
+				yy_current_state = yyg->yy_last_accepting_state;
 				goto yy_find_action;
 				}
 			}
 
-		else switch ( yy_get_next_buffer(  ) )
+		else switch ( yy_get_next_buffer( yyscanner ) )
 			{
 			case EOB_ACT_END_OF_FILE:
 				{
-				(yy_did_buffer_switch_on_eof) = 0;
+				yyg->yy_did_buffer_switch_on_eof = 0;
 
-				if ( php_wrap( ) )
+				if ( php_wrap(yyscanner ) )
 					{
 					/* Note: because we've taken care in
 					 * yy_get_next_buffer() to have set up
-					 * php_text, we can now set up
+					 * yytext, we can now set up
 					 * yy_c_buf_p so that if some total
 					 * hoser (like flex itself) wants to
 					 * call the scanner after we return the
 					 * YY_NULL, it'll still work - another
 					 * YY_NULL will get returned.
 					 */
-					(yy_c_buf_p) = (yytext_ptr) + YY_MORE_ADJ;
+					yyg->yy_c_buf_p = yyg->yytext_ptr + YY_MORE_ADJ;
 
 					yy_act = YY_STATE_EOF(YY_START);
 					goto do_action;
@@ -1483,30 +1486,30 @@ case YY_STATE_EOF(HEREDOCUMENT):
 
 				else
 					{
-					if ( ! (yy_did_buffer_switch_on_eof) )
+					if ( ! yyg->yy_did_buffer_switch_on_eof )
 						YY_NEW_FILE;
 					}
 				break;
 				}
 
 			case EOB_ACT_CONTINUE_SCAN:
-				(yy_c_buf_p) =
-					(yytext_ptr) + yy_amount_of_matched_text;
+				yyg->yy_c_buf_p =
+					yyg->yytext_ptr + yy_amount_of_matched_text;
 
-				yy_current_state = yy_get_previous_state(  );
+				yy_current_state = yy_get_previous_state( yyscanner );
 
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+				yy_cp = yyg->yy_c_buf_p;
+				yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 				goto yy_match;
 
 			case EOB_ACT_LAST_MATCH:
-				(yy_c_buf_p) =
-				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)];
+				yyg->yy_c_buf_p =
+				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars];
 
-				yy_current_state = yy_get_previous_state(  );
+				yy_current_state = yy_get_previous_state( yyscanner );
 
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+				yy_cp = yyg->yy_c_buf_p;
+				yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 				goto yy_find_action;
 			}
 		break;
@@ -1526,20 +1529,21 @@ case YY_STATE_EOF(HEREDOCUMENT):
  *	EOB_ACT_CONTINUE_SCAN - continue scanning from current position
  *	EOB_ACT_END_OF_FILE - end of file
  */
-static int yy_get_next_buffer (void)
+static int yy_get_next_buffer (yyscan_t yyscanner)
 {
-    	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
-	register char *source = (yytext_ptr);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
+	register char *source = yyg->yytext_ptr;
 	register int number_to_move, i;
 	int ret_val;
 
-	if ( (yy_c_buf_p) > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] )
+	if ( yyg->yy_c_buf_p > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars + 1] )
 		YY_FATAL_ERROR(
 		"fatal flex scanner internal error--end of buffer missed" );
 
 	if ( YY_CURRENT_BUFFER_LVALUE->yy_fill_buffer == 0 )
 		{ /* Don't try to fill the buffer, so this is an EOF. */
-		if ( (yy_c_buf_p) - (yytext_ptr) - YY_MORE_ADJ == 1 )
+		if ( yyg->yy_c_buf_p - yyg->yytext_ptr - YY_MORE_ADJ == 1 )
 			{
 			/* We matched a single character, the EOB, so
 			 * treat this as a final EOF.
@@ -1559,7 +1563,7 @@ static int yy_get_next_buffer (void)
 	/* Try to read more data. */
 
 	/* First move last chars to start of buffer. */
-	number_to_move = (int) ((yy_c_buf_p) - (yytext_ptr)) - 1;
+	number_to_move = (int) (yyg->yy_c_buf_p - yyg->yytext_ptr) - 1;
 
 	for ( i = 0; i < number_to_move; ++i )
 		*(dest++) = *(source++);
@@ -1568,7 +1572,7 @@ static int yy_get_next_buffer (void)
 		/* don't do the read, it's not guaranteed to return an EOF,
 		 * just force an EOF
 		 */
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars) = 0;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars = 0;
 
 	else
 		{
@@ -1582,7 +1586,7 @@ static int yy_get_next_buffer (void)
 			YY_BUFFER_STATE b = YY_CURRENT_BUFFER;
 
 			int yy_c_buf_p_offset =
-				(int) ((yy_c_buf_p) - b->yy_ch_buf);
+				(int) (yyg->yy_c_buf_p - b->yy_ch_buf);
 
 			if ( b->yy_is_our_buffer )
 				{
@@ -1595,7 +1599,7 @@ static int yy_get_next_buffer (void)
 
 				b->yy_ch_buf = (char *)
 					/* Include room in for 2 EOB chars. */
-					php_realloc((void *) b->yy_ch_buf,b->yy_buf_size + 2  );
+					php_realloc((void *) b->yy_ch_buf,b->yy_buf_size + 2 ,yyscanner);
 				}
 			else
 				/* Can't grow it, we don't own it. */
@@ -1605,7 +1609,7 @@ static int yy_get_next_buffer (void)
 				YY_FATAL_ERROR(
 				"fatal error - scanner input buffer overflow" );
 
-			(yy_c_buf_p) = &b->yy_ch_buf[yy_c_buf_p_offset];
+			yyg->yy_c_buf_p = &b->yy_ch_buf[yy_c_buf_p_offset];
 
 			num_to_read = YY_CURRENT_BUFFER_LVALUE->yy_buf_size -
 						number_to_move - 1;
@@ -1617,17 +1621,17 @@ static int yy_get_next_buffer (void)
 
 		/* Read in more data. */
 		YY_INPUT( (&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[number_to_move]),
-			(yy_n_chars), (size_t) num_to_read );
+			yyg->yy_n_chars, (size_t) num_to_read );
 
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
-	if ( (yy_n_chars) == 0 )
+	if ( yyg->yy_n_chars == 0 )
 		{
 		if ( number_to_move == YY_MORE_ADJ )
 			{
 			ret_val = EOB_ACT_END_OF_FILE;
-			php_restart(php_in  );
+			php_restart(yyin ,yyscanner);
 			}
 
 		else
@@ -1641,40 +1645,41 @@ static int yy_get_next_buffer (void)
 	else
 		ret_val = EOB_ACT_CONTINUE_SCAN;
 
-	if ((yy_size_t) ((yy_n_chars) + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
+	if ((yy_size_t) (yyg->yy_n_chars + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
 		/* Extend the array by 50%, plus the number we really need. */
-		yy_size_t new_size = (yy_n_chars) + number_to_move + ((yy_n_chars) >> 1);
-		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) php_realloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size  );
+		yy_size_t new_size = yyg->yy_n_chars + number_to_move + (yyg->yy_n_chars >> 1);
+		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) php_realloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size ,yyscanner);
 		if ( ! YY_CURRENT_BUFFER_LVALUE->yy_ch_buf )
 			YY_FATAL_ERROR( "out of dynamic memory in yy_get_next_buffer()" );
 	}
 
-	(yy_n_chars) += number_to_move;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] = YY_END_OF_BUFFER_CHAR;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] = YY_END_OF_BUFFER_CHAR;
+	yyg->yy_n_chars += number_to_move;
+	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] = YY_END_OF_BUFFER_CHAR;
+	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars + 1] = YY_END_OF_BUFFER_CHAR;
 
-	(yytext_ptr) = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
+	yyg->yytext_ptr = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
 
 	return ret_val;
 }
 
 /* yy_get_previous_state - get the state just before the EOB char was reached */
 
-    static yy_state_type yy_get_previous_state (void)
+    static yy_state_type yy_get_previous_state (yyscan_t yyscanner)
 {
 	register yy_state_type yy_current_state;
 	register char *yy_cp;
-    
-	yy_current_state = (yy_start);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	yy_current_state = yyg->yy_start;
 	yy_current_state += YY_AT_BOL();
 
-	for ( yy_cp = (yytext_ptr) + YY_MORE_ADJ; yy_cp < (yy_c_buf_p); ++yy_cp )
+	for ( yy_cp = yyg->yytext_ptr + YY_MORE_ADJ; yy_cp < yyg->yy_c_buf_p; ++yy_cp )
 		{
 		register YY_CHAR yy_c = (*yy_cp ? yy_ec[YY_SC_TO_UI(*yy_cp)] : 1);
 		if ( yy_accept[yy_current_state] )
 			{
-			(yy_last_accepting_state) = yy_current_state;
-			(yy_last_accepting_cpos) = yy_cp;
+			yyg->yy_last_accepting_state = yy_current_state;
+			yyg->yy_last_accepting_cpos = yy_cp;
 			}
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
@@ -1693,16 +1698,17 @@ static int yy_get_next_buffer (void)
  * synopsis
  *	next_state = yy_try_NUL_trans( current_state );
  */
-    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state )
+    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state , yyscan_t yyscanner)
 {
 	register int yy_is_jam;
-    	register char *yy_cp = (yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner; /* This var may be unused depending upon options. */
+	register char *yy_cp = yyg->yy_c_buf_p;
 
 	register YY_CHAR yy_c = 1;
 	if ( yy_accept[yy_current_state] )
 		{
-		(yy_last_accepting_state) = yy_current_state;
-		(yy_last_accepting_cpos) = yy_cp;
+		yyg->yy_last_accepting_state = yy_current_state;
+		yyg->yy_last_accepting_cpos = yy_cp;
 		}
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
@@ -1718,32 +1724,33 @@ static int yy_get_next_buffer (void)
 
 #ifndef YY_NO_INPUT
 #ifdef __cplusplus
-    static int yyinput (void)
+    static int yyinput (yyscan_t yyscanner)
 #else
-    static int input  (void)
+    static int input  (yyscan_t yyscanner)
 #endif
 
 {
 	int c;
-    
-	*(yy_c_buf_p) = (yy_hold_char);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	*yyg->yy_c_buf_p = yyg->yy_hold_char;
 
-	if ( *(yy_c_buf_p) == YY_END_OF_BUFFER_CHAR )
+	if ( *yyg->yy_c_buf_p == YY_END_OF_BUFFER_CHAR )
 		{
 		/* yy_c_buf_p now points to the character we want to return.
 		 * If this occurs *before* the EOB characters, then it's a
 		 * valid NUL; if not, then we've hit the end of the buffer.
 		 */
-		if ( (yy_c_buf_p) < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
+		if ( yyg->yy_c_buf_p < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] )
 			/* This was really a NUL. */
-			*(yy_c_buf_p) = '\0';
+			*yyg->yy_c_buf_p = '\0';
 
 		else
 			{ /* need more input */
-			int offset = (yy_c_buf_p) - (yytext_ptr);
-			++(yy_c_buf_p);
+			int offset = yyg->yy_c_buf_p - yyg->yytext_ptr;
+			++yyg->yy_c_buf_p;
 
-			switch ( yy_get_next_buffer(  ) )
+			switch ( yy_get_next_buffer( yyscanner ) )
 				{
 				case EOB_ACT_LAST_MATCH:
 					/* This happens because yy_g_n_b()
@@ -1757,39 +1764,41 @@ static int yy_get_next_buffer (void)
 					 */
 
 					/* Reset buffer status. */
-					php_restart(php_in );
+					php_restart(yyin ,yyscanner);
 
 					/*FALLTHROUGH*/
 
 				case EOB_ACT_END_OF_FILE:
 					{
-					if ( php_wrap( ) )
+					if ( php_wrap(yyscanner ) )
 						return EOF;
 
-					if ( ! (yy_did_buffer_switch_on_eof) )
+					if ( ! yyg->yy_did_buffer_switch_on_eof )
 						YY_NEW_FILE;
 #ifdef __cplusplus
-					return yyinput();
+					return yyinput(yyscanner );
 #else
-					return input();
+					return input(yyscanner );
 #endif
 					}
 
 				case EOB_ACT_CONTINUE_SCAN:
-					(yy_c_buf_p) = (yytext_ptr) + offset;
+					yyg->yy_c_buf_p = yyg->yytext_ptr + offset;
 					break;
 				}
 			}
 		}
 
-	c = *(unsigned char *) (yy_c_buf_p);	/* cast for 8-bit char's */
-	*(yy_c_buf_p) = '\0';	/* preserve php_text */
-	(yy_hold_char) = *++(yy_c_buf_p);
+	c = *(unsigned char *) yyg->yy_c_buf_p;	/* cast for 8-bit char's */
+	*yyg->yy_c_buf_p = '\0';	/* preserve yytext */
+	yyg->yy_hold_char = *++yyg->yy_c_buf_p;
 
 	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = (c == '\n');
 	if ( YY_CURRENT_BUFFER_LVALUE->yy_at_bol )
 		   
-    php_lineno++;
+    do{ yylineno++;
+        yycolumn=0;
+    }while(0)
 ;
 
 	return c;
@@ -1798,76 +1807,79 @@ static int yy_get_next_buffer (void)
 
 /** Immediately switch to a different input stream.
  * @param input_file A readable stream.
- * 
+ * @param yyscanner The scanner object.
  * @note This function does not reset the start condition to @c INITIAL .
  */
-    void php_restart  (FILE * input_file )
+    void php_restart  (FILE * input_file , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	if ( ! YY_CURRENT_BUFFER ){
-        php_ensure_buffer_stack ();
+        php_ensure_buffer_stack (yyscanner );
 		YY_CURRENT_BUFFER_LVALUE =
-            php__create_buffer(php_in,YY_BUF_SIZE );
+            php__create_buffer(yyin,YY_BUF_SIZE ,yyscanner);
 	}
 
-	php__init_buffer(YY_CURRENT_BUFFER,input_file );
-	php__load_buffer_state( );
+	php__init_buffer(YY_CURRENT_BUFFER,input_file ,yyscanner);
+	php__load_buffer_state(yyscanner );
 }
 
 /** Switch to a different input buffer.
  * @param new_buffer The new input buffer.
- * 
+ * @param yyscanner The scanner object.
  */
-    void php__switch_to_buffer  (YY_BUFFER_STATE  new_buffer )
+    void php__switch_to_buffer  (YY_BUFFER_STATE  new_buffer , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	/* TODO. We should be able to replace this entire function body
 	 * with
 	 *		php_pop_buffer_state();
 	 *		php_push_buffer_state(new_buffer);
      */
-	php_ensure_buffer_stack ();
+	php_ensure_buffer_stack (yyscanner );
 	if ( YY_CURRENT_BUFFER == new_buffer )
 		return;
 
 	if ( YY_CURRENT_BUFFER )
 		{
 		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		*yyg->yy_c_buf_p = yyg->yy_hold_char;
+		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = yyg->yy_c_buf_p;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
 	YY_CURRENT_BUFFER_LVALUE = new_buffer;
-	php__load_buffer_state( );
+	php__load_buffer_state(yyscanner );
 
 	/* We don't actually know whether we did this switch during
 	 * EOF (php_wrap()) processing, but the only time this flag
 	 * is looked at is after php_wrap() is called, so it's safe
 	 * to go ahead and always set it.
 	 */
-	(yy_did_buffer_switch_on_eof) = 1;
+	yyg->yy_did_buffer_switch_on_eof = 1;
 }
 
-static void php__load_buffer_state  (void)
+static void php__load_buffer_state  (yyscan_t yyscanner)
 {
-    	(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-	(yytext_ptr) = (yy_c_buf_p) = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
-	php_in = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
-	(yy_hold_char) = *(yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
+	yyg->yytext_ptr = yyg->yy_c_buf_p = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
+	yyin = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
+	yyg->yy_hold_char = *yyg->yy_c_buf_p;
 }
 
 /** Allocate and initialize an input buffer state.
  * @param file A readable stream.
  * @param size The character buffer size in bytes. When in doubt, use @c YY_BUF_SIZE.
- * 
+ * @param yyscanner The scanner object.
  * @return the allocated buffer state.
  */
-    YY_BUFFER_STATE php__create_buffer  (FILE * file, int  size )
+    YY_BUFFER_STATE php__create_buffer  (FILE * file, int  size , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
     
-	b = (YY_BUFFER_STATE) php_alloc(sizeof( struct yy_buffer_state )  );
+	b = (YY_BUFFER_STATE) php_alloc(sizeof( struct yy_buffer_state ) ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "out of dynamic memory in php__create_buffer()" );
 
@@ -1876,24 +1888,25 @@ static void php__load_buffer_state  (void)
 	/* yy_ch_buf has to be 2 characters longer than the size given because
 	 * we need to put in 2 end-of-buffer characters.
 	 */
-	b->yy_ch_buf = (char *) php_alloc(b->yy_buf_size + 2  );
+	b->yy_ch_buf = (char *) php_alloc(b->yy_buf_size + 2 ,yyscanner);
 	if ( ! b->yy_ch_buf )
 		YY_FATAL_ERROR( "out of dynamic memory in php__create_buffer()" );
 
 	b->yy_is_our_buffer = 1;
 
-	php__init_buffer(b,file );
+	php__init_buffer(b,file ,yyscanner);
 
 	return b;
 }
 
 /** Destroy the buffer.
  * @param b a buffer created with php__create_buffer()
- * 
+ * @param yyscanner The scanner object.
  */
-    void php__delete_buffer (YY_BUFFER_STATE  b )
+    void php__delete_buffer (YY_BUFFER_STATE  b , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	if ( ! b )
 		return;
 
@@ -1901,21 +1914,22 @@ static void php__load_buffer_state  (void)
 		YY_CURRENT_BUFFER_LVALUE = (YY_BUFFER_STATE) 0;
 
 	if ( b->yy_is_our_buffer )
-		php_free((void *) b->yy_ch_buf  );
+		php_free((void *) b->yy_ch_buf ,yyscanner);
 
-	php_free((void *) b  );
+	php_free((void *) b ,yyscanner);
 }
 
 /* Initializes or reinitializes a buffer.
  * This function is sometimes called more than once on the same buffer,
  * such as during a php_restart() or at EOF.
  */
-    static void php__init_buffer  (YY_BUFFER_STATE  b, FILE * file )
+    static void php__init_buffer  (YY_BUFFER_STATE  b, FILE * file , yyscan_t yyscanner)
 
 {
 	int oerrno = errno;
-    
-	php__flush_buffer(b );
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	php__flush_buffer(b ,yyscanner);
 
 	b->yy_input_file = file;
 	b->yy_fill_buffer = 1;
@@ -1936,11 +1950,12 @@ static void php__load_buffer_state  (void)
 
 /** Discard all buffered characters. On the next scan, YY_INPUT will be called.
  * @param b the buffer state to be flushed, usually @c YY_CURRENT_BUFFER.
- * 
+ * @param yyscanner The scanner object.
  */
-    void php__flush_buffer (YY_BUFFER_STATE  b )
+    void php__flush_buffer (YY_BUFFER_STATE  b , yyscan_t yyscanner)
 {
-    	if ( ! b )
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if ( ! b )
 		return;
 
 	b->yy_n_chars = 0;
@@ -1958,114 +1973,117 @@ static void php__load_buffer_state  (void)
 	b->yy_buffer_status = YY_BUFFER_NEW;
 
 	if ( b == YY_CURRENT_BUFFER )
-		php__load_buffer_state( );
+		php__load_buffer_state(yyscanner );
 }
 
 /** Pushes the new state onto the stack. The new state becomes
  *  the current state. This function will allocate the stack
  *  if necessary.
  *  @param new_buffer The new state.
- *  
+ *  @param yyscanner The scanner object.
  */
-void php_push_buffer_state (YY_BUFFER_STATE new_buffer )
+void php_push_buffer_state (YY_BUFFER_STATE new_buffer , yyscan_t yyscanner)
 {
-    	if (new_buffer == NULL)
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if (new_buffer == NULL)
 		return;
 
-	php_ensure_buffer_stack();
+	php_ensure_buffer_stack(yyscanner );
 
 	/* This block is copied from php__switch_to_buffer. */
 	if ( YY_CURRENT_BUFFER )
 		{
 		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		*yyg->yy_c_buf_p = yyg->yy_hold_char;
+		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = yyg->yy_c_buf_p;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
 	/* Only push if top exists. Otherwise, replace top. */
 	if (YY_CURRENT_BUFFER)
-		(yy_buffer_stack_top)++;
+		yyg->yy_buffer_stack_top++;
 	YY_CURRENT_BUFFER_LVALUE = new_buffer;
 
 	/* copied from php__switch_to_buffer. */
-	php__load_buffer_state( );
-	(yy_did_buffer_switch_on_eof) = 1;
+	php__load_buffer_state(yyscanner );
+	yyg->yy_did_buffer_switch_on_eof = 1;
 }
 
 /** Removes and deletes the top of the stack, if present.
  *  The next element becomes the new top.
- *  
+ *  @param yyscanner The scanner object.
  */
-void php_pop_buffer_state (void)
+void php_pop_buffer_state (yyscan_t yyscanner)
 {
-    	if (!YY_CURRENT_BUFFER)
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if (!YY_CURRENT_BUFFER)
 		return;
 
-	php__delete_buffer(YY_CURRENT_BUFFER );
+	php__delete_buffer(YY_CURRENT_BUFFER ,yyscanner);
 	YY_CURRENT_BUFFER_LVALUE = NULL;
-	if ((yy_buffer_stack_top) > 0)
-		--(yy_buffer_stack_top);
+	if (yyg->yy_buffer_stack_top > 0)
+		--yyg->yy_buffer_stack_top;
 
 	if (YY_CURRENT_BUFFER) {
-		php__load_buffer_state( );
-		(yy_did_buffer_switch_on_eof) = 1;
+		php__load_buffer_state(yyscanner );
+		yyg->yy_did_buffer_switch_on_eof = 1;
 	}
 }
 
 /* Allocates the stack if it does not exist.
  *  Guarantees space for at least one push.
  */
-static void php_ensure_buffer_stack (void)
+static void php_ensure_buffer_stack (yyscan_t yyscanner)
 {
 	int num_to_alloc;
-    
-	if (!(yy_buffer_stack)) {
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	if (!yyg->yy_buffer_stack) {
 
 		/* First allocation is just for 2 elements, since we don't know if this
 		 * scanner will even need a stack. We use 2 instead of 1 to avoid an
 		 * immediate realloc on the next call.
          */
 		num_to_alloc = 1;
-		(yy_buffer_stack) = (struct yy_buffer_state**)php_alloc
+		yyg->yy_buffer_stack = (struct yy_buffer_state**)php_alloc
 								(num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
+								, yyscanner);
+		if ( ! yyg->yy_buffer_stack )
 			YY_FATAL_ERROR( "out of dynamic memory in php_ensure_buffer_stack()" );
 								  
-		memset((yy_buffer_stack), 0, num_to_alloc * sizeof(struct yy_buffer_state*));
+		memset(yyg->yy_buffer_stack, 0, num_to_alloc * sizeof(struct yy_buffer_state*));
 				
-		(yy_buffer_stack_max) = num_to_alloc;
-		(yy_buffer_stack_top) = 0;
+		yyg->yy_buffer_stack_max = num_to_alloc;
+		yyg->yy_buffer_stack_top = 0;
 		return;
 	}
 
-	if ((yy_buffer_stack_top) >= ((yy_buffer_stack_max)) - 1){
+	if (yyg->yy_buffer_stack_top >= (yyg->yy_buffer_stack_max) - 1){
 
 		/* Increase the buffer to prepare for a possible push. */
 		int grow_size = 8 /* arbitrary grow size */;
 
-		num_to_alloc = (yy_buffer_stack_max) + grow_size;
-		(yy_buffer_stack) = (struct yy_buffer_state**)php_realloc
-								((yy_buffer_stack),
+		num_to_alloc = yyg->yy_buffer_stack_max + grow_size;
+		yyg->yy_buffer_stack = (struct yy_buffer_state**)php_realloc
+								(yyg->yy_buffer_stack,
 								num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
+								, yyscanner);
+		if ( ! yyg->yy_buffer_stack )
 			YY_FATAL_ERROR( "out of dynamic memory in php_ensure_buffer_stack()" );
 
 		/* zero only the new slots.*/
-		memset((yy_buffer_stack) + (yy_buffer_stack_max), 0, grow_size * sizeof(struct yy_buffer_state*));
-		(yy_buffer_stack_max) = num_to_alloc;
+		memset(yyg->yy_buffer_stack + yyg->yy_buffer_stack_max, 0, grow_size * sizeof(struct yy_buffer_state*));
+		yyg->yy_buffer_stack_max = num_to_alloc;
 	}
 }
 
 /** Setup the input buffer state to scan directly from a user-specified character buffer.
  * @param base the character buffer
  * @param size the size in bytes of the character buffer
- * 
+ * @param yyscanner The scanner object.
  * @return the newly allocated buffer state object. 
  */
-YY_BUFFER_STATE php__scan_buffer  (char * base, yy_size_t  size )
+YY_BUFFER_STATE php__scan_buffer  (char * base, yy_size_t  size , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
     
@@ -2075,7 +2093,7 @@ YY_BUFFER_STATE php__scan_buffer  (char * base, yy_size_t  size )
 		/* They forgot to leave room for the EOB's. */
 		return 0;
 
-	b = (YY_BUFFER_STATE) php_alloc(sizeof( struct yy_buffer_state )  );
+	b = (YY_BUFFER_STATE) php_alloc(sizeof( struct yy_buffer_state ) ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "out of dynamic memory in php__scan_buffer()" );
 
@@ -2089,7 +2107,7 @@ YY_BUFFER_STATE php__scan_buffer  (char * base, yy_size_t  size )
 	b->yy_fill_buffer = 0;
 	b->yy_buffer_status = YY_BUFFER_NEW;
 
-	php__switch_to_buffer(b  );
+	php__switch_to_buffer(b ,yyscanner);
 
 	return b;
 }
@@ -2097,25 +2115,25 @@ YY_BUFFER_STATE php__scan_buffer  (char * base, yy_size_t  size )
 /** Setup the input buffer state to scan a string. The next call to php_lex() will
  * scan from a @e copy of @a str.
  * @param yystr a NUL-terminated string to scan
- * 
+ * @param yyscanner The scanner object.
  * @return the newly allocated buffer state object.
  * @note If you want to scan bytes that may contain NUL values, then use
  *       php__scan_bytes() instead.
  */
-YY_BUFFER_STATE php__scan_string (yyconst char * yystr )
+YY_BUFFER_STATE php__scan_string (yyconst char * yystr , yyscan_t yyscanner)
 {
     
-	return php__scan_bytes(yystr,strlen(yystr) );
+	return php__scan_bytes(yystr,strlen(yystr) ,yyscanner);
 }
 
 /** Setup the input buffer state to scan the given bytes. The next call to php_lex() will
  * scan from a @e copy of @a bytes.
  * @param bytes the byte buffer to scan
  * @param len the number of bytes in the buffer pointed to by @a bytes.
- * 
+ * @param yyscanner The scanner object.
  * @return the newly allocated buffer state object.
  */
-YY_BUFFER_STATE php__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
+YY_BUFFER_STATE php__scan_bytes  (yyconst char * yybytes, int  _yybytes_len , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
 	char *buf;
@@ -2124,7 +2142,7 @@ YY_BUFFER_STATE php__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
     
 	/* Get memory for full buffer, including space for trailing EOB's. */
 	n = _yybytes_len + 2;
-	buf = (char *) php_alloc(n  );
+	buf = (char *) php_alloc(n ,yyscanner);
 	if ( ! buf )
 		YY_FATAL_ERROR( "out of dynamic memory in php__scan_bytes()" );
 
@@ -2133,7 +2151,7 @@ YY_BUFFER_STATE php__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
 
 	buf[_yybytes_len] = buf[_yybytes_len+1] = YY_END_OF_BUFFER_CHAR;
 
-	b = php__scan_buffer(buf,n );
+	b = php__scan_buffer(buf,n ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "bad buffer in php__scan_bytes()" );
 
@@ -2149,7 +2167,7 @@ YY_BUFFER_STATE php__scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
 #define YY_EXIT_FAILURE 2
 #endif
 
-static void yy_fatal_error (yyconst char* msg )
+static void yy_fatal_error (yyconst char* msg , yyscan_t yyscanner)
 {
     	(void) fprintf( stderr, "%s\n", msg );
 	exit( YY_EXIT_FAILURE );
@@ -2161,120 +2179,250 @@ static void yy_fatal_error (yyconst char* msg )
 #define yyless(n) \
 	do \
 		{ \
-		/* Undo effects of setting up php_text. */ \
+		/* Undo effects of setting up yytext. */ \
         int yyless_macro_arg = (n); \
         YY_LESS_LINENO(yyless_macro_arg);\
-		php_text[php_leng] = (yy_hold_char); \
-		(yy_c_buf_p) = php_text + yyless_macro_arg; \
-		(yy_hold_char) = *(yy_c_buf_p); \
-		*(yy_c_buf_p) = '\0'; \
-		php_leng = yyless_macro_arg; \
+		yytext[yyleng] = yyg->yy_hold_char; \
+		yyg->yy_c_buf_p = yytext + yyless_macro_arg; \
+		yyg->yy_hold_char = *yyg->yy_c_buf_p; \
+		*yyg->yy_c_buf_p = '\0'; \
+		yyleng = yyless_macro_arg; \
 		} \
 	while ( 0 )
 
 /* Accessor  methods (get/set functions) to struct members. */
 
+/** Get the user-defined data for this scanner.
+ * @param yyscanner The scanner object.
+ */
+YY_EXTRA_TYPE php_get_extra  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyextra;
+}
+
 /** Get the current line number.
- * 
+ * @param yyscanner The scanner object.
  */
-int php_get_lineno  (void)
+int php_get_lineno  (yyscan_t yyscanner)
 {
-        
-    return php_lineno;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        if (! YY_CURRENT_BUFFER)
+            return 0;
+
+    return yylineno;
+}
+
+/** Get the current column number.
+ * @param yyscanner The scanner object.
+ */
+int php_get_column  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        if (! YY_CURRENT_BUFFER)
+            return 0;
+
+    return yycolumn;
 }
 
 /** Get the input stream.
- * 
+ * @param yyscanner The scanner object.
  */
-FILE *php_get_in  (void)
+FILE *php_get_in  (yyscan_t yyscanner)
 {
-        return php_in;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyin;
 }
 
 /** Get the output stream.
- * 
+ * @param yyscanner The scanner object.
  */
-FILE *php_get_out  (void)
+FILE *php_get_out  (yyscan_t yyscanner)
 {
-        return php_out;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyout;
 }
 
 /** Get the length of the current token.
- * 
+ * @param yyscanner The scanner object.
  */
-int php_get_leng  (void)
+int php_get_leng  (yyscan_t yyscanner)
 {
-        return php_leng;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyleng;
 }
 
 /** Get the current token.
- * 
+ * @param yyscanner The scanner object.
  */
 
-char *php_get_text  (void)
+char *php_get_text  (yyscan_t yyscanner)
 {
-        return php_text;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yytext;
+}
+
+/** Set the user-defined data. This data is never touched by the scanner.
+ * @param user_defined The data to be associated with this scanner.
+ * @param yyscanner The scanner object.
+ */
+void php_set_extra (YY_EXTRA_TYPE  user_defined , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyextra = user_defined ;
 }
 
 /** Set the current line number.
  * @param line_number
- * 
+ * @param yyscanner The scanner object.
  */
-void php_set_lineno (int  line_number )
+void php_set_lineno (int  line_number , yyscan_t yyscanner)
 {
-    
-    php_lineno = line_number;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        /* lineno is only valid if an input buffer exists. */
+        if (! YY_CURRENT_BUFFER )
+           yy_fatal_error( "php_set_lineno called with no buffer" , yyscanner);
+
+    yylineno = line_number;
+}
+
+/** Set the current column.
+ * @param line_number
+ * @param yyscanner The scanner object.
+ */
+void php_set_column (int  column_no , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        /* column is only valid if an input buffer exists. */
+        if (! YY_CURRENT_BUFFER )
+           yy_fatal_error( "php_set_column called with no buffer" , yyscanner);
+
+    yycolumn = column_no;
 }
 
 /** Set the input stream. This does not discard the current
  * input buffer.
  * @param in_str A readable stream.
- * 
+ * @param yyscanner The scanner object.
  * @see php__switch_to_buffer
  */
-void php_set_in (FILE *  in_str )
+void php_set_in (FILE *  in_str , yyscan_t yyscanner)
 {
-        php_in = in_str ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyin = in_str ;
 }
 
-void php_set_out (FILE *  out_str )
+void php_set_out (FILE *  out_str , yyscan_t yyscanner)
 {
-        php_out = out_str ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyout = out_str ;
 }
 
-int php_get_debug  (void)
+int php_get_debug  (yyscan_t yyscanner)
 {
-        return php__flex_debug;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yy_flex_debug;
 }
 
-void php_set_debug (int  bdebug )
+void php_set_debug (int  bdebug , yyscan_t yyscanner)
 {
-        php__flex_debug = bdebug ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yy_flex_debug = bdebug ;
 }
 
-static int yy_init_globals (void)
+/* User-visible API */
+
+/* php_lex_init is special because it creates the scanner itself, so it is
+ * the ONLY reentrant function that doesn't take the scanner as the last argument.
+ * That's why we explicitly handle the declaration, instead of using our macros.
+ */
+
+int php_lex_init(yyscan_t* ptr_yy_globals)
+
 {
-        /* Initialization is the same as for the non-reentrant scanner.
+    if (ptr_yy_globals == NULL){
+        errno = EINVAL;
+        return 1;
+    }
+
+    *ptr_yy_globals = (yyscan_t) php_alloc ( sizeof( struct yyguts_t ), NULL );
+
+    if (*ptr_yy_globals == NULL){
+        errno = ENOMEM;
+        return 1;
+    }
+
+    /* By setting to 0xAA, we expose bugs in yy_init_globals. Leave at 0x00 for releases. */
+    memset(*ptr_yy_globals,0x00,sizeof(struct yyguts_t));
+
+    return yy_init_globals ( *ptr_yy_globals );
+}
+
+/* php_lex_init_extra has the same functionality as php_lex_init, but follows the
+ * convention of taking the scanner as the last argument. Note however, that
+ * this is a *pointer* to a scanner, as it will be allocated by this call (and
+ * is the reason, too, why this function also must handle its own declaration).
+ * The user defined value in the first argument will be available to php_alloc in
+ * the yyextra field.
+ */
+
+int php_lex_init_extra(YY_EXTRA_TYPE yy_user_defined,yyscan_t* ptr_yy_globals )
+
+{
+    struct yyguts_t dummy_yyguts;
+
+    php_set_extra (yy_user_defined, &dummy_yyguts);
+
+    if (ptr_yy_globals == NULL){
+        errno = EINVAL;
+        return 1;
+    }
+
+    *ptr_yy_globals = (yyscan_t) php_alloc ( sizeof( struct yyguts_t ), &dummy_yyguts );
+
+    if (*ptr_yy_globals == NULL){
+        errno = ENOMEM;
+        return 1;
+    }
+
+    /* By setting to 0xAA, we expose bugs in
+    yy_init_globals. Leave at 0x00 for releases. */
+    memset(*ptr_yy_globals,0x00,sizeof(struct yyguts_t));
+
+    php_set_extra (yy_user_defined, *ptr_yy_globals);
+
+    return yy_init_globals ( *ptr_yy_globals );
+}
+
+static int yy_init_globals (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    /* Initialization is the same as for the non-reentrant scanner.
      * This function is called from php_lex_destroy(), so don't allocate here.
      */
 
-    /* We do not touch php_lineno unless the option is enabled. */
-    php_lineno =  1;
-    
-    (yy_buffer_stack) = 0;
-    (yy_buffer_stack_top) = 0;
-    (yy_buffer_stack_max) = 0;
-    (yy_c_buf_p) = (char *) 0;
-    (yy_init) = 0;
-    (yy_start) = 0;
+    yyg->yy_buffer_stack = 0;
+    yyg->yy_buffer_stack_top = 0;
+    yyg->yy_buffer_stack_max = 0;
+    yyg->yy_c_buf_p = (char *) 0;
+    yyg->yy_init = 0;
+    yyg->yy_start = 0;
+
+    yyg->yy_start_stack_ptr = 0;
+    yyg->yy_start_stack_depth = 0;
+    yyg->yy_start_stack =  NULL;
 
 /* Defined in main.c */
 #ifdef YY_STDINIT
-    php_in = stdin;
-    php_out = stdout;
+    yyin = stdin;
+    yyout = stdout;
 #else
-    php_in = (FILE *) 0;
-    php_out = (FILE *) 0;
+    yyin = (FILE *) 0;
+    yyout = (FILE *) 0;
 #endif
 
     /* For future reference: Set errno on error, since we are called by
@@ -2284,24 +2432,32 @@ static int yy_init_globals (void)
 }
 
 /* php_lex_destroy is for both reentrant and non-reentrant scanners. */
-int php_lex_destroy  (void)
+int php_lex_destroy  (yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
     /* Pop the buffer stack, destroying each element. */
 	while(YY_CURRENT_BUFFER){
-		php__delete_buffer(YY_CURRENT_BUFFER  );
+		php__delete_buffer(YY_CURRENT_BUFFER ,yyscanner );
 		YY_CURRENT_BUFFER_LVALUE = NULL;
-		php_pop_buffer_state();
+		php_pop_buffer_state(yyscanner);
 	}
 
 	/* Destroy the stack itself. */
-	php_free((yy_buffer_stack) );
-	(yy_buffer_stack) = NULL;
+	php_free(yyg->yy_buffer_stack ,yyscanner);
+	yyg->yy_buffer_stack = NULL;
+
+    /* Destroy the start condition stack. */
+        php_free(yyg->yy_start_stack ,yyscanner );
+        yyg->yy_start_stack = NULL;
 
     /* Reset the globals. This is important in a non-reentrant scanner so the next time
      * php_lex() is called, initialization will occur. */
-    yy_init_globals( );
+    yy_init_globals( yyscanner);
 
+    /* Destroy the main struct (reentrant only). */
+    php_free ( yyscanner , yyscanner );
+    yyscanner = NULL;
     return 0;
 }
 
@@ -2310,7 +2466,7 @@ int php_lex_destroy  (void)
  */
 
 #ifndef yytext_ptr
-static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
+static void yy_flex_strncpy (char* s1, yyconst char * s2, int n , yyscan_t yyscanner)
 {
 	register int i;
 	for ( i = 0; i < n; ++i )
@@ -2319,7 +2475,7 @@ static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
 #endif
 
 #ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * s )
+static int yy_flex_strlen (yyconst char * s , yyscan_t yyscanner)
 {
 	register int n;
 	for ( n = 0; s[n]; ++n )
@@ -2329,12 +2485,12 @@ static int yy_flex_strlen (yyconst char * s )
 }
 #endif
 
-void *php_alloc (yy_size_t  size )
+void *php_alloc (yy_size_t  size , yyscan_t yyscanner)
 {
 	return (void *) malloc( size );
 }
 
-void *php_realloc  (void * ptr, yy_size_t  size )
+void *php_realloc  (void * ptr, yy_size_t  size , yyscan_t yyscanner)
 {
 	/* The cast to (char *) in the following accommodates both
 	 * implementations that use char* generic pointers, and those
@@ -2346,14 +2502,14 @@ void *php_realloc  (void * ptr, yy_size_t  size )
 	return (void *) realloc( (char *) ptr, size );
 }
 
-void php_free (void * ptr )
+void php_free (void * ptr , yyscan_t yyscanner)
 {
 	free( (char *) ptr );	/* see php_realloc() for (char *) cast */
 }
 
 #define YYTABLES_NAME "yytables"
 
-#line 275 "php.l"
+#line 271 "php.l"
 
 
 /*
@@ -2362,41 +2518,41 @@ void php_free (void * ptr )
 void
 php(const struct parser_param *param)
 {
+	yyscan_t scanner;
 	int token;
 
-	level = 0;
-	string = strbuf_open(0);
-	if (linetable_open(param->file) == -1)
+	param->ctx->level = 0;
+	param->ctx->string = strbuf_open(0);
+	if ((param->ctx->lt = linetable_open(param->file)) == NULL)
 		die("'%s' cannot open.", param->file);
-
-	LEXRESTART(NULL);
-	LEXLINENO = 1;
-	while ((token = LEXLEX(param)) != 0) {
+	if (php_lex_init_extra(param, &scanner) != 0)
+		die("cannot initialize the scanner.");
+	while ((token = php_lex(scanner)) != 0) {
 		switch (token) {
 		case PHP_DEFINE:
-			if (LEXLEX(param) != PHP_LPAREN)
+			if (php_lex(scanner) != PHP_LPAREN)
 				break;
-			if (LEXLEX(param) != PHP_STRING)
+			if (php_lex(scanner) != PHP_STRING)
 				break;
-			PUT(PARSER_DEF, strbuf_value(string), LEXLINENO);
+			PUT(PARSER_DEF, strbuf_value(param->ctx->string), LEXLINENO);
 			break;
 		case PHP_CLASS:
-			if (LEXLEX(param) != PHP_TOKEN)
+			if (php_lex(scanner) != PHP_TOKEN)
 				break;
 			PUT(PARSER_DEF, LEXTEXT, LEXLINENO);
 			break;
 		case PHP_FUNCTION:
 		case PHP_CFUNCTION:
 		case PHP_OLD_FUNCTION:
-			if (LEXLEX(param) != PHP_TOKEN)
+			if (php_lex(scanner) != PHP_TOKEN)
 				break;
 			PUT(PARSER_DEF, LEXTEXT, LEXLINENO);
 			break;
 		case PHP_VARIABLE:
 			if (php_reserved_variable(LEXTEXT, LEXLENG)) {
 				PUT(PARSER_REF_SYM, LEXTEXT, LEXLINENO);
-				if (LEXLEX(param) == PHP_LBRACK && LEXLEX(param) == PHP_STRING && LEXLEX(param) == PHP_RBRACK) {
-					const char *str = strbuf_value(string);
+				if (php_lex(scanner) == PHP_LBRACK && php_lex(scanner) == PHP_STRING && php_lex(scanner) == PHP_RBRACK) {
+					const char *str = strbuf_value(param->ctx->string);
 
 					if (strchr(str, '$') == NULL)
 						PUT(PARSER_REF_SYM, str, LEXLINENO);
@@ -2408,14 +2564,14 @@ php(const struct parser_param *param)
 			}
 			break;
 		case PHP_POINTER:
-			if (LEXLEX(param) != PHP_TOKEN)
+			if (php_lex(scanner) != PHP_TOKEN)
 				break;
 			/* FALLTHROUGH */
 		case PHP_TOKEN:
 			PUT(PARSER_REF_SYM, LEXTEXT, LEXLINENO);
 			break;
 		case PHP_NEW:
-			if (LEXLEX(param) != PHP_TOKEN)
+			if (php_lex(scanner) != PHP_TOKEN)
 				break;
 			PUT(PARSER_REF_SYM, LEXTEXT, LEXLINENO);
 			break;
@@ -2423,9 +2579,9 @@ php(const struct parser_param *param)
 		 * ${x->y}
 		 */
 		case PHP_DOLLAR:
-			if (LEXLEX(param) != PHP_LBRACE)
+			if (php_lex(scanner) != PHP_LBRACE)
 				break;
-			while ((token = LEXLEX(param)) != PHP_RBRACE) {
+			while ((token = php_lex(scanner)) != PHP_RBRACE) {
 				if (token == PHP_TOKEN) {
 					PUT(PARSER_REF_SYM, LEXTEXT, LEXLINENO);
 				}
@@ -2435,7 +2591,8 @@ php(const struct parser_param *param)
 			break;
 		}
 	}
-	linetable_close();
-	strbuf_close(string);
+	php_lex_destroy(scanner);
+	linetable_close(param->ctx->lt);
+	strbuf_close(param->ctx->string);
 }
 
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "bloom.h"
+#include "checkalloc.h"
+#include "dbop.h"
+#include "die.h"
+#include "gparam.h"
+#include "strlimcpy.h"
+#include "varray.h"
+
+/**
+ @file
+
+ Bloom filter of the keys of a tag file.
+
+ Most names looked up in @NAME{GTAGS} to know whether or not they are defined
+ are not defined, and each failed lookup walks the B-tree. The filter answers
+ such a question in memory. If it says no, the key is surely absent.
+ If it says yes, the key may be present and the tag file must be examined.
+
+ The filter of a tag file is written next to it (@FILE{GTAGS.bloom}) by
+ bloom_make() when the tag file is made or updated, and is published with
+ the tag file (see dbop_pending()):
+
+ @code{.txt}
+ GLOBAL-BLOOM 3 <nbits> <nhash> <size> <inode> <generation>\n
+ <bit array (nbits / 8 bytes)>
+ @endcode
+
+ The size, the inode number and the generation number (#GENERATIONKEY) of
+ the tag file are recorded in the header, and the filter is not used if they
+ don't match the opened tag file. A tag file updated with its delta keeps its
+ size and inode number, but gets a new generation number (see dbop_close()).
+ The filter is compared with the opened tag file, not with the path name,
+ so a reader of an old tag file never uses the filter of a new one.
+ */
+#define BLOOM_MAGIC	"GLOBAL-BLOOM"
+#define BLOOM_VERSION	3
+
+/**
+ * Two independent hash values of a key. The i-th hash function is
+ * @CODE{h1 + i * h2} (double hashing).
+ */
+typedef struct {
+	unsigned int h1;
+	unsigned int h2;
+} HASHPAIR;
+
+static void
+hashpair(const char *key, HASHPAIR *hp)
+{
+	const unsigned char *p = (const unsigned char *)key;
+	unsigned int h1 = 2166136261U;		/* FNV-1a */
+	unsigned int h2 = 0;			/* sdbm */
+
+	for (; *p; p++) {
+		h1 = (h1 ^ *p) * 16777619U;
+		h2 = *p + (h2 << 6) + (h2 << 16) - h2;
+	}
+	hp->h1 = h1;
+	hp->h2 = h2 | 1;
+}
+static const char *
+bloom_path(const char *tagfile)
+{
+	static char path[MAXPATHLEN];
+
+	if (strlen(tagfile) + sizeof(BLOOM_SUFFIX) > sizeof(path))
+		die("path name too long.");
+	strlimcpy(path, tagfile, sizeof(path));
+	strcat(path, BLOOM_SUFFIX);
+	return path;
+}
+/**
+ * bloom_open: load the filter of a tag file.
+ *
+ *	@param[in]	tagfile	path of the tag file
+ *	@param[in]	fd	file descriptor of the opened tag file
+ *	@param[in]	generation	generation number of the opened tag file (0 if none)
+ *	@return		#BLOOM structure, or @VAR{NULL} if the filter doesn't exist or is out of date
+ */
+BLOOM *
+bloom_open(const char *tagfile, int fd, unsigned long generation)
+{
+	BLOOM *bloom;
+	FILE *ip;
+	struct stat st;
+	char header[128], magic[32];
+	unsigned int nbits, nhash;
+	unsigned long gen;
+	long size, ino;
+	int version;
+
+	if (fd < 0 || fstat(fd, &st) < 0)
+		return NULL;
+	if ((ip = fopen(bloom_path(tagfile), "rb")) == NULL)
+		return NULL;
+	if (fgets(header, sizeof(header), ip) == NULL
+	    || sscanf(header, "%31s %d %u %u %ld %ld %lu", magic, &version, &nbits, &nhash, &size, &ino, &gen) != 7
+	    || strcmp(magic, BLOOM_MAGIC) || version != BLOOM_VERSION
+	    || nbits == 0 || nbits % 8 != 0 || nhash == 0
+	    || size != (long)st.st_size || ino != (long)st.st_ino || gen != generation) {
+		fclose(ip);
+		return NULL;
+	}
+	bloom = (BLOOM *)check_malloc(sizeof(BLOOM));
+	bloom->nbits = nbits;
+	bloom->nhash = nhash;
+	bloom->bits = (unsigned char *)check_malloc(nbits / 8);
+	if (fread(bloom->bits, 1, nbits / 8, ip) != nbits / 8) {
+		fclose(ip);
+		bloom_close(bloom);
+		return NULL;
+	}
+	fclose(ip);
+	return bloom;
+}
+/**
+ * bloom_contains: whether or not the key may be in the tag file.
+ *
+ *	@param[in]	bloom	#BLOOM structure
+ *	@param[in]	key	key
+ *	@return		0: surely absent, 1: may be present
+ */
+int
+bloom_contains(BLOOM *bloom, const char *key)
+{
+	HASHPAIR hp;
+	unsigned int i, bit;
+
+	hashpair(key, &hp);
+	for (i = 0; i < bloom->nhash; i++) {
+		bit = (hp.h1 + i * hp.h2) % bloom->nbits;
+		if (!(bloom->bits[bit / 8] & (1 << (bit % 8))))
+			return 0;
+	}
+	return 1;
+}
+/**
+ * bloom_close: free the filter.
+ *
+ *	@param[in]	bloom	#BLOOM structure
+ */
+void
+bloom_close(BLOOM *bloom)
+{
+	free(bloom->bits);
+	free(bloom);
+}
+/**
+ * bloom_make: make the filter of a tag file.
+ *
+ *	@param[in]	tagfile	path of the tag file to read (must be closed)
+ *	@param[in]	name	path of the tag file which the filter is for. <br>
+ *			It differs from @a tagfile when the tag file is a shadow.
+ *	@param[in]	generation	generation number of the tag file (0 if none)
+ *
+ * The filter is written to its shadow, so a reader never sees a half-written one.
+ */
+void
+bloom_make(const char *tagfile, const char *name, unsigned long generation)
+{
+	DBOP *dbop;
+	VARRAY *vb;
+	HASHPAIR *hp;
+	FILE *op;
+	struct stat st;
+	unsigned char *bits;
+	unsigned int nbits, bit;
+	int i, j;
+	const char *key;
+	char path[MAXPATHLEN];
+
+	if ((dbop = dbop_open(tagfile, 0, 0, 0)) == NULL)
+		die("%s not found.", tagfile);
+	vb = varray_open(sizeof(HASHPAIR), 1024);
+	for (key = dbop_first(dbop, NULL, NULL, DBOP_KEY); key; key = dbop_next(dbop))
+		hashpair(key, (HASHPAIR *)varray_append(vb));
+	dbop_close(dbop);
+	/*
+	 * The size is a multiple of 8 bits and at least 64 bits.
+	 */
+	nbits = (vb->length * BLOOM_BITS + 63) / 64 * 64;
+	if (nbits == 0)
+		nbits = 64;
+	bits = (unsigned char *)check_calloc(nbits / 8, 1);
+	for (i = 0; i < vb->length; i++) {
+		hp = (HASHPAIR *)varray_assign(vb, i, 0);
+		for (j = 0; j < BLOOM_NHASH; j++) {
+			bit = (hp->h1 + j * hp->h2) % nbits;
+			bits[bit / 8] |= 1 << (bit % 8);
+		}
+	}
+	varray_close(vb);
+	if (stat(tagfile, &st) < 0)
+		die("cannot stat '%s'.", tagfile);
+	strlimcpy(path, dbop_pending(bloom_path(name)), sizeof(path));
+	if ((op = fopen(path, "wb")) == NULL)
+		die("cannot make '%s'.", path);
+	fprintf(op, "%s %d %u %u %ld %ld %lu\n", BLOOM_MAGIC, BLOOM_VERSION,
+		nbits, (unsigned int)BLOOM_NHASH, (long)st.st_size, (long)st.st_ino, generation);
+	if (fwrite(bits, 1, nbits / 8, op) != nbits / 8 || fclose(op) != 0)
+		die("cannot write '%s'.", path);
+	free(bits);
+}
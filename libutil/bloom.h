@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _BLOOM_H_
+#define _BLOOM_H_
+
+/**
+ * Suffix of the filter file of a tag file.
+ */
+#define BLOOM_SUFFIX	".bloom"
+/**
+ * Number of bits for each key. With #BLOOM_NHASH hash functions,
+ * about 1% of the absent keys pass the filter.
+ */
+#define BLOOM_BITS	10
+#define BLOOM_NHASH	7
+
+typedef struct {
+	unsigned int nbits;		/**< number of bits */
+	unsigned int nhash;		/**< number of hash functions */
+	unsigned char *bits;		/**< bit array */
+} BLOOM;
+
+BLOOM *bloom_open(const char *, int, unsigned long);
+int bloom_contains(BLOOM *, const char *);
+void bloom_close(BLOOM *);
+void bloom_make(const char *, const char *, unsigned long);
+
+#endif /* ! _BLOOM_H_ */
@@ -39,16 +39,29 @@
 #include <unistd.h>
 #endif
 #include <errno.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
 
 #include "char.h"
 #include "checkalloc.h"
 #include "dbop.h"
 #include "die.h"
-#include "env.h"
+#include "extsort.h"
 #include "locatestring.h"
+#include "makepath.h"
+#include "statistics.h"
 #include "strbuf.h"
 #include "strlimcpy.h"
 #include "test.h"
+#include "varray.h"
 
 /**
  * Though the prefix of the key of meta record is currently only a @CODE{' '} (blank),
@@ -57,186 +70,90 @@
 #define ismeta(p)	(*((char *)(p)) <= ' ')
 
 /**
- * Stuff for #DBOP_SORTED_WRITE
+ @name Snapshot publishing
+
+ A tag file is never written in place. A tag file opened for writing is
+ a copy (a shadow, @FILE{GTAGS.new}) made at dbop_open(), and dbop_close()
+ only puts it on the list of pending files. dbop_publish() renames all the
+ pending shadows onto the tag files at once.
+
+ Readers which have already opened a tag file keep reading the old one
+ (its snapshot) until they close it. To open several tag files of the same
+ generation, readers use the generation number in @FILE{GGEN} like a
+ sequence lock: dbop_publish() makes it odd before the renames and even
+ after them, so a reader which saw the same even number before and after
+ opening its tag files has a consistent set. See gtags_open().
+
+ A tag file opened to update it (mode 2) is not copied. The tag file is
+ read only, and the pages written are put in its delta (@FILE{GTAGS.delta}),
+ which is read with it (see mpool_overlay()). The delta is published like
+ a tag file: it is copied to its shadow at dbop_open(), and the shadow is
+ renamed onto it. So an update costs the pages written and the delta of
+ the former updates. When the delta becomes large, dbop_close() merges it
+ into a copy of the tag file, which is published with the removal of the
+ delta.
+
+ The indexes of a tag file and other files which must be replaced together
+ with it are written to their shadows too (see dbop_pending()), and the
+ files which must be removed are removed by dbop_publish() (see dbop_remove()).
  */
-#define SORT_SEP '\t'
+/** @{ */
+/** times to read again an odd generation number (a publication in progress) */
+#define GENERATION_RETRY	30
+/** first wait (in microseconds) before reading it again, which is doubled each time */
+#define GENERATION_WAIT		100
+/** longest wait (in microseconds) */
+#define GENERATION_MAXWAIT	100000
+
+static STRBUF *pending;		/**< names of the pending tag files (NUL separated) */
+
+static const char *shadow_path(const char *);
+static const char *delta_path(const char *);
+static void add_pending(const char *);
+static int is_pending(const char *);
+static void merge_delta(const char *);
+static void wait_usec(long);
+static int dirlength(const char *);
+static int copy_file(const char *, const char *);
+static void changed_keys(DBOP *, STRBUF *, STRBUF *);
+static unsigned long read_generation(const char *);
+static void write_generation(const char *, unsigned long);
+static unsigned long stamp_generation(DBOP *, unsigned long);
+/** @} */
 
 /**
- * Two functions required for sorted writing.
- *
- * @fn static void start_sort_process(DBOP *dbop)
- * (1) start_sort_process: start sort process for sorted writing
- *
- *	@param[in]	dbop	DBOP descriptor
- *
- * @fn static void terminate_sort_process(DBOP *dbop)
- * (2) terminate_sort_process: terminate sort process
- *
- *	@param[in]	dbop	DBOP descriptor
- */
-static void start_sort_process(DBOP *);
-static void terminate_sort_process(DBOP *);
-static char *sortnotfound = "POSIX sort program not found. If available, the program will be speed up.\nPlease see ./configure --help.";
-/*
- * 1. DJGPP
- */
-#if defined(__DJGPP__)
-/*
- * Just ignored. DJGPP version doesn't use sorted writing.
- */
-static void
-start_sort_process(DBOP *dbop) {
-	return;
-}
-static void
-terminate_sort_process(DBOP *dbop) {
-	return;
-}
-/*
- * 2. WIN32
- */
-#elif defined(_WIN32) && !defined(__CYGWIN__)
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-/*
- * sort is included with the binary distribution
- */
-static char argv[] = "sort -k 1,1";
-static void
-start_sort_process(DBOP *dbop) {
-	HANDLE opipe[2], ipipe[2];
-	SECURITY_ATTRIBUTES sa;
-	STARTUPINFO si;
-	PROCESS_INFORMATION pi;
-	const char* lc_all;
-	char sort[MAX_PATH];
-	char* path;
-	static int informed;
-
-	if (!strcmp(POSIX_SORT, "no"))
-		return;
-	if (informed)
-		return;
-	/*
-	 * force using sort in the same directory as the program, to avoid
-	 * using the Windows one
-	 */
-	path = strrchr(_pgmptr, '\\');
-	sprintf(sort, "%.*s\\sort.exe", path - _pgmptr, _pgmptr);
-	if (!test("fx", sort)) {
-		warning(sortnotfound);
-		informed = 1;
-		return;
-	}
+ @name Case-folded key index
 
-	sa.nLength = sizeof(sa);
-	sa.bInheritHandle = TRUE;
-	sa.lpSecurityDescriptor = NULL;
-	if (!CreatePipe(&opipe[0], &opipe[1], &sa, 0) ||
-	    !CreatePipe(&ipipe[0], &ipipe[1], &sa, 0))
-		die("CreatePipe failed.");
-	SetHandleInformation(opipe[1], HANDLE_FLAG_INHERIT, 0);
-	SetHandleInformation(ipipe[0], HANDLE_FLAG_INHERIT, 0);
-	ZeroMemory(&si, sizeof(si));
-	si.cb = sizeof(si);
-	si.hStdInput = opipe[0];
-	si.hStdOutput = ipipe[1];
-	si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
-	si.dwFlags = STARTF_USESTDHANDLES;
-	lc_all = getenv("LC_ALL");
-	if (lc_all == NULL)
-		lc_all = "";
-	set_env("LC_ALL", "C");
-	CreateProcess(sort, argv, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi);
-	set_env("LC_ALL", lc_all);
-	CloseHandle(opipe[0]);
-	CloseHandle(ipipe[1]);
-	CloseHandle(pi.hThread);
-	dbop->pid = pi.hProcess;
-	dbop->sortout = fdopen(_open_osfhandle((long)opipe[1], _O_WRONLY), "w");
-	dbop->sortin = fdopen(_open_osfhandle((long)ipipe[0], _O_RDONLY), "r");
-	if (dbop->sortout == NULL || dbop->sortin == NULL)
-		die("fdopen failed.");
-}
-static void
-terminate_sort_process(DBOP *dbop) {
-	WaitForSingleObject(dbop->pid, INFINITE);
-	CloseHandle(dbop->pid);
-}
-/*
- * 3. UNIX and CYGWIN
- */
-#else
-#include <sys/wait.h>
-/*
- * Though it doesn't understand why, GNU sort with no option is faster
- * than 'sort -k 1,1'. But we should use '-k 1,1' here not to rely on
- * a specific command.
- */
-static char *argv[] = {
-	POSIX_SORT,
-	"-k",
-	"1,1",
-	NULL
-};
-static void
-start_sort_process(DBOP *dbop) {
-	int opipe[2], ipipe[2];
+ To read the keys which are equal to (or start with) a name ignoring case,
+ the keys which have upper case letters are written with their lower case
+ forms to the index (@FILE{GTAGS.fold}, @FILE{GRTAGS.fold}), which is also
+ a B-tree:
 
-	if (!strcmp(POSIX_SORT, "no"))
-		return;
-	if (!test("fx", POSIX_SORT)) {
-		static int informed;
+ @code{.txt}
+ [key]			[data]
+ <key in lower case>	<key>
+ @endcode
 
-		if (!informed) {
-			warning(sortnotfound);
-			informed = 1;
-		}
-		return;
-	}
-	/*
-	 * Setup pipe for two way communication
-	 *
-	 *	Parent(gtags)				Child(sort)
-	 *	---------------------------------------------------
-	 *	(dbop->sortout) opipe[1] =====> opipe[0] (stdin)
-	 *	(dbop->sortin)  ipipe[0] <===== ipipe[1] (stdout)
-	 */
-	if (pipe(opipe) < 0 || pipe(ipipe) < 0)
-		die("pipe(2) failed.");
-	dbop->pid = fork();
-	if (dbop->pid == 0) {
-		/* child process */
-		close(opipe[1]);
-		close(ipipe[0]);
-		if (dup2(opipe[0], 0) < 0 || dup2(ipipe[1], 1) < 0)
-			die("dup2(2) failed.");
-		close(opipe[0]);
-		close(ipipe[1]);
-		/*
-		 * Use C locale in order to avoid the degradation of performance 	 
-		 * by internationalized sort command. 	 
-		 */
-		set_env("LC_ALL", "C");
-		execvp(POSIX_SORT, argv);
-	} else if (dbop->pid < 0)
-		die("fork(2) failed.");
-	/* parent process */
-	close(opipe[0]);
-	close(ipipe[1]);
-	fcntl(ipipe[0], F_SETFD, FD_CLOEXEC);
-	fcntl(opipe[1], F_SETFD, FD_CLOEXEC);
-	dbop->sortout = fdopen(opipe[1], "w");
-	dbop->sortin = fdopen(ipipe[0], "r");
-	if (dbop->sortout == NULL || dbop->sortin == NULL)
-		die("fdopen(3) failed.");
-}
-static void
-terminate_sort_process(DBOP *dbop) {
-	while (waitpid(dbop->pid, NULL, 0) < 0 && errno == EINTR)
-		;
-}
-#endif
+ The other keys are their own lower case forms, and are read from the tag
+ file itself. So both are read by key range. Only ASCII letters are folded.
+
+ The index is made by dbop_close() when the tag file is made, and is
+ updated with the keys added or removed when the tag file is updated.
+ It is published with the tag file. The size, the inode number and the
+ generation number (#GENERATIONKEY) of the tag file are recorded in it
+ (#TAGFILEKEY), and the index is not used if they don't match the opened
+ tag file.
+ */
+/** @{ */
+#define TAGFILEKEY	" __.TAGFILE"
+
+static const char *fold_path(const char *);
+static int fold_string(const char *, char *, int);
+static DBOP *fold_open(DBOP *);
+static void fold_make(const char *, const char *, unsigned long);
+static void fold_update(const char *, const char *, STRBUF *, STRBUF *, unsigned long, unsigned long);
+static int compare_string(const void *, const void *);
+/** @} */
 
 /**
  * dbop_open: open db database.
@@ -246,10 +163,24 @@ terminate_sort_process(DBOP *dbop) {
  *	@param[in]	perm	file permission
  *	@param[in]	flags
  *			#DBOP_DUP: allow duplicate records. <br>
- *			#DBOP_SORTED_WRITE: use sorted writing. This requires @NAME{POSIX} sort.
+ *			#DBOP_SORTED_WRITE: use sorted writing. <br>
+ *			#DBOP_BLOOM: use the key filter in dbop_get(), or make it in dbop_close(). <br>
+ *			#DBOP_TRIGRAM: use the trigram index in dbop_narrow(), or make it in dbop_close(). <br>
+ *			#DBOP_FOLD: use the case-folded key index in dbop_fold(), or make it in dbop_close().
  *	@return		descripter for @NAME{dbop_xxx()}
  *
  * Sorted wirting is fast because all writing is done by not insertion but addition.
+ * Records are sorted in memory, and if they exceed the limit, they are sorted
+ * using temporary files (see libutil/extsort.c). When creating a tag file,
+ * the sorted records are loaded into the B-tree from the bottom up.
+ *
+ * When a tag file is opened for writing, its shadow is opened instead, or it
+ * is opened with the shadow of its delta. See dbop_publish().
+ *
+ * The key filter (see libutil/bloom.c) lets dbop_get() answer most lookups
+ * of absent keys without reading the B-tree. The trigram index (see
+ * libutil/trigram.c) lets a sequential read with a regular expression skip
+ * the keys which cannot match.
  */
 DBOP *
 dbop_open(const char *path, int mode, int perm, int flags)
@@ -258,6 +189,11 @@ dbop_open(const char *path, int mode, int perm, int flags)
 	int rw = 0;
 	DBOP *dbop;
 	BTREEINFO info;
+	struct stat st;
+	const char *dbfile = path;
+	char overlay[MAXPATHLEN];
+	int pending = path != NULL && is_pending(path);
+	int dbperm = 0600;
 
 	/*
 	 * setup arguments.
@@ -290,12 +226,44 @@ dbop_open(const char *path, int mode, int perm, int flags)
 		info.cachesize = GTAGSMINCACHE;
 
 	/*
-	 * if unlink do job normally, those who already open tag file can use
-	 * it until closing.
+	 * Write to the shadow. Those who already open the tag file can use
+	 * it until closing, and it is not replaced until dbop_publish().
+	 * A tag file which is pending is read from its shadow.
+	 *
+	 * A tag file which is not pending is updated with the shadow of its
+	 * delta, which is a copy of the delta (or is made by dbopen()).
+	 * The delta is read with the tag file, or its shadow if it is pending.
 	 */
-	if (path != NULL && mode == 1 && test("f", path))
-		(void)unlink(path);
-	db = dbopen(path, rw, 0600, DB_BTREE, &info);
+	if (path != NULL && (mode == 1 || pending)) {
+		dbfile = shadow_path(path);
+		if (mode == 1 && test("f", dbfile))
+			(void)unlink(dbfile);
+	}
+#ifdef USE_DB185_COMPAT
+	else if (path != NULL && mode == 2) {
+		dbfile = shadow_path(path);
+		if (copy_file(path, dbfile) < 0)
+			return NULL;
+	}
+#else
+	else if (path != NULL && mode == 2) {
+		if (stat(path, &st) < 0)
+			return NULL;
+		dbperm = st.st_mode & 0777;
+		strlimcpy(overlay, shadow_path(delta_path(path)), sizeof(overlay));
+		if (!is_pending(delta_path(path)) && copy_file(delta_path(path), overlay) < 0)
+			(void)unlink(overlay);
+		info.overlay = overlay;
+	} else if (path != NULL) {
+		if (is_pending(delta_path(path)))
+			strlimcpy(overlay, shadow_path(delta_path(path)), sizeof(overlay));
+		else
+			strlimcpy(overlay, delta_path(path), sizeof(overlay));
+		if (test("f", overlay))
+			info.overlay = overlay;
+	}
+#endif
+	db = dbopen(dbfile, rw, dbperm, DB_BTREE, &info);
 	if (!db)
 		return NULL;
 	dbop = (DBOP *)check_calloc(sizeof(DBOP), 1);
@@ -304,19 +272,219 @@ dbop_open(const char *path, int mode, int perm, int flags)
 	else
 		strlimcpy(dbop->dbname, path, sizeof(dbop->dbname));
 	dbop->db	= db;
+	dbop->mode	= mode;
 	dbop->openflags	= flags;
 	dbop->perm	= (mode == 1) ? perm : 0;
+#ifndef USE_DB185_COMPAT
+	dbop->delta	= (mode == 2 && info.overlay != NULL);
+#endif
 	dbop->lastdat	= NULL;
 	dbop->lastsize	= 0;
-	dbop->sortout	= NULL;
-	dbop->sortin	= NULL;
+	dbop->sort	= NULL;
 	/*
 	 * Setup sorted writing.
+	 * Decide the size of memory for sorting. The default value is 64MB.
+	 * See libutil/gparam.h for the details.
+	 */
+	if (mode != 0 && dbop->openflags & DBOP_SORTED_WRITE) {
+		int sortbuf = GTAGSSORTBUF;
+
+		if (getenv("GTAGSSORTBUF") != NULL)
+			sortbuf = atoi(getenv("GTAGSSORTBUF"));
+		if (sortbuf < GTAGSMINSORTBUF)
+			sortbuf = GTAGSMINSORTBUF;
+		dbop->sort = extsort_open(sortbuf);
+	}
+	/*
+	 * The keys put or deleted are recorded to update the indexes of
+	 * the tag file instead of making them again. See dbop_close().
 	 */
-	if (mode != 0 && dbop->openflags & DBOP_SORTED_WRITE)
-		start_sort_process(dbop);
+	if (mode == 2 && path != NULL && !pending && flags & (DBOP_TRIGRAM|DBOP_FOLD))
+		dbop->changed = strhash_open(256);
 	return dbop;
 }
+/**
+ * dbop_absent: whether or not the key filter says that the key is absent.
+ *
+ *	@param[in]	dbop	descripter
+ *	@param[in]	name	key
+ *	@return		1: absent, 0: may be present (or no filter)
+ *
+ * The filter is loaded at the first call. If it doesn't exist or is out of date,
+ * every key is examined in the B-tree as usual.
+ */
+int
+dbop_absent(DBOP *dbop, const char *name)
+{
+	if (!(dbop->openflags & DBOP_BLOOM) || dbop->mode != 0 || ismeta(name))
+		return 0;
+	if (!dbop->bloom_tried) {
+		dbop->bloom = bloom_open(dbop->dbname, (*dbop->db->fd)(dbop->db),
+					dbop_getgeneration(dbop));
+		dbop->bloom_tried = 1;
+	}
+	return dbop->bloom && !bloom_contains(dbop->bloom, name);
+}
+/**
+ * dbop_narrow: narrow the next sequential read to the candidates for a regular expression.
+ *
+ *	@param[in]	dbop	descripter
+ *	@param[in]	pattern	regular expression
+ *	@param[in]	regflags	flags for regcomp(3)
+ *	@return		1: narrowed, 0: not narrowed
+ *
+ * The next dbop_first() without a key reads only the records of the keys
+ * which may match the pattern. The compiled pattern must be given to it as
+ * usual, since the candidates are not examined here. If the trigram index
+ * doesn't exist, is out of date, or cannot narrow the keys, nothing is done.
+ */
+int
+dbop_narrow(DBOP *dbop, const char *pattern, int regflags)
+{
+	dbop->narrow = 0;
+	if (!(dbop->openflags & DBOP_TRIGRAM) || dbop->mode != 0)
+		return 0;
+	if (!dbop->trigram_tried) {
+		dbop->trigram = trigram_open(dbop->dbname, (*dbop->db->fd)(dbop->db),
+						dbop_getgeneration(dbop));
+		dbop->trigram_tried = 1;
+	}
+	if (dbop->trigram == NULL)
+		return 0;
+	if (dbop->cand == NULL)
+		dbop->cand = strbuf_open(0);
+	if (trigram_search(dbop->trigram, pattern, regflags, dbop->cand) < 0)
+		return 0;
+	dbop->narrow = 1;
+	return 1;
+}
+/**
+ * dbop_fold: narrow the next sequential read to the keys equal to a name ignoring case.
+ *
+ *	@param[in]	dbop	descripter
+ *	@param[in]	name	name
+ *	@param[in]	prefix	1: the keys which start with @a name ignoring case
+ *	@return		1: narrowed, 0: not narrowed
+ *
+ * The next dbop_first() without a key reads only the records of those keys.
+ * Without the case-folded key index, the keys which start with the first
+ * letter of the name in either case are examined.
+ */
+int
+dbop_fold(DBOP *dbop, const char *name, int prefix)
+{
+	STRBUF *sb;
+	VARRAY *vb;
+	const char *key, *p, *end, **keys;
+	char folded[MAXKEYLEN + 1], buf[MAXKEYLEN + 1];
+	int i, len;
+
+	dbop->narrow = 0;
+	if (!(dbop->openflags & DBOP_FOLD) || dbop->mode != 0 || *name == '\0')
+		return 0;
+	if (!dbop->fold_tried) {
+		dbop->fold = fold_open(dbop);
+		dbop->fold_tried = 1;
+	}
+	(void)fold_string(name, folded, sizeof(folded));
+	len = strlen(folded);
+	sb = strbuf_open(0);
+	if (dbop->fold) {
+		/*
+		 * The keys without upper case letters.
+		 */
+		if (prefix) {
+			for (key = dbop_first(dbop, folded, NULL, DBOP_KEY|DBOP_PREFIX); key; key = dbop_next(dbop))
+				strbuf_puts0(sb, key);
+		} else if (dbop_get(dbop, folded) != NULL) {
+			strbuf_puts0(sb, folded);
+		}
+		/*
+		 * The keys with upper case letters.
+		 */
+		for (key = dbop_first(dbop->fold, folded, NULL, prefix ? DBOP_PREFIX : 0); key; key = dbop_next(dbop->fold))
+			strbuf_puts0(sb, key);
+	} else {
+		int upper = (folded[0] >= 'a' && folded[0] <= 'z') ? folded[0] - 'a' + 'A' : folded[0];
+		char first[2];
+
+		first[1] = '\0';
+		for (i = 0; i < 2; i++) {
+			first[0] = (i == 0) ? upper : folded[0];
+			if (i == 1 && upper == folded[0])
+				break;
+			for (key = dbop_first(dbop, first, NULL, DBOP_KEY|DBOP_PREFIX); key; key = dbop_next(dbop)) {
+				(void)fold_string(key, buf, sizeof(buf));
+				if (prefix ? !strncmp(buf, folded, len) : !strcmp(buf, folded))
+					strbuf_puts0(sb, key);
+			}
+		}
+	}
+	/*
+	 * The candidates are read in the order of the tag file.
+	 */
+	vb = varray_open(sizeof(char *), 100);
+	end = strbuf_value(sb) + strbuf_getlen(sb);
+	for (p = strbuf_value(sb); p < end; p += strlen(p) + 1)
+		*(const char **)varray_append(vb) = p;
+	if (dbop->cand == NULL)
+		dbop->cand = strbuf_open(0);
+	else
+		strbuf_reset(dbop->cand);
+	if (vb->length > 0) {
+		keys = (const char **)varray_assign(vb, 0, 0);
+		qsort(keys, vb->length, sizeof(char *), compare_string);
+		for (i = 0; i < vb->length; i++)
+			if (i == 0 || strcmp(keys[i], keys[i - 1]))
+				strbuf_puts0(dbop->cand, keys[i]);
+	}
+	varray_close(vb);
+	strbuf_close(sb);
+	dbop->narrow = 1;
+	return 1;
+}
+/**
+ * dbop_seq: move the cursor for a sequential read.
+ *
+ *	@param[in]	dbop	descripter
+ *	@param[out]	key	key
+ *	@param[out]	dat	data
+ *	@param[in]	flag	#R_FIRST or #R_NEXT
+ *	@return		status of @NAME{seq()}
+ *
+ * If the read is narrowed by dbop_narrow(), the cursor is placed at each
+ * candidate key in turn, and the records of the other keys are skipped.
+ */
+static int
+dbop_seq(DBOP *dbop, DBT *key, DBT *dat, int flag)
+{
+	DB *db = dbop->db;
+	int status;
+
+	if (dbop->candp == NULL)
+		return (*db->seq)(db, key, dat, flag);
+	if (flag == R_NEXT) {
+		status = (*db->seq)(db, key, dat, R_NEXT);
+		if (status != RET_SUCCESS || !strcmp((char *)key->data, dbop->candp))
+			return status;
+		/*
+		 * The records of the current candidate are over.
+		 */
+		dbop->candp += strlen(dbop->candp) + 1;
+		if (dbop->candp < dbop->candend && !strcmp((char *)key->data, dbop->candp))
+			return status;
+	}
+	for (; dbop->candp < dbop->candend; dbop->candp += strlen(dbop->candp) + 1) {
+		key->data = (char *)dbop->candp;
+		key->size = strlen(dbop->candp) + 1;
+		status = (*db->seq)(db, key, dat, R_CURSOR);
+		if (status != RET_SUCCESS)
+			return status;
+		if (!strcmp((char *)key->data, dbop->candp))
+			return status;
+	}
+	return RET_SPECIAL;
+}
 /**
  * dbop_get: get data by a key.
  *
@@ -331,6 +499,11 @@ dbop_get(DBOP *dbop, const char *name)
 	DBT key, dat;
 	int status;
 
+	if (dbop_absent(dbop, name)) {
+		dbop->lastdat = NULL;
+		dbop->lastsize = 0;
+		return NULL;
+	}
 	key.data = (char *)name;
 	key.size = strlen(name)+1;
 
@@ -366,14 +539,14 @@ dbop_put(DBOP *dbop, const char *name, const char *data)
 		die("primary key size == 0.");
 	if (len > MAXKEYLEN)
 		die("primary key too long.");
+	statistics_count(STATISTICS_PUTS, 1);
 	/* sorted writing */
-	if (dbop->sortout != NULL) {
-		fputs(name, dbop->sortout);
-		putc(SORT_SEP, dbop->sortout);
-		fputs(data, dbop->sortout);
-		putc('\n', dbop->sortout);
+	if (dbop->sort != NULL) {
+		extsort_put(dbop->sort, name, data, strlen(data) + 1);
 		return;
 	}
+	if (dbop->changed && !ismeta(name))
+		strhash_assign(dbop->changed, name, 1);
 	key.data = (char *)name;
 	key.size = strlen(name)+1;
 	dat.data = (char *)data;
@@ -395,8 +568,6 @@ dbop_put(DBOP *dbop, const char *name, const char *data)
  *	@param[in]	name	key
  *	@param[in]	data	data
  *	@param[in]	length	length of @a data
- *
- * @note This function doesn't support sorted writing.
  */
 void
 dbop_put_withlen(DBOP *dbop, const char *name, const char *data, int length)
@@ -410,6 +581,14 @@ dbop_put_withlen(DBOP *dbop, const char *name, const char *data, int length)
 		die("primary key size == 0.");
 	if (len > MAXKEYLEN)
 		die("primary key too long.");
+	statistics_count(STATISTICS_PUTS, 1);
+	/* sorted writing */
+	if (dbop->sort != NULL) {
+		extsort_put(dbop->sort, name, data, length);
+		return;
+	}
+	if (dbop->changed && !ismeta(name))
+		strhash_assign(dbop->changed, name, 1);
 	key.data = (char *)name;
 	key.size = strlen(name)+1;
 	dat.data = (char *)data;
@@ -437,6 +616,12 @@ dbop_delete(DBOP *dbop, const char *path)
 	DBT key;
 	int status;
 
+	if (dbop->changed) {
+		const char *name = path ? path : dbop->lastkey;
+
+		if (name && !ismeta(name))
+			strhash_assign(dbop->changed, name, 1);
+	}
 	if (path) {
 		key.data = (char *)path;
 		key.size = strlen(path)+1;
@@ -468,7 +653,9 @@ dbop_update(DBOP *dbop, const char *key, const char *dat)
  *	@param[in]	preg	compiled regular expression if any.
  *	@param[in]	flags	following dbop_next call take over this. <br>
  *			#DBOP_KEY:	read key part <br>
- *			#DBOP_PREFIX:	prefix read; only valied when sequential read
+ *			#DBOP_PREFIX:	prefix read; only valied when sequential read <br>
+ *			#DBOP_SEEK:	start at the first key not less than @a name,
+ *					and read the following records sequentially
  *	@return		data
  */
 const char *
@@ -477,7 +664,10 @@ dbop_first(DBOP *dbop, const char *name, regex_t *preg, int flags)
 	DB *db = dbop->db;
 	DBT key, dat;
 	int status;
+	int narrow = dbop->narrow;
 
+	dbop->narrow = 0;
+	dbop->candp = NULL;
 	dbop->preg = preg;
 	if (flags & DBOP_PREFIX && !name)
 		flags &= ~DBOP_PREFIX;
@@ -485,6 +675,11 @@ dbop_first(DBOP *dbop, const char *name, regex_t *preg, int flags)
 		if (strlen(name) > MAXKEYLEN)
 			die("primary key too long.");
 		strlimcpy(dbop->key, name, sizeof(dbop->key));
+		if (!(flags & (DBOP_PREFIX|DBOP_SEEK)) && dbop_absent(dbop, name)) {
+			dbop->lastdat = NULL;
+			dbop->lastsize = 0;
+			return NULL;
+		}
 		key.data = (char *)name;
 		key.size = strlen(name);
 		/*
@@ -496,6 +691,11 @@ dbop_first(DBOP *dbop, const char *name, regex_t *preg, int flags)
 		for (status = (*db->seq)(db, &key, &dat, R_CURSOR);
 			status == RET_SUCCESS;
 			status = (*db->seq)(db, &key, &dat, R_NEXT)) {
+			if (flags & DBOP_SEEK) {
+				/* the following records are read sequentially */
+				dbop->keylen = dbop->key[0] = 0;
+				break;
+			}
 			if (flags & DBOP_PREFIX) {
 				if (strncmp((char *)key.data, dbop->key, dbop->keylen))
 					return NULL;
@@ -509,9 +709,13 @@ dbop_first(DBOP *dbop, const char *name, regex_t *preg, int flags)
 		}
 	} else {
 		dbop->keylen = dbop->key[0] = 0;
-		for (status = (*db->seq)(db, &key, &dat, R_FIRST);
+		if (narrow) {
+			dbop->candp = strbuf_value(dbop->cand);
+			dbop->candend = dbop->candp + strbuf_getlen(dbop->cand);
+		}
+		for (status = dbop_seq(dbop, &key, &dat, R_FIRST);
 			status == RET_SUCCESS;
-			status = (*db->seq)(db, &key, &dat, R_NEXT)) {
+			status = dbop_seq(dbop, &key, &dat, R_NEXT)) {
 			/* skip meta records */
 			if (ismeta(key.data) && !(dbop->openflags & DBOP_RAW))
 				continue;
@@ -550,7 +754,6 @@ dbop_first(DBOP *dbop, const char *name, regex_t *preg, int flags)
 const char *
 dbop_next(DBOP *dbop)
 {
-	DB *db = dbop->db;
 	int flags = dbop->ioflags;
 	DBT key, dat;
 	int status;
@@ -559,15 +762,14 @@ dbop_next(DBOP *dbop)
 		dbop->unread = 0;
 		return dbop->lastdat;
 	}
-	while ((status = (*db->seq)(db, &key, &dat, R_NEXT)) == RET_SUCCESS) {
+	while ((status = dbop_seq(dbop, &key, &dat, R_NEXT)) == RET_SUCCESS) {
 		assert(dat.data != NULL);
-		/* skip meta records */
-		if (!(dbop->openflags & DBOP_RAW)) {
-			if (flags & DBOP_KEY && ismeta(key.data))
-				continue;
-			else if (ismeta(dat.data))
-				continue;
-		}
+		/*
+		 * skip meta records unless a meta key is being read.
+		 * The key is examined, since the data may be binary (#GTAGS_BINARY).
+		 */
+		if (ismeta(key.data) && !(dbop->openflags & DBOP_RAW) && !(dbop->keylen && ismeta(dbop->key)))
+			continue;
 		if (flags & DBOP_KEY) {
 			if (!strcmp(dbop->prev, (char *)key.data))
 				continue;
@@ -697,6 +899,44 @@ dbop_putversion(DBOP *dbop, int version)
 	snprintf(number, sizeof(number), "%d", version);
 	dbop_putoption(dbop, VERSIONKEY, number);
 }
+/**
+ * dbop_getgeneration: get the generation number in which the tag file was written
+ *
+ *	@return		generation number (0 if not recorded)
+ */
+unsigned long
+dbop_getgeneration(DBOP *dbop)
+{
+	const char *p;
+
+	if ((p = dbop_getoption(dbop, GENERATIONKEY)) == NULL)
+		return 0;
+	return strtoul(p, NULL, 10);
+}
+#ifndef USE_DB185_COMPAT
+/**
+ * sorted_next: read the next sorted record for __bt_bulkload().
+ *
+ *	@param[in]	arg	sorter
+ *	@param[out]	key	key
+ *	@param[out]	dat	data
+ *	@return		RET_SUCCESS: normal, RET_SPECIAL: end of records
+ */
+static int
+sorted_next(void *arg, DBT *key, DBT *dat)
+{
+	const char *name, *data;
+	int len;
+
+	if ((name = extsort_get((EXTSORT *)arg, &data, &len)) == NULL)
+		return RET_SPECIAL;
+	key->data = (char *)name;
+	key->size = strlen(name)+1;
+	dat->data = (char *)data;
+	dat->size = len;
+	return RET_SUCCESS;
+}
+#endif
 /**
  * dbop_close: close db
  * 
@@ -706,37 +946,50 @@ void
 dbop_close(DBOP *dbop)
 {
 	DB *db = dbop->db;
+	STRBUF *added = NULL, *removed = NULL;
+	unsigned long oldgen = 0, gen = 0;
 
+	/*
+	 * The indexes of the tag file are bound to it by the generation number.
+	 * The size and the inode number of a tag file could be the same as those
+	 * of another one, and don't change when it is updated with the delta.
+	 */
+	if (dbop->dbname[0] != '\0'
+	    && ((dbop->mode == 2 && dbop->openflags & DBOP_BLOOM)
+	     || (dbop->mode != 0 && dbop->openflags & (DBOP_TRIGRAM|DBOP_FOLD)))) {
+		if (dbop->mode == 2)
+			oldgen = dbop_getgeneration(dbop);
+		gen = stamp_generation(dbop, oldgen);
+	}
 	/*
 	 * Load sorted tag records and write them to the tag file.
 	 */
-	if (dbop->sortout != NULL) {
-		STRBUF *sb = strbuf_open(256);
-		char *p;
+	if (dbop->sort != NULL) {
+		EXTSORT *es = dbop->sort;
+		const char *key, *data;
+		int len;
 
 		/*
-		 * End of the former stage of sorted writing.
-		 * fclose() and sortout = NULL is important.
-		 *
-		 * fclose(): enables reading from sortin descriptor.
-		 * sortout = NULL: makes the following dbop_put write to the tag file directly.
+		 * sort = NULL makes the following dbop_put_withlen write to the tag file directly.
 		 */
-		fclose(dbop->sortout);
-		dbop->sortout = NULL;
+		dbop->sort = NULL;
+#ifndef USE_DB185_COMPAT
 		/*
-		 * The last stage of sorted writing.
+		 * A new tag file is built from the bottom up without splitting pages.
 		 */
-		while (strbuf_fgets(sb, dbop->sortin, STRBUF_NOCRLF)) {
-			for (p = strbuf_value(sb); *p && *p != SORT_SEP; p++)
-				;
-			if (!*p)
-				die("unexpected end of record.");
-			*p++ = '\0';
-			dbop_put(dbop, strbuf_value(sb), p);
-		}
-		fclose(dbop->sortin);
-		strbuf_close(sb);
-		terminate_sort_process(dbop);
+		if (dbop->mode == 1) {
+			if (__bt_bulkload(db, sorted_next, es, DBOP_FILLFACTOR) != RET_SUCCESS)
+				die(dbop->put_errmsg ? dbop->put_errmsg : "dbop_close failed.");
+		} else
+#endif
+		while ((key = extsort_get(es, &data, &len)) != NULL)
+			dbop_put_withlen(dbop, key, data, len);
+		extsort_close(es);
+	}
+	if (dbop->changed) {
+		added = strbuf_open(0);
+		removed = strbuf_open(0);
+		changed_keys(dbop, added, removed);
 	}
 #ifdef USE_DB185_COMPAT
 	(void)db->close(db);
@@ -746,9 +999,618 @@ dbop_close(DBOP *dbop)
 	 */
 	(void)db->close(db, dbop->dbname[0] == '\0' ? 1 : 0);
 #endif
-	if (dbop->dbname[0] != '\0') {
-		if (dbop->perm && chmod(dbop->dbname, dbop->perm) < 0)
-			die("chmod(2) failed.");
+	if (dbop->dbname[0] != '\0' && dbop->mode != 0) {
+		char tagfile[MAXPATHLEN], delta[MAXPATHLEN];
+		struct stat st, dst;
+
+		strlimcpy(delta, delta_path(dbop->dbname), sizeof(delta));
+		/*
+		 * The tag file after the update is the tag file with the delta,
+		 * or a copy of the tag file into which a large delta is merged.
+		 */
+		strlimcpy(tagfile, dbop->dbname, sizeof(tagfile));
+		if (dbop->delta) {
+			if (stat(dbop->dbname, &st) < 0 || stat(shadow_path(delta), &dst) < 0)
+				die("cannot stat '%s'.", dbop->dbname);
+			if (dst.st_size > st.st_size / DBOP_DELTA_RATIO) {
+				merge_delta(dbop->dbname);
+				strlimcpy(tagfile, shadow_path(dbop->dbname), sizeof(tagfile));
+			} else
+				add_pending(delta);
+		} else {
+			strlimcpy(tagfile, shadow_path(dbop->dbname), sizeof(tagfile));
+			if (dbop->perm && chmod(tagfile, dbop->perm) < 0)
+				die("chmod(2) failed.");
+			add_pending(dbop->dbname);
+			if (dbop->mode == 1)
+				dbop_remove(delta);
+		}
+		/*
+		 * The indexes are made after the tag file is complete. They read
+		 * the tag file as it is pending.
+		 */
+		if (dbop->openflags & DBOP_BLOOM)
+			bloom_make(tagfile, dbop->dbname, gen);
+		if (dbop->openflags & DBOP_TRIGRAM) {
+			if (added)
+				trigram_update(tagfile, dbop->dbname, added, oldgen, gen);
+			else
+				trigram_make(tagfile, dbop->dbname, gen);
+		}
+		if (dbop->openflags & DBOP_FOLD) {
+			if (added)
+				fold_update(tagfile, dbop->dbname, added, removed, oldgen, gen);
+			else
+				fold_make(tagfile, dbop->dbname, gen);
+		}
 	}
+	if (dbop->bloom)
+		bloom_close(dbop->bloom);
+	if (dbop->trigram)
+		trigram_close(dbop->trigram);
+	if (dbop->cand)
+		strbuf_close(dbop->cand);
+	if (dbop->fold)
+		dbop_close(dbop->fold);
+	if (dbop->changed)
+		strhash_close(dbop->changed);
+	if (added)
+		strbuf_close(added);
+	if (removed)
+		strbuf_close(removed);
 	(void)free(dbop);
 }
+/**
+ * changed_keys: get the keys added to or removed from a tag file being updated.
+ *
+ *	@param[in]	dbop	descripter (mode 2)
+ *	@param[out]	added	keys which are not in the tag file before the update
+ *	@param[out]	removed	keys which are not in the tag file after the update
+ *
+ * The tag file itself is not replaced until dbop_publish(), so it is
+ * compared with the shadow for the keys put or deleted.
+ */
+static void
+changed_keys(DBOP *dbop, STRBUF *added, STRBUF *removed)
+{
+	DBOP *orig = dbop_open(dbop->dbname, 0, 0, 0);
+	struct sh_entry *entry;
+	int before, after;
+
+	for (entry = strhash_first(dbop->changed); entry; entry = strhash_next(dbop->changed)) {
+		before = orig != NULL && dbop_get(orig, entry->name) != NULL;
+		after = dbop_get(dbop, entry->name) != NULL;
+		if (!before && after)
+			strbuf_puts0(added, entry->name);
+		else if (before && !after)
+			strbuf_puts0(removed, entry->name);
+	}
+	if (orig)
+		dbop_close(orig);
+}
+/**
+ * dbop_pending: write a file which is replaced together with the tag files.
+ *
+ *	@param[in]	path	file (e.g. an index of a tag file)
+ *	@return		path of its shadow, to which the file is written
+ *
+ * The file is replaced with the shadow by dbop_publish(), or the shadow is
+ * removed by dbop_discard().
+ */
+const char *
+dbop_pending(const char *path)
+{
+	add_pending(path);
+	return shadow_path(path);
+}
+/**
+ * dbop_remove: remove a file together with the replacement of the tag files.
+ *
+ *	@param[in]	path	file
+ *
+ * The file is removed by dbop_publish(). If it is a tag file, its delta is
+ * removed too. Nothing is done if the file doesn't exist.
+ */
+void
+dbop_remove(const char *path)
+{
+	char delta[MAXPATHLEN];
+
+	if (!test("f", path) && !is_pending(path))
+		return;
+	(void)unlink(shadow_path(path));
+	add_pending(path);
+	strlimcpy(delta, delta_path(path), sizeof(delta));
+	dbop_remove(delta);
+}
+/**
+ * dbop_publish: replace the tag files with their shadows.
+ *
+ * The tag files in the same directory are replaced together, while the
+ * generation number of the directory is odd. Call this after all the tag
+ * files updated at the same time are closed. A pending file which has no
+ * shadow is removed (see dbop_remove()).
+ */
+void
+dbop_publish(void)
+{
+	const char *start, *end, *p, *q;
+	char dir[MAXPATHLEN], shadow[MAXPATHLEN];
+	unsigned long gen;
+
+	if (pending == NULL || strbuf_getlen(pending) == 0)
+		return;
+	start = strbuf_value(pending);
+	end = start + strbuf_getlen(pending);
+	for (p = start; p < end; p += strlen(p) + 1) {
+		int dirlen = dirlength(p);
+
+		/*
+		 * Each directory is published once, at its first pending file.
+		 */
+		for (q = start; q < p; q += strlen(q) + 1)
+			if (dirlength(q) == dirlen && !strncmp(q, p, dirlen))
+				break;
+		if (q < p)
+			continue;
+		if (dirlen > 0)
+			snprintf(dir, sizeof(dir), "%.*s", dirlen, p);
+		else
+			strlimcpy(dir, ".", sizeof(dir));
+		gen = read_generation(dir);
+		gen += (gen & 1) ? 2 : 1;
+		write_generation(dir, gen);
+		for (q = p; q < end; q += strlen(q) + 1) {
+			if (dirlength(q) != dirlen || strncmp(q, p, dirlen))
+				continue;
+			strlimcpy(shadow, shadow_path(q), sizeof(shadow));
+			if (!test("f", shadow)) {
+				(void)unlink(q);
+				continue;
+			}
+#if defined(_WIN32) && !defined(__CYGWIN__)
+			(void)unlink(q);
+#endif
+			if (rename(shadow, q) < 0)
+				die("cannot rename '%s' to '%s'.", shadow, q);
+		}
+		write_generation(dir, gen + 1);
+	}
+	strbuf_reset(pending);
+}
+/**
+ * dbop_discard: remove the shadows of the pending tag files.
+ */
+void
+dbop_discard(void)
+{
+	const char *start, *end, *p;
+
+	if (pending == NULL)
+		return;
+	start = strbuf_value(pending);
+	end = start + strbuf_getlen(pending);
+	for (p = start; p < end; p += strlen(p) + 1)
+		(void)unlink(shadow_path(p));
+	strbuf_reset(pending);
+}
+/**
+ * dbop_generation: generation number of the tag files in a directory.
+ *
+ *	@param[in]	dir	directory
+ *	@return		generation number (0 if unknown)
+ *
+ * If a publication is in progress, this waits for it by reading again after
+ * a while, which is doubled each time. If the number stays odd (a writer died
+ * while publishing), it is returned as is.
+ */
+unsigned long
+dbop_generation(const char *dir)
+{
+	unsigned long gen = read_generation(dir);
+	long usec = GENERATION_WAIT;
+	int i;
+
+	for (i = 0; (gen & 1) && i < GENERATION_RETRY; i++) {
+		wait_usec(usec);
+		if (usec < GENERATION_MAXWAIT)
+			usec *= 2;
+		if (usec > GENERATION_MAXWAIT)
+			usec = GENERATION_MAXWAIT;
+		gen = read_generation(dir);
+	}
+	return gen;
+}
+/**
+ * shadow_path: path name of the shadow of a tag file
+ */
+static const char *
+shadow_path(const char *path)
+{
+	static char shadow[MAXPATHLEN];
+
+	if (strlen(path) + sizeof(DBOP_SHADOW_SUFFIX) > sizeof(shadow))
+		die("path name too long.");
+	strlimcpy(shadow, path, sizeof(shadow));
+	strcat(shadow, DBOP_SHADOW_SUFFIX);
+	return shadow;
+}
+/**
+ * delta_path: path name of the delta of a tag file
+ */
+static const char *
+delta_path(const char *path)
+{
+	static char delta[MAXPATHLEN];
+
+	if (strlen(path) + sizeof(DBOP_DELTA_SUFFIX) > sizeof(delta))
+		die("path name too long.");
+	strlimcpy(delta, path, sizeof(delta));
+	strcat(delta, DBOP_DELTA_SUFFIX);
+	return delta;
+}
+/**
+ * add_pending: put a file on the list of pending files.
+ */
+static void
+add_pending(const char *path)
+{
+	if (is_pending(path))
+		return;
+	if (pending == NULL)
+		pending = strbuf_open(0);
+	strbuf_puts0(pending, path);
+}
+/**
+ * is_pending: whether or not a tag file is waiting for dbop_publish()
+ */
+static int
+is_pending(const char *path)
+{
+	const char *start, *end, *p;
+
+	if (pending == NULL)
+		return 0;
+	start = strbuf_value(pending);
+	end = start + strbuf_getlen(pending);
+	for (p = start; p < end; p += strlen(p) + 1)
+		if (!strcmp(p, path))
+			return 1;
+	return 0;
+}
+/**
+ * dirlength: length of the directory part of a path name
+ *
+ *	@return		length without the last '/', or 0 if there is no directory part
+ */
+static int
+dirlength(const char *path)
+{
+	const char *p = locatestring(path, "/", MATCH_LAST);
+
+	return p ? p - path : 0;
+}
+/**
+ * merge_delta: make the shadow of a tag file from the tag file and the shadow of its delta.
+ *
+ * The tag file is replaced with the shadow and the delta is removed by dbop_publish().
+ */
+static void
+merge_delta(const char *path)
+{
+#ifndef USE_DB185_COMPAT
+	char shadow[MAXPATHLEN], delta[MAXPATHLEN];
+
+	strlimcpy(shadow, shadow_path(path), sizeof(shadow));
+	strlimcpy(delta, shadow_path(delta_path(path)), sizeof(delta));
+	if (copy_file(path, shadow) < 0 || __bt_merge(shadow, delta) != RET_SUCCESS)
+		die("cannot merge '%s' into '%s'.", delta, shadow);
+	(void)unlink(delta);
+	add_pending(path);
+	dbop_remove(delta_path(path));
+#endif
+}
+/**
+ * wait_usec: wait for a while.
+ *
+ *	@param[in]	usec	microseconds
+ */
+static void
+wait_usec(long usec)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+	Sleep(usec / 1000 + 1);
+#else
+	struct timespec ts;
+
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = usec % 1000000 * 1000;
+	(void)nanosleep(&ts, NULL);
+#endif
+}
+/**
+ * copy_file: copy a tag file to its shadow keeping the permission.
+ *
+ *	@return		0: normal, -1: @a from doesn't exist
+ *
+ * If the file system supports it, the shadow is made as a clone of the
+ * tag file which shares its blocks until they are written.
+ */
+static int
+copy_file(const char *from, const char *to)
+{
+	struct stat st;
+	char buf[65536];
+	int ip, op, size;
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+	if ((ip = open(from, O_RDONLY|O_BINARY)) < 0)
+		return -1;
+	if (fstat(ip, &st) < 0)
+		die("cannot stat '%s'.", from);
+	(void)unlink(to);
+	if ((op = open(to, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, st.st_mode & 0777)) < 0)
+		die("cannot make '%s'.", to);
+#ifdef FICLONE
+	if (ioctl(op, FICLONE, ip) == 0) {
+		if (close(op) < 0)
+			die("cannot write '%s'.", to);
+		close(ip);
+		return 0;
+	}
+#endif
+	while ((size = read(ip, buf, sizeof(buf))) != 0) {
+		if (size < 0)
+			die("cannot read '%s'.", from);
+		if (write(op, buf, size) != size)
+			die("cannot write '%s'.", to);
+	}
+	if (close(op) < 0)
+		die("cannot write '%s'.", to);
+	close(ip);
+	return 0;
+}
+/**
+ * read_generation: read the generation number of a directory.
+ */
+static unsigned long
+read_generation(const char *dir)
+{
+	char buf[32];
+	int fd, n;
+
+	if ((fd = open(makepath(dir, DBOP_GENERATION, NULL), O_RDONLY)) < 0)
+		return 0;
+	n = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (n <= 0)
+		return 0;
+	buf[n] = '\0';
+	return strtoul(buf, NULL, 10);
+}
+/**
+ * write_generation: write the generation number of a directory.
+ *
+ * The number is written to a temporary file and renamed, so a reader
+ * always reads a whole number.
+ */
+static void
+write_generation(const char *dir, unsigned long gen)
+{
+	char path[MAXPATHLEN], tmp[MAXPATHLEN];
+	FILE *op;
+
+	strlimcpy(path, makepath(dir, DBOP_GENERATION, NULL), sizeof(path));
+	if (snprintf(tmp, sizeof(tmp), "%s%s", path, DBOP_SHADOW_SUFFIX) >= sizeof(tmp))
+		die("path name too long.");
+	if ((op = fopen(tmp, "w")) == NULL)
+		die("cannot make '%s'.", tmp);
+	fprintf(op, "%lu\n", gen);
+	if (fclose(op) != 0)
+		die("cannot write '%s'.", tmp);
+#if defined(_WIN32) && !defined(__CYGWIN__)
+	(void)unlink(path);
+#endif
+	if (rename(tmp, path) < 0)
+		die("cannot rename '%s' to '%s'.", tmp, path);
+}
+/**
+ * stamp_generation: record the generation number in a tag file being written.
+ *
+ *	@param[in]	dbop	descripter (mode 1 or 2)
+ *	@param[in]	oldgen	generation number of the tag file before the update
+ *	@return		generation number
+ *
+ * It is the generation number of the directory which dbop_publish() will
+ * make, and is greater than the old one even if @FILE{GGEN} was removed.
+ */
+static unsigned long
+stamp_generation(DBOP *dbop, unsigned long oldgen)
+{
+	char dir[MAXPATHLEN], buf[32];
+	int dirlen = dirlength(dbop->dbname);
+	unsigned long gen;
+
+	if (dirlen > 0)
+		snprintf(dir, sizeof(dir), "%.*s", dirlen, dbop->dbname);
+	else
+		strlimcpy(dir, ".", sizeof(dir));
+	gen = read_generation(dir);
+	gen += (gen & 1) ? 3 : 2;
+	if (gen <= oldgen)
+		gen = oldgen + 1;
+	/* the tag file may allow duplicate records */
+	if (oldgen)
+		dbop_delete(dbop, GENERATIONKEY);
+	snprintf(buf, sizeof(buf), "%lu", gen);
+	dbop_putoption(dbop, GENERATIONKEY, buf);
+	return gen;
+}
+/**
+ * fold_path: path name of the case-folded key index of a tag file
+ */
+static const char *
+fold_path(const char *path)
+{
+	static char fold[MAXPATHLEN];
+
+	if (strlen(path) + sizeof(DBOP_FOLD_SUFFIX) > sizeof(fold))
+		die("path name too long.");
+	strlimcpy(fold, path, sizeof(fold));
+	strcat(fold, DBOP_FOLD_SUFFIX);
+	return fold;
+}
+/**
+ * fold_string: fold a string to lower case.
+ *
+ *	@param[in]	s	string
+ *	@param[out]	buf	result
+ *	@param[in]	size	size of @a buf
+ *	@return		1: @a s has upper case letters, 0: it doesn't
+ */
+static int
+fold_string(const char *s, char *buf, int size)
+{
+	char *p = buf, *end = buf + size - 1;
+	int upper = 0;
+
+	for (; *s && p < end; s++) {
+		if (*s >= 'A' && *s <= 'Z') {
+			*p++ = *s - 'A' + 'a';
+			upper = 1;
+		} else
+			*p++ = *s;
+	}
+	*p = '\0';
+	return upper;
+}
+/**
+ * fold_open: open the case-folded key index of a tag file.
+ *
+ *	@return		descripter, or @VAR{NULL} if the index doesn't exist or is out of date
+ */
+static DBOP *
+fold_open(DBOP *dbop)
+{
+	DBOP *fold;
+	struct stat st;
+	const char *p;
+	unsigned long gen, generation = dbop_getgeneration(dbop);
+	long size, ino;
+	int fd = (*dbop->db->fd)(dbop->db);
+
+	if (fd < 0 || fstat(fd, &st) < 0 || generation == 0)
+		return NULL;
+	if ((fold = dbop_open(fold_path(dbop->dbname), 0, 0, 0)) == NULL)
+		return NULL;
+	if ((p = dbop_getoption(fold, TAGFILEKEY)) == NULL
+	    || sscanf(p, "%ld %ld %lu", &size, &ino, &gen) != 3
+	    || size != (long)st.st_size || ino != (long)st.st_ino || gen != generation) {
+		dbop_close(fold);
+		return NULL;
+	}
+	return fold;
+}
+/**
+ * fold_make: make the case-folded key index of a tag file.
+ *
+ *	@param[in]	tagfile	path of the tag file to read (must be closed)
+ *	@param[in]	name	path of the tag file which the index is for. <br>
+ *			It differs from @a tagfile when the tag file is a shadow.
+ *	@param[in]	generation	generation number of the tag file
+ */
+static void
+fold_make(const char *tagfile, const char *name, unsigned long generation)
+{
+	DBOP *dbop, *fold;
+	struct stat st;
+	const char *key;
+	char path[MAXPATHLEN], folded[MAXKEYLEN + 1], buf[64];
+
+	/* tagfile may be the buffer of shadow_path(), which dbop_open() uses. */
+	strlimcpy(path, tagfile, sizeof(path));
+	if (stat(path, &st) < 0)
+		die("cannot stat '%s'.", path);
+	if ((dbop = dbop_open(path, 0, 0, 0)) == NULL)
+		die("%s not found.", path);
+	if ((fold = dbop_open(fold_path(name), 1, 0644, DBOP_DUP|DBOP_SORTED_WRITE)) == NULL)
+		die("cannot make '%s'.", fold_path(name));
+	for (key = dbop_first(dbop, NULL, NULL, DBOP_KEY); key; key = dbop_next(dbop))
+		if (fold_string(key, folded, sizeof(folded)))
+			dbop_put(fold, folded, key);
+	dbop_close(dbop);
+	snprintf(buf, sizeof(buf), "%ld %ld %lu", (long)st.st_size, (long)st.st_ino, generation);
+	dbop_putoption(fold, TAGFILEKEY, buf);
+	dbop_close(fold);
+}
+/**
+ * fold_update: update the case-folded key index of a tag file.
+ *
+ *	@param[in]	tagfile	path of the updated tag file (must be closed)
+ *	@param[in]	name	path of the tag file which the index is for
+ *	@param[in]	added	keys added to the tag file
+ *	@param[in]	removed	keys removed from the tag file
+ *	@param[in]	oldgen	generation number of the tag file before the update
+ *	@param[in]	generation	generation number of the updated tag file
+ *
+ * If the index is not for the tag file before the update, it is made again.
+ */
+static void
+fold_update(const char *tagfile, const char *name, STRBUF *added, STRBUF *removed, unsigned long oldgen, unsigned long generation)
+{
+	DBOP *fold;
+	struct stat st;
+	const char *p, *key, *end, *data;
+	unsigned long gen;
+	long size, ino;
+	int valid = 0;
+	char path[MAXPATHLEN], folded[MAXKEYLEN + 1], buf[64];
+
+	strlimcpy(path, tagfile, sizeof(path));
+	if (stat(name, &st) == 0 && (fold = dbop_open(fold_path(name), 0, 0, 0)) != NULL) {
+		if ((p = dbop_getoption(fold, TAGFILEKEY)) != NULL
+		    && sscanf(p, "%ld %ld %lu", &size, &ino, &gen) == 3
+		    && size == (long)st.st_size && ino == (long)st.st_ino
+		    && oldgen != 0 && gen == oldgen)
+			valid = 1;
+		dbop_close(fold);
+	}
+	if (!valid) {
+		fold_make(path, name, generation);
+		return;
+	}
+	if (stat(path, &st) < 0)
+		die("cannot stat '%s'.", path);
+	if ((fold = dbop_open(fold_path(name), 2, 0644, DBOP_DUP)) == NULL)
+		die("cannot open '%s'.", fold_path(name));
+	end = strbuf_value(removed) + strbuf_getlen(removed);
+	for (key = strbuf_value(removed); key < end; key += strlen(key) + 1) {
+		if (!fold_string(key, folded, sizeof(folded)))
+			continue;
+		for (data = dbop_first(fold, folded, NULL, 0); data; data = dbop_next(fold)) {
+			if (!strcmp(data, key)) {
+				dbop_delete(fold, NULL);
+				break;
+			}
+		}
+	}
+	end = strbuf_value(added) + strbuf_getlen(added);
+	for (key = strbuf_value(added); key < end; key += strlen(key) + 1)
+		if (fold_string(key, folded, sizeof(folded)))
+			dbop_put(fold, folded, key);
+	/* the index allows duplicate records */
+	dbop_delete(fold, TAGFILEKEY);
+	snprintf(buf, sizeof(buf), "%ld %ld %lu", (long)st.st_size, (long)st.st_ino, generation);
+	dbop_putoption(fold, TAGFILEKEY, buf);
+	dbop_close(fold);
+}
+/**
+ * compare_string: compare function for qsort(3)
+ */
+static int
+compare_string(const void *s1, const void *s2)
+{
+	return strcmp(*(const char **)s1, *(const char **)s2);
+}
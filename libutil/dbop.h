@@ -27,17 +27,48 @@
 #else
 #include "db.h"
 #endif
+#include "bloom.h"
+#include "extsort.h"
 #include "regex.h"
 #include "strbuf.h"
-
-#if defined(_WIN32) && !defined(__CYGWIN__)
-typedef void* HANDLE;
-#endif
+#include "strhash.h"
+#include "trigram.h"
 
 #define DBOP_PAGESIZE	8192
+/**
+ * Fill factor (%) of the pages of a new tag file. See dbop_close().
+ */
+#define DBOP_FILLFACTOR	100
 #define VERSIONKEY	" __.VERSION"
+/**
+ * Generation number of the directory in which a tag file was written.
+ * The indexes of the tag file record it. See dbop_close().
+ */
+#define GENERATIONKEY	" __.GENERATION"
+/**
+ * Suffix of the shadow file which is written instead of a tag file. See dbop_open().
+ */
+#define DBOP_SHADOW_SUFFIX	".new"
+/**
+ * Suffix of the file to which the pages of a tag file are written when it is
+ * updated. See dbop_open().
+ */
+#define DBOP_DELTA_SUFFIX	".delta"
+/**
+ * The delta is merged into a new tag file when it becomes larger than
+ * 1/#DBOP_DELTA_RATIO of the tag file. See dbop_close().
+ */
+#define DBOP_DELTA_RATIO	8
+/**
+ * File of the generation number of the tag files in a directory. See dbop_publish().
+ */
+#define DBOP_GENERATION	"GGEN"
+/**
+ * Suffix of the case-folded key index of a tag file. See dbop_fold().
+ */
+#define DBOP_FOLD_SUFFIX	".fold"
 
-typedef	struct {
+typedef	struct dbop {
 	/**
 	 * @name (1) COMMON PART
 	 */
@@ -64,19 +95,49 @@ typedef	struct {
 	int keylen;			/**< key length */
 	char prev[MAXKEYLEN];		/**< previous key value */
 	int perm;			/**< file permission */
+	int delta;			/**< 1: the pages are written to the delta (mode 2) */
 	/** @} */
 
 	/**
 	 * @name (3) sorted write
 	 */
 	/** @{ */
-	FILE *sortout;			/**< write to sort command */
-	FILE *sortin;			/**< read from sort command */
-#if defined(_WIN32) && !defined(__CYGWIN__)
-	HANDLE pid;
-#else
-	int pid;			/**< sort process id */
-#endif
+	EXTSORT *sort;			/**< sorter */
+	/** @} */
+
+	/**
+	 * @name (4) key filter (#DBOP_BLOOM)
+	 */
+	/** @{ */
+	BLOOM *bloom;			/**< filter (loaded on demand) */
+	int bloom_tried;		/**< bloom_open() has been called */
+	/** @} */
+
+	/**
+	 * @name (5) candidate keys (#DBOP_TRIGRAM)
+	 */
+	/** @{ */
+	TRIGRAM *trigram;		/**< trigram index (loaded on demand) */
+	int trigram_tried;		/**< trigram_open() has been called */
+	STRBUF *cand;			/**< candidate keys (NUL separated) */
+	int narrow;			/**< 1: the next dbop_first() reads @a cand only */
+	const char *candp;		/**< current candidate (@VAR{NULL}: not narrowed) */
+	const char *candend;		/**< end of @a cand */
+	/** @} */
+
+	/**
+	 * @name (6) case-folded key index (#DBOP_FOLD)
+	 */
+	/** @{ */
+	struct dbop *fold;		/**< index (loaded on demand) */
+	int fold_tried;			/**< the index has been opened */
+	/** @} */
+
+	/**
+	 * @name (7) update of the indexes (#DBOP_TRIGRAM, #DBOP_FOLD)
+	 */
+	/** @{ */
+	STRHASH *changed;		/**< keys put or deleted while updating (mode 2) */
 	/** @} */
 } DBOP;
 
@@ -86,6 +147,12 @@ typedef	struct {
 /** @{ */
 		/** allow duplicate records	*/
 #define	DBOP_DUP	1
+		/** use (read) or make (write) the key filter */
+#define	DBOP_BLOOM	16
+		/** use (read) or make (write) the trigram index */
+#define	DBOP_TRIGRAM	64
+		/** use (read) or make (write) the case-folded key index */
+#define	DBOP_FOLD	128
 /** @} */
 
 /**
@@ -100,10 +167,15 @@ typedef	struct {
 #define DBOP_RAW		4
 			/** sorted write */
 #define DBOP_SORTED_WRITE	8
+			/** start at the first key not less than the name */
+#define DBOP_SEEK		32
 /** @} */
 
 DBOP *dbop_open(const char *, int, int, int);
 const char *dbop_get(DBOP *, const char *);
+int dbop_absent(DBOP *, const char *);
+int dbop_narrow(DBOP *, const char *, int);
+int dbop_fold(DBOP *, const char *, int);
 void dbop_put(DBOP *, const char *, const char *);
 void dbop_put_withlen(DBOP *, const char *, const char *, int);
 void dbop_delete(DBOP *, const char *);
@@ -117,6 +189,12 @@ const char *dbop_getoption(DBOP *, const char *);
 void dbop_putoption(DBOP *, const char *, const char *);
 int dbop_getversion(DBOP *);
 void dbop_putversion(DBOP *, int);
+unsigned long dbop_getgeneration(DBOP *);
 void dbop_close(DBOP *);
+const char *dbop_pending(const char *);
+void dbop_remove(const char *);
+void dbop_publish(void);
+void dbop_discard(void);
+unsigned long dbop_generation(const char *);
 
 #endif /* _DBOP_H_ */
@@ -47,7 +47,7 @@ defined(const char *name)
 		 */
 		if (!(dbpath = getenv("GTAGSDBPATH")))
 			dbpath = ".";
-		dbop = dbop_open(makepath(dbpath, "GTAGS", NULL), 0, 0, 0);
+		dbop = dbop_open(makepath(dbpath, "GTAGS", NULL), 0, 0, DBOP_BLOOM);
 		if (dbop == NULL)
 			die("'GTAGS' not found.");
 	}
@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if (defined(_WIN32) && !defined(__CYGWIN__))
+#include <io.h>
+#include <share.h>
+#define mkstemp(p) open(_mktemp(p), _O_CREAT | _O_RDWR | _O_BINARY | _O_TEMPORARY, _S_IWRITE | _SH_DENYRW)
+#endif
+
+#include "checkalloc.h"
+#include "die.h"
+#include "extsort.h"
+#include "gparam.h"
+#include "strbuf.h"
+
+/**
+ @file
+
+ External merge sort of records.
+
+ Each record consists of a key (string) and data (binary). Records are sorted
+ by the key and then by the data, both compared bytewise. This is the same
+ order as @XREF{sort,1} @OPTION{-k 1,1} in the C locale makes for lines
+ of 'key\\tdata'.
+
+ @code{.txt}
+	extsort_put()		records are stored in memory
+	    |
+	    | (memory is full)
+	    v
+	write_run()		sorted records (a run) are written
+	    |			to the temporary file
+	    v
+	extsort_get()		runs are merged and returned in order
+ @endcode
+
+ If all records fit in memory, the temporary file is never made.
+*/
+
+/**
+ * Record layout: int keylen, int datalen, key, '\\0', data, '\\0'
+ */
+#define HEADSIZE	(sizeof(int) * 2)
+#define RECSIZE(keylen, datalen)	(HEADSIZE + (keylen) + 1 + (datalen) + 1)
+/** size of write buffer */
+#define WRITEBUFSIZE	65536
+/** minimum size of read buffer for a run */
+#define MINREADBUFSIZE	65536
+
+struct extsort_run {
+	off_t offset;			/**< offset of unread part in the temporary file */
+	off_t end;			/**< end of the run in the temporary file */
+	char *buf;			/**< read buffer */
+	int bufsize;			/**< size of @a buf */
+	int len;			/**< length of valid data in @a buf */
+	int pos;			/**< position of the current record in @a buf */
+};
+
+static int
+reclen(const char *rec)
+{
+	int len[2];
+
+	memcpy(len, rec, HEADSIZE);
+	return RECSIZE(len[0], len[1]);
+}
+/**
+ * compare: compare two records.
+ */
+static int
+compare(const char *r1, const char *r2)
+{
+	int len1[2], len2[2], n;
+
+	memcpy(len1, r1, HEADSIZE);
+	memcpy(len2, r2, HEADSIZE);
+	r1 += HEADSIZE;
+	r2 += HEADSIZE;
+	/* compare keys including the terminating '\0' */
+	n = memcmp(r1, r2, (len1[0] < len2[0] ? len1[0] : len2[0]) + 1);
+	if (n != 0)
+		return n;
+	r1 += len1[0] + 1;
+	r2 += len2[0] + 1;
+	n = memcmp(r1, r2, len1[1] < len2[1] ? len1[1] : len2[1]);
+	if (n != 0)
+		return n;
+	return len1[1] - len2[1];
+}
+/*
+ * qsort(3) doesn't pass any context to the compare function.
+ */
+static const char *sort_base;
+
+static int
+compare_index(const void *i1, const void *i2)
+{
+	return compare(sort_base + *(const int *)i1, sort_base + *(const int *)i2);
+}
+/**
+ * open_tempfile: make an anonymous temporary file in @CODE{$TMPDIR}.
+ */
+static int
+open_tempfile(void)
+{
+	char path[MAXPATHLEN];
+	const char *tmpdir;
+	int fd;
+
+	tmpdir = getenv("TMPDIR");
+#if defined(_WIN32) && !defined(__CYGWIN__)
+	if (tmpdir == NULL)
+		tmpdir = getenv("TMP");
+#endif
+	if (tmpdir == NULL)
+		tmpdir = "/tmp";
+	if (snprintf(path, sizeof(path), "%s/gtags.XXXXXX", tmpdir) >= sizeof(path))
+		die("TMPDIR too long.");
+	if ((fd = mkstemp(path)) < 0)
+		die("cannot make temporary file in '%s'.\nYou can specify the directory for the temporary file using environment variable 'TMPDIR'.", tmpdir);
+#if !defined(_WIN32) || defined(__CYGWIN__)
+	(void)unlink(path);
+#endif
+	return fd;
+}
+static void
+flush_writebuf(EXTSORT *es)
+{
+	const char *p = strbuf_value(es->wb);
+	int len = strbuf_getlen(es->wb);
+	int n;
+
+	while (len > 0) {
+		if ((n = write(es->fd, p, len)) < 0) {
+			if (errno == EINTR)
+				continue;
+			die("cannot write to temporary file.\nYou can specify the directory for the temporary file using environment variable 'TMPDIR'.");
+		}
+		p += n;
+		len -= n;
+		es->tmpsize += n;
+	}
+	strbuf_reset(es->wb);
+}
+/**
+ * write_run: sort records in memory and write them to the temporary file.
+ */
+static void
+write_run(EXTSORT *es)
+{
+	struct extsort_run *run;
+	int i;
+
+	if (es->fd < 0) {
+		es->fd = open_tempfile();
+		es->wb = strbuf_open(WRITEBUFSIZE);
+	}
+	sort_base = es->buf;
+	qsort(es->index, es->count, sizeof(int), compare_index);
+	es->runs = (struct extsort_run *)check_realloc(es->runs, sizeof(struct extsort_run) * (es->nruns + 1));
+	run = &es->runs[es->nruns++];
+	memset(run, 0, sizeof(*run));
+	run->offset = es->tmpsize;
+	for (i = 0; i < es->count; i++) {
+		const char *rec = es->buf + es->index[i];
+
+		strbuf_nputs(es->wb, rec, reclen(rec));
+		if (strbuf_getlen(es->wb) >= WRITEBUFSIZE)
+			flush_writebuf(es);
+	}
+	flush_writebuf(es);
+	run->end = es->tmpsize;
+	es->used = es->count = 0;
+}
+/**
+ * fill_run: make at least @a need bytes of the current record available in the buffer.
+ *
+ *	@return	length of available data from the current record
+ */
+static int
+fill_run(EXTSORT *es, struct extsort_run *run, int need)
+{
+	int n;
+
+	if (run->len - run->pos >= need)
+		return run->len - run->pos;
+	if (run->pos > 0) {
+		memmove(run->buf, run->buf + run->pos, run->len - run->pos);
+		run->len -= run->pos;
+		run->pos = 0;
+	}
+	if (need > run->bufsize) {
+		run->bufsize = need;
+		run->buf = check_realloc(run->buf, run->bufsize);
+	}
+	while (run->len < run->bufsize && run->offset < run->end) {
+		n = run->bufsize - run->len;
+		if (run->end - run->offset < n)
+			n = run->end - run->offset;
+		if (lseek(es->fd, run->offset, SEEK_SET) < 0)
+			die("cannot seek temporary file.");
+		if ((n = read(es->fd, run->buf + run->len, n)) <= 0) {
+			if (n < 0 && errno == EINTR)
+				continue;
+			die("cannot read temporary file.");
+		}
+		run->offset += n;
+		run->len += n;
+	}
+	return run->len;
+}
+/**
+ * current_record: return the current record of a run.
+ *
+ *	@return	record, @VAR{NULL}: end of the run
+ */
+static const char *
+current_record(EXTSORT *es, struct extsort_run *run)
+{
+	int len = fill_run(es, run, HEADSIZE);
+
+	if (len == 0)
+		return NULL;
+	if (len < HEADSIZE)
+		die("temporary file is broken.");
+	len = reclen(run->buf + run->pos);
+	if (fill_run(es, run, len) < len)
+		die("temporary file is broken.");
+	return run->buf + run->pos;
+}
+/*
+ * Heap of runs ordered by their current records.
+ */
+static int
+less_run(EXTSORT *es, int r1, int r2)
+{
+	int n = compare(es->runs[r1].buf + es->runs[r1].pos, es->runs[r2].buf + es->runs[r2].pos);
+
+	return n < 0 || (n == 0 && r1 < r2);
+}
+static void
+sift_down(EXTSORT *es, int i)
+{
+	int *heap = es->heap;
+	int child, tmp;
+
+	for (;;) {
+		child = i * 2 + 1;
+		if (child >= es->heapsize)
+			break;
+		if (child + 1 < es->heapsize && less_run(es, heap[child + 1], heap[child]))
+			child++;
+		if (!less_run(es, heap[child], heap[i]))
+			break;
+		tmp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = tmp;
+		i = child;
+	}
+}
+/**
+ * start_reading: prepare for reading records in order.
+ */
+static void
+start_reading(EXTSORT *es)
+{
+	int i, bufsize;
+
+	es->reading = 1;
+	if (es->nruns == 0) {
+		sort_base = es->buf;
+		qsort(es->index, es->count, sizeof(int), compare_index);
+		es->next = 0;
+		return;
+	}
+	/*
+	 * Write the rest of records, and merge all runs.
+	 */
+	if (es->count > 0)
+		write_run(es);
+	free(es->buf);
+	free(es->index);
+	es->buf = NULL;
+	es->index = NULL;
+	es->bufsize = es->indexsize = 0;
+	bufsize = es->memsize / es->nruns;
+	if (bufsize < MINREADBUFSIZE)
+		bufsize = MINREADBUFSIZE;
+	es->heap = (int *)check_malloc(sizeof(int) * es->nruns);
+	es->heapsize = 0;
+	for (i = 0; i < es->nruns; i++) {
+		struct extsort_run *run = &es->runs[i];
+
+		run->bufsize = bufsize;
+		run->buf = check_malloc(run->bufsize);
+		if (current_record(es, run) != NULL)
+			es->heap[es->heapsize++] = i;
+	}
+	for (i = es->heapsize / 2 - 1; i >= 0; i--)
+		sift_down(es, i);
+	es->popped = 0;
+}
+/**
+ * extsort_open: open a sorter.
+ *
+ *	@param[in]	memsize	size of memory for sorting (bytes) <br>
+ *			If records exceed it, they are sorted in pieces using
+ *			the temporary file.
+ *	@return		sorter
+ */
+EXTSORT *
+extsort_open(int memsize)
+{
+	EXTSORT *es = (EXTSORT *)check_calloc(sizeof(EXTSORT), 1);
+
+	es->memsize = memsize;
+	es->fd = -1;
+	return es;
+}
+/**
+ * extsort_put: put a record.
+ *
+ *	@param[in]	es	sorter
+ *	@param[in]	key	key
+ *	@param[in]	data	data
+ *	@param[in]	datalen	length of @a data
+ */
+void
+extsort_put(EXTSORT *es, const char *key, const char *data, int datalen)
+{
+	int len[2], size;
+	char *p;
+
+	if (es->reading)
+		die("extsort_put: already reading.");
+	len[0] = strlen(key);
+	len[1] = datalen;
+	size = RECSIZE(len[0], len[1]);
+	if (es->count > 0 && es->used + size + (es->count + 1) * sizeof(int) > es->memsize)
+		write_run(es);
+	if (es->used + size > es->bufsize) {
+		int newsize = es->bufsize ? es->bufsize : MINREADBUFSIZE;
+
+		while (es->used + size > newsize)
+			newsize *= 2;
+		es->buf = check_realloc(es->buf, newsize);
+		es->bufsize = newsize;
+	}
+	if (es->count >= es->indexsize) {
+		es->indexsize = es->indexsize ? es->indexsize * 2 : 1024;
+		es->index = (int *)check_realloc(es->index, sizeof(int) * es->indexsize);
+	}
+	es->index[es->count++] = es->used;
+	p = es->buf + es->used;
+	memcpy(p, len, HEADSIZE);
+	p += HEADSIZE;
+	memcpy(p, key, len[0] + 1);
+	p += len[0] + 1;
+	memcpy(p, data, datalen);
+	p[datalen] = '\0';
+	es->used += size;
+}
+/**
+ * extsort_get: get the next record in order.
+ *
+ *	@param[in]	es	sorter
+ *	@param[out]	data	data
+ *	@param[out]	datalen	length of @a data
+ *	@return		key, @VAR{NULL}: no more record
+ *
+ * After the first call of this function, extsort_put() cannot be called.
+ * The key and the data are valid until the next call.
+ */
+const char *
+extsort_get(EXTSORT *es, const char **data, int *datalen)
+{
+	const char *rec;
+	int len[2];
+
+	if (!es->reading)
+		start_reading(es);
+	if (es->nruns == 0) {
+		if (es->next >= es->count)
+			return NULL;
+		rec = es->buf + es->index[es->next++];
+	} else {
+		if (es->popped) {
+			struct extsort_run *run = &es->runs[es->heap[0]];
+
+			run->pos += reclen(run->buf + run->pos);
+			if (current_record(es, run) == NULL)
+				es->heap[0] = es->heap[--es->heapsize];
+			sift_down(es, 0);
+		}
+		if (es->heapsize == 0) {
+			es->popped = 0;
+			return NULL;
+		}
+		es->popped = 1;
+		rec = current_record(es, &es->runs[es->heap[0]]);
+	}
+	memcpy(len, rec, HEADSIZE);
+	rec += HEADSIZE;
+	if (data)
+		*data = rec + len[0] + 1;
+	if (datalen)
+		*datalen = len[1];
+	return rec;
+}
+/**
+ * extsort_close: close a sorter.
+ *
+ *	@param[in]	es	sorter
+ */
+void
+extsort_close(EXTSORT *es)
+{
+	int i;
+
+	for (i = 0; i < es->nruns; i++)
+		free(es->runs[i].buf);
+	free(es->runs);
+	free(es->heap);
+	free(es->buf);
+	free(es->index);
+	if (es->wb)
+		strbuf_close(es->wb);
+	if (es->fd >= 0)
+		close(es->fd);
+	free(es);
+}
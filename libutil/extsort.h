@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _EXTSORT_H_
+#define _EXTSORT_H_
+
+#include <sys/types.h>
+
+#include "strbuf.h"
+
+struct extsort_run;
+
+typedef struct {
+	int memsize;			/**< memory limit for a run */
+	/**
+	 * @name records in memory
+	 */
+	/** @{ */
+	char *buf;			/**< record buffer */
+	int bufsize;			/**< allocated size of @a buf */
+	int used;			/**< used size of @a buf */
+	int *index;			/**< offsets of records in @a buf */
+	int indexsize;			/**< allocated size of @a index */
+	int count;			/**< number of records in @a buf */
+	/** @} */
+	/**
+	 * @name runs in the temporary file
+	 */
+	/** @{ */
+	int fd;				/**< temporary file */
+	off_t tmpsize;			/**< size of the temporary file */
+	STRBUF *wb;			/**< write buffer */
+	struct extsort_run *runs;	/**< runs */
+	int nruns;			/**< number of runs */
+	int *heap;			/**< heap of runs for merging */
+	int heapsize;			/**< number of runs in @a heap */
+	/** @} */
+	int reading;			/**< 1: reading stage */
+	int next;			/**< next record to read in memory */
+	int popped;			/**< 1: the last record came from the top of @a heap */
+} EXTSORT;
+
+EXTSORT *extsort_open(int);
+void extsort_put(EXTSORT *, const char *, const char *, int);
+const char *extsort_get(EXTSORT *, const char **, int *);
+void extsort_close(EXTSORT *);
+
+#endif /* ! _EXTSORT_H_ */
@@ -44,24 +44,34 @@
 #include <unistd.h>
 #endif
 
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_PTHREAD_CREATE)
+#define USE_FIND_THREADS
+#include <pthread.h>
+#endif
+
 #include "gparam.h"
-#include "regex.h"
 
 #include "abs2rel.h"
-#include "char.h"
+#include "bloom.h"
 #include "checkalloc.h"
 #include "conf.h"
+#include "dbop.h"
 #include "die.h"
 #include "find.h"
 #include "getdbpath.h"
+#include "gitindex.h"
 #include "is_unixy.h"
 #include "langmap.h"
+#include "lineindex.h"
 #include "locatestring.h"
 #include "makepath.h"
 #include "path.h"
+#include "shard.h"
 #include "strbuf.h"
+#include "strhash.h"
 #include "strlimcpy.h"
 #include "test.h"
+#include "trigram.h"
 #include "varray.h"
 
 /*
@@ -90,11 +100,29 @@
  * @endcode
  *
  */
-static regex_t *skip;			/**< regex for skipping units */
-static regex_t *suff;			/**< regex for suffixes */
-static STRBUF *list;
-static int list_count;
-static char **listarray;		/**< list for skipping full path */
+/**
+ * @name Skip List
+ */
+/** @{ */
+struct skipnode {
+	char *name;			/**< component of path */
+	int flags;			/**< SKIP_DIR, SKIP_FILE */
+	struct skipnode *child;		/**< first component under this */
+	struct skipnode *sibling;	/**< next component */
+};
+#define SKIP_DIR	1		/**< skip all files under this */
+#define SKIP_FILE	2		/**< skip this file */
+struct skiplist {
+	STRHASH *files;			/**< file names */
+	STRHASH *dirs;			/**< directory names */
+	STRBUF *names;			/**< names which include '/' */
+	struct skipnode *root;		/**< full paths */
+	int icase;			/**< ignore case distinctions */
+};
+static struct skiplist *skip;		/**< compiled skip list */
+/** @} */
+static int source_ready;		/**< 1: the language map is set up */
+static LANGMAP *suff;			/**< suffix table ignoring case */
 static FILE *ip;
 static FILE *temp;
 static char rootdir[PATH_MAX];
@@ -103,10 +131,17 @@ static int find_mode;
 static int find_eof;
 #define FIND_OPEN	1
 #define FILELIST_OPEN	2
+#define GITINDEX_OPEN	3
+static GITINDEX *gitindex;		/**< git index for find_open_gitindex() */
+static int gitindex_next;		/**< next entry of the git index */
+static int gitindex_untracked;		/**< 1: read untracked files too */
 
 static void trim(char *);
 static char *find_read_traverse(void);
 static char *find_read_filelist(void);
+static char *find_read_gitindex(void);
+static void traverse_open(const char *);
+static void traverse_close(void);
 
 extern int qflag;
 #ifdef DEBUG
@@ -133,178 +168,237 @@ trim(char *s)
 	*p = 0;
 }
 /**
- * prepare_source: preparing regular expression.
+ * prepare_source: prepare the suffix table.
  *
- *	<!-- @param[in]	flags	flags for regcomp. -->
- *	@return	compiled regular expression for source files.
+ * The language map is shared with the parser (see setup_langmap()).
+ * Only if the @CODE{icase_path} option is set, a suffix table which
+ * ignores case distinctions is compiled for source files.
  */
-static regex_t *
+static void
 prepare_source(void)
 {
-	static regex_t suff_area;
 	STRBUF *sb = strbuf_open(0);
-	char *sufflist = NULL;
-	char *langmap = NULL;
-	int flags = REG_EXTENDED;
+	const char *langmap = DEFAULTLANGMAP;
 
+	if (getconfs("langmap", sb))
+		langmap = strbuf_value(sb);
+	setup_langmap(langmap);
+#if !defined(_WIN32) && !defined(__DJGPP__)
 	/*
 	 * load icase_path option.
 	 */
 	if (getconfb("icase_path"))
-		flags |= REG_ICASE;
-#if defined(_WIN32) || defined(__DJGPP__)
-	flags |= REG_ICASE;
+		suff = langmap_open(langmap, 1);
 #endif
-	/*
-	 * make suffix list.
-	 */
-	strbuf_reset(sb);
-	if (getconfs("langmap", sb)) {
-		langmap =  check_strdup(strbuf_value(sb));
-	}
-	strbuf_reset(sb);
-	make_suffixes(langmap ? langmap : DEFAULTLANGMAP, sb);
-	sufflist = check_strdup(strbuf_value(sb));
-	trim(sufflist);
-	{
-		const char *suffp;
-
-		strbuf_reset(sb);
-		strbuf_puts(sb, "\\.(");       /* ) */
-		for (suffp = sufflist; suffp; ) {
-			const char *p;
-
-			for (p = suffp; *p && *p != ','; p++) {
-				if (!isalnum((unsigned char)*p))
-					strbuf_putc(sb, '\\');
-				strbuf_putc(sb, *p);
-			}
-			if (!*p)
+	strbuf_close(sb);
+	source_ready = 1;
+}
+/**
+ * lower: copy a string in lower case.
+ *
+ *	@param[out]	buf	buffer
+ *	@param[in]	s	string
+ *	@param[in]	len	length of @a s
+ *	@param[in]	icase	1: convert to lower case
+ *	@return		@a buf
+ */
+static const char *
+lower(char *buf, const char *s, int len, int icase)
+{
+	int i;
+
+	if (len > MAXPATHLEN - 1)
+		len = MAXPATHLEN - 1;
+	for (i = 0; i < len; i++)
+		buf[i] = icase ? tolower((unsigned char)s[i]) : s[i];
+	buf[len] = '\0';
+	return buf;
+}
+/**
+ * add_skipnode: add a full path of the skip list to the tree.
+ *
+ *	@param[in]	path	path name which starts with @FILE{/}
+ *
+ * If the path ends with @FILE{/}, it is a directory and all files under it
+ * are skipped. Otherwise the file is skipped.
+ */
+static void
+add_skipnode(const char *path)
+{
+	struct skipnode **np, *node = skip->root;
+	const char *p, *q;
+
+	for (p = path + 1; *p; p = *q ? q + 1 : q) {
+		for (q = p; *q && *q != '/'; q++)
+			;
+		for (np = &node->child; *np; np = &(*np)->sibling)
+			if (!STRNCMP((*np)->name, p, q - p) && (*np)->name[q - p] == '\0')
 				break;
-			assert(*p == ',');
-			strbuf_putc(sb, '|');
-			suffp = ++p;
+		if (*np == NULL) {
+			*np = (struct skipnode *)check_calloc(sizeof(struct skipnode), 1);
+			(*np)->name = check_malloc(q - p + 1);
+			memcpy((*np)->name, p, q - p);
+			(*np)->name[q - p] = '\0';
+		}
+		node = *np;
+		if (*q == '\0') {
+			node->flags |= SKIP_FILE;
+			return;
 		}
-		strbuf_puts(sb, ")$");
-		/*
-		 * compile regular expression.
-		 */
-		if (regcomp(&suff_area, strbuf_value(sb), flags) != 0)
-			die("cannot compile regular expression.");
 	}
-	strbuf_close(sb);
-	if (langmap)
-		free(langmap);
-	if (sufflist)
-		free(sufflist);
-	return &suff_area;
+	node->flags |= SKIP_DIR;
+}
+/**
+ * free_skipnode: free the tree of full paths.
+ */
+static void
+free_skipnode(struct skipnode *node)
+{
+	while (node) {
+		struct skipnode *next = node->sibling;
+
+		free_skipnode(node->child);
+		if (node->name)
+			free(node->name);
+		free(node);
+		node = next;
+	}
+}
+/**
+ * Tag files and the suffixes of their sidecar files and of the shadow files
+ * written while updating them.
+ */
+static const char *tagfiles[] = {"GTAGS", "GRTAGS", "GSYMS", "GPATH", LINEINDEX_NAME, DBOP_GENERATION};
+static const char *suffixes[] = {
+	"", DBOP_SHADOW_SUFFIX,
+	DBOP_DELTA_SUFFIX, DBOP_DELTA_SUFFIX DBOP_SHADOW_SUFFIX,
+	BLOOM_SUFFIX, BLOOM_SUFFIX DBOP_SHADOW_SUFFIX,
+	TRIGRAM_SUFFIX, TRIGRAM_SUFFIX DBOP_SHADOW_SUFFIX,
+	DBOP_FOLD_SUFFIX, DBOP_FOLD_SUFFIX DBOP_SHADOW_SUFFIX,
+	DBOP_FOLD_SUFFIX DBOP_DELTA_SUFFIX, DBOP_FOLD_SUFFIX DBOP_DELTA_SUFFIX DBOP_SHADOW_SUFFIX
+};
+/**
+ * istagfile: check whether a file is a tag file, or a file made with it.
+ *
+ *	@param[in]	name	file name (the last component of a path)
+ *	@return		1: tag file, 0: other file
+ */
+int
+istagfile(const char *name)
+{
+	int i, j, len;
+
+	for (i = 0; i < sizeof(tagfiles) / sizeof(tagfiles[0]); i++) {
+		len = strlen(tagfiles[i]);
+		if (strncmp(name, tagfiles[i], len))
+			continue;
+		for (j = 0; j < sizeof(suffixes) / sizeof(suffixes[0]); j++)
+			if (!strcmp(name + len, suffixes[j]))
+				return 1;
+	}
+	return 0;
 }
 /**
  * prepare_skip: prepare skipping files.
  *
- *	@par Globals used (output):
- *		#listarray[]: 	skip list. <br>
- *		#list_count:	 count of skip list.
+ *	@return	compiled skip list.
  *
- *	@return	compiled regular expression for skip files.
+ * The skip list is compiled into the following tables:
+ * - file names (hash): the path is skipped if its last component matches.
+ * - directory names (hash): the path is skipped if one of its directories
+ *   matches.
+ * - full paths (tree of components): the path is skipped if it is a
+ *   listed file, or is under a listed directory.
+ * - other names which include @CODE{'/'} (list)
  */
-static regex_t *
+static struct skiplist *
 prepare_skip(void)
 {
-	static regex_t skip_area;
+	char buf[MAXPATHLEN];
 	char *skiplist;
-	STRBUF *reg = strbuf_open(0);
-	char *p, *q;
-	int flags = REG_EXTENDED|REG_NEWLINE;
+	STRBUF *sb = strbuf_open(0);
+	char *p;
+	int i, j;
 
-	/*
-	 * load icase_path option.
-	 */
-	if (getconfb("icase_path"))
-		flags |= REG_ICASE;
-#if defined(_WIN32) || defined(__DJGPP__)
-	flags |= REG_ICASE;
-#endif
-	/*
-	 * initialize common data.
-	 */
-	if (!list)
-		list = strbuf_open(0);
-	else
-		strbuf_reset(list);
-	list_count = 0;
-	if (listarray)
-		(void)free(listarray);
-	listarray = (char **)0;
 	/*
 	 * load skip data.
 	 */
-	if (!getconfs("skip", reg)) {
-		strbuf_close(reg);
+	if (!getconfs("skip", sb)) {
+		strbuf_close(sb);
 		return NULL;
 	}
-	skiplist = check_strdup(strbuf_value(reg));
+	skiplist = check_strdup(strbuf_value(sb));
 	trim(skiplist);
-	strbuf_reset(reg);
+	skip = (struct skiplist *)check_calloc(sizeof(struct skiplist), 1);
 	/*
-	 * construct regular expression.
+	 * load icase_path option.
 	 */
-	strbuf_putc(reg, '(');	/* ) */
+	if (getconfb("icase_path"))
+		skip->icase = 1;
+#if defined(_WIN32) || defined(__DJGPP__)
+	skip->icase = 1;
+#endif
+	skip->files = strhash_open(64);
+	skip->dirs = strhash_open(64);
+	skip->names = strbuf_open(0);
+	skip->root = (struct skipnode *)check_calloc(sizeof(struct skipnode), 1);
 	/*
 	 * Hard coded skip files:
-	 * (1) files which start with '.'
-	 * (2) tag files
+	 * (1) files which start with '.' (see skipthisfile())
+	 * (2) tag files, their shadow files and sidecar files
+	 * (3) directory of the shards of tag files
 	 */
-	/* skip files which start with '.' e.g. .cvsignore */
-	if (!accept_dotfiles) {
-		strbuf_puts(reg, "/\\.[^/]+$|");
-		strbuf_puts(reg, "/\\.[^/]+/|");
-	}
-	/* skip tag files */
-	strbuf_puts(reg, "/GTAGS$|");
-	strbuf_puts(reg, "/GRTAGS$|");
-	strbuf_puts(reg, "/GSYMS$|");
-	strbuf_puts(reg, "/GPATH$|");
+	for (i = 0; i < sizeof(tagfiles) / sizeof(tagfiles[0]); i++) {
+		for (j = 0; j < sizeof(suffixes) / sizeof(suffixes[0]); j++) {
+			snprintf(buf, sizeof(buf), "%s%s", tagfiles[i], suffixes[j]);
+			strhash_assign(skip->files, lower(buf, buf, strlen(buf), skip->icase), 1);
+		}
+	}
+	strhash_assign(skip->dirs, lower(buf, GSHARDS, strlen(GSHARDS), skip->icase), 1);
 	for (p = skiplist; p; ) {
 		char *skipf = p;
+		char *last, *q;
+
 		if ((p = locatestring(p, ",", MATCH_FIRST)) != NULL)
 			*p++ = 0;
+		if (*skipf == '\0')
+			continue;
+		last = skipf + strlen(skipf) - 1;
 		if (*skipf == '/') {
-			list_count++;
-			strbuf_puts0(list, skipf);
+			add_skipnode(skipf);
+		} else if ((q = locatestring(skipf, "/", MATCH_FIRST)) != NULL && q < last) {
+			/* e.g. 'a/b' or 'a/b/' */
+			strbuf_putc(skip->names, '/');
+			strbuf_puts0(skip->names, lower(buf, skipf, strlen(skipf), skip->icase));
+		} else if (*last == '/') {
+			strhash_assign(skip->dirs, lower(buf, skipf, last - skipf, skip->icase), 1);
 		} else {
-			strbuf_putc(reg, '/');
-			for (q = skipf; *q; q++) {
-				if (isregexchar(*q))
-					strbuf_putc(reg, '\\');
-				strbuf_putc(reg, *q);
-			}
-			if (*(q - 1) != '/')
-				strbuf_putc(reg, '$');
-			if (p)
-				strbuf_putc(reg, '|');
+			strhash_assign(skip->files, lower(buf, skipf, last - skipf + 1, skip->icase), 1);
 		}
 	}
-	strbuf_unputc(reg, '|');
-	strbuf_putc(reg, ')');
-	/*
-	 * compile regular expression.
-	 */
-	if (regcomp(&skip_area, strbuf_value(reg), flags) != 0)
-		die("cannot compile regular expression.");
-	if (list_count > 0) {
-		int i;
-		listarray = (char **)check_malloc(sizeof(char *) * list_count);
-		p = strbuf_value(list);
-		for (i = 0; i < list_count; i++) {
-			listarray[i] = p;
-			p += strlen(p) + 1;
-		}
-	}
-	strbuf_close(reg);
+	strbuf_close(sb);
 	free(skiplist);
 
-	return &skip_area;
+	return skip;
+}
+/**
+ * source_lang: decide the language of a source file.
+ *
+ *	@param[in]	path	path name
+ *	@return		language name, or NULL if not a source file
+ */
+static const char *
+source_lang(const char *path)
+{
+	const char *suffix;
+
+	if (!source_ready)
+		prepare_source();
+	if ((suffix = locatestring(path, ".", MATCH_LAST)) == NULL)
+		return NULL;
+	if (suff)
+		return langmap_lookup(suff, suffix);
+	return decide_lang(suffix);
 }
 /**
  * issourcefile: check whether or not a source file.
@@ -315,14 +409,7 @@ prepare_skip(void)
 int
 issourcefile(const char *path)
 {
-	if (suff == NULL) {
-		suff = prepare_source();	/* XXX this cannot return NULL */
-		if (suff == NULL)
-			die("prepare_source failed.");
-	}
-	if (regexec(suff, path, 0, 0, 0) == 0)
-		return 1;
-	return 0;
+	return source_lang(path) != NULL;
 }
 /**
  * skipthisfile: check whether or not we accept this file.
@@ -338,8 +425,9 @@ issourcefile(const char *path)
 int
 skipthisfile(const char *path)
 {
-	const char *first, *last;
-	int i;
+	char buf[MAXPATHLEN];
+	const char *p, *q, *name;
+	struct skipnode *node;
 
 	/*
 	 * unit check.
@@ -349,31 +437,81 @@ skipthisfile(const char *path)
 		if (skip == NULL)
 			die("prepare_skip failed.");
 	}
-	if (regexec(skip, path, 0, 0, 0) == 0)
-		return 1;
 	/*
-	 * list check.
+	 * Each component which follows a '/' is examined.
+	 * A component followed by '/' is a directory.
 	 */
-	if (list_count == 0)
-		return 0;
-	for (i = 0; i < list_count; i++) {
-		first = listarray[i];
-		last = first + strlen(first);
-		/*
-		 * the path must start with "./".
-		 */
-		if (*(last - 1) == '/') {	/* it's a directory */
-			if (!STRNCMP(path + 1, first, last - first)) {
-				return 1;
-			}
-		} else {
-			if (!STRCMP(path + 1, first)) {
+	for (p = locatestring(path, "/", MATCH_FIRST); p; p = *q ? q : NULL) {
+		p++;
+		for (q = p; *q && *q != '/'; q++)
+			;
+		if (q == p)
+			continue;
+		/* skip files which start with '.' e.g. .cvsignore */
+		if (!accept_dotfiles && *p == '.' && q - p > 1)
+			return 1;
+		name = lower(buf, p, q - p, skip->icase);
+		if (strhash_assign(*q ? skip->dirs : skip->files, name, 0))
+			return 1;
+	}
+	/*
+	 * names which include '/'.
+	 */
+	if (strbuf_getlen(skip->names) > 0) {
+		const char *end = strbuf_value(skip->names) + strbuf_getlen(skip->names);
+		const char *target = skip->icase ? lower(buf, path, strlen(path), 1) : path;
+		int len = strlen(target);
+
+		for (name = strbuf_value(skip->names); name < end; name += strlen(name) + 1) {
+			int n = strlen(name);
+
+			if (name[n - 1] == '/') {
+				if (locatestring(target, name, MATCH_FIRST))
+					return 1;
+			} else if (len >= n && !strcmp(target + len - n, name))
 				return 1;
-			}
 		}
 	}
+	/*
+	 * full path check.
+	 * the path must start with "./".
+	 */
+	node = skip->root;
+	if (node->flags & SKIP_DIR)
+		return 1;
+	for (p = path + 2; node && *p; p = q + 1) {
+		struct skipnode *np;
+
+		for (q = p; *q && *q != '/'; q++)
+			;
+		for (np = node->child; np; np = np->sibling)
+			if (!STRNCMP(np->name, p, q - p) && np->name[q - p] == '\0')
+				break;
+		if (np == NULL)
+			break;
+		if (*q == '\0')
+			return (np->flags & SKIP_FILE) ? 1 : 0;
+		if (np->flags & SKIP_DIR)
+			return 1;
+		node = np;
+	}
 	return 0;
 }
+/**
+ * find_classify: classify a path name.
+ *
+ *	@param[in]	path	path name (@STRONG{must} start with @FILE{./})
+ *	@return		#FIND_SKIP: skip, #FIND_SOURCE: source file, #FIND_OTHER: other file
+ *
+ * This is equivalent to calling skipthisfile() and issourcefile().
+ */
+int
+find_classify(const char *path)
+{
+	if (skipthisfile(path))
+		return FIND_SKIP;
+	return source_lang(path) ? FIND_SOURCE : FIND_OTHER;
+}
 
 /**
  * @name Directory Stack
@@ -385,39 +523,75 @@ struct stack_entry {
 	STRBUF *sb;
 	char *real;
 	char *dirp, *start, *end, *p;
+	struct dirlist *child;			/**< subdirectories read ahead */
 };
 static int current_entry;			/**< current entry of the stack */
 /** @} */
 
 /**
- * getrealpath: return a real path of dir using allocated area.
+ * @name Directory Reader
+ *
+ * The list of a directory is made by readdirs(). The type of each entry is
+ * taken from @CODE{d_type} of @NAME{readdir()} if possible, otherwise from
+ * @NAME{fstatat()} relative to the directory, so that no path name is
+ * looked up again.
+ *
+ * When a directory is entered, the lists of its subdirectories are requested
+ * in the order of the directory list. Reader threads read them ahead while
+ * the current directory is processed, and find_read_traverse() takes them
+ * in the same order, so the order of paths is the same as reading
+ * them one by one.
+ * Since the traversal is depth first, the queue is a stack: the
+ * subdirectories of the last entered directory are pushed in reverse order,
+ * so that the first of them is read first. At most @CODE{FINDREADAHEAD}
+ * lists are read ahead and not yet taken. A directory which is still in
+ * the queue when it is entered is read there.
+ * The number of threads is taken from @NAME{GTAGSFINDTHREADS}.
+ * If it is 0, or threads are not available, directories are read when they
+ * are entered.
  */
-char *
-getrealpath(const char *dir)
-{
-	char real[PATH_MAX];
+/** @{ */
+struct dirlist {
+	char *path;				/**< directory (ends with '/') */
+	char *real;				/**< real path or NULL */
+	STRBUF *sb;				/**< directory list */
+	int status;				/**< -1: cannot open, 0: normal */
+	int state;				/**< DL_XXX */
+	struct dirlist *next;			/**< next sibling */
+};
+#define DL_REQUESTED	0			/**< not in the queue */
+#define DL_QUEUED	1			/**< in the queue */
+#define DL_READING	2			/**< being read */
+#define DL_READ		3			/**< read by a reader thread */
+static int nthreads;				/**< number of reader threads */
+#ifdef USE_FIND_THREADS
+static pthread_t *threads;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_done = PTHREAD_COND_INITIALIZER;
+static struct dirlist **queue;			/**< stack of requests */
+static int queue_count, queue_size;
+static int queue_ahead;				/**< lists read ahead and not taken */
+static int queue_shutdown;
+#endif
+/** @} */
 
-	if (realpath(dir, real) == NULL)
-		die("cannot get real path of '%s'.", trimpath(dir));
-	return check_strdup(real);
-}
 /**
- * has_symlinkloop: whether or not @a dir has a symbolic link loops.
+ * has_symlinkloop: whether or not a directory has a symbolic link loops.
  *
  *	@param[in]	dir	directory (@STRONG{should} end by @FILE{/})
+ *	@param[in]	real	real path of @a dir
  *	@return		1: has a loop, 0: don't have a loop
  */
-int
-has_symlinkloop(const char *dir)
+static int
+has_symlinkloop(const char *dir, const char *real)
 {
 	struct stack_entry *sp;
-	char real[PATH_MAX], *p;
+	const char *p;
 	int i;
 
 	if (!strcmp(dir, "./"))
 		return 0;
-	if (realpath(dir, real) == NULL)
-		die("cannot get real path of '%s'.", trimpath(dir));
 #ifdef SLOOPDEBUG
 	fprintf(stderr, "======== has_symlinkloop ======\n");
 	fprintf(stderr, "dir = '%s', real path = '%s'\n", dir, real);
@@ -445,54 +619,316 @@ has_symlinkloop(const char *dir)
 }
 
 /**
- * getdirs: get directory list
+ * readdirs: read a directory list
  *
  *	@param[in]	dir	directory (@STRONG{should} end by @FILE{/})
  *	@param[out]	sb	string buffer
- *	@return		-1: error, 0: normal
+ *	@return		-1: cannot open, 0: normal
  *
  * @par format of directory list:
  * @code
- * |ddir1\0ffile1\0|
+ * |ddir1\0ffile1\0?file2\0|
  * @endcode
- * means directory @FILE{dir1}, file @FILE{file1}.
+ * means directory @FILE{dir1}, file @FILE{file1} and @FILE{file2} which
+ * cannot be stat'ed. @CODE{' '} means other than directory and file.
+ *
+ * This function is called by the reader threads. It must not use
+ * module local areas nor report errors.
  */
 static int
-getdirs(const char *dir, STRBUF *sb)
+readdirs(const char *dir, STRBUF *sb)
 {
 	DIR *dirp;
 	struct dirent *dp;
 	struct stat st;
+#ifdef HAVE_FSTATAT
+	int fd;
+#else
+	char path[MAXPATHLEN];
+#endif
 
-	if (check_looplink && has_symlinkloop(dir)) {
-		warning("symbolic link loop detected. '%s' is ignored.", trimpath(dir));
-		return -1;
-	}
-	if ((dirp = opendir(dir)) == NULL) {
-		warning("cannot open directory '%s'. ignored.", trimpath(dir));
+	if ((dirp = opendir(dir)) == NULL)
 		return -1;
-	}
+#ifdef HAVE_FSTATAT
+	fd = dirfd(dirp);
+#endif
 	while ((dp = readdir(dirp)) != NULL) {
+		int type = 0;
+
 		if (!strcmp(dp->d_name, "."))
 			continue;
 		if (!strcmp(dp->d_name, ".."))
 			continue;
-		if (stat(makepath(dir, dp->d_name, NULL), &st) < 0) {
-			warning("cannot stat '%s'. ignored.", trimpath(dp->d_name));
-			continue;
+#ifdef DT_UNKNOWN
+		/*
+		 * A symbolic link must be followed as stat(2) does.
+		 */
+		switch (dp->d_type) {
+		case DT_DIR:
+			type = 'd';
+			break;
+		case DT_REG:
+			type = 'f';
+			break;
+		case DT_UNKNOWN:
+		case DT_LNK:
+			break;
+		default:
+			type = ' ';
+			break;
 		}
-		if (S_ISDIR(st.st_mode))
-			strbuf_putc(sb, 'd');
-		else if (S_ISREG(st.st_mode))
-			strbuf_putc(sb, 'f');
-		else
-			strbuf_putc(sb, ' ');
+#endif
+		if (type == 0) {
+#ifdef HAVE_FSTATAT
+			if (fstatat(fd, dp->d_name, &st, 0) < 0)
+#else
+			snprintf(path, sizeof(path), "%s%s", dir, dp->d_name);
+			if (stat(path, &st) < 0)
+#endif
+				type = '?';
+			else if (S_ISDIR(st.st_mode))
+				type = 'd';
+			else if (S_ISREG(st.st_mode))
+				type = 'f';
+			else
+				type = ' ';
+		}
+		strbuf_putc(sb, type);
 		strbuf_puts(sb, dp->d_name);
 		strbuf_putc(sb, '\0');
 	}
 	(void)closedir(dirp);
 	return 0;
 }
+/**
+ * dirlist_read: read a directory and its real path.
+ *
+ *	@param[in]	dl	directory list
+ */
+static void
+dirlist_read(struct dirlist *dl)
+{
+	char real[PATH_MAX];
+
+	if (realpath(dl->path, real) != NULL) {
+		dl->real = check_strdup(real);
+		dl->status = readdirs(dl->path, dl->sb);
+	}
+}
+#ifdef USE_FIND_THREADS
+/**
+ * reader: main routine of reader threads.
+ */
+static void *
+reader(void *arg)
+{
+	struct dirlist *dl;
+
+	for (;;) {
+		pthread_mutex_lock(&queue_lock);
+		while ((queue_count == 0 || queue_ahead >= FINDREADAHEAD) && !queue_shutdown)
+			pthread_cond_wait(&queue_work, &queue_lock);
+		if (queue_shutdown) {
+			pthread_mutex_unlock(&queue_lock);
+			break;
+		}
+		dl = queue[--queue_count];
+		dl->state = DL_READING;
+		queue_ahead++;
+		pthread_mutex_unlock(&queue_lock);
+
+		dirlist_read(dl);
+
+		pthread_mutex_lock(&queue_lock);
+		dl->state = DL_READ;
+		pthread_cond_broadcast(&queue_done);
+		pthread_mutex_unlock(&queue_lock);
+	}
+	return NULL;
+}
+/**
+ * dirlist_queue: push the requested subdirectories to the queue.
+ *
+ *	@param[in]	list	first subdirectory
+ *
+ * They are pushed in reverse order, so that the first one is on the top.
+ */
+static void
+dirlist_queue(struct dirlist *list)
+{
+	struct dirlist *dl;
+	int n = 0, i;
+
+	for (dl = list; dl; dl = dl->next)
+		n++;
+	if (n == 0)
+		return;
+	pthread_mutex_lock(&queue_lock);
+	if (queue_count + n > queue_size) {
+		while (queue_count + n > queue_size)
+			queue_size = queue_size ? queue_size * 2 : 256;
+		queue = (struct dirlist **)check_realloc(queue, sizeof(struct dirlist *) * queue_size);
+	}
+	i = queue_count + n;
+	for (dl = list; dl; dl = dl->next) {
+		dl->state = DL_QUEUED;
+		queue[--i] = dl;
+	}
+	queue_count += n;
+	pthread_cond_broadcast(&queue_work);
+	pthread_mutex_unlock(&queue_lock);
+}
+/**
+ * dirlist_wait: wait for a directory list to be read.
+ *
+ *	@param[in]	dl	directory list
+ *
+ * If no reader thread has taken it yet, it is removed from the queue
+ * and read here.
+ */
+static void
+dirlist_wait(struct dirlist *dl)
+{
+	int i;
+
+	pthread_mutex_lock(&queue_lock);
+	if (dl->state == DL_REQUESTED || dl->state == DL_QUEUED) {
+		if (dl->state == DL_QUEUED) {
+			for (i = queue_count - 1; queue[i] != dl; i--)
+				;
+			memmove(&queue[i], &queue[i + 1], sizeof(struct dirlist *) * (queue_count - i - 1));
+			queue_count--;
+		}
+		dl->state = DL_READING;
+		pthread_mutex_unlock(&queue_lock);
+		dirlist_read(dl);
+		return;
+	}
+	while (dl->state != DL_READ)
+		pthread_cond_wait(&queue_done, &queue_lock);
+	queue_ahead--;
+	pthread_cond_signal(&queue_work);
+	pthread_mutex_unlock(&queue_lock);
+}
+#endif
+/**
+ * dirlist_request: request a directory list.
+ *
+ *	@param[in]	path	directory (@STRONG{should} end by @FILE{/})
+ *	@return		directory list
+ *
+ * If reader threads are running, the directory is read ahead after
+ * it is queued by getdirs().
+ */
+static struct dirlist *
+dirlist_request(const char *path)
+{
+	struct dirlist *dl = (struct dirlist *)check_calloc(sizeof(struct dirlist), 1);
+
+	dl->path = check_strdup(path);
+	dl->sb = strbuf_open(0);
+	dl->state = DL_REQUESTED;
+	return dl;
+}
+/**
+ * dirlist_close: free a directory list.
+ *
+ *	@param[in]	dl	directory list
+ */
+static void
+dirlist_close(struct dirlist *dl)
+{
+	free(dl->path);
+	if (dl->real)
+		free(dl->real);
+	if (dl->sb)
+		strbuf_close(dl->sb);
+	free(dl);
+}
+/**
+ * getdirs: get directory list
+ *
+ *	@param[in]	dl	directory list requested by dirlist_request()
+ *	@param[out]	curp	stack entry to which the list is set <br>
+ *			It is not on the stack yet.
+ *	@return		-1: error, 0: normal
+ *
+ * The list is read here unless it has been read ahead.
+ * The entries to be skipped are marked by @CODE{'x'}, and files other than
+ * source files by @CODE{'o'}. The lists of the remaining subdirectories
+ * are requested.
+ */
+static int
+getdirs(struct dirlist *dl, struct stack_entry *curp)
+{
+	struct dirlist **childp = &curp->child;
+	char path[MAXPATHLEN];
+	char *p, *end;
+
+	if (nthreads == 0)
+		dirlist_read(dl);
+#ifdef USE_FIND_THREADS
+	else
+		dirlist_wait(dl);
+#endif
+	if (dl->real == NULL)
+		die("cannot get real path of '%s'.", trimpath(dl->path));
+	if (check_looplink && has_symlinkloop(dl->path, dl->real)) {
+		warning("symbolic link loop detected. '%s' is ignored.", trimpath(dl->path));
+		return -1;
+	}
+	if (dl->status < 0) {
+		warning("cannot open directory '%s'. ignored.", trimpath(dl->path));
+		return -1;
+	}
+	curp->sb = dl->sb;
+	curp->real = dl->real;
+	curp->child = NULL;
+	dl->sb = NULL;
+	dl->real = NULL;
+	/*
+	 * Skip files described in the skip list.
+	 */
+	p = strbuf_value(curp->sb);
+	end = p + strbuf_getlen(curp->sb);
+	for (; p < end; p += strlen(p) + 1) {
+		const char *unit = p + 1;
+
+		if (*p == '?') {
+			warning("cannot stat '%s'. ignored.", trimpath(unit));
+			*p = 'x';
+			continue;
+		}
+		/* makepath() returns unsafe module local area. */
+		strlimcpy(path, makepath(dir, unit, NULL), sizeof(path));
+		if (*p == 'f') {
+			switch (find_classify(path)) {
+			case FIND_SKIP:
+				*p = 'x';
+				break;
+			case FIND_OTHER:
+				*p = 'o';
+				break;
+			}
+			continue;
+		}
+		if (*p == 'd')
+			strcat(path, "/");
+		if (skipthisfile(path))
+			*p = 'x';
+		else if (*p == 'd') {
+			*childp = dirlist_request(path);
+			childp = &(*childp)->next;
+		}
+	}
+#ifdef USE_FIND_THREADS
+	if (nthreads > 0)
+		dirlist_queue(curp->child);
+#endif
+	curp->start = curp->p = strbuf_value(curp->sb);
+	curp->end   = curp->start + strbuf_getlen(curp->sb);
+	return 0;
+}
 /**
  * set_accept_dotfiles: make find to accept dot files and dot directries.
  */
@@ -510,28 +946,65 @@ set_accept_dotfiles(void)
 void
 find_open(const char *start)
 {
-	struct stack_entry *curp;
 	assert(find_mode == 0);
 	find_mode = FIND_OPEN;
+	traverse_open(start);
+}
+/**
+ * traverse_open: start traversal of the source tree.
+ *
+ *	@param[in]	start	start directory (the root directory or its subdirectory)
+ */
+static void
+traverse_open(const char *start)
+{
+	struct stack_entry *curp;
+	struct dirlist *dl;
 
 	if (!start)
 		start = "./";
-        if (realpath(start, rootdir) == NULL)
+	/*
+	 * Even if the traversal starts at a subdirectory (a shard),
+	 * a link to the root directory is a loop.
+	 */
+        if (realpath("./", rootdir) == NULL)
                 die("cannot get real path of '%s'.", trimpath(dir));
+	/*
+	 * start reader threads.
+	 */
+	nthreads = FINDTHREADS;
+	if (getenv("GTAGSFINDTHREADS") != NULL)
+		nthreads = atoi(getenv("GTAGSFINDTHREADS"));
+	if (nthreads < 0)
+		nthreads = 0;
+#ifdef USE_FIND_THREADS
+	if (nthreads > 0) {
+		int i;
+
+		queue_shutdown = 0;
+		threads = (pthread_t *)check_malloc(sizeof(pthread_t) * nthreads);
+		for (i = 0; i < nthreads; i++)
+			if (pthread_create(&threads[i], NULL, reader, NULL) != 0)
+				break;
+		nthreads = i;
+	}
+#else
+	nthreads = 0;
+#endif
 	/*
 	 * setup stack.
 	 */
 	stack = varray_open(sizeof(struct stack_entry), 50);
-	current_entry = 0;
-	curp = varray_assign(stack, current_entry, 1);
+	curp = varray_assign(stack, 0, 1);
 	strlimcpy(dir, start, sizeof(dir));
-	curp->dirp = dir + strlen(dir);
-	curp->sb = strbuf_open(0);
-	curp->real = getrealpath(dir);
-	if (getdirs(dir, curp->sb) < 0)
+	dl = dirlist_request(dir);
+	/* the start directory is not on the stack yet. */
+	current_entry = -1;
+	if (getdirs(dl, curp) < 0)
 		die("Work is given up.");
-	curp->start = curp->p = strbuf_value(curp->sb);
-	curp->end   = curp->start + strbuf_getlen(curp->sb);
+	dirlist_close(dl);
+	current_entry = 0;
+	curp->dirp = dir + strlen(dir);
 	strlimcpy(cwddir, get_root(), sizeof(cwddir));
 }
 /**
@@ -575,6 +1048,26 @@ find_open_filelist(const char *filename, const char *root)
 		snprintf(rootdir, sizeof(rootdir), "%s/", root);
 	strlimcpy(cwddir, root, sizeof(cwddir));
 }
+/**
+ * find_open_gitindex: find_open like interface for reading the git index.
+ *
+ *	@param[in]	gi		git index (see gitindex_open())
+ *	@param[in]	untracked	1: read untracked files as well
+ *
+ * The tracked files are read in the order of the index. If @a untracked
+ * is 1, the source tree is traversed after them, and the files which are
+ * not in the index are read.
+ */
+void
+find_open_gitindex(GITINDEX *gi, int untracked)
+{
+	assert(find_mode == 0);
+	find_mode = GITINDEX_OPEN;
+	gitindex = gi;
+	gitindex_next = 0;
+	gitindex_untracked = untracked;
+	strlimcpy(cwddir, get_root(), sizeof(cwddir));
+}
 /**
  * find_read: read path without @VAR{GPATH}.
  *
@@ -592,6 +1085,8 @@ find_read(void)
 		path = find_read_filelist();
 	else if (find_mode == FIND_OPEN)
 		path = find_read_traverse();
+	else if (find_mode == GITINDEX_OPEN)
+		path = find_read_gitindex();
 	else
 		die("find_read: internal error.");
 	return path;
@@ -600,6 +1095,9 @@ find_read(void)
  * find_read_traverse: read path without @VAR{GPATH}.
  *
  *	@return		path
+ *
+ * The entries of the directory lists are already classified by getdirs(),
+ * so that no file is stat'ed or classified here.
  */
 char *
 find_read_traverse(void)
@@ -616,28 +1114,14 @@ find_read_traverse(void)
 			curp->p += strlen(curp->p) + 1;
 
 			/*
-			 * Skip files described in the skip list.
+			 * Skip files described in the skip list
+			 * and files which cannot be stat'ed.
 			 */
-				/* makepath() returns unsafe module local area. */
-			strlimcpy(path, makepath(dir, unit, NULL), sizeof(path));
-			if (type == 'd')
-				strcat(path, "/");
-			if (skipthisfile(path))
+			if (type == 'x')
 				continue;
-			if (type == 'f') {
-				/*
-				 * Skip the following:
-				 * o directory
-				 * o file which does not exist
-				 * o dead symbolic link
-				 */
-				if (!test("f", path)) {
-					if (test("d", path))
-						warning("'%s' is a directory. ignored.", trimpath(path));
-					else
-						warning("'%s' not found. ignored.", trimpath(path));
-					continue;
-				}
+			if (type == 'f' || type == 'o') {
+				/* makepath() returns unsafe module local area. */
+				strlimcpy(path, makepath(dir, unit, NULL), sizeof(path));
 				/*
 				 * Now GLOBAL can treat the path which includes blanks.
 				 * This message is obsoleted.
@@ -650,7 +1134,7 @@ find_read_traverse(void)
 				 * A blank at the head of path means
 				 * other than source file.
 				 */
-				if (issourcefile(path)) {
+				if (type == 'f') {
 					strlimcpy(val, path, sizeof(val));
 				} else {
 					/* other file like 'Makefile' */
@@ -661,12 +1145,18 @@ find_read_traverse(void)
 				return val;
 			}
 			if (type == 'd') {
-				STRBUF *sb = strbuf_open(0);
+				struct dirlist *dl = curp->child;
+				struct stack_entry entry;
 				char *dirp = curp->dirp;
+				int status;
+
 				strcat(dirp, unit);
 				strcat(dirp, "/");
-				if (getdirs(dir, sb) < 0) {
-					strbuf_close(sb);
+				assert(dl != NULL && !strcmp(dl->path, dir));
+				curp->child = dl->next;
+				status = getdirs(dl, &entry);
+				dirlist_close(dl);
+				if (status < 0) {
 					*(curp->dirp) = 0;
 					continue;
 				}
@@ -674,11 +1164,8 @@ find_read_traverse(void)
 				 * Push stack.
 				 */
 				curp = varray_assign(stack, ++current_entry, 1);
+				*curp = entry;
 				curp->dirp = dirp + strlen(dirp);
-				curp->real = getrealpath(dir);
-				curp->sb = sb;
-				curp->start = curp->p = strbuf_value(sb);
-				curp->end   = curp->start + strbuf_getlen(sb);
 			}
 		}
 		strbuf_close(curp->sb);
@@ -696,6 +1183,51 @@ find_read_traverse(void)
 	find_eof = 1;
 	return NULL;
 }
+/**
+ * find_read_gitindex: read path from the git index
+ *
+ *	@return		path
+ */
+static char *
+find_read_gitindex(void)
+{
+	static char buf[MAXPATHLEN + 2];
+	char *path = buf + 1;
+	char *p;
+
+	while (gitindex_next < gitindex->count) {
+		const struct gitindex_entry *e = &gitindex->entries[gitindex_next++];
+		struct stat st;
+		int type;
+
+		if (snprintf(path, sizeof(buf) - 1, "./%s", e->path) >= sizeof(buf) - 1)
+			continue;
+		if ((type = find_classify(path)) == FIND_SKIP)
+			continue;
+		/*
+		 * Skip files which are removed from the working tree,
+		 * and symbolic links which don't point to a file.
+		 */
+		if (stat(path, &st) < 0 || !S_ISREG(st.st_mode))
+			continue;
+		/*
+		 * A blank at the head of path means
+		 * other than source file.
+		 */
+		if (type == FIND_OTHER)
+			*--path = ' ';
+		return path;
+	}
+	if (gitindex_untracked) {
+		if (stack == NULL)
+			traverse_open(NULL);
+		while ((p = find_read_traverse()) != NULL)
+			if (gitindex_lookup(gitindex, *p == ' ' ? p + 1 : p) == NULL)
+				return p;
+	}
+	find_eof = 1;
+	return NULL;
+}
 /**
  * find_read_filelist: read path from file
  *
@@ -757,17 +1289,69 @@ find_read_filelist(void)
 			warning("'%s' ignored, because it includes blank.", trimpath(path));
 			continue;
 		}
-		if (skipthisfile(path))
-			continue;
 		/*
 		 * A blank at the head of path means
 		 * other than source file.
 		 */
-		if (!issourcefile(path))
+		switch (find_classify(path)) {
+		case FIND_SKIP:
+			continue;
+		case FIND_OTHER:
 			*--path = ' ';
+			break;
+		}
 		return path;
 	}
 }
+/**
+ * traverse_close: stop traversal of the source tree.
+ */
+static void
+traverse_close(void)
+{
+#ifdef USE_FIND_THREADS
+	if (nthreads > 0) {
+		int i;
+
+		pthread_mutex_lock(&queue_lock);
+		queue_shutdown = 1;
+		pthread_cond_broadcast(&queue_work);
+		pthread_mutex_unlock(&queue_lock);
+		for (i = 0; i < nthreads; i++)
+			pthread_join(threads[i], NULL);
+		free(threads);
+		threads = NULL;
+		free(queue);
+		queue = NULL;
+		queue_count = queue_size = queue_ahead = 0;
+	}
+#endif
+	nthreads = 0;
+	if (stack) {
+		/*
+		 * Free the directories left by an interrupted traversal.
+		 */
+		if (!find_eof) {
+			struct stack_entry *sp = varray_assign(stack, 0, 0);
+			int i;
+
+			for (i = current_entry; i >= 0; i--) {
+				while (sp[i].child) {
+					struct dirlist *dl = sp[i].child;
+
+					sp[i].child = dl->next;
+					dirlist_close(dl);
+				}
+				if (sp[i].sb)
+					strbuf_close(sp[i].sb);
+				if (sp[i].real)
+					free(sp[i].real);
+			}
+		}
+		varray_close(stack);
+		stack = NULL;
+	}
+}
 /**
  * find_close: close iterator.
  */
@@ -776,8 +1360,11 @@ find_close(void)
 {
 	assert(find_mode != 0);
 	if (find_mode == FIND_OPEN) {
+		traverse_close();
+	} else if (find_mode == GITINDEX_OPEN) {
 		if (stack)
-			varray_close(stack);
+			traverse_close();
+		gitindex = NULL;
 	} else if (find_mode == FILELIST_OPEN) {
 		/*
 		 * The --file=- option is specified, we don't close file
@@ -788,9 +1375,18 @@ find_close(void)
 	} else {
 		die("find_close: internal error.");
 	}
-	if (suff)
-		regfree(suff);
-	if (skip)
-		regfree(skip);
+	if (suff) {
+		langmap_close(suff);
+		suff = NULL;
+	}
+	source_ready = 0;
+	if (skip) {
+		strhash_close(skip->files);
+		strhash_close(skip->dirs);
+		strbuf_close(skip->names);
+		free_skipnode(skip->root);
+		free(skip);
+		skip = NULL;
+	}
 	find_eof = find_mode = 0;
 }
@@ -21,11 +21,23 @@
 #ifndef _FIND_H_
 #define _FIND_H_
 
+#include "gitindex.h"
+
+/**
+ * the result of find_classify()
+ */
+#define FIND_SKIP	0
+#define FIND_SOURCE	1
+#define FIND_OTHER	2
+
 void set_accept_dotfiles(void);
 int skipthisfile(const char *);
+int istagfile(const char *);
 int issourcefile(const char *);
+int find_classify(const char *);
 void find_open(const char *);
 void find_open_filelist(const char *, const char *);
+void find_open_gitindex(GITINDEX *, int);
 char *find_read(void);
 void find_close(void);
 
@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include "checkalloc.h"
+#include "gitindex.h"
+#include "gparam.h"
+#include "locatestring.h"
+#include "makepath.h"
+#include "strbuf.h"
+#include "strlimcpy.h"
+
+/**
+ @file
+
+ Read the index file of git (@FILE{.git/index}) without running git.
+
+ The index lists every tracked path with its status and the object name
+ (SHA-1) of its contents. Gtags uses it instead of traversing the source
+ tree, and to know whether a file has been changed without reading it.
+
+ @par Format of the index (version 2, 3 and 4):
+ @code{.txt}
+ header:	"DIRC" <version:4> <number of entries:4>
+ entry:		<ctime:8> <mtime:8> <dev:4> <ino:4> <mode:4> <uid:4> <gid:4>
+		<size:4> <sha1:20> <flags:2> [<extended flags:2>] <path>
+ @endcode
+ All numbers are in network byte order. In version 2 and 3, the path is
+ terminated by NUL and the entry is padded by NULs to a multiple of 8 bytes.
+ In version 4, the path is compressed against the previous one and
+ is not padded. Extensions follow the entries.
+
+ An index which depends on another file (split index) or which has
+ sparse directory entries is not supported. Neither is a repository whose
+ objects are named by SHA-256 (@CODE{extensions.objectFormat} in the
+ configuration file), since the size of an entry differs.
+ gitindex_open() returns NULL for them, and the caller should traverse
+ the source tree instead.
+*/
+
+#define HASH_SIZE	20		/**< size of an object name (SHA-1) */
+#define ENTRY_FIXED	(42 + HASH_SIZE) /**< size of the fixed part of an entry */
+#define FLAG_EXTENDED	0x4000		/**< extended flags follow */
+#define FLAG_STAGEMASK	0x3000		/**< merge stage */
+#define FLAG_NAMEMASK	0x0fff		/**< length of path */
+#define EXT_SKIPWORKTREE 0x4000		/**< not checked out */
+#define EXT_INTENTTOADD	0x2000		/**< added with 'git add -N' */
+
+static unsigned long
+get32(const unsigned char *p)
+{
+	return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) | ((unsigned long)p[2] << 8) | p[3];
+}
+static unsigned int
+get16(const unsigned char *p)
+{
+	return (p[0] << 8) | p[1];
+}
+/**
+ * get_varint: decode an offset of the path compression (version 4)
+ *
+ *	@param[in,out]	pp	pointer
+ *	@param[in]	end	end of buffer
+ *	@return		value, or -1 if broken
+ */
+static long
+get_varint(const unsigned char **pp, const unsigned char *end)
+{
+	const unsigned char *p = *pp;
+	long val;
+
+	if (p >= end)
+		return -1;
+	val = *p & 127;
+	while (*p++ & 128) {
+		if (p >= end || val > (MAXPATHLEN << 7))
+			return -1;
+		val = ((val + 1) << 7) | (*p & 127);
+	}
+	*pp = p;
+	return val;
+}
+/**
+ * git_dir: get the git directory.
+ *
+ *	@param[in]	root	root directory of the working tree
+ *	@param[out]	sb	git directory
+ *	@return		0: normal, -1: not found
+ *
+ * @FILE{.git} may be a file which has the location of the git directory
+ * (@CODE{gitdir: <path>}), as in worktrees and submodules.
+ */
+static int
+git_dir(const char *root, STRBUF *sb)
+{
+	struct stat st;
+	char gitdir[MAXPATHLEN];
+
+	strlimcpy(gitdir, makepath(root, ".git", NULL), sizeof(gitdir));
+	if (stat(gitdir, &st) < 0)
+		return -1;
+	if (S_ISREG(st.st_mode)) {
+		FILE *ip = fopen(gitdir, "r");
+		STRBUF *ib;
+		const char *p;
+
+		if (ip == NULL)
+			return -1;
+		ib = strbuf_open(0);
+		p = strbuf_fgets(ib, ip, STRBUF_NOCRLF);
+		fclose(ip);
+		if (p == NULL || strncmp(p, "gitdir: ", 8)) {
+			strbuf_close(ib);
+			return -1;
+		}
+		p += 8;
+		if (*p == '/')
+			strlimcpy(gitdir, p, sizeof(gitdir));
+		else
+			strlimcpy(gitdir, makepath(root, p, NULL), sizeof(gitdir));
+		strbuf_close(ib);
+	}
+	strbuf_reset(sb);
+	strbuf_puts(sb, gitdir);
+	return 0;
+}
+/**
+ * sha1_config: check the object format in a configuration file of git.
+ *
+ *	@param[in]	config	configuration file
+ *	@return		1: SHA-1 (or no configuration file), 0: other format
+ *
+ * @code{.txt}
+ * [extensions]
+ *	objectFormat = sha256
+ * @endcode
+ * Section and variable names are case insensitive.
+ */
+static int
+sha1_config(const char *config)
+{
+	FILE *ip = fopen(config, "r");
+	STRBUF *ib;
+	const char *p;
+	int extensions = 0, sha1 = 1;
+
+	if (ip == NULL)
+		return 1;
+	ib = strbuf_open(0);
+	while ((p = strbuf_fgets(ib, ip, STRBUF_NOCRLF)) != NULL) {
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '[') {
+			p++;
+			while (*p == ' ' || *p == '\t')
+				p++;
+			p = locatestring(p, "extensions", MATCH_AT_FIRST|IGNORE_CASE);
+			extensions = (p != NULL && (*p == ']' || *p == ' ' || *p == '\t'));
+		} else if (extensions
+		    && (p = locatestring(p, "objectformat", MATCH_AT_FIRST|IGNORE_CASE)) != NULL) {
+			while (*p == ' ' || *p == '\t')
+				p++;
+			if (*p++ != '=')
+				continue;
+			while (*p == ' ' || *p == '\t')
+				p++;
+			if (!locatestring(p, "sha1", MATCH_AT_FIRST|IGNORE_CASE))
+				sha1 = 0;
+		}
+	}
+	fclose(ip);
+	strbuf_close(ib);
+	return sha1;
+}
+/**
+ * index_path: get the path name of the index file.
+ *
+ *	@param[in]	root	root directory of the working tree
+ *	@param[out]	sb	path name
+ *	@return		0: normal, -1: not found or not supported
+ *
+ * The configuration file of a linked worktree is in the common directory
+ * whose location is written in @FILE{commondir}.
+ */
+static int
+index_path(const char *root, STRBUF *sb)
+{
+	char gitdir[MAXPATHLEN];
+	char commondir[MAXPATHLEN];
+	FILE *ip;
+
+	if (git_dir(root, sb) < 0)
+		return -1;
+	strlimcpy(gitdir, strbuf_value(sb), sizeof(gitdir));
+	strlimcpy(commondir, gitdir, sizeof(commondir));
+	if ((ip = fopen(makepath(gitdir, "commondir", NULL), "r")) != NULL) {
+		const char *p = strbuf_fgets(sb, ip, STRBUF_NOCRLF);
+
+		fclose(ip);
+		if (p != NULL && *p == '/')
+			strlimcpy(commondir, p, sizeof(commondir));
+		else if (p != NULL && *p)
+			strlimcpy(commondir, makepath(gitdir, p, NULL), sizeof(commondir));
+	}
+	if (!sha1_config(makepath(commondir, "config", NULL)))
+		return -1;
+	if (strcmp(commondir, gitdir) && !sha1_config(makepath(gitdir, "config.worktree", NULL)))
+		return -1;
+	strbuf_reset(sb);
+	strbuf_puts(sb, makepath(gitdir, "index", NULL));
+	return 0;
+}
+/**
+ * gitindex_open: read the git index
+ *
+ *	@param[in]	root	root directory of the working tree
+ *	@return		index, or NULL if not available
+ */
+GITINDEX *
+gitindex_open(const char *root)
+{
+	STRBUF *sb = strbuf_open(0);
+	GITINDEX *gi = NULL;
+	FILE *ip = NULL;
+	struct stat st;
+	unsigned char *buf = NULL;
+	const unsigned char *p, *end;
+	unsigned long version, count, i;
+	char *prev;
+	int prevlen = 0;
+
+	if (index_path(root, sb) < 0)
+		goto fail;
+	if (stat(strbuf_value(sb), &st) < 0 || st.st_size < 12 + HASH_SIZE)
+		goto fail;
+	if ((ip = fopen(strbuf_value(sb), "rb")) == NULL)
+		goto fail;
+	buf = (unsigned char *)check_malloc(st.st_size);
+	if (fread(buf, 1, st.st_size, ip) != (size_t)st.st_size)
+		goto fail;
+	fclose(ip);
+	ip = NULL;
+	end = buf + st.st_size - HASH_SIZE;	/* checksum at the end */
+	if (memcmp(buf, "DIRC", 4))
+		goto fail;
+	version = get32(buf + 4);
+	if (version < 2 || version > 4)
+		goto fail;
+	count = get32(buf + 8);
+	if (count > (unsigned long)st.st_size / ENTRY_FIXED)
+		goto fail;
+	gi = (GITINDEX *)check_calloc(sizeof(GITINDEX), 1);
+	gi->entries = (struct gitindex_entry *)check_calloc(sizeof(struct gitindex_entry), count + 1);
+	gi->hash = strhash_open(count / 4 + 1);
+	gi->mtime = (unsigned long)st.st_mtime;
+	prev = check_malloc(MAXPATHLEN);
+	prev[0] = '\0';
+	for (p = buf + 12, i = 0; i < count; i++) {
+		const unsigned char *ent = p;
+		struct gitindex_entry *e;
+		unsigned int flags, extflags = 0;
+		struct sh_entry *sh;
+		const char *name;
+		int j;
+
+		if (p + ENTRY_FIXED > end)
+			goto broken;
+		flags = get16(p + 40 + HASH_SIZE);
+		p += ENTRY_FIXED;
+		if (flags & FLAG_EXTENDED) {
+			if (version < 3 || p + 2 > end)
+				goto broken;
+			extflags = get16(p);
+			p += 2;
+		}
+		if (version == 4) {
+			long strip = get_varint(&p, end);
+			const unsigned char *q;
+
+			if (strip < 0 || strip > prevlen)
+				goto broken;
+			for (q = p; q < end && *q; q++)
+				;
+			if (q >= end || prevlen - strip + (q - p) >= MAXPATHLEN)
+				goto broken;
+			prevlen -= strip;
+			memcpy(prev + prevlen, p, q - p);
+			prevlen += q - p;
+			prev[prevlen] = '\0';
+			p = q + 1;
+		} else {
+			const unsigned char *q;
+
+			for (q = p; q < end && *q; q++)
+				;
+			if (q >= end || q - p >= MAXPATHLEN)
+				goto broken;
+			prevlen = q - p;
+			memcpy(prev, p, prevlen);
+			prev[prevlen] = '\0';
+			/* padding: 1 to 8 NULs */
+			p = ent + (((p - ent) + prevlen + 8) & ~7);
+		}
+		/*
+		 * Sparse directories cannot be expanded without reading trees.
+		 */
+		if ((get32(ent + 24) & 0170000) == 0040000)
+			goto broken;
+		/*
+		 * Skip the following:
+		 * o unmerged entries except for the first stage
+		 * o files which are not checked out
+		 * o submodules
+		 */
+		if (extflags & (EXT_SKIPWORKTREE|EXT_INTENTTOADD))
+			continue;
+		if ((get32(ent + 24) & 0170000) == 0160000)
+			continue;
+		sh = strhash_assign(gi->hash, prev, 1);
+		if (sh->value != NULL)
+			continue;
+		name = sh->name;
+		e = &gi->entries[gi->count++];
+		e->path = name;
+		e->mtime = get32(ent + 8);
+		e->ino = get32(ent + 20);
+		e->mode = get32(ent + 24);
+		e->size = get32(ent + 36);
+		for (j = 0; j < HASH_SIZE; j++)
+			snprintf(e->blob + j * 2, 3, "%02x", ent[40 + j]);
+		/*
+		 * Unmerged entries have no contents in the working tree.
+		 */
+		if (flags & FLAG_STAGEMASK)
+			e->blob[0] = '\0';
+		sh->value = e;
+	}
+	/*
+	 * A split index has its entries in another file.
+	 */
+	while (p + 8 <= end) {
+		if (!memcmp(p, "link", 4))
+			goto broken;
+		p += 8 + get32(p + 4);
+	}
+	free(prev);
+	free(buf);
+	strbuf_close(sb);
+	return gi;
+broken:
+	free(prev);
+fail:
+	if (ip)
+		fclose(ip);
+	if (buf)
+		free(buf);
+	if (gi)
+		gitindex_close(gi);
+	strbuf_close(sb);
+	return NULL;
+}
+/**
+ * gitindex_lookup: look up a path name
+ *
+ *	@param[in]	gi	index
+ *	@param[in]	path	path name (@FILE{./} at the head is allowed)
+ *	@return		entry, or NULL if not tracked
+ */
+const struct gitindex_entry *
+gitindex_lookup(GITINDEX *gi, const char *path)
+{
+	struct sh_entry *sh;
+
+	if (path[0] == '.' && path[1] == '/')
+		path += 2;
+	sh = strhash_assign(gi->hash, path, 0);
+	return sh ? (const struct gitindex_entry *)sh->value : NULL;
+}
+/**
+ * gitindex_blob: get the object name of the contents of a file
+ *
+ *	@param[in]	gi	index
+ *	@param[in]	path	path name
+ *	@param[in]	size	current size of the file
+ *	@param[in]	mtime	current modification time of the file
+ *	@param[in]	ino	current inode number of the file
+ *	@return		object name, or NULL if unknown
+ *
+ * The object name is valid only if the status of the file is the same as
+ * recorded in the index. If the file was modified in the same second as the
+ * index was written, the status cannot be trusted (a racy entry in git).
+ */
+const char *
+gitindex_blob(GITINDEX *gi, const char *path, unsigned long size, unsigned long mtime, unsigned long ino)
+{
+	const struct gitindex_entry *e = gitindex_lookup(gi, path);
+
+	if (e == NULL || e->blob[0] == '\0')
+		return NULL;
+	if (e->size != (size & 0xffffffffUL) || e->mtime != (mtime & 0xffffffffUL))
+		return NULL;
+	if (e->ino != 0 && e->ino != (ino & 0xffffffffUL))
+		return NULL;
+	if (e->mtime >= gi->mtime)
+		return NULL;
+	return e->blob;
+}
+/**
+ * gitindex_close: free the index
+ *
+ *	@param[in]	gi	index
+ */
+void
+gitindex_close(GITINDEX *gi)
+{
+	if (gi->hash)
+		strhash_close(gi->hash);
+	free(gi->entries);
+	free(gi);
+}
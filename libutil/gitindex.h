@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _GITINDEX_H_
+#define _GITINDEX_H_
+
+#include "strhash.h"
+
+/**
+ * An entry of the git index.
+ */
+struct gitindex_entry {
+	const char *path;		/**< path name relative to the root */
+	unsigned long mtime;		/**< modification time (seconds) */
+	unsigned long size;		/**< file size (lower 32 bits) */
+	unsigned long ino;		/**< inode number (lower 32 bits) */
+	unsigned int mode;		/**< file mode */
+	char blob[41];			/**< object name of the contents */
+};
+
+typedef struct {
+	struct gitindex_entry *entries;	/**< entries in the order of path */
+	int count;			/**< number of entries */
+	STRHASH *hash;			/**< path name => entry */
+	unsigned long mtime;		/**< modification time of the index */
+} GITINDEX;
+
+GITINDEX *gitindex_open(const char *);
+const struct gitindex_entry *gitindex_lookup(GITINDEX *, const char *);
+const char *gitindex_blob(GITINDEX *, const char *, unsigned long, unsigned long, unsigned long);
+void gitindex_close(GITINDEX *);
+
+#endif /* ! _GITINDEX_H_ */
@@ -24,6 +24,7 @@
 #include "gparam.h"
 #include "abs2rel.h"
 #include "args.h"
+#include "bloom.h"
 #include "char.h"
 #include "checkalloc.h"
 #include "compress.h"
@@ -42,6 +43,7 @@
 #include "idset.h"
 #include "is_unixy.h"
 #include "langmap.h"
+#include "lineindex.h"
 #include "linetable.h"
 #include "locatestring.h"
 #include "logging.h"
@@ -49,6 +51,7 @@
 #include "path.h"
 #include "pathconvert.h"
 #include "pool.h"
+#include "shard.h"
 #include "split.h"
 #include "statistics.h"
 #include "strbuf.h"
@@ -58,6 +61,7 @@
 #include "tab.h"
 #include "test.h"
 #include "token.h"
+#include "trigram.h"
 #include "usable.h"
 #include "version.h"
 #include "varray.h"
@@ -55,5 +55,40 @@
 #define GTAGSCACHE	50000000
 		/** minimum cache size 500KB	*/
 #define GTAGSMINCACHE	500000
+/*
+ * The default size of memory for sorted writing is 64MB.
+ * The minimum size is 1MB.
+ */
+		/** default sort buffer size 64MB */
+#define GTAGSSORTBUF	64000000
+		/** minimum sort buffer size 1MB */
+#define GTAGSMINSORTBUF	1000000
+/*
+ * The default size of memory for the tags of a file in compact format
+ * and the names of its file index is 64MB. If they exceed it, they are
+ * spilled to sorted runs. The minimum size is 1MB.
+ */
+		/** default pool size 64MB */
+#define GTAGSPOOLBUF	64000000
+		/** minimum pool size 1MB */
+#define GTAGSMINPOOLBUF	1000000
+/*
+ * Gtags --watch applies the changes after this period with no event.
+ */
+		/** quiet period 0.5 second */
+#define WATCHDELAY	500
+/*
+ * The number of threads which read directories ahead in the traversal.
+ * If it is 0, directories are read one by one.
+ */
+		/** default number of reader threads */
+#define FINDTHREADS	4
+		/** max number of directory lists read ahead */
+#define FINDREADAHEAD	64
+/*
+ * Gtags --profile reports the slowest files at the end.
+ */
+		/** number of files in the report */
+#define PROFILETOP	10
 
 #endif /* ! _GPARAM_H_ */
@@ -21,7 +21,10 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <assert.h>
+#include <stdio.h>
 #ifdef STDC_HEADERS
 #include <stdlib.h>
 #endif
@@ -37,6 +40,7 @@
 #include "gtagsop.h"
 #include "makepath.h"
 #include "gpathop.h"
+#include "shard.h"
 #include "strbuf.h"
 #include "strlimcpy.h"
 
@@ -45,6 +49,7 @@ static int _nextkey;
 static int _mode;
 static int opened;
 static int created;
+static char _dbpath[MAXPATHLEN];	/**< dbpath of the GPATH opened last */
 
 /**
  * @file
@@ -89,9 +94,54 @@ static int created;
  *      ./aaa.c\0       11\0
  *      ./README\0      12\0o\0         <=== 'o' means other files.
  * @endcode
+ *
+ * @par
+ * The record of a source file may have the status of the file following
+ * an empty flag. It is used to find changed files in the incremental
+ * updating (see #FILESTAT). Since it is ignored by older versions, the
+ * format version is still 2.
+ *
+ * @par
+ * @code{.txt}
+ *      key             data
+ *      --------------------
+ *      ./aaa.c\0       11\0\0<size> <mtime> <inode> <hash>[ <blob>]\0
+ * @endcode
+ *
+ * @par
+ * @NAME{hash} is the hash value of the contents in 16 hexadecimal digits,
+ * or '-' if it is not computed (see gpath_hash()).
+ * @NAME{blob} is the object name of the contents taken from the git index
+ * (see gpath_set_gitindex()). It is recorded only when it is known.
  */
 static int support_version = 2;	/**< acceptable format version   */
 static int create_version = 2;	/**< format version of newly created tag file */
+static GITINDEX *gitindex;	/**< git index for gpath_filestat() */
+/**
+ * put_filestat: put the status of a file into a record
+ *
+ *	@param[in]	sb	record
+ *	@param[in]	st	status of the file
+ */
+static void
+put_filestat(STRBUF *sb, const FILESTAT *st)
+{
+	char buf[80];
+
+	snprintf(buf, sizeof(buf), "%lu %lu %lu ", st->size, st->mtime, st->ino);
+	strbuf_puts(sb, buf);
+	if (st->hashed) {
+		snprintf(buf, sizeof(buf), "%08lx%08lx",
+			(unsigned long)(st->hash >> 32), (unsigned long)(st->hash & 0xffffffffUL));
+		strbuf_puts(sb, buf);
+	} else
+		strbuf_putc(sb, '-');
+	if (st->blob[0]) {
+		strbuf_putc(sb, ' ');
+		strbuf_puts(sb, st->blob);
+	}
+	strbuf_putc(sb, '\0');
+}
 /**
  * gpath_open: open gpath tag file
  *
@@ -113,7 +163,11 @@ gpath_open(const char *dbpath, int mode)
 	}
 	/*
 	 * We create GPATH just first time.
+	 * The GPATH of another shard is a different one.
 	 */
+	if (created && strcmp(dbpath, _dbpath))
+		created = 0;
+	strlimcpy(_dbpath, dbpath, sizeof(_dbpath));
 	_mode = mode;
 	if (mode == 1 && created)
 		mode = 0;
@@ -152,24 +206,39 @@ void
 gpath_put(const char *path, int type)
 {
 	char fid[MAXFIDLEN];
+	FILESTAT st;
 	STATIC_STRBUF(sb);
 
 	assert(opened > 0);
 	if (_mode == 1 && created)
 		return;
-	if (dbop_get(dbop, path) != NULL)
+	if (dbop_get(dbop, path) != NULL) {
+		/*
+		 * The file will be parsed again. Record the current status.
+		 */
+		if (type == GPATH_SOURCE && gpath_filestat(path, &st) == 0)
+			gpath_putstat(path, &st);
 		return;
+	}
 	/*
 	 * generate new file id for the path.
 	 */
 	snprintf(fid, sizeof(fid), "%d", _nextkey++);
 	/*
 	 * path => fid mapping.
+	 * The status of a source file is recorded before parsing, so that
+	 * a change while parsing is detected next time. The hash value of
+	 * the contents is not computed here, since the file is not read;
+	 * the caller may record it later by gpath_putstat().
 	 */
 	strbuf_clear(sb);
 	strbuf_puts0(sb, fid);
 	if (type == GPATH_OTHER)
 		strbuf_puts0(sb, "o");
+	else if (gpath_filestat(path, &st) == 0) {
+		strbuf_puts0(sb, "");
+		put_filestat(sb, &st);
+	}
 	dbop_put_withlen(dbop, path, strbuf_value(sb), strbuf_getlen(sb));
 	/*
 	 * fid => path mapping.
@@ -221,6 +290,169 @@ gpath_fid2path(const char *fid, int *type)
 	}
 	return path;
 }
+/**
+ * gpath_getstat: get the recorded status of a source file
+ *
+ *	@param[in]	path	path name
+ *	@param[out]	st	status of the file
+ *	@return		0: normal, -1: not recorded
+ *
+ * Files registered by older versions have no status.
+ */
+int
+gpath_getstat(const char *path, FILESTAT *st)
+{
+	static const char xdigits[] = "0123456789abcdef";
+	const char *dat;
+	char hash[17];
+	int size, i;
+
+	assert(opened > 0);
+	if ((dat = dbop_get(dbop, path)) == NULL)
+		return -1;
+	dbop_lastdat(dbop, &size);
+	/*
+	 * Dat format is like follows.
+	 * dat '11\0\0<size> <mtime> <inode> <hash>[ <blob>]\0'
+	 *      (fid) (flag) (status)
+	 */
+	i = strlen(dat) + 1;
+	if (i + 1 >= size || dat[i] != '\0')
+		return -1;
+	st->blob[0] = '\0';
+	if (sscanf(dat + i + 1, "%lu %lu %lu %16s %40s", &st->size, &st->mtime, &st->ino, hash, st->blob) < 4)
+		return -1;
+	/*
+	 * The hash value recorded by older versions (in decimal) is ignored.
+	 */
+	st->hash = 0;
+	st->hashed = 0;
+	if (strlen(hash) == 16 && strspn(hash, xdigits) == 16) {
+		for (i = 0; i < 16; i++)
+			st->hash = (st->hash << 4) | (strchr(xdigits, hash[i]) - xdigits);
+		st->hashed = 1;
+	}
+	return 0;
+}
+/**
+ * gpath_putstat: record the status of a source file
+ *
+ *	@param[in]	path	path name
+ *	@param[in]	st	status of the file
+ */
+void
+gpath_putstat(const char *path, const FILESTAT *st)
+{
+	const char *fid;
+	STATIC_STRBUF(sb);
+
+	assert(opened > 0);
+	assert(_mode != 0);
+	if ((fid = dbop_get(dbop, path)) == NULL)
+		return;
+	strbuf_clear(sb);
+	strbuf_puts0(sb, fid);
+	strbuf_puts0(sb, "");
+	put_filestat(sb, st);
+	dbop_put_withlen(dbop, path, strbuf_value(sb), strbuf_getlen(sb));
+}
+/**
+ * gpath_set_gitindex: use the git index for the status of files
+ *
+ *	@param[in]	gi	git index, or @VAR{NULL}
+ */
+void
+gpath_set_gitindex(GITINDEX *gi)
+{
+	gitindex = gi;
+}
+/**
+ * gpath_filestat: get the status of a file except for the hash value
+ *
+ *	@param[in]	path	path name
+ *	@param[out]	st	status of the file
+ *	@return		0: normal, -1: error
+ *
+ * If the git index is available and the file is not changed since it
+ * was added to the index, the object name of the contents is set too.
+ */
+int
+gpath_filestat(const char *path, FILESTAT *st)
+{
+	struct stat sb;
+	const char *blob;
+
+	if (stat(path, &sb) < 0)
+		return -1;
+	st->size = (unsigned long)sb.st_size;
+	st->mtime = (unsigned long)sb.st_mtime;
+	st->ino = (unsigned long)sb.st_ino;
+	st->hash = 0;
+	st->hashed = 0;
+	st->blob[0] = '\0';
+	if (gitindex && (blob = gitindex_blob(gitindex, path, st->size, st->mtime, st->ino)) != NULL)
+		strlimcpy(st->blob, blob, sizeof(st->blob));
+	return 0;
+}
+/**
+ * gpath_filehash: compute the hash value of the contents of a file
+ *
+ *	@param[in]	path	path name
+ *	@param[out]	st	status of the file, in which the hash value is set
+ *	@return		0: normal, -1: error
+ */
+int
+gpath_filehash(const char *path, FILESTAT *st)
+{
+	FILE *ip;
+	char buf[8192];
+	size_t n;
+
+	if ((ip = fopen(path, "rb")) == NULL)
+		return -1;
+	gpath_hashinit(st);
+	while ((n = fread(buf, 1, sizeof(buf), ip)) > 0)
+		gpath_hash(st, buf, n);
+	if (ferror(ip)) {
+		fclose(ip);
+		st->hashed = 0;
+		return -1;
+	}
+	fclose(ip);
+	return 0;
+}
+/**
+ * gpath_hashinit: start computing the hash value of the contents
+ *
+ *	@param[out]	st	status of the file
+ */
+void
+gpath_hashinit(FILESTAT *st)
+{
+	st->hash = 14695981039346656037ULL;
+	st->hashed = 1;
+}
+/**
+ * gpath_hash: add a part of the contents to the hash value
+ *
+ *	@param[in,out]	st	status of the file
+ *	@param[in]	buf	the next part of the contents
+ *	@param[in]	size	size of @a buf
+ *
+ * The hash function is 64-bit FNV-1a. It lets the caller that reads the
+ * file anyway compute the hash value without reading it again.
+ */
+void
+gpath_hash(FILESTAT *st, const void *buf, size_t size)
+{
+	const unsigned char *p = (const unsigned char *)buf;
+	const unsigned char *end = p + size;
+	uint64_t hash = st->hash;
+
+	while (p < end)
+		hash = (hash ^ *p++) * 1099511628211ULL;
+	st->hash = hash;
+}
 /**
  * gpath_delete: delete specified path record
  *
@@ -283,8 +515,11 @@ gpath_close(void)
  * @par
  * @NAME{gfind_xxx()} does almost same with @NAME{find_xxx()} but much faster,
  * because @NAME{gfind_xxx()} use #GPATH (file index). <br>
- * If #GPATH exist then you should use this.
+ * If #GPATH exist then you should use this. <br>
+ * If the tag files are sharded, the paths of all the shards are read
+ * in the order of path name.
  */
+static GFIND *gfind_open_shard(const char *, const char *, int);
 
 /**
  * gfind_open: start iterator using #GPATH.
@@ -299,6 +534,29 @@ gpath_close(void)
  */
 GFIND *
 gfind_open(const char *dbpath, const char *local, int target)
+{
+	GFIND *gfind;
+	SHARDS *shards = shard_open(dbpath);
+	int i;
+
+	if (shards == NULL)
+		return gfind_open_shard(dbpath, local, target);
+	gfind = (GFIND *)check_calloc(sizeof(GFIND), 1);
+	gfind->part = (GFIND **)check_calloc(sizeof(GFIND *), shards->count);
+	for (i = 0; i < shards->count; i++) {
+		if (!shard_exist(shards, i))
+			continue;
+		gfind->part[gfind->parts++] = gfind_open_shard(shard_dbpath(shards, i), local, target);
+	}
+	shard_close(shards);
+	gfind->first = 1;
+	return gfind;
+}
+/**
+ * gfind_open_shard: start iterator using the #GPATH of a dbpath (or a shard).
+ */
+static GFIND *
+gfind_open_shard(const char *dbpath, const char *local, int target)
 {
 	GFIND *gfind = (GFIND *)check_calloc(sizeof(GFIND), 1);
 
@@ -332,6 +590,32 @@ gfind_read(GFIND *gfind)
 	gfind->type = GPATH_SOURCE;
 	if (gfind->eod)
 		return NULL;
+	if (gfind->part) {
+		/*
+		 * Merge the shards: return the least path of them.
+		 */
+		GFIND *part = NULL;
+		int i, last = gfind->cur;
+
+		for (i = 0; i < gfind->parts; i++) {
+			if (gfind->first || i == last)
+				gfind_read(gfind->part[i]);
+			if (gfind->part[i]->eod)
+				continue;
+			if (part == NULL || strcmp(gfind->part[i]->path, part->path) < 0) {
+				part = gfind->part[i];
+				gfind->cur = i;
+			}
+		}
+		gfind->first = 0;
+		if (part == NULL) {
+			gfind->eod = 1;
+			return NULL;
+		}
+		gfind->dbop = part->dbop;
+		gfind->type = part->type;
+		return gfind->path = part->path;
+	}
 	for (;;) {
 		if (gfind->first) {
 			gfind->first = 0;
@@ -360,6 +644,15 @@ gfind_read(GFIND *gfind)
 void
 gfind_close(GFIND *gfind)
 {
+	if (gfind->part) {
+		int i;
+
+		for (i = 0; i < gfind->parts; i++)
+			gfind_close(gfind->part[i]);
+		free(gfind->part);
+		free(gfind);
+		return;
+	}
 	dbop_close(gfind->dbop);
 	free((void *)gfind->prefix);
 	free(gfind);
@@ -21,9 +21,13 @@
 #ifndef _PATHOP_H_
 #define _PATHOP_H_
 #include <stdio.h>
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
 
 #include "gparam.h"
 #include "dbop.h"
+#include "gitindex.h"
 
 #define NEXTKEY		" __.NEXTKEY"
 
@@ -36,7 +40,20 @@
 #define GPATH_BOTH	3
 /** @} */
 
+/**
+ * Status of a source file recorded in #GPATH.
+ * If it is not changed, the file need not be parsed again.
+ */
 typedef struct {
+	unsigned long size;	/**< file size */
+	unsigned long mtime;	/**< modification time */
+	unsigned long ino;	/**< inode number */
+	uint64_t hash;		/**< hash value of the contents */
+	int hashed;		/**< 1: @NAME{hash} is set, 0: unknown */
+	char blob[41];		/**< object name in the git index, or "" */
+} FILESTAT;
+
+typedef struct gfind {
 	/** set by gfind_open() */
 	DBOP *dbop;
 	const char *prefix;
@@ -48,12 +65,23 @@ typedef struct {
 	/* set by gfind_read() */
 	int type;		/**< File type; set by gfind_read() */
 	const char *path;	/**< return value of gfind_read() */
+	/** for sharded tag files */
+	struct gfind **part;	/**< iterator of each shard */
+	int parts;		/**< number of the shards */
+	int cur;		/**< shard of the last path */
 } GFIND;
 
 int gpath_open(const char *, int);
 const char *gpath_path2fid(const char *, int *);
 const char *gpath_fid2path(const char *, int *);
 void gpath_put(const char *, int);
+int gpath_getstat(const char *, FILESTAT *);
+void gpath_putstat(const char *, const FILESTAT *);
+int gpath_filestat(const char *, FILESTAT *);
+int gpath_filehash(const char *, FILESTAT *);
+void gpath_hashinit(FILESTAT *);
+void gpath_hash(FILESTAT *, const void *, size_t);
+void gpath_set_gitindex(GITINDEX *);
 void gpath_delete(const char *);
 void gpath_close(void);
 int gpath_nextkey(void);
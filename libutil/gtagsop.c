@@ -53,18 +53,29 @@
 #include "strbuf.h"
 #include "strhash.h"
 #include "strlimcpy.h"
-#include "strmake.h"
 #include "varray.h"
 
 #define HASHBUCKETS	2048
+/** times to open the tag files again when they are replaced while being opened */
+#define OPEN_RETRY	10
 
 static int compare_path(const void *, const void *);
 static int compare_lineno(const void *, const void *);
 static int compare_tags(const void *, const void *);
 static const char *seekto(const char *, int);
+static void put_number(STRBUF *, unsigned int);
+static const unsigned char *get_number(const unsigned char *, const unsigned char *, unsigned int *);
 static int is_defined_in_GTAGS(GTOP *, const char *);
 static void flush_pool(GTOP *, const char *);
+static void spill_pool(GTOP *);
+static void put_key(GTOP *, const char *);
+static void spill_keys(GTOP *);
+static void put_compact(GTOP *, const char *, VARRAY *, const char *);
+static void put_fileindex(GTOP *, const char *);
+static int delete_by_fileindex(GTOP *, IDSET *);
+static void delete_fileindex(GTOP *, unsigned int);
 static void segment_read(GTOP *);
+static int literal_prefix(const char *, char *, int, int *);
 
 /**
  * compare_path: compare function for sorting path names.
@@ -101,17 +112,19 @@ compare_tags(const void *v1, const void *v2)
  *
  * @par Usage:
  * @code
- *           0         1          2
- * tagline = <file id> <tag name> <line number>
+ *           0         1          2             3
+ * tagline = <file id> <tag name> <line number> <line image>
  *
  * <file id>     = seekto(tagline, SEEKTO_FILEID);
  * <tag name>    = seekto(tagline, SEEKTO_TAGNAME);
  * <line number> = seekto(tagline, SEEKTO_LINENO);
+ * <line image>  = seekto(tagline, SEEKTO_IMAGE);
  * @endcode
  */
 #define SEEKTO_FILEID	0
 #define SEEKTO_TAGNAME	1
 #define SEEKTO_LINENO	2
+#define SEEKTO_IMAGE	3
 
 static const char *
 seekto(const char *string, int n)
@@ -125,6 +138,49 @@ seekto(const char *string, int n)
 	}
 	return p;
 }
+/**
+ * put_number: put a number of a binary record.
+ *
+ *	@param[in]	sb	#STRBUF
+ *	@param[in]	n	number
+ *
+ * The number is stored plus one, so no byte is NUL. See [Tag format].
+ */
+static void
+put_number(STRBUF *sb, unsigned int n)
+{
+	n++;
+	while (n >= 0x80) {
+		strbuf_putc(sb, (n & 0x7f) | 0x80);
+		n >>= 7;
+	}
+	strbuf_putc(sb, n);
+}
+/**
+ * get_number: get a number of a binary record.
+ *
+ *	@param[in]	p	start of the number
+ *	@param[in]	end	end of the record
+ *	@param[out]	n	number
+ *	@return		next of the number
+ */
+static const unsigned char *
+get_number(const unsigned char *p, const unsigned char *end, unsigned int *n)
+{
+	unsigned int v = 0;
+	int shift;
+
+	for (shift = 0; p < end && *p & 0x80; shift += 7) {
+		if (shift > 21)
+			die("illegal tag record.");
+		v |= (*p++ & 0x7f) << shift;
+	}
+	if (p >= end || *p == 0)
+		die("illegal tag record.");
+	v |= *p++ << shift;
+	*n = v - 1;
+	return p;
+}
 /**
  * Tag format
  *
@@ -154,6 +210,30 @@ seekto(const char *string, int n)
  *         Line image might be compressed (#GTAGS_COMPRESS). <br>
  *         Tag name might be compressed (#GTAGS_COMPNAME).
  *
+ * @par Binary standard format:
+ *
+ *	This format is the default format of #GTAGS since format version 7
+ *	(#GTAGS_BINARY). It has the same items as the standard format.
+ *
+ * @par
+ * @code{.txt}
+ *         <file id><line number><name length><tag name><image length><line image>
+ * @endcode
+ *
+ * @par
+ *         Each number is a variable length integer: 7 bits in a byte from
+ *         the lowest, and the highest bit is set except in the last byte. <br>
+ *         Each number is stored plus one, so a record never includes NUL
+ *         and can be treated as a string. <br>
+ *         Decoding a record doesn't search for separators (see gtags_decode()).
+ *
+ * @par
+ * @code{.txt}
+ *         [example]
+ *         +------------------------------------
+ *         |<111><11><5>func<15>int func(int a)
+ * @endcode
+ *
  * @par Compact format:
  * 
  * @par
@@ -182,6 +262,19 @@ seekto(const char *string, int n)
  *           ex: 10,3,2 means '10 13 15'. <br>
  *	   In addition,successive line numbers are expressed as a range. <br>
  *           ex: 10-3 means '10 11 12 13'.
+ * @par File index:
+ * @par
+ *	Both formats may have meta records for each file, one for each tag
+ *	name used as a key of the records of the file (#GTAGS_FILEINDEX).
+ *	They are used to delete the records of a file without reading the
+ *	whole tag file. A file without tags has a record with an empty name.
+ * @par
+ * @code{.txt}
+ *         [key]                [data]
+ *         " __.KEYS.<file id>" "<tag name>"
+ *         " __.KEYS.<file id>" "<tag name>"
+ *         ...
+ * @endcode
  *
  * @par [Description]
  * 
@@ -231,8 +324,10 @@ seekto(const char *string, int n)
                        if (format !=  4) then print error message.
   GLOBAL-5.4 - 5.8.2	support format version 4 and 5
                        if (format > 5 || format < 4) then print error message.
-  GLOBAL-5.9 -		support only format version 6
+  GLOBAL-5.9 - 6.2.7	support only format version 6
                        if (format > 6 || format < 6) then print error message.
+  GLOBAL-6.2.8 -	support format version 6 and 7
+                       if (format > 7 || format < 6) then print error message.
  @endverbatim
  *
  * In @NAME{GLOBAL-5.0}, we threw away the compatibility with the past formats.
@@ -249,8 +344,8 @@ seekto(const char *string, int n)
  *       GTAGS seems older format. Please remake tag files.
  * @endcode
  */
-static int new_format_version = 6;	/**< new format version */
-static int upper_bound_version = 6;	/**< acceptable format version (upper bound) */
+static int new_format_version = 7;	/**< new format version */
+static int upper_bound_version = 7;	/**< acceptable format version (upper bound) */
 static int lower_bound_version = 6;	/**< acceptable format version (lower bound) */
 static const char *const tagslist[] = {"GPATH", "GTAGS", "GRTAGS", "GSYMS"};
 /**
@@ -275,6 +370,10 @@ static const char *const tagslist[] = {"GPATH", "GTAGS", "GRTAGS", "GSYMS"};
 		if ((gtop->db == GRTAGS && !defined) || (gtop->db == GSYMS && defined))	\
 			continue;							\
 	}
+/**
+ * Number of steps of the cursor of #GTAGS before it is placed again by a search.
+ */
+#define MERGE_STEPS	8
 /**
  * is_defined_in_GTAGS: whether or not the name is defined in #GTAGS.
  *
@@ -282,18 +381,49 @@ static const char *const tagslist[] = {"GPATH", "GTAGS", "GRTAGS", "GSYMS"};
  *	@param[in]	name	tag name
  *	@return		0: not defined, 1: defined
  *
- * @note It is assumed that the input stream is sorted by the tag name.
+ * If @CODE{gtop->shards} is set, the @NAME{GTAGS} of the shards are also examined.
+ *
+ * Since the names come from a scan of @NAME{GRTAGS}, they are sorted like the
+ * keys of @NAME{GTAGS}. So a cursor of @NAME{GTAGS} is moved forward with them
+ * (merge join) instead of looking up each name. When the next name is far
+ * ahead (more than #MERGE_STEPS keys), the cursor is placed by a search.
+ * If the names go back (a new scan), the cursor is placed again.
  */
 static int
 is_defined_in_GTAGS(GTOP *gtop, const char *name)
 {
-	static char prev_name[MAXTOKEN+1];
-	static int prev_result;
+	int n, cmp;
 
-	if (!strcmp(name, prev_name))
-		return prev_result;
-	strlimcpy(prev_name, name, sizeof(prev_name));
-	return prev_result = dbop_get(gtop->gtags, prev_name) ? 1 : 0;
+	if (!strcmp(name, gtop->prev_name))
+		return gtop->prev_result;
+	if (strcmp(name, gtop->prev_name) < 0)
+		gtop->gtags_cursor = 0;
+	strlimcpy(gtop->prev_name, name, sizeof(gtop->prev_name));
+	gtop->prev_result = 0;
+	if (!dbop_absent(gtop->gtags, name)) {
+		cmp = -1;
+		if (gtop->gtags_cursor) {
+			for (n = 0; gtop->gtags_key != NULL && n < MERGE_STEPS; n++) {
+				if ((cmp = strcmp(gtop->gtags_key, name)) >= 0)
+					break;
+				gtop->gtags_key = dbop_next(gtop->gtags);
+			}
+			if (gtop->gtags_key == NULL)
+				cmp = 1;
+		}
+		if (cmp < 0) {
+			gtop->gtags_key = dbop_first(gtop->gtags, name, NULL, DBOP_KEY|DBOP_SEEK);
+			gtop->gtags_cursor = 1;
+			cmp = gtop->gtags_key ? strcmp(gtop->gtags_key, name) : 1;
+		}
+		gtop->prev_result = (cmp == 0);
+	}
+	/*
+	 * The tag may be defined in another shard.
+	 */
+	if (!gtop->prev_result && gtop->shards)
+		gtop->prev_result = shard_defined(gtop->shards, name);
+	return gtop->prev_result;
 }
 /**
  * dbname: return db name
@@ -318,7 +448,9 @@ dbname(int db)
  *	@param[in]	mode	#GTAGS_READ: read only <br>
  *			#GTAGS_CREATE: create tag <br>
  *			#GTAGS_MODIFY: modify tag
- *	@param[in]	flags	#GTAGS_COMPACT: compact format
+ *	@param[in]	flags	#GTAGS_COMPACT: compact format <br>
+ *			#GTAGS_TRIGRAM: make or update the trigram index <br>
+ *			#GTAGS_FOLD: make or update the case-folded key index
  *	@return		#GTOP structure
  *
  * @note when error occurred, @NAME{gtags_open()} doesn't return.
@@ -327,8 +459,9 @@ GTOP *
 gtags_open(const char *dbpath, const char *root, int db, int mode, int flags)
 {
 	GTOP *gtop;
-	char tagfile[MAXPATHLEN];
-	int dbmode;
+	char tagfile[MAXPATHLEN], path[MAXPATHLEN];
+	unsigned long gen = 0;
+	int dbmode, dbflags, retry;
 
 	gtop = (GTOP *)check_calloc(sizeof(GTOP), 1);
 	gtop->db = db;
@@ -358,19 +491,60 @@ gtags_open(const char *dbpath, const char *root, int db, int mode, int flags)
 	 * GSYMS:	tags which belongs to GRTAGS, and is not defined in GTAGS.
 	 */
 	strlimcpy(tagfile, makepath(dbpath, dbname(db == GSYMS ? GRTAGS : db), NULL), sizeof(tagfile));
-	gtop->dbop = dbop_open(tagfile, dbmode, 0644, DBOP_DUP|DBOP_SORTED_WRITE);
-	if (gtop->dbop == NULL) {
-		if (dbmode == 1)
-			die("cannot make %s.", dbname(db));
-		die("%s not found.", dbname(db));
+	/*
+	 * The key filter of GTAGS is made whenever the tag file is written.
+	 * The trigram index and the case-folded key index are used whenever
+	 * they exist, but are made or updated only if requested (see
+	 * #GTAGS_TRIGRAM and #GTAGS_FOLD); otherwise they are removed with
+	 * the replacement of the tag file, since they would be out of date.
+	 */
+	dbflags = DBOP_DUP|DBOP_SORTED_WRITE|(db == GTAGS ? DBOP_BLOOM : 0);
+	if (dbmode == 0 || flags & GTAGS_TRIGRAM)
+		dbflags |= DBOP_TRIGRAM;
+	else if (snprintf(path, sizeof(path), "%s%s", tagfile, TRIGRAM_SUFFIX) < sizeof(path))
+		dbop_remove(path);
+	if (dbmode == 0 || flags & GTAGS_FOLD)
+		dbflags |= DBOP_FOLD;
+	else if (snprintf(path, sizeof(path), "%s%s", tagfile, DBOP_FOLD_SUFFIX) < sizeof(path))
+		dbop_remove(path);
+	/*
+	 * A reader opens the tag files of the same generation. If they are
+	 * replaced by gtags(1) while being opened, they are opened again.
+	 * See dbop_publish().
+	 */
+	for (retry = 0; ; retry++) {
+		if (gtop->mode == GTAGS_READ)
+			gen = dbop_generation(dbpath);
+		gtop->dbop = dbop_open(tagfile, dbmode, 0644, dbflags);
+		if (gtop->dbop == NULL) {
+			if (dbmode == 1)
+				die("cannot make %s.", dbname(db));
+			die("%s not found.", dbname(db));
+		}
+		if (gtop->mode == GTAGS_READ && db != GTAGS) {
+			gtop->gtags = dbop_open(makepath(dbpath, dbname(GTAGS), NULL), 0, 0, DBOP_BLOOM);
+			if (gtop->gtags == NULL)
+				die("GTAGS not found.");
+		}
+		if (gpath_open(dbpath, dbmode) < 0) {
+			if (dbmode == 1)
+				die("cannot create GPATH.");
+			else
+				die("GPATH not found.");
+		}
+		if (gtop->mode != GTAGS_READ || retry >= OPEN_RETRY || dbop_generation(dbpath) == gen)
+			break;
+		dbop_close(gtop->dbop);
+		if (gtop->gtags) {
+			dbop_close(gtop->gtags);
+			gtop->gtags = NULL;
+		}
+		gpath_close();
 	}
-	if (gtop->mode == GTAGS_READ && db != GTAGS) {
+	if (gtop->gtags) {
 		const char *gtags = makepath(dbpath, dbname(GTAGS), NULL);
 		int format_version;
 
-		gtop->gtags = dbop_open(gtags, 0, 0, 0);
-		if (gtop->gtags == NULL)
-			die("GTAGS not found.");
 		format_version = dbop_getversion(gtop->dbop);
 		if (format_version > upper_bound_version)
 			die("%s seems new format. Please install the latest GLOBAL.", gtags);
@@ -393,6 +567,7 @@ gtags_open(const char *dbpath, const char *root, int db, int mode, int flags)
 		} else {
 			/* standard format */
 			gtop->format |= GTAGS_COMPRESS;
+			gtop->format |= GTAGS_BINARY;
 		}
 		gtop->format |= GTAGS_COMPNAME;
 		if (gtop->format & GTAGS_COMPACT)
@@ -405,6 +580,10 @@ gtags_open(const char *dbpath, const char *root, int db, int mode, int flags)
 			dbop_putoption(gtop->dbop, COMPLINEKEY, NULL);
 		if (gtop->format & GTAGS_COMPNAME)
 			dbop_putoption(gtop->dbop, COMPNAMEKEY, NULL);
+		if (gtop->format & GTAGS_BINARY)
+			dbop_putoption(gtop->dbop, BINARYKEY, NULL);
+		gtop->format |= GTAGS_FILEINDEX;
+		dbop_putoption(gtop->dbop, FILEINDEXKEY, NULL);
 		dbop_putversion(gtop->dbop, gtop->format_version); 
 	} else {
 		/*
@@ -433,15 +612,27 @@ gtags_open(const char *dbpath, const char *root, int db, int mode, int flags)
 			gtop->format |= GTAGS_COMPLINE;
 		if (dbop_getoption(gtop->dbop, COMPNAMEKEY) != NULL)
 			gtop->format |= GTAGS_COMPNAME;
-	}
-	if (gpath_open(dbpath, dbmode) < 0) {
-		if (dbmode == 1)
-			die("cannot create GPATH.");
-		else
-			die("GPATH not found.");
+		if (dbop_getoption(gtop->dbop, FILEINDEXKEY) != NULL)
+			gtop->format |= GTAGS_FILEINDEX;
+		if (dbop_getoption(gtop->dbop, BINARYKEY) != NULL)
+			gtop->format |= GTAGS_BINARY;
 	}
 	if (gtop->mode != GTAGS_READ)
 		gtop->sb = strbuf_open(0);	/* This buffer is used for working area. */
+	if (gtop->mode != GTAGS_READ && gtop->format & GTAGS_FILEINDEX)
+		gtop->key_hash = strhash_open(HASHBUCKETS);
+	/*
+	 * The pool has the tags (compact format) and the names of the file
+	 * index of the current file.
+	 */
+	if (gtop->mode != GTAGS_READ) {
+		gtop->pool_size = 0;
+		gtop->pool_limit = GTAGSPOOLBUF;
+		if (getenv("GTAGSPOOLBUF") != NULL)
+			gtop->pool_limit = atol(getenv("GTAGSPOOLBUF"));
+		if (gtop->pool_limit < GTAGSMINPOOLBUF)
+			gtop->pool_limit = GTAGSMINPOOLBUF;
+	}
 	/*
 	 * Stuff for compact format.
 	 */
@@ -469,6 +660,8 @@ gtags_put_using(GTOP *gtop, const char *tag, int lno, const char *fid, const cha
 
 	if (gtop->format & GTAGS_COMPACT) {
 		struct sh_entry *entry;
+		VARRAY *vb;
+		int alloced;
 
 		/*
 		 * Register each record into the pool.
@@ -482,9 +675,19 @@ gtags_put_using(GTOP *gtop, const char *tag, int lno, const char *fid, const cha
 		 * ...
 		 */
 		entry = strhash_assign(gtop->path_hash, tag, 1);
-		if (entry->value == NULL)
+		if (entry->value == NULL) {
 			entry->value = varray_open(sizeof(int), 100);
-		*(int *)varray_append((VARRAY *)entry->value) = lno;
+			gtop->pool_size += sizeof(struct sh_entry) + sizeof(VARRAY) + strlen(tag) + 1;
+		}
+		vb = (VARRAY *)entry->value;
+		alloced = vb->alloced;
+		*(int *)varray_append(vb) = lno;
+		gtop->pool_size += (vb->alloced - alloced) * sizeof(int);
+		/*
+		 * A huge file may have too many tags to keep in memory.
+		 */
+		if (gtop->pool_size > gtop->pool_limit)
+			spill_pool(gtop);
 		return;
 	}
 	/*
@@ -506,20 +709,42 @@ gtags_put_using(GTOP *gtop, const char *tag, int lno, const char *fid, const cha
 		key = tag;
 	}
 	strbuf_reset(gtop->sb);
-	strbuf_puts(gtop->sb, fid);
-	strbuf_putc(gtop->sb, ' ');
-	strbuf_puts(gtop->sb, (gtop->format & GTAGS_COMPNAME) ? compress(tag, key) : tag);
-	strbuf_putc(gtop->sb, ' ');
-	strbuf_putn(gtop->sb, lno);
-	strbuf_putc(gtop->sb, ' ');
-	strbuf_puts(gtop->sb, (gtop->format & GTAGS_COMPRESS) ? compress(img, key) : img);
+	if (gtop->format & GTAGS_BINARY) {
+		const char *p;
+
+		put_number(gtop->sb, atoi(fid));
+		put_number(gtop->sb, lno);
+		/*
+		 * compress() returns a static buffer, so each item is put
+		 * before the next one is compressed.
+		 */
+		p = (gtop->format & GTAGS_COMPNAME) ? compress(tag, key) : tag;
+		put_number(gtop->sb, strlen(p));
+		strbuf_puts(gtop->sb, p);
+		p = (gtop->format & GTAGS_COMPRESS) ? compress(img, key) : img;
+		put_number(gtop->sb, strlen(p));
+		strbuf_puts(gtop->sb, p);
+	} else {
+		strbuf_puts(gtop->sb, fid);
+		strbuf_putc(gtop->sb, ' ');
+		strbuf_puts(gtop->sb, (gtop->format & GTAGS_COMPNAME) ? compress(tag, key) : tag);
+		strbuf_putc(gtop->sb, ' ');
+		strbuf_putn(gtop->sb, lno);
+		strbuf_putc(gtop->sb, ' ');
+		strbuf_puts(gtop->sb, (gtop->format & GTAGS_COMPRESS) ? compress(img, key) : img);
+	}
 	dbop_put(gtop->dbop, key, strbuf_value(gtop->sb));
+	if (gtop->key_hash)
+		put_key(gtop, key);
 }
 /**
- * gtags_flush: Flush the pool for compact format.
+ * gtags_flush: Flush the pool for compact format, and write the file index.
  *
  *	@param[in]	gtop	descripter of #GTOP
  *	@param[in]	fid	file id
+ *
+ * This function must be called after the records of each file,
+ * even if the file has no tags.
  */
 void
 gtags_flush(GTOP *gtop, const char *fid)
@@ -528,6 +753,8 @@ gtags_flush(GTOP *gtop, const char *fid)
 		flush_pool(gtop, fid);
 		strhash_reset(gtop->path_hash);
 	}
+	if (gtop->key_hash)
+		put_fileindex(gtop, fid);
 }
 /**
  * gtags_delete: delete records belong to set of fid.
@@ -539,19 +766,119 @@ void
 gtags_delete(GTOP *gtop, IDSET *deleteset)
 {
 	const char *tagline;
-	int fid;
+	GTREC rec;
 
+	/*
+	 * If the tag file has the file index, only the records which
+	 * belong to the files are read.
+	 */
+	if (gtop->format & GTAGS_FILEINDEX && delete_by_fileindex(gtop, deleteset) == 0)
+		return;
 	for (tagline = dbop_first(gtop->dbop, NULL, NULL, 0); tagline; tagline = dbop_next(gtop->dbop)) {
 		/*
 		 * Extract path from the tag line.
 		 */
-		fid = atoi(tagline);
+		gtags_decode(tagline, gtop->dbop->lastsize, gtop->format, &rec);
 		/*
 		 * If the file id exists in the deleteset, delete the tagline.
 		 */
-		if (idset_contains(deleteset, fid))
+		if (idset_contains(deleteset, rec.fid))
 			dbop_delete(gtop->dbop, NULL);
 	}
+	if (gtop->format & GTAGS_FILEINDEX) {
+		unsigned int id;
+
+		for (id = idset_first(deleteset); id != END_OF_ID; id = idset_next(deleteset))
+			delete_fileindex(gtop, id);
+	}
+}
+/**
+ * gtags_decode: get the fields of a tag record.
+ *
+ *	@param[in]	tagline	tag record
+ *	@param[in]	size	size of the record including the terminating NUL
+ *			(@CODE{dbop->lastsize})
+ *	@param[in]	format	format of the tag file (@CODE{gtop->format})
+ *	@param[out]	rec	fields of the record
+ *
+ * The fields point into @a tagline. The tag name is not terminated, and
+ * the line image is the rest of the record. In compact format, the line
+ * number is the first one and the line image is empty. <br>
+ * A binary record (#GTAGS_BINARY) is decoded without searching for separators.
+ * Every length in it is checked against @a size before it is used, and
+ * a broken record is fatal.
+ */
+void
+gtags_decode(const char *tagline, int size, int format, GTREC *rec)
+{
+	if (format & GTAGS_BINARY) {
+		const unsigned char *p = (const unsigned char *)tagline;
+		const unsigned char *end = p + size - 1;	/* the terminating NUL */
+		unsigned int n;
+
+		if (size < 1 || *end != '\0')
+			die("illegal tag record.");
+		p = get_number(p, end, &rec->fid);
+		p = get_number(p, end, &n);
+		rec->lineno = n;
+		p = get_number(p, end, &n);
+		if (n > end - p)
+			die("illegal tag record.");
+		rec->name = (const char *)p;
+		rec->namelen = n;
+		p = get_number(p + n, end, &n);
+		rec->image = (const char *)p;
+		if (n != end - p)
+			die("illegal tag record.");
+	} else {
+		const char *lineno;
+
+		rec->name = seekto(tagline, SEEKTO_TAGNAME);
+		lineno = seekto(tagline, SEEKTO_LINENO);
+		if (rec->name == NULL || lineno == NULL)
+			die("illegal tag record.\n%s", tagline);
+		rec->fid = atoi(tagline);
+		rec->namelen = lineno - rec->name - 1;
+		rec->lineno = atoi(lineno);
+		if ((rec->image = seekto(tagline, SEEKTO_IMAGE)) == NULL)
+			rec->image = "";
+	}
+}
+/**
+ * literal_prefix: get the literal prefix of a regular expression.
+ *
+ *	@param[in]	pattern	regular expression
+ *	@param[out]	prefix	prefix (#IDENTLEN bytes)
+ *	@param[in]	ascii	1: the prefix ends before a non-ASCII character
+ *	@param[out]	exact	1: the pattern is '^' + prefix + '$'
+ *	@return		length of the prefix (0: no prefix)
+ *
+ * The prefix is the literal characters following '^' at the head. A character
+ * followed by a quantifier which allows zero is not included, nor is any if
+ * the pattern has an alternation.
+ */
+static int
+literal_prefix(const char *pattern, char *prefix, int ascii, int *exact)
+{
+	const unsigned char *p = (const unsigned char *)pattern + 1;
+	int i = 0;
+
+	*exact = 0;
+	if (*pattern != '^' || strchr(pattern, '|'))
+		return 0;
+	while (*p && !isregexchar(*p) && !(ascii && *p >= 0x80) && i < IDENTLEN - 1)
+		prefix[i++] = *p++;
+	if (*p == '*' || *p == '?' || *p == '{' || (*p == '\\' && (p[1] == '{' || p[1] == '?'))) {
+		/* the last character may be absent (with the continuation bytes of UTF-8) */
+		while (i > 0 && (prefix[i - 1] & 0xc0) == 0x80)
+			i--;
+		if (i > 0)
+			i--;
+	} else if (*p == '$' && p[1] == '\0') {
+		*exact = 1;
+	}
+	prefix[i] = '\0';
+	return i;
 }
 /**
  * gtags_first: return first record
@@ -606,6 +933,13 @@ gtags_first(GTOP *gtop, const char *pattern, int flags)
 	if (flags & GTOP_NOREGEX) {
 		key = pattern;
 		preg = NULL;
+		/*
+		 * Read the keys which are equal to (or start with) the pattern
+		 * ignoring case.
+		 */
+		if (flags & GTOP_IGNORECASE && pattern != NULL
+		    && dbop_fold(gtop->dbop, pattern, (flags & GTOP_PREFIX) ? 1 : 0))
+			key = NULL;
 	} else if (pattern == NULL || !strcmp(pattern, ".*")) {
 		/*
 		 * Since the regular expression '.*' matches to any record,
@@ -614,22 +948,28 @@ gtags_first(GTOP *gtop, const char *pattern, int flags)
 		key = NULL;
 		preg = NULL;
 	} else if (isregex(pattern) && regcomp(preg, pattern, regflags) == 0) {
-		const char *p;
+		int exact;
 		/*
 		 * If the pattern include '^' + some non regular expression
 		 * characters like '^aaa[0-9]', we take prefix read method
 		 * with the non regular expression part as the prefix.
+		 * Ignoring case, the keys which start with the prefix in
+		 * any case are read.
 		 */
-		if (!(flags & GTOP_IGNORECASE) && *pattern == '^' && *(p = pattern + 1) && !isregexchar(*p)) {
-			int i = 0;
-
-			while (*p && !isregexchar(*p) && i < IDENTLEN)
-				prefix[i++] = *p++;
-			prefix[i] = '\0';
-			key = prefix;
-			dbflags |= DBOP_PREFIX;
+		if (literal_prefix(pattern, prefix, (flags & GTOP_IGNORECASE) ? 1 : 0, &exact) > 0) {
+			if (flags & GTOP_IGNORECASE) {
+				key = NULL;
+				(void)dbop_fold(gtop->dbop, prefix, exact ? 0 : 1);
+			} else {
+				key = prefix;
+				dbflags |= DBOP_PREFIX;
+			}
 		} else {
 			key = NULL;
+			/*
+			 * Read only the keys which may match the pattern.
+			 */
+			(void)dbop_narrow(gtop->dbop, pattern, regflags);
 		}
 	} else {
 		key = pattern;
@@ -641,9 +981,10 @@ gtags_first(GTOP *gtop, const char *pattern, int flags)
 	 */
 	if (gtop->flags & GTOP_PATH) {
 		struct sh_entry *entry;
-		char *p;
+		char fid[MAXFIDLEN];
 		const char *cp;
 		unsigned long i;
+		GTREC rec;
 
 		gtop->path_hash = strhash_open(HASHBUCKETS);
 		/*
@@ -661,16 +1002,14 @@ gtags_first(GTOP *gtop, const char *pattern, int flags)
 		{
 			VIRTUAL_GRTAGS_GSYMS_PROCESSING(gtop);
 			/* extract file id */
-			p = locatestring(tagline, " ", MATCH_FIRST);
-			if (p == NULL)
-				die("Illegal tag record. '%s'\n", tagline);
-			*p = '\0';
-			entry = strhash_assign(gtop->path_hash, tagline, 1);
+			gtags_decode(tagline, gtop->dbop->lastsize, gtop->format, &rec);
+			snprintf(fid, sizeof(fid), "%u", rec.fid);
+			entry = strhash_assign(gtop->path_hash, fid, 1);
 			/* new entry: get path name and set. */
 			if (entry->value == NULL) {
-				cp = gpath_fid2path(tagline, NULL);
+				cp = gpath_fid2path(fid, NULL);
 				if (cp == NULL)
-					die("GPATH is corrupted.(file id '%s' not found)", tagline);
+					die("GPATH is corrupted.(file id '%s' not found)", fid);
 				entry->value = strhash_strdup(gtop->path_hash, cp, 0);
 			}
 		}
@@ -786,6 +1125,10 @@ gtags_close(GTOP *gtop)
 		abbrev_close();
 	if (gtop->format & GTAGS_COMPACT && gtop->cur_path[0])
 		flush_pool(gtop, NULL);
+	if (gtop->spill)
+		extsort_close(gtop->spill);
+	if (gtop->key_spill)
+		extsort_close(gtop->key_spill);
 	if (gtop->segment_pool)
 		pool_close(gtop->segment_pool);
 	if (gtop->path_array)
@@ -796,6 +1139,8 @@ gtags_close(GTOP *gtop)
 		varray_close(gtop->vb);
 	if (gtop->path_hash)
 		strhash_close(gtop->path_hash);
+	if (gtop->key_hash)
+		strhash_close(gtop->key_hash);
 	gpath_close();
 	dbop_close(gtop->dbop);
 	if (gtop->gtags)
@@ -807,130 +1152,387 @@ gtags_close(GTOP *gtop)
  *
  *	@param[in]	gtop	descripter of #GTOP
  *	@param[in]	s_fid
+ *
+ * If a part of the pool has been spilled (see spill_pool()), the rest is
+ * spilled too, and the line numbers of each tag are gathered from the
+ * sorted runs. The records are the same as those made from the pool.
  */
 static void
 flush_pool(GTOP *gtop, const char *s_fid)
 {
 	struct sh_entry *entry;
-	int header_offset;
-	int i, last;
 
 	if (s_fid == NULL && (s_fid = gpath_path2fid(gtop->cur_path, NULL)) == NULL)
 		die("GPATH is corrupted.('%s' not found)", gtop->cur_path);
+	if (gtop->spill) {
+		EXTSORT *es;
+		STRBUF *name = strbuf_open(0);
+		VARRAY *vb = varray_open(sizeof(int), 100);
+		const char *tag, *data;
+		int len;
+
+		spill_pool(gtop);
+		es = gtop->spill;
+		gtop->spill = NULL;
+		while ((tag = extsort_get(es, &data, &len)) != NULL) {
+			int n = len / sizeof(int);
+
+			if (vb->length > 0 && strcmp(tag, strbuf_value(name))) {
+				put_compact(gtop, strbuf_value(name), vb, s_fid);
+				vb->length = 0;
+			}
+			if (vb->length == 0) {
+				strbuf_reset(name);
+				strbuf_puts(name, tag);
+			}
+			if (n > 0) {
+				int length = vb->length;
+
+				varray_assign(vb, length + n - 1, 1);
+				memcpy(vb->vbuf + length * sizeof(int), data, n * sizeof(int));
+			}
+		}
+		if (vb->length > 0)
+			put_compact(gtop, strbuf_value(name), vb, s_fid);
+		varray_close(vb);
+		strbuf_close(name);
+		extsort_close(es);
+		return;
+	}
 	/*
 	 * Write records as compact format and free line number table
 	 * for each entry in the pool.
 	 */
+	for (entry = strhash_first(gtop->path_hash); entry; entry = strhash_next(gtop->path_hash)) {
+		put_compact(gtop, entry->name, (VARRAY *)entry->value, s_fid);
+		/* Free line number table */
+		varray_close((VARRAY *)entry->value);
+	}
+	gtop->pool_size = gtop->key_size;
+}
+/**
+ * spill_pool: move the pool to the sorted runs.
+ *
+ *	@param[in]	gtop	descripter of #GTOP
+ *
+ * The line numbers of a tag are written as the data of a record whose key
+ * is the tag name. A tag may have several records, since the pool is spilled
+ * whenever it exceeds the limit.
+ */
+static void
+spill_pool(GTOP *gtop)
+{
+	struct sh_entry *entry;
+
+	if (gtop->spill == NULL)
+		gtop->spill = extsort_open(gtop->pool_limit);
 	for (entry = strhash_first(gtop->path_hash); entry; entry = strhash_next(gtop->path_hash)) {
 		VARRAY *vb = (VARRAY *)entry->value;
-		int *lno_array = varray_assign(vb, 0, 0);
-		const char *key = entry->name;
 
-		/*
-		 * extract method when class method definition.
-		 *
-		 * Ex: Class::method(...)
-		 *
-		 * key	= 'method'
-		 * data = 'Class::method  103 ./class.cpp ...'
-		 */
-		if (gtop->flags & GTAGS_EXTRACTMETHOD) {
-			if ((key = locatestring(entry->name, ".", MATCH_LAST)) != NULL)
-				key++;
-			else if ((key = locatestring(entry->name, "::", MATCH_LAST)) != NULL)
-				key += 2;
-			else
-				key = entry->name;
-		}
-		/* Sort line number table */
-		qsort(lno_array, vb->length, sizeof(int), compare_lineno); 
+		extsort_put(gtop->spill, entry->name, vb->vbuf, vb->length * sizeof(int));
+		varray_close(vb);
+	}
+	strhash_reset(gtop->path_hash);
+	gtop->pool_size = gtop->key_size;
+}
+/**
+ * put_compact: write the records of a tag in compact format.
+ *
+ *	@param[in]	gtop	descripter of #GTOP
+ *	@param[in]	name	tag name
+ *	@param[in]	vb	line numbers, which are sorted in place
+ *	@param[in]	s_fid	file id
+ */
+static void
+put_compact(GTOP *gtop, const char *name, VARRAY *vb, const char *s_fid)
+{
+	int *lno_array = varray_assign(vb, 0, 0);
+	const char *key = name;
+	int header_offset;
+	int i, last;
 
-		strbuf_reset(gtop->sb);
-		strbuf_puts(gtop->sb, s_fid);
-		strbuf_putc(gtop->sb, ' ');
-		if (gtop->format & GTAGS_COMPNAME) {
-			strbuf_puts(gtop->sb, compress(entry->name, key));
-		} else {
-			strbuf_puts(gtop->sb, entry->name);
-		}
-		strbuf_putc(gtop->sb, ' ');
-		header_offset = strbuf_getlen(gtop->sb);
-		/*
-		 * If GTAGS_COMPLINE flag is set, each line number is expressed as the
-		 * difference from the previous line number except for the head.
-		 * GTAGS_COMPLINE is set by default in format version 5.
-		 */
-		if (gtop->format & GTAGS_COMPLINE) {
-			int cont = 0;
-
-			last = 0;			/* line 0 doesn't exist */
-			for (i = 0; i < vb->length; i++) {
-				int n = lno_array[i];
-
-				if (n == last)
-					continue;
-				if (last > 0 && n == last + 1) {
-					if (!cont) {
-						/*
-						 * Don't use range expression at the head.
-						 */
-						if (strbuf_getlen(gtop->sb) == header_offset)
-							strbuf_putn(gtop->sb, n);
-						else
-							cont = last;
-					}
-				} else {
+	/*
+	 * extract method when class method definition.
+	 *
+	 * Ex: Class::method(...)
+	 *
+	 * key	= 'method'
+	 * data = 'Class::method  103 ./class.cpp ...'
+	 */
+	if (gtop->flags & GTAGS_EXTRACTMETHOD) {
+		if ((key = locatestring(name, ".", MATCH_LAST)) != NULL)
+			key++;
+		else if ((key = locatestring(name, "::", MATCH_LAST)) != NULL)
+			key += 2;
+		else
+			key = name;
+	}
+	/* Sort line number table */
+	qsort(lno_array, vb->length, sizeof(int), compare_lineno); 
+
+	strbuf_reset(gtop->sb);
+	strbuf_puts(gtop->sb, s_fid);
+	strbuf_putc(gtop->sb, ' ');
+	if (gtop->format & GTAGS_COMPNAME) {
+		strbuf_puts(gtop->sb, compress(name, key));
+	} else {
+		strbuf_puts(gtop->sb, name);
+	}
+	strbuf_putc(gtop->sb, ' ');
+	header_offset = strbuf_getlen(gtop->sb);
+	/*
+	 * If GTAGS_COMPLINE flag is set, each line number is expressed as the
+	 * difference from the previous line number except for the head.
+	 * GTAGS_COMPLINE is set by default in format version 5.
+	 */
+	if (gtop->format & GTAGS_COMPLINE) {
+		int cont = 0;
+
+		last = 0;			/* line 0 doesn't exist */
+		for (i = 0; i < vb->length; i++) {
+			int n = lno_array[i];
+
+			if (n == last)
+				continue;
+			if (last > 0 && n == last + 1) {
+				if (!cont) {
 					/*
-					 * Range expression. ex: 10-2 means 10 11 12
+					 * Don't use range expression at the head.
 					 */
-					if (cont) {
-						strbuf_putc(gtop->sb, '-');
-						strbuf_putn(gtop->sb, last - cont);
-						cont = 0;
-					}
-					if (strbuf_getlen(gtop->sb) > header_offset) {
-						strbuf_putc(gtop->sb, ',');
-						strbuf_putn(gtop->sb, n - last);
-					} else {
+					if (strbuf_getlen(gtop->sb) == header_offset)
 						strbuf_putn(gtop->sb, n);
-					}
-					if (strbuf_getlen(gtop->sb) > DBOP_PAGESIZE / 4) {
-						dbop_put(gtop->dbop, key, strbuf_value(gtop->sb));
-						strbuf_setlen(gtop->sb, header_offset);
-					}
+					else
+						cont = last;
 				}
-				last = n;
-			}
-			if (cont) {
-				strbuf_putc(gtop->sb, '-');
-				strbuf_putn(gtop->sb, last - cont);
-			}
-		} else {
-			/*
-			 * This code is to support older format (version 4).
-			 */
-			last = 0;			/* line 0 doesn't exist */
-			for (i = 0; i < vb->length; i++) {
-				int n = lno_array[i];
-
-				if (n == last)
-					continue;
-				if (strbuf_getlen(gtop->sb) > header_offset)
+			} else {
+				/*
+				 * Range expression. ex: 10-2 means 10 11 12
+				 */
+				if (cont) {
+					strbuf_putc(gtop->sb, '-');
+					strbuf_putn(gtop->sb, last - cont);
+					cont = 0;
+				}
+				if (strbuf_getlen(gtop->sb) > header_offset) {
 					strbuf_putc(gtop->sb, ',');
-				strbuf_putn(gtop->sb, n);
+					strbuf_putn(gtop->sb, n - last);
+				} else {
+					strbuf_putn(gtop->sb, n);
+				}
 				if (strbuf_getlen(gtop->sb) > DBOP_PAGESIZE / 4) {
 					dbop_put(gtop->dbop, key, strbuf_value(gtop->sb));
 					strbuf_setlen(gtop->sb, header_offset);
 				}
-				last = n;
 			}
+			last = n;
 		}
-		if (strbuf_getlen(gtop->sb) > header_offset) {
-			dbop_put(gtop->dbop, key, strbuf_value(gtop->sb));
+		if (cont) {
+			strbuf_putc(gtop->sb, '-');
+			strbuf_putn(gtop->sb, last - cont);
 		}
-		/* Free line number table */
-		varray_close(vb);
+	} else {
+		/*
+		 * This code is to support older format (version 4).
+		 */
+		last = 0;			/* line 0 doesn't exist */
+		for (i = 0; i < vb->length; i++) {
+			int n = lno_array[i];
+
+			if (n == last)
+				continue;
+			if (strbuf_getlen(gtop->sb) > header_offset)
+				strbuf_putc(gtop->sb, ',');
+			strbuf_putn(gtop->sb, n);
+			if (strbuf_getlen(gtop->sb) > DBOP_PAGESIZE / 4) {
+				dbop_put(gtop->dbop, key, strbuf_value(gtop->sb));
+				strbuf_setlen(gtop->sb, header_offset);
+			}
+			last = n;
+		}
+	}
+	if (strbuf_getlen(gtop->sb) > header_offset) {
+		dbop_put(gtop->dbop, key, strbuf_value(gtop->sb));
+	}
+	if (gtop->key_hash)
+		put_key(gtop, key);
+}
+/**
+ * put_key: register a tag name of the current file for the file index.
+ *
+ *	@param[in]	gtop	descripter of #GTOP
+ *	@param[in]	key	tag name
+ *
+ * The names are counted in the pool, and spilled with spill_keys()
+ * if the pool exceeds the limit.
+ */
+static void
+put_key(GTOP *gtop, const char *key)
+{
+	unsigned long entries = gtop->key_hash->entries;
+	unsigned long size;
+
+	strhash_assign(gtop->key_hash, key, 1);
+	if (gtop->key_hash->entries == entries)		/* already registered */
+		return;
+	size = sizeof(struct sh_entry) + strlen(key) + 1;
+	gtop->key_size += size;
+	gtop->pool_size += size;
+	if (gtop->pool_size > gtop->pool_limit)
+		spill_keys(gtop);
+}
+/**
+ * spill_keys: move the names of the file index to the sorted runs.
+ *
+ *	@param[in]	gtop	descripter of #GTOP
+ */
+static void
+spill_keys(GTOP *gtop)
+{
+	struct sh_entry *entry;
+
+	if (gtop->key_spill == NULL)
+		gtop->key_spill = extsort_open(gtop->pool_limit);
+	for (entry = strhash_first(gtop->key_hash); entry; entry = strhash_next(gtop->key_hash))
+		extsort_put(gtop->key_spill, entry->name, "", 0);
+	strhash_reset(gtop->key_hash);
+	gtop->pool_size -= gtop->key_size;
+	gtop->key_size = 0;
+}
+/**
+ * put_fileindex: write the file index of a file.
+ *
+ *	@param[in]	gtop	descripter of #GTOP
+ *	@param[in]	fid	file id
+ *
+ * The file index has a record for each tag name of the file:
+ *
+ * @code{.txt}
+ *	key:	" __.KEYS.<fid>"
+ *	data:	<tag name>
+ * @endcode
+ *
+ * A file without tags has a record with an empty name, so that it is
+ * known to be in the index.
+ * The names are taken from @CODE{gtop->key_hash}, which is cleared.
+ * They are written in sorted order, so that the index does not depend on
+ * the order in which the tags were written. If some of them have been spilled
+ * (see spill_keys()), the rest are spilled too, and the names are read from
+ * the sorted runs.
+ */
+static void
+put_fileindex(GTOP *gtop, const char *fid)
+{
+	struct sh_entry *entry;
+	char key[MAXKEYLEN];
+	unsigned long count = 0;
+
+	snprintf(key, sizeof(key), "%s%s", FILEKEYSKEY, fid);
+	if (gtop->key_spill) {
+		EXTSORT *es;
+		STRBUF *prev = strbuf_open(0);
+		const char *name, *data;
+		int len;
+
+		spill_keys(gtop);
+		es = gtop->key_spill;
+		gtop->key_spill = NULL;
+		while ((name = extsort_get(es, &data, &len)) != NULL) {
+			/* a name may be spilled several times */
+			if (strbuf_getlen(prev) > 0 && !strcmp(name, strbuf_value(prev)))
+				continue;
+			dbop_put(gtop->dbop, key, name);
+			count++;
+			strbuf_reset(prev);
+			strbuf_puts(prev, name);
+		}
+		strbuf_close(prev);
+		extsort_close(es);
+	} else {
+		char **names;
+		unsigned long i;
+
+		names = (char **)check_malloc((gtop->key_hash->entries + 1) * sizeof(char *));
+		for (entry = strhash_first(gtop->key_hash); entry; entry = strhash_next(gtop->key_hash))
+			names[count++] = entry->name;
+		qsort(names, count, sizeof(char *), compare_path);
+		for (i = 0; i < count; i++)
+			dbop_put(gtop->dbop, key, names[i]);
+		free(names);
+		strhash_reset(gtop->key_hash);
+		gtop->pool_size -= gtop->key_size;
+		gtop->key_size = 0;
 	}
+	if (count == 0)
+		dbop_put(gtop->dbop, key, "");
+}
+/**
+ * delete_by_fileindex: delete records belong to set of fid using the file index.
+ *
+ *	@param[in]	gtop	#GTOP structure
+ *	@param[in]	deleteset bit array of fid
+ *	@return		0: deleted, -1: some files are not in the index
+ *
+ * Only the records whose key is listed in the file index are read.
+ * If a file is not in the index, nothing is deleted, and the caller should
+ * read the whole tag file. This happens when the file was added by an older
+ * version of @NAME{gtags}.
+ */
+static int
+delete_by_fileindex(GTOP *gtop, IDSET *deleteset)
+{
+	STRHASH *names = strhash_open(HASHBUCKETS);
+	struct sh_entry *entry;
+	char key[MAXKEYLEN];
+	const char *p, *tagline;
+	unsigned int id;
+	GTREC rec;
+
+	/*
+	 * Collect tag names of the files.
+	 */
+	for (id = idset_first(deleteset); id != END_OF_ID; id = idset_next(deleteset)) {
+		snprintf(key, sizeof(key), "%s%u", FILEKEYSKEY, id);
+		if ((p = dbop_first(gtop->dbop, key, NULL, 0)) == NULL) {
+			strhash_close(names);
+			return -1;
+		}
+		for (; p; p = dbop_next(gtop->dbop))
+			if (*p)
+				strhash_assign(names, p, 1);
+	}
+	/*
+	 * Delete the records of the files and their index.
+	 */
+	for (entry = strhash_first(names); entry; entry = strhash_next(names)) {
+		for (tagline = dbop_first(gtop->dbop, entry->name, NULL, 0); tagline; tagline = dbop_next(gtop->dbop)) {
+			gtags_decode(tagline, gtop->dbop->lastsize, gtop->format, &rec);
+			if (idset_contains(deleteset, rec.fid))
+				dbop_delete(gtop->dbop, NULL);
+		}
+	}
+	for (id = idset_first(deleteset); id != END_OF_ID; id = idset_next(deleteset))
+		delete_fileindex(gtop, id);
+	strhash_close(names);
+	return 0;
+}
+/**
+ * delete_fileindex: delete the file index of a file.
+ *
+ *	@param[in]	gtop	#GTOP structure
+ *	@param[in]	id	file id
+ *
+ * The records are deleted one by one with the cursor, since deleting
+ * a key whose duplicates span several pages at once breaks the B-tree.
+ */
+static void
+delete_fileindex(GTOP *gtop, unsigned int id)
+{
+	char key[MAXKEYLEN];
+	const char *p;
+
+	snprintf(key, sizeof(key), "%s%u", FILEKEYSKEY, id);
+	for (p = dbop_first(gtop->dbop, key, NULL, 0); p; p = dbop_next(gtop->dbop))
+		dbop_delete(gtop->dbop, NULL);
 }
 /**
  * Read a tag segment with sorting.
@@ -955,8 +1557,10 @@ flush_pool(GTOP *gtop, const char *s_fid)
 void
 segment_read(GTOP *gtop)
 {
-	const char *tagline, *fid, *path, *lineno;
+	const char *tagline, *path;
+	char fid[MAXFIDLEN];
 	GTP *gtp;
+	GTREC rec;
 	struct sh_entry *sh;
 
 	/*
@@ -985,16 +1589,14 @@ segment_read(GTOP *gtop)
 		/*
 		 * convert fid into hashed path name to save memory.
 		 */
-		fid = (const char *)strmake(tagline, " ");
+		gtags_decode(gtp->tagline, strlen(gtp->tagline) + 1, gtop->format, &rec);
+		snprintf(fid, sizeof(fid), "%u", rec.fid);
 		path = gpath_fid2path(fid, NULL);
 		if (path == NULL)
 			die("gtags_first: path not found. (fid=%s)", fid);
 		sh = strhash_assign(gtop->path_hash, path, 1);
 		gtp->path = sh->name;
-		lineno = seekto(gtp->tagline, SEEKTO_LINENO);
-		if (lineno == NULL)
-			die("illegal tag record.\n%s", tagline);
-		gtp->lineno = atoi(lineno);
+		gtp->lineno = rec.lineno;
 	}
 	/*
 	 * Sort tag lines.
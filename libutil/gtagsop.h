@@ -25,7 +25,9 @@
 
 #include "gparam.h"
 #include "dbop.h"
+#include "extsort.h"
 #include "idset.h"
+#include "shard.h"
 #include "strbuf.h"
 #include "strhash.h"
 #include "varray.h"
@@ -34,6 +36,9 @@
 #define COMPRESSKEY	" __.COMPRESS"
 #define COMPLINEKEY	" __.COMPLINE"
 #define COMPNAMEKEY	" __.COMPNAME"
+#define FILEINDEXKEY	" __.FILEINDEX"
+#define FILEKEYSKEY	" __.KEYS."
+#define BINARYKEY	" __.BINARY"
 
 #define NOTAGS		-1
 #define GPATH		0
@@ -61,6 +66,14 @@
 #define GTAGS_COMPNAME		8
 			/** extract method from class definition */
 #define GTAGS_EXTRACTMETHOD	16
+			/** index from file id to tag names */
+#define GTAGS_FILEINDEX		32
+			/** binary record of standard format (format version 7) */
+#define GTAGS_BINARY		64
+			/** make or update the trigram index */
+#define GTAGS_TRIGRAM		128
+			/** make or update the case-folded key index */
+#define GTAGS_FOLD		256
 			/** print information for debug */
 #define GTAGS_DEBUG		65536
 /** @} */
@@ -96,9 +109,31 @@ typedef struct {
 	int lineno;
 } GTP;
 
+/**
+ * Fields of a tag record (see gtags_decode()).
+ */
+typedef struct {
+	unsigned int fid;		/**< file id */
+	int lineno;			/**< line number (the first one in compact format) */
+	const char *name;		/**< tag name (may be compressed, not terminated) */
+	int namelen;			/**< length of the tag name */
+	const char *image;		/**< line image (may be compressed) */
+} GTREC;
+
 typedef struct {
 	DBOP *dbop;			/**< descripter of #DBOP */
 	DBOP *gtags;			/**< descripter of #GTAGS */
+	SHARDS *shards;			/**< the other shards which may define tags */
+
+	/**
+	 * Stuff for is_defined_in_GTAGS() (merge join with #GTAGS).
+	 */
+	/** @{ */
+	const char *gtags_key;		/**< key at the cursor of #GTAGS (@VAR{NULL}: end) */
+	int gtags_cursor;		/**< the cursor of #GTAGS is placed */
+	char prev_name[IDENTLEN];	/**< the last examined name */
+	int prev_result;		/**< whether or not @CODE{prev_name} is defined */
+	/** @} */
 	int format_version;		/**< format version */
 	int format;			/**< #GTAGS_COMPACT, #GTAGS_COMPRESS */
 	int mode;			/**< mode */
@@ -135,10 +170,17 @@ typedef struct {
 	/** @{ */
 	char cur_path[MAXPATHLEN];	/**< current path */
 	STRBUF *sb;			/**< string buffer */
+	unsigned long pool_size;	/**< memory used by the pool and @CODE{key_hash} */
+	unsigned long pool_limit;	/**< limit of the memory for the pool */
+	EXTSORT *spill;			/**< records spilled from the pool */
 	/** @} */
 
 	/** used for compact format and path name only read */
 	STRHASH *path_hash;
+	/** tag names of the current file (#GTAGS_FILEINDEX) */
+	STRHASH *key_hash;
+	unsigned long key_size;		/**< memory used by @CODE{key_hash} */
+	EXTSORT *key_spill;		/**< tag names spilled from @CODE{key_hash} */
 } GTOP;
 
 const char *dbname(int);
@@ -146,6 +188,7 @@ GTOP *gtags_open(const char *, const char *, int, int, int);
 void gtags_put_using(GTOP *, const char *, int, const char *, const char *);
 void gtags_flush(GTOP *, const char *);
 void gtags_delete(GTOP *, IDSET *);
+void gtags_decode(const char *, int, int, GTREC *);
 GTP *gtags_first(GTOP *, const char *, int);
 GTP *gtags_next(GTOP *);
 void gtags_close(GTOP *);
@@ -21,6 +21,7 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#include <ctype.h>
 #ifdef STDC_HEADERS
 #include <stdlib.h>
 #endif
@@ -30,39 +31,48 @@
 #include <strings.h>
 #endif
 
+#include "checkalloc.h"
 #include "die.h"
-#include "locatestring.h"
+#include "gparam.h"
 #include "strbuf.h"
 #include "langmap.h"
 
-static int match_suffix_list(const char *, const char *);
-
-static STRBUF *active_map;
+static LANGMAP *active_map;
+static char *active_string;		/**< langmap of active_map */
 
 /**
- * construct language map.
+ * langmap_open: compile language map.
  *
- * copy string langmap (@a map) and convert it to language map like this:
+ *	@param[in]	map	langmap (string)
+ *	@param[in]	icase	1: ignore case distinctions in suffixes
+ *	@return		compiled language map
+ *
+ * Each suffix of langmap is hashed to the language name:
  *
  * @code{.txt}
  * langmap (string)	"c:.c.h,java:.java,cpp:.C.H"
  *	|
  *	v
- * language map		c\0.c.h\0java\0.java\0cpp\0.C.H\0
+ * suffix table		".c" => "c", ".h" => "c", ".java" => "java", ...
  * @endcode
+ *
+ * If a suffix appears twice, the first language takes it.
  */
-void
-setup_langmap(const char *map)
+LANGMAP *
+langmap_open(const char *map, int icase)
 {
-	char *p;
+	LANGMAP *lm = (LANGMAP *)check_calloc(sizeof(LANGMAP), 1);
+	STRBUF *sb = strbuf_open(0);
+	char *p, *lang, *list;
 	int onsuffix = 0;		/* not on suffix string */
 
-	active_map = strbuf_open(0);
-	strbuf_puts(active_map, map);
-	for (p = strbuf_value(active_map); *p; p++) {
-		/*
-		 * "c:.c.h,java:.java,cpp:.C.H"
-		 */
+	lm->suffixes = strhash_open(64);
+	lm->icase = icase;
+	/*
+	 * "c:.c.h,java:.java,cpp:.C.H" => "c\0.c.h\0java\0.java\0cpp\0.C.H\0"
+	 */
+	strbuf_puts(sb, map);
+	for (p = strbuf_value(sb); *p; p++) {
 		if ((onsuffix == 0 && *p == ',') || (onsuffix == 1 && *p == ':'))
 			die_with_code(2, "syntax error in langmap '%s'.", map);
 		if (*p == ':' || *p == ',') {
@@ -72,7 +82,95 @@ setup_langmap(const char *map)
 	}
 	if (onsuffix == 0)
 		die_with_code(2, "syntax error in langmap '%s'.", map);
-	/* strbuf_close(active_map); */
+	for (lang = strbuf_value(sb); lang < p; lang = list + strlen(list) + 1) {
+		const char *name = NULL;
+		char *suffix, *next;
+
+		list = lang + strlen(lang) + 1;
+		/*
+		 * The part before the first '.' is not a suffix.
+		 */
+		for (suffix = strchr(list, '.'); suffix != NULL; suffix = next) {
+			struct sh_entry *entry;
+
+			if ((next = strchr(suffix + 1, '.')) != NULL)
+				*next = '\0';
+			if (icase) {
+				char *q;
+				for (q = suffix; *q; q++)
+					*q = tolower((unsigned char)*q);
+			}
+			entry = strhash_assign(lm->suffixes, suffix, 1);
+			if (entry->value == NULL) {
+				if (name == NULL)
+					name = strhash_strdup(lm->suffixes, lang, 0);
+				entry->value = (void *)name;
+			}
+			if (next != NULL)
+				*next = '.';
+		}
+	}
+	strbuf_close(sb);
+	return lm;
+}
+/**
+ * langmap_lookup: decide the language of the @a suffix.
+ *
+ *	@param[in]	lm	compiled language map
+ *	@param[in]	suffix	suffix including the '.'
+ *	@return		language name or NULL
+ */
+const char *
+langmap_lookup(LANGMAP *lm, const char *suffix)
+{
+	struct sh_entry *entry;
+
+	if (lm->icase) {
+		char buf[MAXPATHLEN];
+		int i;
+
+		for (i = 0; suffix[i] && i < sizeof(buf) - 1; i++)
+			buf[i] = tolower((unsigned char)suffix[i]);
+		if (suffix[i])
+			return NULL;
+		buf[i] = '\0';
+		entry = strhash_assign(lm->suffixes, buf, 0);
+	} else {
+		entry = strhash_assign(lm->suffixes, suffix, 0);
+	}
+	return entry ? (const char *)entry->value : NULL;
+}
+/**
+ * langmap_close: free compiled language map.
+ */
+void
+langmap_close(LANGMAP *lm)
+{
+	strhash_close(lm->suffixes);
+	free(lm);
+}
+/**
+ * construct language map.
+ *
+ * The map is shared by the parser and find_read(), so it is not compiled
+ * again for the same @a map.
+ */
+void
+setup_langmap(const char *map)
+{
+	int icase = 0;
+
+#if defined(_WIN32) || defined(__DJGPP__)
+	icase = 1;
+#endif
+	if (active_map) {
+		if (!strcmp(active_string, map))
+			return;
+		langmap_close(active_map);
+		free(active_string);
+	}
+	active_map = langmap_open(map, icase);
+	active_string = check_strdup(map);
 }
 
 /**
@@ -86,8 +184,6 @@ setup_langmap(const char *map)
 const char *
 decide_lang(const char *suffix)
 {
-	const char *lang, *list, *tail;
-
 	/*
 	 * Though '*.h' files are shared by C and C++, GLOBAL treats them
 	 * as C source files by default. If you set an environment variable
@@ -95,39 +191,7 @@ decide_lang(const char *suffix)
 	 */
 	if (!strcmp(suffix, ".h") && getenv("GTAGSFORCECPP") != NULL)
 		return "cpp";
-	lang = strbuf_value(active_map);
-	tail = lang + strbuf_getlen(active_map);
-
-	/* check whether or not list includes suffix. */
-	while (lang < tail) {
-		list = lang + strlen(lang) + 1;
-		if (match_suffix_list(suffix, list))
-			return lang;
-		lang = list + strlen(list) + 1;
-	}
-
-	return NULL;
-}
-
-/**
- * return true if the @a suffix matches with one in the @a list.
- */
-static int
-match_suffix_list(const char *suffix, const char *list)
-{
-	const char *p;
-
-	while (*list) {
-		if ((p = locatestring(list, suffix, MATCH_AT_FIRST
-#if defined(_WIN32) || defined(__DJGPP__)
-							     |IGNORE_CASE
-#endif
-			)) != NULL && (*p == '\0' || *p == '.'))
-			return 1;
-		for (list++; *list && *list != '.'; list++)
-			;
-	}
-	return 0;
+	return langmap_lookup(active_map, suffix);
 }
 
 /**
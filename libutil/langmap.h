@@ -21,11 +21,23 @@
 #define _LANGMAP_H_
 
 #include "strbuf.h"
+#include "strhash.h"
 
 #define DEFAULTLANGMAP  "c:.c.h,yacc:.y,asm:.s.S,java:.java,cpp:.c++.cc.hh.cpp.cxx.hxx.hpp.C.H,php:.php.php3.phtml"
 #define DEFAULTSKIP     "HTML/,HTML.pub/,tags,TAGS,ID,y.tab.c,y.tab.h,cscope.out,cscope.po.out,cscope.in.out,SCCS/,RCS/,CVS/,CVSROOT/,{arch}/,autom4te.cache/"
 #define DEFAULTINCLUDEFILESUFFIXES "h,hh,hxx,hpp,H,inc.php"
 
+/**
+ * compiled language map
+ */
+typedef struct {
+	STRHASH *suffixes;		/**< suffix => language name */
+	int icase;			/**< ignore case distinctions */
+} LANGMAP;
+
+LANGMAP *langmap_open(const char *, int);
+const char *langmap_lookup(LANGMAP *, const char *);
+void langmap_close(LANGMAP *);
 void setup_langmap(const char *);
 const char *decide_lang(const char *);
 void make_suffixes(const char *, STRBUF *);
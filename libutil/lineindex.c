@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "checkalloc.h"
+#include "die.h"
+#include "lineindex.h"
+#include "makepath.h"
+#include "test.h"
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/**
+ @file
+
+ Line offsets of the source files.
+
+ To print the line images of the records of compact format (@NAME{GRTAGS},
+ and @NAME{GTAGS} made with the @OPTION{-c} option), @XREF{global,1} used to
+ read each source file line by line from the head up to the line, and read
+ it again from the head whenever the line numbers went backwards.
+ @XREF{gtags,1} writes the offset of each line of each source file to
+ @FILE{GLINES}, so that only the lines needed are read.
+
+ @code{.txt}
+ [key]		[data]
+ <file id>	<path name>\0<size><mtime><length of line 1><length of line 2>...
+ @endcode
+
+ The numbers are variable length integers: 7 bits in a byte from the lowest,
+ and the highest bit is set except in the last byte. The length of a line
+ includes the newline.
+
+ The path name, the size and the modification time of the file are checked
+ when the offsets are loaded. If the file has been changed since the tag files
+ were made, the offsets are not used and the file should be read as before.
+ Since the time is in seconds, a change in the same second as the offsets
+ were made cannot be detected by it. The offsets of a file modified in the
+ current second are not written, as the status of a file is compared with
+ the contents in the same case (see modified() of @XREF{gtags,1}).
+ */
+
+static void
+put_number(STRBUF *sb, unsigned long n)
+{
+	while (n >= 0x80) {
+		strbuf_putc(sb, (n & 0x7f) | 0x80);
+		n >>= 7;
+	}
+	strbuf_putc(sb, n);
+}
+static const unsigned char *
+get_number(const unsigned char *p, const unsigned char *end, unsigned long *n)
+{
+	unsigned long v = 0;
+	int shift = 0;
+
+	for (; p < end && *p & 0x80; shift += 7)
+		v |= (unsigned long)(*p++ & 0x7f) << shift;
+	if (p >= end)
+		return NULL;
+	v |= (unsigned long)*p++ << shift;
+	*n = v;
+	return p;
+}
+/**
+ * lineindex_open: open the line offsets.
+ *
+ *	@param[in]	dbpath	dbpath directory
+ *	@param[in]	mode	0: read, 1: create, 2: modify
+ *	@return		#LINEINDEX structure, or @VAR{NULL} if @FILE{GLINES} doesn't
+ *			exist in read mode
+ *
+ * In modify mode, @FILE{GLINES} is made if it doesn't exist (tag files made by
+ * an older @XREF{gtags,1}). It has the files updated after that.
+ */
+LINEINDEX *
+lineindex_open(const char *dbpath, int mode)
+{
+	LINEINDEX *li;
+	const char *path = makepath(dbpath, LINEINDEX_NAME, NULL);
+	DBOP *dbop;
+
+	if (mode == 2 && !test("f", path))
+		mode = 1;
+	if ((dbop = dbop_open(path, mode, 0644, 0)) == NULL) {
+		if (mode != 0)
+			die("cannot make %s.", LINEINDEX_NAME);
+		return NULL;
+	}
+	li = (LINEINDEX *)check_calloc(sizeof(LINEINDEX), 1);
+	li->dbop = dbop;
+	li->sb = strbuf_open(0);
+	li->fd = -1;
+	return li;
+}
+/**
+ * lineindex_put: write the line offsets of a source file.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ *	@param[in]	fid	file id
+ *	@param[in]	path	path name of the source file
+ *	@param[out]	st	status of the file, or @VAR{NULL}
+ *	@return		0: normal, -1: the file cannot be read
+ *
+ * Nothing is written if the file cannot be read, or if it was modified in
+ * the current second.
+ * If @a st is not @VAR{NULL}, the size, the modification time, the inode
+ * number and the hash value of the contents are set in it, so that the
+ * file needn't be read again for the hash value (see gpath_hash()).
+ */
+int
+lineindex_put(LINEINDEX *li, const char *fid, const char *path, FILESTAT *st)
+{
+	STRBUF *sb = li->sb;
+	struct stat statp;
+	char buf[8192];
+	unsigned long length = 0;
+	int fd, i, n;
+
+	if ((fd = open(path, O_RDONLY|O_BINARY)) < 0)
+		return -1;
+	if (fstat(fd, &statp) < 0) {
+		close(fd);
+		return -1;
+	}
+	strbuf_reset(sb);
+	strbuf_puts0(sb, path);
+	put_number(sb, statp.st_size);
+	put_number(sb, statp.st_mtime);
+	if (st) {
+		st->size = (unsigned long)statp.st_size;
+		st->mtime = (unsigned long)statp.st_mtime;
+		st->ino = (unsigned long)statp.st_ino;
+		gpath_hashinit(st);
+	}
+	while ((n = read(fd, buf, sizeof(buf))) > 0) {
+		if (st)
+			gpath_hash(st, buf, n);
+		for (i = 0; i < n; i++) {
+			length++;
+			if (buf[i] == '\n') {
+				put_number(sb, length);
+				length = 0;
+			}
+		}
+	}
+	close(fd);
+	if (n < 0) {
+		if (st)
+			st->hashed = 0;
+		return -1;
+	}
+	if (length > 0)
+		put_number(sb, length);
+	if ((unsigned long)statp.st_mtime < (unsigned long)time(NULL))
+		dbop_put_withlen(li->dbop, fid, strbuf_value(sb), strbuf_getlen(sb));
+	return 0;
+}
+/**
+ * lineindex_delete: delete the line offsets of a source file.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ *	@param[in]	fid	file id
+ */
+void
+lineindex_delete(LINEINDEX *li, const char *fid)
+{
+	dbop_delete(li->dbop, fid);
+}
+/**
+ * lineindex_load: open a source file with its line offsets.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ *	@param[in]	fid	file id
+ *	@param[in]	root	root directory of source tree
+ *	@param[in]	path	path name of the source file (relative to @a root)
+ *	@return		0: loaded, -1: the offsets are not available or out of date
+ *
+ * The system is told that the file is read at random.
+ */
+int
+lineindex_load(LINEINDEX *li, const char *fid, const char *root, const char *path)
+{
+	const unsigned char *p, *end;
+	const char *dat;
+	struct stat st;
+	unsigned long size, mtime, length, offset;
+	int fd, size_of_dat;
+
+	lineindex_unload(li);
+	if ((dat = dbop_get(li->dbop, fid)) == NULL)
+		return -1;
+	size_of_dat = li->dbop->lastsize;
+	if (strcmp(dat, path))
+		return -1;
+	p = (const unsigned char *)dat + strlen(dat) + 1;
+	end = (const unsigned char *)dat + size_of_dat;
+	if ((p = get_number(p, end, &size)) == NULL || (p = get_number(p, end, &mtime)) == NULL)
+		return -1;
+	if ((fd = open(makepath(root, path, NULL), O_RDONLY|O_BINARY)) < 0)
+		return -1;
+	if (fstat(fd, &st) < 0 || size != (unsigned long)st.st_size || mtime != (unsigned long)st.st_mtime) {
+		close(fd);
+		return -1;
+	}
+	if (li->vb == NULL)
+		li->vb = varray_open(sizeof(long), 1024);
+	else
+		varray_reset(li->vb);
+	offset = 0;
+	*(long *)varray_assign(li->vb, 0, 1) = 0;
+	for (li->count = 0; p < end; ) {
+		if ((p = get_number(p, end, &length)) == NULL)
+			break;
+		offset += length;
+		*(long *)varray_assign(li->vb, ++li->count, 1) = offset;
+	}
+	if (offset != size) {
+		close(fd);
+		return -1;
+	}
+#ifdef POSIX_FADV_RANDOM
+	(void)posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+	li->fd = fd;
+	return 0;
+}
+/**
+ * lineindex_willneed: tell the system that some lines will be read.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ *	@param[in]	from	the first line
+ *	@param[in]	to	the last line
+ */
+void
+lineindex_willneed(LINEINDEX *li, int from, int to)
+{
+#ifdef POSIX_FADV_WILLNEED
+	long start, end;
+
+	if (li->fd < 0 || from < 1 || from > to || from > li->count)
+		return;
+	if (to > li->count)
+		to = li->count;
+	start = *(long *)varray_assign(li->vb, from - 1, 0);
+	end = *(long *)varray_assign(li->vb, to, 0);
+	(void)posix_fadvise(li->fd, start, end - start, POSIX_FADV_WILLNEED);
+#endif
+}
+/**
+ * lineindex_get: read a line of the loaded source file.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ *	@param[in]	lineno	line number
+ *	@return		line image without the newline, or "" if there is no such line
+ */
+const char *
+lineindex_get(LINEINDEX *li, int lineno)
+{
+	STRBUF *sb = li->sb;
+	char buf[8192];
+	long start, end;
+	int n;
+
+	if (li->fd < 0 || lineno < 1 || lineno > li->count)
+		return "";
+	start = *(long *)varray_assign(li->vb, lineno - 1, 0);
+	end = *(long *)varray_assign(li->vb, lineno, 0);
+	strbuf_reset(sb);
+#ifndef HAVE_PREAD
+	if (lseek(li->fd, start, SEEK_SET) < 0)
+		return "";
+#endif
+	while (start < end) {
+		int size = end - start < sizeof(buf) ? end - start : sizeof(buf);
+
+#ifdef HAVE_PREAD
+		n = pread(li->fd, buf, size, start);
+#else
+		n = read(li->fd, buf, size);
+#endif
+		if (n <= 0)
+			break;
+		strbuf_nputs(sb, buf, n);
+		start += n;
+	}
+	/* the same as STRBUF_NOCRLF of strbuf_fgets() */
+	strbuf_unputc(sb, '\n');
+	strbuf_unputc(sb, '\r');
+	return strbuf_value(sb);
+}
+/**
+ * lineindex_unload: close the loaded source file.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ */
+void
+lineindex_unload(LINEINDEX *li)
+{
+	if (li->fd >= 0)
+		close(li->fd);
+	li->fd = -1;
+	li->count = 0;
+}
+/**
+ * lineindex_close: close the line offsets.
+ *
+ *	@param[in]	li	#LINEINDEX structure
+ */
+void
+lineindex_close(LINEINDEX *li)
+{
+	lineindex_unload(li);
+	dbop_close(li->dbop);
+	if (li->vb)
+		varray_close(li->vb);
+	strbuf_close(li->sb);
+	free(li);
+}
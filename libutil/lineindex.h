@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _LINEINDEX_H_
+#define _LINEINDEX_H_
+
+#include "dbop.h"
+#include "gpathop.h"
+#include "strbuf.h"
+#include "varray.h"
+
+/**
+ * Name of the tag file of the line offsets.
+ */
+#define LINEINDEX_NAME	"GLINES"
+
+typedef struct {
+	DBOP *dbop;			/**< descripter of @FILE{GLINES} */
+	STRBUF *sb;			/**< working area */
+	/**
+	 * Stuff for the loaded source file.
+	 */
+	/** @{ */
+	int fd;				/**< file descripter (-1: not loaded) */
+	VARRAY *vb;			/**< offset of each line (long) */
+	int count;			/**< number of lines */
+	/** @} */
+} LINEINDEX;
+
+LINEINDEX *lineindex_open(const char *, int);
+int lineindex_put(LINEINDEX *, const char *, const char *, FILESTAT *);
+void lineindex_delete(LINEINDEX *, const char *);
+int lineindex_load(LINEINDEX *, const char *, const char *, const char *);
+void lineindex_willneed(LINEINDEX *, int, int);
+const char *lineindex_get(LINEINDEX *, int);
+void lineindex_unload(LINEINDEX *);
+void lineindex_close(LINEINDEX *);
+
+#endif /* ! _LINEINDEX_H_ */
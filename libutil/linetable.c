@@ -30,155 +30,148 @@
 #endif
 #include <sys/stat.h>
 
+#include "checkalloc.h"
 #include "die.h"
 #include "linetable.h"
 #include "varray.h"
 #include "strbuf.h"
 
-/** @name File buffer */
-/** @{ */
 #define EXPAND 1024
-static STRBUF *ib;
-static char *filebuf;
-static int filesize;
-/** @} */
 
-/** @name File pointer */
-/** @{ */
-static char *curp;
-static char *endp;
-/** @} */
-
-/** Offset table */
-static VARRAY *vb;
-
-static void linetable_put(int, int);
+static void linetable_put(LINETABLE *, int, int);
 /**
  * linetable_open: load whole of file into memory.
  *
  *	@param[in]	path	path
- *	@return		0: normal <br>
- *			-1: cannot open file.
+ *	@return		line table, @VAR{NULL}: cannot open file.
  */
-int
+LINETABLE *
 linetable_open(const char *path)
 {
+	LINETABLE *lt;
 	FILE *ip;
 	struct stat sb;
 	int lineno, offset;
 
 	if (stat(path, &sb) < 0)
-		return -1;
-	ib = strbuf_open(sb.st_size);
-	vb = varray_open(sizeof(int), EXPAND);
+		return NULL;
 	if ((ip = fopen(path, "r")) == NULL)
-		return -1;
+		return NULL;
+	lt = (LINETABLE *)check_calloc(sizeof(LINETABLE), 1);
+	lt->ib = strbuf_open(sb.st_size);
+	lt->vb = varray_open(sizeof(int), EXPAND);
 	lineno = 1;
 	offset = 0;
 	for (offset = 0;
-		(strbuf_fgets(ib, ip, STRBUF_APPEND), offset != strbuf_getlen(ib));
-		offset = strbuf_getlen(ib))
+		(strbuf_fgets(lt->ib, ip, STRBUF_APPEND), offset != strbuf_getlen(lt->ib));
+		offset = strbuf_getlen(lt->ib))
 	{
-		linetable_put(offset, lineno++);
+		linetable_put(lt, offset, lineno++);
 	}
 	fclose(ip);
-	curp = filebuf = strbuf_value(ib);
-	filesize = offset;
-	endp = filebuf + filesize;
-	/* strbuf_close(ib); */
+	lt->curp = lt->filebuf = strbuf_value(lt->ib);
+	lt->filesize = offset;
+	lt->endp = lt->filebuf + lt->filesize;
 
-	return 0;
+	return lt;
 }
 /**
  * linetable_read: @XREF{read,2} compatible routine for linetable.
  *
+ *	@param[in]	lt	line table
  *	@param[in,out]	buf	read buffer
  *	@param[in]	size	buffer size
  *	@return		==-1: end of file <br>
  *			!=-1: number of bytes actually read
  */
 int
-linetable_read(char *buf, int size)
+linetable_read(LINETABLE *lt, char *buf, int size)
 {
-	int leaved = endp - curp;
+	int leaved = lt->endp - lt->curp;
 
 	if (leaved <= 0)
 		return -1;	/* EOF */
 	if (size > leaved)
 		size = leaved;
-	memcpy(buf, curp, size);
-	curp += size;
+	memcpy(buf, lt->curp, size);
+	lt->curp += size;
 
 	return size;
 }
 /**
  * linetable_put: put a line into table.
  *
+ *	@param[in]	lt	line table
  *	@param[in]	offset	offset of the line
  *	@param[in]	lineno	line number of the line (\>= 1)
  */
-void
-linetable_put(int offset, int lineno)
+static void
+linetable_put(LINETABLE *lt, int offset, int lineno)
 {
 	int *entry;
 
 	if (lineno <= 0)
 		die("linetable_put: line number must >= 1 (lineno = %d)", lineno);
-	entry = varray_assign(vb, lineno - 1, 1);
+	entry = varray_assign(lt->vb, lineno - 1, 1);
 	*entry = offset;
 }
 /**
  * linetable_get: get a line from table.
  *
+ *	@param[in]	lt	line table
  *	@param[in]	lineno	line number of the line (\>= 1)
  *	@param[out]	offset	offset of the line <br>
  *			if @CODE{offset == NULL}, nothing returned.
  *	@return		line pointer
  */
 char *
-linetable_get(int lineno, int *offset)
+linetable_get(LINETABLE *lt, int lineno, int *offset)
 {
 	int addr;
 
 	if (lineno <= 0)
 		die("linetable_get: line number must >= 1 (lineno = %d)", lineno);
-	addr = *((int *)varray_assign(vb, lineno - 1, 0));
+	addr = *((int *)varray_assign(lt->vb, lineno - 1, 0));
 	if (offset)
 		*offset = addr;
-	return filebuf + addr;
+	return lt->filebuf + addr;
 }
 /**
  * linetable_close: close line table.
+ *
+ *	@param[in]	lt	line table
  */
 void
-linetable_close(void)
+linetable_close(LINETABLE *lt)
 {
-	varray_close(vb);
-	strbuf_close(ib);
+	varray_close(lt->vb);
+	strbuf_close(lt->ib);
+	free(lt);
 }
 /**
  * linetable_print: print a line.
  *
+ *	@param[in]	lt	line table
  *	@param[in]	op	output file pointer
  *	@param[in]	lineno	line number (\>= 1)
  */
 void
-linetable_print(FILE *op, int lineno)
+linetable_print(LINETABLE *lt, FILE *op, int lineno)
 {
 	const char *s, *p;
 
 	if (lineno <= 0)
 		die("linetable_print: line number must >= 1 (lineno = %d)", lineno);
-	s = linetable_get(lineno, NULL);
-	if (vb->length == lineno) {
+	s = linetable_get(lt, lineno, NULL);
+	if (lt->vb->length == lineno) {
 		/*
 		 * The last line may not include newline.
 		 */
-		fwrite(s, 1, endp - s, op);
-		if (endp[-1] != '\n')
+		fwrite(s, 1, lt->endp - s, op);
+		if (lt->endp[-1] != '\n')
 			fputc('\n', op);
 	} else {
-		p = linetable_get(lineno + 1, NULL);
+		p = linetable_get(lt, lineno + 1, NULL);
 		fwrite(s, 1, p - s, op);
 	}
 }
@@ -21,10 +21,28 @@
 #define _LINETABLE_H
 #include <stdio.h>
 
-int linetable_open(const char *);
-int linetable_read(char *, int);
-char *linetable_get(int, int *);
-void linetable_close(void);
-void linetable_print(FILE *, int);
+#include "strbuf.h"
+#include "varray.h"
+
+/**
+ * Line table.
+ *
+ * The whole of a file and the offsets of its lines are kept in this
+ * structure, so that more than one file can be read at the same time.
+ */
+typedef struct {
+	STRBUF *ib;			/**< file buffer */
+	char *filebuf;			/**< contents of the file */
+	int filesize;			/**< size of the file */
+	char *curp;			/**< current position for linetable_read() */
+	char *endp;			/**< end of the file */
+	VARRAY *vb;			/**< offset table */
+} LINETABLE;
+
+LINETABLE *linetable_open(const char *);
+int linetable_read(LINETABLE *, char *, int);
+char *linetable_get(LINETABLE *, int, int *);
+void linetable_close(LINETABLE *);
+void linetable_print(LINETABLE *, FILE *, int);
 
 #endif /* ! _LINETABLE_H */
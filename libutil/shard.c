@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <sys/types.h>
+#include <dirent.h>
+#endif
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include "checkalloc.h"
+#include "die.h"
+#include "gpathop.h"
+#include "gtagsop.h"
+#include "makepath.h"
+#include "shard.h"
+#include "strbuf.h"
+#include "test.h"
+#include "varray.h"
+
+/**
+ @file
+
+ Sharded tag files.
+
+ The tag files of a large project can be divided into shards, one for each
+ top level directory of the source tree. Each shard has its own @NAME{GPATH},
+ @NAME{GTAGS} and @NAME{GRTAGS}, and is made and updated independently.
+
+ @code{.txt}
+ dbpath/GPATH, GTAGS, GRTAGS		the root shard
+ dbpath/GSHARDS/<dir>/GPATH, GTAGS, GRTAGS	the shard of ./<dir>/
+ @endcode
+
+ The root shard has the files directly under the root directory and the files
+ in the directories which have no shard. The path names in every shard are
+ relative to the root directory as usual, so the results of the shards can
+ be merged without conversion. The file ids are local to each shard.
+ */
+
+static int
+compare_name(const void *s1, const void *s2)
+{
+	return strcmp(*(char **)s1, *(char **)s2);
+}
+/**
+ * shard_open: load the list of the shards.
+ *
+ *	@param[in]	dbpath	dbpath directory
+ *	@return		#SHARDS structure, or @VAR{NULL} if the tag files are not sharded
+ *
+ * The shard 0 is always the root shard. The others are sorted by the name.
+ * A shard which is being made may not have the tag files yet (see shard_exist()).
+ */
+SHARDS *
+shard_open(const char *dbpath)
+{
+	SHARDS *shards;
+	VARRAY *vb;
+	DIR *dirp;
+	struct dirent *dp;
+	char dir[MAXPATHLEN];
+	int i;
+
+	snprintf(dir, sizeof(dir), "%s", makepath(dbpath, GSHARDS, NULL));
+	if (!test("d", dir))
+		return NULL;
+	if ((dirp = opendir(dir)) == NULL)
+		die("cannot open directory '%s'.", dir);
+	vb = varray_open(sizeof(char *), 32);
+	*(char **)varray_append(vb) = check_strdup(ROOTSHARD);
+	while ((dp = readdir(dirp)) != NULL) {
+		if (dp->d_name[0] == '.')
+			continue;
+		if (!test("d", makepath(dir, dp->d_name, NULL)))
+			continue;
+		*(char **)varray_append(vb) = check_strdup(dp->d_name);
+	}
+	(void)closedir(dirp);
+	shards = (SHARDS *)check_calloc(sizeof(SHARDS), 1);
+	shards->count = vb->length;
+	shards->name = (char **)check_malloc(sizeof(char *) * shards->count);
+	memcpy(shards->name, varray_assign(vb, 0, 0), sizeof(char *) * shards->count);
+	varray_close(vb);
+	qsort(shards->name + 1, shards->count - 1, sizeof(char *), compare_name);
+	shards->dbpath = (char **)check_malloc(sizeof(char *) * shards->count);
+	shards->dbpath[0] = check_strdup(dbpath);
+	for (i = 1; i < shards->count; i++)
+		shards->dbpath[i] = check_strdup(makepath(dir, shards->name[i], NULL));
+	shards->gpath = (DBOP **)check_calloc(sizeof(DBOP *), shards->count);
+	shards->gtags = (DBOP **)check_calloc(sizeof(DBOP *), shards->count);
+	return shards;
+}
+/**
+ * shard_lookup: the shard which a path belongs to
+ *
+ *	@param[in]	shards	#SHARDS structure
+ *	@param[in]	path	path name (@STRONG{must} start with @FILE{./})
+ *	@return		index of the shard
+ */
+int
+shard_lookup(SHARDS *shards, const char *path)
+{
+	char name[MAXPATHLEN];
+	const char *p;
+	int lo, hi;
+
+	if (path[0] == '.' && path[1] == '/')
+		path += 2;
+	if ((p = strchr(path, '/')) == NULL || p - path >= sizeof(name))
+		return 0;
+	memcpy(name, path, p - path);
+	name[p - path] = '\0';
+	lo = 1;
+	hi = shards->count - 1;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		int ret = strcmp(name, shards->name[mid]);
+
+		if (ret == 0)
+			return mid;
+		if (ret < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+	return 0;
+}
+/**
+ * shard_exist: whether or not a shard has the tag files.
+ *
+ *	@param[in]	shards	#SHARDS structure
+ *	@param[in]	i	index of the shard
+ *	@return		1: exist, 0: not exist
+ */
+int
+shard_exist(SHARDS *shards, int i)
+{
+	const char *dbpath = shards->dbpath[i];
+
+	return test("f", makepath(dbpath, dbname(GPATH), NULL))
+		&& test("f", makepath(dbpath, dbname(GTAGS), NULL))
+		&& test("f", makepath(dbpath, dbname(GRTAGS), NULL));
+}
+/**
+ * shard_defined: whether or not the name is defined in any shard.
+ *
+ *	@param[in]	shards	#SHARDS structure
+ *	@param[in]	name	tag name
+ *	@return		1: defined, 0: not defined
+ */
+int
+shard_defined(SHARDS *shards, const char *name)
+{
+	int i;
+
+	for (i = 0; i < shards->count; i++) {
+		if (shards->gtags[i] == NULL) {
+			if (!shard_exist(shards, i))
+				continue;
+			shards->gtags[i] = dbop_open(makepath(shards->dbpath[i], dbname(GTAGS), NULL), 0, 0, DBOP_BLOOM);
+			if (shards->gtags[i] == NULL)
+				die("%s not found.", dbname(GTAGS));
+		}
+		if (dbop_get(shards->gtags[i], name))
+			return 1;
+	}
+	return 0;
+}
+/**
+ * shard_path2fid: convert path into id using the shard of the path
+ *
+ *	@param[in]	shards	#SHARDS structure
+ *	@param[in]	path	path name
+ *	@param[out]	type	path type <br>
+ *			#GPATH_SOURCE: source file <br>
+ *			#GPATH_OTHER: other file
+ *	@return		file id (local to the shard)
+ */
+const char *
+shard_path2fid(SHARDS *shards, const char *path, int *type)
+{
+	int i = shard_lookup(shards, path);
+	const char *fid;
+
+	if (shards->gpath[i] == NULL) {
+		if (!shard_exist(shards, i))
+			return NULL;
+		shards->gpath[i] = dbop_open(makepath(shards->dbpath[i], dbname(GPATH), NULL), 0, 0, 0);
+		if (shards->gpath[i] == NULL)
+			die("%s not found.", dbname(GPATH));
+	}
+	fid = dbop_get(shards->gpath[i], path);
+	if (fid && type) {
+		const char *flag = dbop_getflag(shards->gpath[i]);
+		*type = (*flag == 'o') ? GPATH_OTHER : GPATH_SOURCE;
+	}
+	return fid;
+}
+/**
+ * shard_close: close the shards.
+ *
+ *	@param[in]	shards	#SHARDS structure
+ */
+void
+shard_close(SHARDS *shards)
+{
+	int i;
+
+	for (i = 0; i < shards->count; i++) {
+		if (shards->gpath[i])
+			dbop_close(shards->gpath[i]);
+		if (shards->gtags[i])
+			dbop_close(shards->gtags[i]);
+		free(shards->name[i]);
+		free(shards->dbpath[i]);
+	}
+	free(shards->gpath);
+	free(shards->gtags);
+	free(shards->name);
+	free(shards->dbpath);
+	free(shards);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _SHARD_H_
+#define _SHARD_H_
+
+#include "dbop.h"
+
+/**
+ * Directory of the shards in the dbpath directory.
+ */
+#define GSHARDS		"GSHARDS"
+/**
+ * Name of the root shard.
+ */
+#define ROOTSHARD	"."
+
+typedef struct {
+	int count;			/**< number of shards including the root shard */
+	char **name;			/**< name of each shard (sorted) */
+	char **dbpath;			/**< dbpath directory of each shard */
+	DBOP **gpath;			/**< @NAME{GPATH} of each shard (opened on demand) */
+	DBOP **gtags;			/**< @NAME{GTAGS} of each shard (opened on demand) */
+} SHARDS;
+
+#define shard_name(shards, i)	((shards)->name[i])
+#define shard_dbpath(shards, i)	((shards)->dbpath[i])
+
+SHARDS *shard_open(const char *);
+int shard_lookup(SHARDS *, const char *);
+int shard_exist(SHARDS *, int);
+int shard_defined(SHARDS *, const char *);
+const char *shard_path2fid(SHARDS *, const char *, int *);
+void shard_close(SHARDS *);
+
+#endif /* ! _SHARD_H_ */
@@ -40,6 +40,7 @@
 #include <string.h>
 
 #include "checkalloc.h"
+#include "db.h"
 #include "die.h"
 #include "queue.h"
 #include "statistics.h"
@@ -96,6 +97,17 @@ typedef time_t ELAPSED_TIME_TYPE;
 #define CPU_TIME_AVAILABLE	0
 #endif
 
+/**
+ * The counters of the database library follow the counters of the works.
+ */
+#define COUNTER_SPLITS		(STATISTICS_COUNTERS + 0)
+#define COUNTER_HITS		(STATISTICS_COUNTERS + 1)
+#define COUNTER_MISSES		(STATISTICS_COUNTERS + 2)
+#define COUNTER_EVICTIONS	(STATISTICS_COUNTERS + 3)
+#define NCOUNTERS		(STATISTICS_COUNTERS + 4)
+
+unsigned long statistics_counter[STATISTICS_COUNTERS];
+
 struct statistics_time {
 	STAILQ_ENTRY(statistics_time) next;
 
@@ -111,6 +123,9 @@ struct statistics_time {
 				/**< percent may be NaN or infinity. */
 #endif
 
+	unsigned long count_start[NCOUNTERS];
+	unsigned long count[NCOUNTERS];	/**< Counters in the period. */
+
 	int name_len;
 	char name[1];
 };
@@ -120,6 +135,16 @@ static STATISTICS_TIME *T_all;
 static STAILQ_HEAD(statistics_time_list, statistics_time)
 	statistics_time_list = STAILQ_HEAD_INITIALIZER(statistics_time_list);
 
+static void
+get_counters(unsigned long *count)
+{
+	memcpy(count, statistics_counter, sizeof(statistics_counter));
+	count[COUNTER_SPLITS] = bt_split;
+	count[COUNTER_HITS] = mpool_cachehit;
+	count[COUNTER_MISSES] = mpool_cachemiss;
+	count[COUNTER_EVICTIONS] = mpool_evicted;
+}
+
 void
 init_statistics(void)
 {
@@ -150,6 +175,7 @@ statistics_time_start(const char *fmt, ...)
 #if CPU_TIME_AVAILABLE
 	GET_CPU_TIME(&t->user_start, &t->system_start);
 #endif
+	get_counters(t->count_start);
 
 	return t;
 }
@@ -162,7 +188,11 @@ statistics_time_end(STATISTICS_TIME *t)
 	CPU_TIME_TYPE user_end;
 	CPU_TIME_TYPE system_end;
 #endif
+	int i;
 
+	get_counters(t->count);
+	for (i = 0; i < NCOUNTERS; i++)
+		t->count[i] -= t->count_start[i];
 	GET_ELAPSED_TIME(&elapsed_end);
 	SUB_ELAPSED_TIME(&elapsed_end, &t->elapsed_start, &t->elapsed);
 
@@ -411,6 +441,70 @@ print_footer_common(void *priv)
 	free(priv);
 }
 
+static void
+print_header_json(void **ppriv)
+{
+	*ppriv = check_calloc(sizeof(int), 1);
+	printf("{\"periods\": [\n");
+}
+
+/**
+ * print_json_number: print a number in JSON, which has no NaN and infinity.
+ */
+static void
+print_json_number(const char *name, double value, int precision)
+{
+	if (value != value || value - value != 0)
+		printf(", \"%s\": null", name);
+	else
+		printf(", \"%s\": %.*f", name, precision, value);
+}
+
+static void
+print_time_json(const STATISTICS_TIME *t, void *priv)
+{
+	int *count = priv;
+	const char *p;
+
+	printf("%s {\"name\": \"", (*count)++ ? ",\n" : "");
+	for (p = t->name; *p; p++) {
+		if (*p == '"' || *p == '\\')
+			putchar('\\');
+		if ((unsigned char)*p >= ' ')
+			putchar(*p);
+	}
+	putchar('"');
+#if CPU_TIME_AVAILABLE
+	print_json_number("user", t->user, USER_PRECISION);
+	print_json_number("system", t->system, SYSTEM_PRECISION);
+#endif
+	print_json_number("elapsed", t->elapsed, ELAPSED_PRECISION);
+#if CPU_TIME_AVAILABLE
+	print_json_number("cpu", t->percent, PERCENT_PRECISION);
+#endif
+	printf(", \"files\": %lu, \"bytes\": %lu",
+		t->count[STATISTICS_FILES], t->count[STATISTICS_BYTES]);
+	if (t->elapsed > 0) {
+		print_json_number("files_per_sec", t->count[STATISTICS_FILES] / t->elapsed, 3);
+		print_json_number("mb_per_sec", t->count[STATISTICS_BYTES] / t->elapsed / (1024 * 1024), 3);
+	} else {
+		printf(", \"files_per_sec\": null, \"mb_per_sec\": null");
+	}
+	printf(", \"definitions\": %lu, \"references\": %lu, \"dbop_put\": %lu",
+		t->count[STATISTICS_DEFS], t->count[STATISTICS_REFS], t->count[STATISTICS_PUTS]);
+	printf(", \"page_splits\": %lu, \"cache_hits\": %lu, \"cache_misses\": %lu, \"cache_evictions\": %lu}",
+		t->count[COUNTER_SPLITS], t->count[COUNTER_HITS], t->count[COUNTER_MISSES],
+		t->count[COUNTER_EVICTIONS]);
+}
+
+static void
+print_footer_json(void *priv)
+{
+	printf("\n]}\n");
+	fflush(stdout);
+	free(priv);
+}
+
 struct printng_style {
 	void (*print_header)(void **);
 	void (*print_time)(const STATISTICS_TIME *, void *);
@@ -424,6 +518,8 @@ static const struct printng_style printing_styles[] = {
 	{ print_header_list, print_time_list, print_footer_common },
 	/* STATISTICS_STYLE_TABLE */
 	{ print_header_table, print_time_table, print_footer_common },
+	/* STATISTICS_STYLE_JSON */
+	{ print_header_json, print_time_json, print_footer_json },
 };
 
 #if !defined(ARRAY_SIZE)
@@ -464,3 +560,20 @@ print_statistics(int style_no)
 	sb = NULL;
 }
 
+/**
+ * statistics_style: get the printing style from its name.
+ *
+ *	@param[in]	name	@CODE{"list"}, @CODE{"table"} or @CODE{"json"}
+ *	@return		style, or -1 if unknown
+ */
+int
+statistics_style(const char *name)
+{
+	if (!strcmp(name, "list"))
+		return STATISTICS_STYLE_LIST;
+	if (!strcmp(name, "table"))
+		return STATISTICS_STYLE_TABLE;
+	if (!strcmp(name, "json"))
+		return STATISTICS_STYLE_JSON;
+	return -1;
+}
@@ -89,17 +89,49 @@ typedef struct statistics_time STATISTICS_TIME;
  *     ------------------- --------- ----------- ------------ -----
  *     The entire time        21.721       2.420       18.989 127.4
  * @endcode
+ *
+ * @par STATISTICS_STYLE_JSON:
+ *    Print statistics information with the counters of each period
+ *    to the standard output in JSON like following, and deallocate resource.
+ *
+ * @code{.txt}
+ *     {"periods": [
+ *      {"name": "Time of making foo", "user": 2.016, "system": 0.128,
+ *       "elapsed": 1.437, "cpu": 149.0, "files": 120, "bytes": 3512000,
+ *       "files_per_sec": 83.507, "mb_per_sec": 2.331, "definitions": 5231,
+ *       "references": 40112, "dbop_put": 45343, "page_splits": 310,
+ *       "cache_hits": 190233, "cache_misses": 1211},
+ *      ...
+ *     ]}
+ * @endcode
  */
 enum {
 	STATISTICS_STYLE_NONE,
 	STATISTICS_STYLE_LIST,
-	STATISTICS_STYLE_TABLE
+	STATISTICS_STYLE_TABLE,
+	STATISTICS_STYLE_JSON
+};
+
+/**
+ * Counters of the works. The number of page splits and the cache hits
+ * and misses are taken from the database library.
+ */
+enum {
+	STATISTICS_FILES,		/**< files parsed */
+	STATISTICS_BYTES,		/**< bytes of the files parsed */
+	STATISTICS_DEFS,		/**< #PARSER_DEF records */
+	STATISTICS_REFS,		/**< #PARSER_REF_SYM records */
+	STATISTICS_PUTS,		/**< dbop_put() calls */
+	STATISTICS_COUNTERS
 };
+extern unsigned long statistics_counter[];
+#define statistics_count(id, n)	(statistics_counter[id] += (n))
 
 void init_statistics(void);
 STATISTICS_TIME *statistics_time_start(const char *, ...)
 	__attribute__ ((__format__ (__printf__, 1, 2)));
 void statistics_time_end(STATISTICS_TIME *);
 void print_statistics(int);
+int statistics_style(const char *);
 
 #endif
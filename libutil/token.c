@@ -29,72 +29,65 @@
 #include <strings.h>
 #endif
 
+#include "checkalloc.h"
 #include "die.h"
 #include "gparam.h"
 #include "strlimcpy.h"
 #include "token.h"
 
-/*
- * File input method.
- */
-int lineno;
-const char *sp, *cp, *lp;
-int crflag;			/**< 1: return '\\n', 0: doesn't return */
-int cmode;			/**< allow token which start with '\#' */
-int cppmode;			/**< allow '\::' as a token */
-int ymode;			/**< allow token which start with '\%' */
-char token[MAXTOKEN];
-char curfile[MAXPATHLEN];
-int continued_line;		/**< previous line ends with '\\\\' */
-
-static char ptok[MAXTOKEN];
-static int lasttok;
-static FILE *ip;
-static STRBUF *ib;
-
-#define tlen	(p - &token[0])
-static void pushbackchar(void);
+#define tlen	(p - &tk->token[0])
+static void pushbackchar(TOKENIZER *);
 
 /**
- * opentoken:
+ * opentoken: open a tokenizer for a file.
  *
  *	@param[in]	file
+ *	@return		tokenizer, @VAR{NULL}: cannot open the file.
  */
-int
+TOKENIZER *
 opentoken(const char *file)
 {
+	TOKENIZER *tk;
+	FILE *ip;
+
 	/*
 	 * b flag is needed for WIN32 environment. Almost unix ignore it.
 	 */
 	if ((ip = fopen(file, "rb")) == NULL)
-		return 0;
-	ib = strbuf_open(MAXBUFLEN);
-	strlimcpy(curfile, file, sizeof(curfile));
-	sp = cp = lp = NULL; ptok[0] = '\0'; lineno = 0;
-	crflag = cmode = cppmode = ymode = 0;
-	continued_line = 0;
-	return 1;
+		return NULL;
+	tk = (TOKENIZER *)check_calloc(sizeof(TOKENIZER), 1);
+	tk->ip = ip;
+	tk->ib = strbuf_open(MAXBUFLEN);
+	strlimcpy(tk->curfile, file, sizeof(tk->curfile));
+	tk->sp = tk->cp = tk->lp = NULL; tk->ptok[0] = '\0'; tk->lineno = 0;
+	tk->crflag = tk->cmode = tk->cppmode = tk->ymode = 0;
+	tk->continued_line = 0;
+	return tk;
 }
 /**
- * closetoken:
+ * closetoken: close a tokenizer.
+ *
+ *	@param[in]	tk	tokenizer
  */
 void
-closetoken(void)
+closetoken(TOKENIZER *tk)
 {
-	strbuf_close(ib);
-	fclose(ip);
+	strbuf_close(tk->ib);
+	fclose(tk->ip);
+	free(tk);
 }
 
 /**
  * nexttoken: get next token
  *
+ *	@param[in]	tk	tokenizer
  *	@param[in]	interested	interested special character <br>
  *				if @VAR{NULL} then all character.
  *	@param[in]	reserved	converter from token to token number <br>
  *				if this is specified, nexttoken() return <br>
  *				word number, else return symbol.
  *	@return	@VAR{EOF}(-1)	end of file <br>
- *		c ==0		symbol (#SYMBOL; #token has the value.) <br>
+ *		c ==0		symbol (#SYMBOL; tk->token has the value.) <br>
  *		c \< 256		interested special character <br>
  *		c \> 1000	reserved word
  *
@@ -106,7 +99,7 @@ closetoken(void)
  */
 
 int
-nexttoken(const char *interested, int (*reserved)(const char *, int))
+nexttoken(TOKENIZER *tk, const char *interested, int (*reserved)(const char *, int))
 {
 	int c;
 	char *p;
@@ -114,19 +107,19 @@ nexttoken(const char *interested, int (*reserved)(const char *, int))
 	int percent = 0;
 
 	/* check push back buffer */
-	if (ptok[0]) {
-		strlimcpy(token, ptok, sizeof(token));
-		ptok[0] = '\0';
-		return lasttok;
+	if (tk->ptok[0]) {
+		strlimcpy(tk->token, tk->ptok, sizeof(tk->token));
+		tk->ptok[0] = '\0';
+		return tk->lasttok;
 	}
 
 	for (;;) {
 		/* skip spaces */
-		if (!crflag)
-			while ((c = nextchar()) != EOF && isspace(c))
+		if (!tk->crflag)
+			while ((c = nextchar(tk)) != EOF && isspace(c))
 				;
 		else
-			while ((c = nextchar()) != EOF && isspace(c) && c != '\n')
+			while ((c = nextchar(tk)) != EOF && isspace(c) && c != '\n')
 				;
 		if (c == EOF || c == '\n')
 			break;
@@ -134,69 +127,69 @@ nexttoken(const char *interested, int (*reserved)(const char *, int))
 		if (c == '"' || c == '\'') {	/* quoted string */
 			int quote = c;
 
-			while ((c = nextchar()) != EOF) {
+			while ((c = nextchar(tk)) != EOF) {
 				if (c == quote)
 					break;
 				if (quote == '\'' && c == '\n')
 					break;
-				if (c == '\\' && (c = nextchar()) == EOF)
+				if (c == '\\' && (c = nextchar(tk)) == EOF)
 					break;
 			}
 		} else if (c == '/') {			/* comment */
-			if ((c = nextchar()) == '/') {
-				while ((c = nextchar()) != EOF)
+			if ((c = nextchar(tk)) == '/') {
+				while ((c = nextchar(tk)) != EOF)
 					if (c == '\n') {
-						pushbackchar();
+						pushbackchar(tk);
 						break;
 					}
 			} else if (c == '*') {
-				while ((c = nextchar()) != EOF) {
+				while ((c = nextchar(tk)) != EOF) {
 					if (c == '*') {
-						if ((c = nextchar()) == '/')
+						if ((c = nextchar(tk)) == '/')
 							break;
-						pushbackchar();
+						pushbackchar(tk);
 					}
 				}
 			} else
-				pushbackchar();
+				pushbackchar(tk);
 		} else if (c == '\\') {
-			if (nextchar() == '\n')
-				continued_line = 1;
+			if (nextchar(tk) == '\n')
+				tk->continued_line = 1;
 		} else if (isdigit(c)) {		/* digit */
-			while ((c = nextchar()) != EOF && (c == '.' || isalnum(c)))
+			while ((c = nextchar(tk)) != EOF && (c == '.' || isalnum(c)))
 				;
-			pushbackchar();
-		} else if (c == '#' && cmode) {
+			pushbackchar(tk);
+		} else if (c == '#' && tk->cmode) {
 			/* recognize '##' as a token if it is reserved word. */
-			if (peekc(1) == '#') {
-				p = token;
+			if (peekc(tk, 1) == '#') {
+				p = tk->token;
 				*p++ = c;
-				*p++ = nextchar();
+				*p++ = nextchar(tk);
 				*p   = 0;
-				if (reserved && (c = (*reserved)(token, tlen)) == 0)
+				if (reserved && (c = (*reserved)(tk->token, tlen)) == 0)
 					break;
-			} else if (!continued_line && atfirst_exceptspace()) {
+			} else if (!tk->continued_line && atfirst_exceptspace(tk)) {
 				sharp = 1;
 				continue;
 			}
-		} else if (c == ':' && cppmode) {
-			if (peekc(1) == ':') {
-				p = token;
+		} else if (c == ':' && tk->cppmode) {
+			if (peekc(tk, 1) == ':') {
+				p = tk->token;
 				*p++ = c;
-				*p++ = nextchar();
+				*p++ = nextchar(tk);
 				*p   = 0;
-				if (reserved && (c = (*reserved)(token, tlen)) == 0)
+				if (reserved && (c = (*reserved)(tk->token, tlen)) == 0)
 					break;
 			}
-		} else if (c == '%' && ymode) {
+		} else if (c == '%' && tk->ymode) {
 			/* recognize '%%' as a token if it is reserved word. */
-			if (atfirst) {
-				p = token;
+			if (atfirst(tk)) {
+				p = tk->token;
 				*p++ = c;
-				if ((c = peekc(1)) == '%' || c == '{' || c == '}') {
-					*p++ = nextchar();
+				if ((c = peekc(tk, 1)) == '%' || c == '{' || c == '}') {
+					*p++ = nextchar(tk);
 					*p   = 0;
-					if (reserved && (c = (*reserved)(token, tlen)) != 0)
+					if (reserved && (c = (*reserved)(tk->token, tlen)) != 0)
 						break;
 				} else if (!isspace(c)) {
 					percent = 1;
@@ -204,7 +197,7 @@ nexttoken(const char *interested, int (*reserved)(const char *, int))
 				}
 			}
 		} else if (c & 0x80 || isalpha(c) || c == '_') {/* symbol */
-			p = token;
+			p = tk->token;
 			if (sharp) {
 				sharp = 0;
 				*p++ = '#';
@@ -212,27 +205,27 @@ nexttoken(const char *interested, int (*reserved)(const char *, int))
 				percent = 0;
 				*p++ = '%';
 			} else if (c == 'L') {
-				int tmp = peekc(1);
+				int tmp = peekc(tk, 1);
 
 				if (tmp == '\"' || tmp == '\'')
 					continue;
 			}
-			for (*p++ = c; (c = nextchar()) != EOF && (c & 0x80 || isalnum(c) || c == '_');) {
-				if (tlen < sizeof(token))
+			for (*p++ = c; (c = nextchar(tk)) != EOF && (c & 0x80 || isalnum(c) || c == '_');) {
+				if (tlen < sizeof(tk->token))
 					*p++ = c;
 			}
-			if (tlen == sizeof(token)) {
-				warning("symbol name is too long. (Ignored)[+%d %s]", lineno, curfile);
+			if (tlen == sizeof(tk->token)) {
+				warning("symbol name is too long. (Ignored)[+%d %s]", tk->lineno, tk->curfile);
 				continue;
 			}
 			*p = 0;
 	
 			if (c != EOF)
-				pushbackchar();
+				pushbackchar(tk);
 			/* convert token string into token number */
 			c = SYMBOL;
 			if (reserved)
-				c = (*reserved)(token, tlen);
+				c = (*reserved)(tk->token, tlen);
 			break;
 		} else {				/* special char */
 			if (interested == NULL || strchr(interested, c))
@@ -241,7 +234,7 @@ nexttoken(const char *interested, int (*reserved)(const char *, int))
 		}
 		sharp = percent = 0;
 	}
-	return lasttok = c;
+	return tk->lasttok = c;
 }
 /**
  * pushbacktoken: push back token
@@ -249,41 +242,42 @@ nexttoken(const char *interested, int (*reserved)(const char *, int))
  *	following nexttoken() return same token again.
  */
 void
-pushbacktoken(void)
+pushbacktoken(TOKENIZER *tk)
 {
-	strlimcpy(ptok, token, sizeof(ptok));
+	strlimcpy(tk->ptok, tk->token, sizeof(tk->ptok));
 }
 /**
  * peekc: peek next char
  *
+ *	@param[in]	tk	tokenizer
  *	@param[in]	immediate	0: ignore blank, 1: include blank
  *
  * peekc() read ahead following blanks but doesn't change line.
  */
 int
-peekc(int immediate)
+peekc(TOKENIZER *tk, int immediate)
 {
 	int c;
 	long pos;
     int comment = 0;
 
-	if (cp != NULL) {
+	if (tk->cp != NULL) {
 		if (immediate)
-			c = nextchar();
+			c = nextchar(tk);
 		else
-            while ((c = nextchar()) != EOF && c != '\n') {
+            while ((c = nextchar(tk)) != EOF && c != '\n') {
                 if (c == '/') {			/* comment */
-                    if ((c = nextchar()) == '/') {
-                        while ((c = nextchar()) != EOF)
+                    if ((c = nextchar(tk)) == '/') {
+                        while ((c = nextchar(tk)) != EOF)
                             if (c == '\n') {
-                                pushbackchar();
+                                pushbackchar(tk);
                                 break;
                             }
                     } else if (c == '*') {
                         comment = 1;
-                        while ((c = nextchar()) != EOF) {
+                        while ((c = nextchar(tk)) != EOF) {
                             if (c == '*') {
-                                if ((c = nextchar()) == '/')
+                                if ((c = nextchar(tk)) == '/')
                                 {
                                     comment = 0;
                                     break;
@@ -291,30 +285,30 @@ peekc(int immediate)
                             }
                             else if (c == '\n')
                             {
-                                pushbackchar();
+                                pushbackchar(tk);
                                 break;
                             }
                         }
                     } else
-                        pushbackchar();
+                        pushbackchar(tk);
                 }
                 else if (!isspace(c))
                     break;
             }
 		if (c != EOF)
-			pushbackchar();
+			pushbackchar(tk);
 		if (c != '\n' || immediate)
 			return c;
 	}
-	pos = ftell(ip);
+	pos = ftell(tk->ip);
 	if (immediate)
-		c = getc(ip);
+		c = getc(tk->ip);
 	else
-        while ((c = getc(ip)) != EOF) {
+        while ((c = getc(tk->ip)) != EOF) {
             if (comment) {
-                while ((c = getc(ip)) != EOF) {
+                while ((c = getc(tk->ip)) != EOF) {
                     if (c == '*') {
-                        if ((c = getc(ip)) == '/')
+                        if ((c = getc(tk->ip)) == '/')
                         {
                             comment = 0;
                             break;
@@ -323,15 +317,15 @@ peekc(int immediate)
                 }
             }
             else if (c == '/') {			/* comment */
-                if ((c = getc(ip)) == '/') {
-                    while ((c = getc(ip)) != EOF)
+                if ((c = getc(tk->ip)) == '/') {
+                    while ((c = getc(tk->ip)) != EOF)
                         if (c == '\n') {
                             break;
                         }
                 } else if (c == '*') {
-                    while ((c = getc(ip)) != EOF) {
+                    while ((c = getc(tk->ip)) != EOF) {
                         if (c == '*') {
-                            if ((c = getc(ip)) == '/')
+                            if ((c = getc(tk->ip)) == '/')
                                 break;
                         }
                     }
@@ -342,7 +336,7 @@ peekc(int immediate)
                 break;
         }
 
-	(void)fseek(ip, pos, SEEK_SET);
+	(void)fseek(tk->ip, pos, SEEK_SET);
 
 	return c;
 }
@@ -350,9 +344,9 @@ peekc(int immediate)
  * throwaway_nextchar: throw away next character
  */
 void
-throwaway_nextchar(void)
+throwaway_nextchar(TOKENIZER *tk)
 {
-	nextchar();
+	nextchar(tk);
 }
 /**
  * atfirst_exceptspace: return if current position is the first column
@@ -364,10 +358,10 @@ throwaway_nextchar(void)
  * @endcode
  */
 int
-atfirst_exceptspace(void)
+atfirst_exceptspace(TOKENIZER *tk)
 {
-	const char *start = sp;
-	const char *end = cp ? cp - 1 : lp;
+	const char *start = tk->sp;
+	const char *end = tk->cp ? tk->cp - 1 : tk->lp;
 
 	while (start < end && *start && isspace(*start))
 		start++;
@@ -380,12 +374,12 @@ atfirst_exceptspace(void)
  * 
  */
 static void
-pushbackchar(void)
+pushbackchar(TOKENIZER *tk)
 {
-        if (sp == NULL)
+        if (tk->sp == NULL)
                 return;         /* nothing to do */
-        if (cp == NULL)
-                cp = lp;
+        if (tk->cp == NULL)
+                tk->cp = tk->lp;
         else
-                --cp;
+                --tk->cp;
 }
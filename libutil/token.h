@@ -21,39 +21,53 @@
 #ifndef _TOKEN_H_
 #define _TOKEN_H_
 
+#include <stdio.h>
+
 #include "gparam.h"
 #include "strbuf.h"
 
 #define SYMBOL		0
 
-extern const char *sp, *cp, *lp;
-extern int lineno;
-extern int crflag;
-extern int cmode;
-extern int cppmode;
-extern int ymode;
-extern char token[MAXTOKEN];
-extern char curfile[MAXPATHLEN];
-extern int continued_line;
-
-#define nextchar() \
-	(cp == NULL ? \
-		((sp = cp = strbuf_fgets(ib, ip, STRBUF_NOCRLF)) == NULL ? \
+/**
+ * Tokenizer.
+ *
+ * All the state of the tokenizer is kept in this structure, so that
+ * more than one file can be read at the same time.
+ */
+typedef struct {
+	const char *sp, *cp, *lp;	/**< start, current and last position in the line */
+	int lineno;			/**< current line number */
+	int crflag;			/**< 1: return '\\n', 0: doesn't return */
+	int cmode;			/**< allow token which start with '\#' */
+	int cppmode;			/**< allow '\::' as a token */
+	int ymode;			/**< allow token which start with '\%' */
+	char token[MAXTOKEN];		/**< current token */
+	char curfile[MAXPATHLEN];	/**< current file */
+	int continued_line;		/**< previous line ends with '\\\\' */
+	char ptok[MAXTOKEN];		/**< push back buffer */
+	int lasttok;			/**< last token */
+	FILE *ip;			/**< input file */
+	STRBUF *ib;			/**< line buffer */
+} TOKENIZER;
+
+#define nextchar(tk) \
+	((tk)->cp == NULL ? \
+		(((tk)->sp = (tk)->cp = strbuf_fgets((tk)->ib, (tk)->ip, STRBUF_NOCRLF)) == NULL ? \
 			EOF : \
-			(lineno++, *cp == 0 ? \
-				(lp = cp, cp = NULL, continued_line = 0, '\n') : \
-				(unsigned char)*cp++)) : \
-		(*cp == 0 ? \
-			(lp = cp, cp = NULL, continued_line = 0, '\n') : \
-			(unsigned char)*cp++))
-#define atfirst (sp && sp == (cp ? cp - 1 : lp))
-
-int opentoken(const char *);
-void closetoken(void);
-int nexttoken(const char *, int (*)(const char *, int));
-void pushbacktoken(void);
-int peekc(int);
-void throwaway_nextchar(void);
-int atfirst_exceptspace(void);
+			((tk)->lineno++, *(tk)->cp == 0 ? \
+				((tk)->lp = (tk)->cp, (tk)->cp = NULL, (tk)->continued_line = 0, '\n') : \
+				(unsigned char)*(tk)->cp++)) : \
+		(*(tk)->cp == 0 ? \
+			((tk)->lp = (tk)->cp, (tk)->cp = NULL, (tk)->continued_line = 0, '\n') : \
+			(unsigned char)*(tk)->cp++))
+#define atfirst(tk) ((tk)->sp && (tk)->sp == ((tk)->cp ? (tk)->cp - 1 : (tk)->lp))
+
+TOKENIZER *opentoken(const char *);
+void closetoken(TOKENIZER *);
+int nexttoken(TOKENIZER *, const char *, int (*)(const char *, int));
+void pushbacktoken(TOKENIZER *);
+int peekc(TOKENIZER *, int);
+void throwaway_nextchar(TOKENIZER *);
+int atfirst_exceptspace(TOKENIZER *);
 
 #endif /* ! _TOKEN_H_ */
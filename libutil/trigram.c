@@ -0,0 +1,885 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#ifdef STDC_HEADERS
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "regex.h"
+
+#include "checkalloc.h"
+#include "dbop.h"
+#include "die.h"
+#include "extsort.h"
+#include "gparam.h"
+#include "strbuf.h"
+#include "strlimcpy.h"
+#include "trigram.h"
+#include "varray.h"
+
+/**
+ @file
+
+ Trigram index of the keys of a tag file.
+
+ A regular expression which is not anchored by a literal prefix (for example,
+ @CODE{global -x 'lock.*acquire'}) cannot use the B-tree, and every key of
+ the tag file is examined by regexec(3). The index tells the keys which
+ contain all the trigrams (three consecutive bytes) of the literal strings
+ which every match of the pattern contains. Only those keys are read and
+ examined by regexec(3) as usual.
+
+ The index of a tag file is written next to it (@FILE{GTAGS.trigram},
+ @FILE{GRTAGS.trigram}) by trigram_make() when the tag file is made, if the
+ @CODE{trigram_index} variable of @FILE{gtags.conf} is set:
+
+ @code{.txt}
+ GLOBAL-TRIGRAM 3 <nkeys> <ntrigrams> <nextra> <extrasize> <size> <inode> <generation>\n
+ <trigram table>	ntrigrams x (<trigram> <offset> <count>)
+ <key offsets>		(nkeys + 1) x <offset>
+ <keys>			the keys in the order of the tag file (without '\0')
+ <posting lists>	the key numbers of each trigram
+ <extra keys>		nextra x <key> '\0' (extrasize bytes)
+ @endcode
+
+ The numbers of the tables are 4 bytes each, in big endian. The offsets are
+ relative to the head of the keys or the posting lists. A posting list is a
+ sequence of variable length integers (the same as @FILE{GLINES}) which are
+ the differences between the key numbers in ascending order.
+
+ The trigrams are folded to lower case (ASCII only), so that the index can be
+ used with the @OPTION{-i} option too. Like the key filter (see libutil/bloom.c),
+ the size and the inode number of the tag file are recorded in the header,
+ and the index is not used if they don't match the opened tag file. Since
+ another tag file may have the same size and inode number, the generation
+ number recorded in the tag file by dbop_close() (#GENERATIONKEY) must also
+ match.
+
+ When the tag file is updated, the index is not made again. The keys added
+ to the tag file are appended to the extra keys by trigram_update(), which
+ are always candidates if they contain the trigrams. The keys removed from
+ the tag file are left in the index, and are simply not found as candidates.
+ */
+#define TRIGRAM_MAGIC	"GLOBAL-TRIGRAM"
+#define TRIGRAM_VERSION	3
+/**
+ * If the extra keys are more than 1/#TRIGRAM_EXTRA_RATIO of the keys
+ * (and #TRIGRAM_MINEXTRA), the index is made again.
+ */
+#define TRIGRAM_EXTRA_RATIO	16
+#define TRIGRAM_MINEXTRA	256
+/**
+ * If the shortest posting list has more than 1/#TRIGRAM_RATIO of the keys,
+ * the index is not used, since reading all the keys is as fast.
+ */
+#define TRIGRAM_RATIO	4
+
+#define FOLD(c)		((c) >= 'A' && (c) <= 'Z' ? (c) - 'A' + 'a' : (c))
+#define TRIGRAM(p)	(FOLD((p)[0]) << 16 | FOLD((p)[1]) << 8 | FOLD((p)[2]))
+
+/**
+ * Kinds of the characters of a regular expression (see required_literals()).
+ */
+#define LITERAL		0	/**< literal character */
+#define BREAK		1	/**< anything else */
+#define OPTIONAL	2	/**< the previous character may be absent */
+#define REPEAT		3	/**< the previous character may be repeated */
+#define ALTERNATE	4	/**< alternation */
+
+static void
+put_int(unsigned char *b, unsigned int n)
+{
+	b[0] = n >> 24;
+	b[1] = n >> 16;
+	b[2] = n >> 8;
+	b[3] = n;
+}
+static unsigned int
+get_int(const unsigned char *b)
+{
+	return (unsigned int)b[0] << 24 | (unsigned int)b[1] << 16 | (unsigned int)b[2] << 8 | b[3];
+}
+static int
+read_int(FILE *ip, long offset, unsigned int *n)
+{
+	unsigned char b[4];
+
+	if (fseek(ip, offset, SEEK_SET) < 0 || fread(b, 1, 4, ip) != 4)
+		return -1;
+	*n = get_int(b);
+	return 0;
+}
+static void
+put_number(STRBUF *sb, unsigned int n)
+{
+	while (n >= 0x80) {
+		strbuf_putc(sb, (n & 0x7f) | 0x80);
+		n >>= 7;
+	}
+	strbuf_putc(sb, n);
+}
+static int
+get_number(FILE *ip, unsigned int *n)
+{
+	unsigned int v = 0;
+	int c, shift = 0;
+
+	while ((c = getc(ip)) != EOF && c & 0x80) {
+		v |= (unsigned int)(c & 0x7f) << shift;
+		shift += 7;
+	}
+	if (c == EOF)
+		return -1;
+	*n = v | (unsigned int)c << shift;
+	return 0;
+}
+static int
+compare_trigram(const void *v1, const void *v2)
+{
+	unsigned int t1 = *(const unsigned int *)v1;
+	unsigned int t2 = *(const unsigned int *)v2;
+
+	return t1 < t2 ? -1 : t1 > t2 ? 1 : 0;
+}
+static int
+compare_entry(const void *v1, const void *v2)
+{
+	return compare_trigram(&((const TRIGRAM_ENTRY *)v1)->trigram, &((const TRIGRAM_ENTRY *)v2)->trigram);
+}
+static int
+compare_count(const void *v1, const void *v2)
+{
+	const TRIGRAM_ENTRY *e1 = *(const TRIGRAM_ENTRY **)v1;
+	const TRIGRAM_ENTRY *e2 = *(const TRIGRAM_ENTRY **)v2;
+
+	return e1->count < e2->count ? -1 : e1->count > e2->count ? 1 : 0;
+}
+static int
+compare_key(const void *s1, const void *s2)
+{
+	return strcmp(*(const char **)s1, *(const char **)s2);
+}
+static const char *
+trigram_path(const char *tagfile)
+{
+	static char path[MAXPATHLEN];
+
+	if (strlen(tagfile) + sizeof(TRIGRAM_SUFFIX) > sizeof(path))
+		die("path name too long.");
+	strlimcpy(path, tagfile, sizeof(path));
+	strcat(path, TRIGRAM_SUFFIX);
+	return path;
+}
+/**
+ * skip_bracket: skip a bracket expression.
+ *
+ *	@param[in]	p	the next of '['
+ *	@return		the next of ']'
+ */
+static const unsigned char *
+skip_bracket(const unsigned char *p)
+{
+	if (*p == '^')
+		p++;
+	if (*p == ']')
+		p++;
+	while (*p && *p != ']') {
+		if (*p == '[' && (p[1] == ':' || p[1] == '.' || p[1] == '=')) {
+			int delim = p[1];
+
+			for (p += 2; *p && !(*p == delim && p[1] == ']'); p++)
+				;
+			if (*p)
+				p += 2;
+		} else
+			p++;
+	}
+	if (*p)
+		p++;
+	return p;
+}
+/**
+ * skip_group: skip a group.
+ *
+ *	@param[in]	p	the next of '(' (or '\\(')
+ *	@param[in]	extended	1: extended regular expression
+ *	@return		the next of the matching ')' (or '\\)')
+ */
+static const unsigned char *
+skip_group(const unsigned char *p, int extended)
+{
+	int depth = 1;
+
+	while (*p && depth > 0) {
+		if (*p == '[') {
+			p = skip_bracket(p + 1);
+		} else if (*p == '\\') {
+			if (!p[1])
+				return p + 1;
+			if (!extended && p[1] == '(')
+				depth++;
+			else if (!extended && p[1] == ')')
+				depth--;
+			p += 2;
+		} else {
+			if (extended && *p == '(')
+				depth++;
+			else if (extended && *p == ')')
+				depth--;
+			p++;
+		}
+	}
+	return p;
+}
+/**
+ * skip_interval: skip an interval expression.
+ *
+ *	@param[in]	p	the next of '{' (or '\\{')
+ *	@param[in]	extended	1: extended regular expression
+ *	@return		the next of '}' (or '\\}')
+ */
+static const unsigned char *
+skip_interval(const unsigned char *p, int extended)
+{
+	if (extended) {
+		while (*p && *p != '}')
+			p++;
+		return *p ? p + 1 : p;
+	}
+	while (*p && !(*p == '\\' && p[1] == '}'))
+		p++;
+	return *p ? p + 2 : p;
+}
+/**
+ * flush_literal: end a literal string.
+ *
+ *	@param[in]	run	literal string
+ *	@param[out]	sb	literal strings
+ *	@param[in]	optional	1: the last character is optional
+ *
+ * The last character is removed with its continuation bytes of UTF-8,
+ * since the quantifier may apply to a multibyte character.
+ */
+static void
+flush_literal(STRBUF *run, STRBUF *sb, int optional)
+{
+	const unsigned char *s = (const unsigned char *)strbuf_value(run);
+	int len = strbuf_getlen(run);
+
+	if (optional) {
+		while (len > 0 && (s[len - 1] & 0xc0) == 0x80)
+			len--;
+		if (len > 0)
+			len--;
+	}
+	if (len >= 3) {
+		strbuf_nputs(sb, (const char *)s, len);
+		strbuf_putc(sb, '\0');
+	}
+	strbuf_reset(run);
+}
+/**
+ * required_literals: get the literal strings which every match of a
+ * regular expression contains.
+ *
+ *	@param[in]	pattern	regular expression
+ *	@param[in]	regflags	#REG_EXTENDED, #REG_ICASE
+ *	@param[out]	sb	literal strings (each terminated by '\0')
+ *	@return		0: normal, -1: the pattern has an alternation
+ *
+ * Only the literal characters at the top level are taken. Groups, bracket
+ * expressions, back references and the like end a literal string, and a
+ * character followed by a quantifier which allows zero is dropped. It is
+ * a subset of what every match contains, which is all that is needed.
+ * Strings shorter than three bytes are not returned.
+ */
+static int
+required_literals(const char *pattern, int regflags, STRBUF *sb)
+{
+	const unsigned char *p = (const unsigned char *)pattern;
+	int extended = (regflags & REG_EXTENDED) ? 1 : 0;
+	int icase = (regflags & REG_ICASE) ? 1 : 0;
+	STRBUF *run = strbuf_open(0);
+	int c, kind;
+
+	strbuf_reset(sb);
+	while ((c = *p++) != '\0') {
+		if (c == '\\') {
+			if ((c = *p) == '\0')
+				break;
+			p++;
+			if (!extended && c == '(') {
+				p = skip_group(p, 0);
+				kind = BREAK;
+			} else if (!extended && c == '{') {
+				p = skip_interval(p, 0);
+				kind = OPTIONAL;
+			} else if (!extended && c == '?') {
+				kind = OPTIONAL;
+			} else if (!extended && c == '+') {
+				kind = REPEAT;
+			} else if (!extended && c == '|') {
+				kind = ALTERNATE;
+			} else if (!extended && (c == ')' || c == '}')) {
+				kind = BREAK;
+			} else if (isalnum(c) || strchr("<>`'", c)) {
+				/* \w, \b, \1 and so on */
+				kind = BREAK;
+			} else {
+				kind = LITERAL;
+			}
+		} else if (c == '[') {
+			p = skip_bracket(p);
+			kind = BREAK;
+		} else if (c == '.' || c == '^' || c == '$') {
+			kind = BREAK;
+		} else if (c == '*') {
+			kind = OPTIONAL;
+		} else if (extended && c == '(') {
+			p = skip_group(p, 1);
+			kind = BREAK;
+		} else if (extended && c == '{') {
+			p = skip_interval(p, 1);
+			kind = OPTIONAL;
+		} else if (extended && c == '?') {
+			kind = OPTIONAL;
+		} else if (extended && c == '+') {
+			kind = REPEAT;
+		} else if (extended && c == '|') {
+			kind = ALTERNATE;
+		} else if (extended && c == ')') {
+			kind = BREAK;
+		} else {
+			kind = LITERAL;
+		}
+		/*
+		 * The case of non-ASCII characters may be ignored in a way
+		 * which the index doesn't know.
+		 */
+		if (kind == LITERAL && icase && c >= 0x80)
+			kind = BREAK;
+		if (kind == ALTERNATE) {
+			strbuf_close(run);
+			return -1;
+		}
+		if (kind == LITERAL)
+			strbuf_putc(run, c);
+		else
+			flush_literal(run, sb, kind == OPTIONAL);
+	}
+	flush_literal(run, sb, 0);
+	strbuf_close(run);
+	return 0;
+}
+/**
+ * trigram_open: load the trigram index of a tag file.
+ *
+ *	@param[in]	tagfile	path of the tag file
+ *	@param[in]	fd	file descriptor of the opened tag file
+ *	@param[in]	generation	generation number of the opened tag file
+ *	@return		#TRIGRAM structure, or @VAR{NULL} if the index doesn't exist or is out of date
+ *
+ * Only the trigram table is loaded. The keys and the posting lists are read
+ * when they are needed.
+ */
+TRIGRAM *
+trigram_open(const char *tagfile, int fd, unsigned long generation)
+{
+	TRIGRAM *tg;
+	FILE *ip;
+	struct stat st;
+	char header[128], magic[32];
+	unsigned char b[12];
+	unsigned int nkeys, ntrigrams, nextra, extrasize, i, keysize;
+	unsigned long gen;
+	long size, ino;
+	int version;
+
+	if (fd < 0 || fstat(fd, &st) < 0 || generation == 0)
+		return NULL;
+	if ((ip = fopen(trigram_path(tagfile), "rb")) == NULL)
+		return NULL;
+	if (fgets(header, sizeof(header), ip) == NULL
+	    || sscanf(header, "%31s %d %u %u %u %u %ld %ld %lu", magic, &version,
+			&nkeys, &ntrigrams, &nextra, &extrasize, &size, &ino, &gen) != 9
+	    || strcmp(magic, TRIGRAM_MAGIC) || version != TRIGRAM_VERSION
+	    || size != (long)st.st_size || ino != (long)st.st_ino || gen != generation) {
+		fclose(ip);
+		return NULL;
+	}
+	tg = (TRIGRAM *)check_calloc(sizeof(TRIGRAM), 1);
+	tg->ip = ip;
+	tg->nkeys = nkeys;
+	tg->ntrigrams = ntrigrams;
+	tg->nextra = nextra;
+	tg->extra = strbuf_open(extrasize);
+	tg->table = (TRIGRAM_ENTRY *)check_malloc(sizeof(TRIGRAM_ENTRY) * (ntrigrams + 1));
+	for (i = 0; i < ntrigrams; i++) {
+		if (fread(b, 1, sizeof(b), ip) != sizeof(b)) {
+			trigram_close(tg);
+			return NULL;
+		}
+		tg->table[i].trigram = get_int(b);
+		tg->table[i].offset = get_int(b + 4);
+		tg->table[i].count = get_int(b + 8);
+	}
+	tg->keyoffsets = ftell(ip);
+	tg->keys = tg->keyoffsets + 4 * ((long)nkeys + 1);
+	if (read_int(ip, tg->keys - 4, &keysize) < 0) {
+		trigram_close(tg);
+		return NULL;
+	}
+	tg->postings = tg->keys + keysize;
+	/*
+	 * The extra keys are at the end of the file.
+	 */
+	if (fstat(fileno(ip), &st) < 0 || (long)st.st_size < (long)extrasize
+	    || fseek(ip, (long)st.st_size - extrasize, SEEK_SET) < 0) {
+		trigram_close(tg);
+		return NULL;
+	}
+	tg->extras = (long)st.st_size - extrasize;
+	while (extrasize > 0) {
+		char buf[BUFSIZ];
+		size_t n = fread(buf, 1, extrasize < sizeof(buf) ? extrasize : sizeof(buf), ip);
+
+		if (n == 0) {
+			trigram_close(tg);
+			return NULL;
+		}
+		strbuf_nputs(tg->extra, buf, n);
+		extrasize -= n;
+	}
+	return tg;
+}
+/**
+ * has_trigrams: check whether a key contains all the trigrams.
+ *
+ *	@param[in]	key	key
+ *	@param[in]	tv	trigrams
+ *	@return		1: contains, 0: doesn't contain
+ */
+static int
+has_trigrams(const char *key, VARRAY *tv)
+{
+	const unsigned char *k = (const unsigned char *)key;
+	unsigned int trigram;
+	int i, n;
+
+	for (i = 0; i < tv->length; i++) {
+		trigram = *(unsigned int *)varray_assign(tv, i, 0);
+		for (n = 0; k[n] && k[n + 1] && k[n + 2]; n++)
+			if (TRIGRAM(k + n) == trigram)
+				break;
+		if (!(k[n] && k[n + 1] && k[n + 2]))
+			return 0;
+	}
+	return 1;
+}
+/**
+ * add_extra: add the extra keys which contain the trigrams to the candidates.
+ *
+ *	@param[in]	tg	#TRIGRAM structure
+ *	@param[in]	tv	trigrams
+ *	@param[in,out]	cand	candidate keys in the order of the tag file
+ *
+ * Both the candidates and the extra keys are sorted, and are merged.
+ */
+static void
+add_extra(TRIGRAM *tg, VARRAY *tv, STRBUF *cand)
+{
+	STRBUF *sb = strbuf_open(strbuf_getlen(cand));
+	const char *p = strbuf_value(cand), *pend = p + strbuf_getlen(cand);
+	const char *q = strbuf_value(tg->extra), *qend = q + strbuf_getlen(tg->extra);
+	int cmp;
+
+	while (p < pend || q < qend) {
+		if (q < qend && !has_trigrams(q, tv)) {
+			q += strlen(q) + 1;
+			continue;
+		}
+		cmp = p >= pend ? 1 : q >= qend ? -1 : strcmp(p, q);
+		if (cmp <= 0) {
+			strbuf_puts0(sb, p);
+			p += strlen(p) + 1;
+			if (cmp == 0)
+				q += strlen(q) + 1;
+		} else {
+			strbuf_puts0(sb, q);
+			q += strlen(q) + 1;
+		}
+	}
+	strbuf_reset(cand);
+	strbuf_nputs(cand, strbuf_value(sb), strbuf_getlen(sb));
+	strbuf_close(sb);
+}
+/**
+ * trigram_search: get the candidate keys for a regular expression.
+ *
+ *	@param[in]	tg	#TRIGRAM structure
+ *	@param[in]	pattern	regular expression
+ *	@param[in]	regflags	flags for regcomp(3)
+ *	@param[out]	cand	candidate keys (each terminated by '\0') in the order of the tag file
+ *	@return		0: normal, -1: the index cannot narrow the keys
+ *
+ * Every key which matches the pattern is in @a cand. The candidates must be
+ * examined by regexec(3) with the pattern. The extra keys which contain all
+ * the trigrams are added to the candidates from the index.
+ */
+int
+trigram_search(TRIGRAM *tg, const char *pattern, int regflags, STRBUF *cand)
+{
+	STRBUF *sb = strbuf_open(0);
+	VARRAY *tv = varray_open(sizeof(unsigned int), 32);
+	VARRAY *ev = varray_open(sizeof(TRIGRAM_ENTRY *), 32);
+	VARRAY *kv = NULL;
+	TRIGRAM_ENTRY key, *entry, **entries;
+	const char *p, *end;
+	unsigned int *keys, i, j, n, w, number, start, stop;
+	char buf[MAXKEYLEN + 1];
+	int status = -1;
+
+	strbuf_reset(cand);
+	if (required_literals(pattern, regflags, sb) < 0)
+		goto out;
+	p = strbuf_value(sb);
+	end = p + strbuf_getlen(sb);
+	for (; p < end; p += strlen(p) + 1)
+		for (i = 0; p[i + 2]; i++)
+			*(unsigned int *)varray_append(tv) = TRIGRAM((const unsigned char *)p + i);
+	if (tv->length == 0)
+		goto out;
+	/*
+	 * If a trigram is not in the index, no key matches.
+	 */
+	qsort(varray_assign(tv, 0, 0), tv->length, sizeof(unsigned int), compare_trigram);
+	for (i = 0; i < tv->length; i++) {
+		key.trigram = *(unsigned int *)varray_assign(tv, i, 0);
+		if (i > 0 && key.trigram == *(unsigned int *)varray_assign(tv, i - 1, 0))
+			continue;
+		entry = (TRIGRAM_ENTRY *)bsearch(&key, tg->table, tg->ntrigrams, sizeof(TRIGRAM_ENTRY), compare_entry);
+		if (entry == NULL) {
+			status = 0;
+			goto out;
+		}
+		*(TRIGRAM_ENTRY **)varray_append(ev) = entry;
+	}
+	/*
+	 * Intersect the posting lists from the shortest one.
+	 */
+	entries = (TRIGRAM_ENTRY **)varray_assign(ev, 0, 0);
+	qsort(entries, ev->length, sizeof(TRIGRAM_ENTRY *), compare_count);
+	if (entries[0]->count > tg->nkeys / TRIGRAM_RATIO)
+		goto out;
+	kv = varray_open(sizeof(unsigned int), 256);
+	keys = NULL;
+	n = 0;
+	for (i = 0; i < ev->length; i++) {
+		unsigned int k = 0;
+
+		if (fseek(tg->ip, tg->postings + entries[i]->offset, SEEK_SET) < 0)
+			goto out;
+		number = 0;
+		for (j = w = 0; j < entries[i]->count; j++) {
+			unsigned int diff;
+
+			if (get_number(tg->ip, &diff) < 0)
+				goto out;
+			number += diff;
+			if (i == 0) {
+				*(unsigned int *)varray_assign(kv, w++, 1) = number;
+				continue;
+			}
+			/*
+			 * Keep the candidates which are also in this list.
+			 */
+			while (k < n && keys[k] < number)
+				k++;
+			if (k >= n)
+				break;
+			if (keys[k] == number)
+				keys[w++] = keys[k++];
+		}
+		n = w;
+		if (n == 0)
+			break;
+		keys = (unsigned int *)varray_assign(kv, 0, 0);
+	}
+	/*
+	 * Read the candidate keys.
+	 */
+	for (i = 0; i < n; i++) {
+		if (read_int(tg->ip, tg->keyoffsets + 4 * (long)keys[i], &start) < 0
+		    || read_int(tg->ip, tg->keyoffsets + 4 * (long)keys[i] + 4, &stop) < 0
+		    || stop < start || stop - start > MAXKEYLEN
+		    || fseek(tg->ip, tg->keys + start, SEEK_SET) < 0
+		    || fread(buf, 1, stop - start, tg->ip) != stop - start)
+			goto out;
+		strbuf_nputs(cand, buf, stop - start);
+		strbuf_putc(cand, '\0');
+	}
+	status = 0;
+out:
+	if (status == 0 && tg->nextra > 0)
+		add_extra(tg, tv, cand);
+	if (status < 0)
+		strbuf_reset(cand);
+	strbuf_close(sb);
+	varray_close(tv);
+	varray_close(ev);
+	if (kv)
+		varray_close(kv);
+	return status;
+}
+/**
+ * trigram_close: free the trigram index.
+ *
+ *	@param[in]	tg	#TRIGRAM structure
+ */
+void
+trigram_close(TRIGRAM *tg)
+{
+	fclose(tg->ip);
+	free(tg->table);
+	if (tg->extra)
+		strbuf_close(tg->extra);
+	free(tg);
+}
+/**
+ * trigram_make: make the trigram index of a tag file.
+ *
+ *	@param[in]	tagfile	path of the tag file to read (must be closed)
+ *	@param[in]	name	path of the tag file which the index is for. <br>
+ *			It differs from @a tagfile when the tag file is a shadow.
+ *	@param[in]	generation	generation number of the tag file
+ *
+ * The pairs of a trigram and a key number are sorted by extsort_xxx().
+ * The index is written to its shadow and is published with the tag file
+ * (see dbop_pending()), so a reader never sees a half-written one.
+ */
+void
+trigram_make(const char *tagfile, const char *name, unsigned long generation)
+{
+	DBOP *dbop;
+	EXTSORT *es;
+	STRBUF *keys, *postings;
+	VARRAY *offsets, *table;
+	TRIGRAM_ENTRY *entry = NULL;
+	FILE *op;
+	struct stat st;
+	unsigned int trigrams[MAXKEYLEN], nkeys, number, last = 0;
+	unsigned char b[12];
+	int i, n, len, sortbuf = GTAGSSORTBUF;
+	const char *key, *data;
+	char path[MAXPATHLEN];
+
+	if (getenv("GTAGSSORTBUF") != NULL)
+		sortbuf = atoi(getenv("GTAGSSORTBUF"));
+	if (sortbuf < GTAGSMINSORTBUF)
+		sortbuf = GTAGSMINSORTBUF;
+	if ((dbop = dbop_open(tagfile, 0, 0, 0)) == NULL)
+		die("%s not found.", tagfile);
+	es = extsort_open(sortbuf);
+	keys = strbuf_open(0);
+	offsets = varray_open(sizeof(unsigned int), 1024);
+	nkeys = 0;
+	for (key = dbop_first(dbop, NULL, NULL, DBOP_KEY); key; key = dbop_next(dbop)) {
+		const unsigned char *k = (const unsigned char *)key;
+		char trigram[4];
+
+		*(unsigned int *)varray_append(offsets) = strbuf_getlen(keys);
+		strbuf_puts(keys, key);
+		/*
+		 * Each trigram of a key is counted once.
+		 */
+		for (n = 0; k[n] && k[n + 1] && k[n + 2]; n++)
+			trigrams[n] = TRIGRAM(k + n);
+		qsort(trigrams, n, sizeof(unsigned int), compare_trigram);
+		put_int(b, nkeys);
+		for (i = 0; i < n; i++) {
+			if (i > 0 && trigrams[i] == trigrams[i - 1])
+				continue;
+			trigram[0] = trigrams[i] >> 16;
+			trigram[1] = trigrams[i] >> 8;
+			trigram[2] = trigrams[i];
+			trigram[3] = '\0';
+			extsort_put(es, trigram, (const char *)b, 4);
+		}
+		nkeys++;
+	}
+	*(unsigned int *)varray_append(offsets) = strbuf_getlen(keys);
+	dbop_close(dbop);
+	/*
+	 * Make the posting lists. The key numbers of a trigram come in
+	 * ascending order, since the records are sorted by the data too.
+	 */
+	table = varray_open(sizeof(TRIGRAM_ENTRY), 1024);
+	postings = strbuf_open(0);
+	while ((key = extsort_get(es, &data, &len)) != NULL) {
+		const unsigned char *k = (const unsigned char *)key;
+		unsigned int trigram = k[0] << 16 | k[1] << 8 | k[2];
+
+		number = get_int((const unsigned char *)data);
+		if (entry == NULL || entry->trigram != trigram) {
+			entry = (TRIGRAM_ENTRY *)varray_append(table);
+			entry->trigram = trigram;
+			entry->offset = strbuf_getlen(postings);
+			entry->count = 0;
+			last = 0;
+		}
+		put_number(postings, number - last);
+		last = number;
+		entry->count++;
+	}
+	extsort_close(es);
+	if (stat(tagfile, &st) < 0)
+		die("cannot stat '%s'.", tagfile);
+	strlimcpy(path, dbop_pending(trigram_path(name)), sizeof(path));
+	if ((op = fopen(path, "wb")) == NULL)
+		die("cannot make '%s'.", path);
+	fprintf(op, "%s %d %u %u 0 0 %ld %ld %lu\n", TRIGRAM_MAGIC, TRIGRAM_VERSION,
+		nkeys, (unsigned int)table->length, (long)st.st_size, (long)st.st_ino, generation);
+	for (i = 0; i < table->length; i++) {
+		entry = (TRIGRAM_ENTRY *)varray_assign(table, i, 0);
+		put_int(b, entry->trigram);
+		put_int(b + 4, entry->offset);
+		put_int(b + 8, entry->count);
+		fwrite(b, 1, 12, op);
+	}
+	for (i = 0; i < offsets->length; i++) {
+		put_int(b, *(unsigned int *)varray_assign(offsets, i, 0));
+		fwrite(b, 1, 4, op);
+	}
+	fwrite(strbuf_value(keys), 1, strbuf_getlen(keys), op);
+	fwrite(strbuf_value(postings), 1, strbuf_getlen(postings), op);
+	if (ferror(op) || fclose(op) != 0)
+		die("cannot write '%s'.", path);
+	strbuf_close(keys);
+	strbuf_close(postings);
+	varray_close(offsets);
+	varray_close(table);
+}
+/**
+ * trigram_update: update the trigram index of a tag file for the added keys.
+ *
+ *	@param[in]	tagfile	path of the updated tag file to read (must be closed)
+ *	@param[in]	name	path of the tag file which the index is for. <br>
+ *			The tag file itself must not be replaced yet.
+ *	@param[in]	added	keys added to the tag file (each terminated by '\0')
+ *	@param[in]	oldgen	generation number of the tag file before the update
+ *	@param[in]	generation	generation number of the updated tag file
+ *
+ * The added keys are merged into the extra keys of the index of the tag file
+ * before the update, and the rest of the index is copied as it is. If the
+ * index is out of date, or the extra keys become too many, the index is made
+ * again by trigram_make().
+ */
+void
+trigram_update(const char *tagfile, const char *name, STRBUF *added, unsigned long oldgen, unsigned long generation)
+{
+	TRIGRAM *tg;
+	VARRAY *vb;
+	STRBUF *extra;
+	FILE *op;
+	struct stat st;
+	const char *p, *end, **keys;
+	char path[MAXPATHLEN], buf[BUFSIZ];
+	long body, rest;
+	unsigned int nextra;
+	int i, fd;
+
+	if ((fd = open(name, O_RDONLY)) < 0) {
+		trigram_make(tagfile, name, generation);
+		return;
+	}
+	tg = trigram_open(name, fd, oldgen);
+	close(fd);
+	if (tg == NULL) {
+		trigram_make(tagfile, name, generation);
+		return;
+	}
+	/*
+	 * Merge the added keys into the extra keys.
+	 */
+	vb = varray_open(sizeof(char *), 256);
+	p = strbuf_value(tg->extra);
+	end = p + strbuf_getlen(tg->extra);
+	for (; p < end; p += strlen(p) + 1)
+		*(const char **)varray_append(vb) = p;
+	p = strbuf_value(added);
+	end = p + strbuf_getlen(added);
+	for (; p < end; p += strlen(p) + 1)
+		*(const char **)varray_append(vb) = p;
+	if (vb->length > TRIGRAM_MINEXTRA && vb->length > tg->nkeys / TRIGRAM_EXTRA_RATIO) {
+		varray_close(vb);
+		trigram_close(tg);
+		trigram_make(tagfile, name, generation);
+		return;
+	}
+	keys = (const char **)varray_assign(vb, 0, 0);
+	qsort(keys, vb->length, sizeof(char *), compare_key);
+	extra = strbuf_open(0);
+	nextra = 0;
+	for (i = 0; i < vb->length; i++) {
+		if (i > 0 && !strcmp(keys[i], keys[i - 1]))
+			continue;
+		strbuf_puts0(extra, keys[i]);
+		nextra++;
+	}
+	varray_close(vb);
+	/*
+	 * Write the new header, the rest of the index and the extra keys.
+	 */
+	if (stat(tagfile, &st) < 0)
+		die("cannot stat '%s'.", tagfile);
+	strlimcpy(path, dbop_pending(trigram_path(name)), sizeof(path));
+	if ((op = fopen(path, "wb")) == NULL)
+		die("cannot make '%s'.", path);
+	fprintf(op, "%s %d %u %u %u %u %ld %ld %lu\n", TRIGRAM_MAGIC, TRIGRAM_VERSION,
+		tg->nkeys, tg->ntrigrams, nextra, (unsigned int)strbuf_getlen(extra),
+		(long)st.st_size, (long)st.st_ino, generation);
+	body = tg->keyoffsets - 12 * (long)tg->ntrigrams;
+	if (fseek(tg->ip, body, SEEK_SET) < 0)
+		die("cannot read '%s'.", trigram_path(name));
+	for (rest = tg->extras - body; rest > 0; rest -= i) {
+		i = fread(buf, 1, rest < sizeof(buf) ? rest : sizeof(buf), tg->ip);
+		if (i <= 0)
+			die("cannot read '%s'.", trigram_path(name));
+		fwrite(buf, 1, i, op);
+	}
+	fwrite(strbuf_value(extra), 1, strbuf_getlen(extra), op);
+	if (ferror(op) || fclose(op) != 0)
+		die("cannot write '%s'.", path);
+	strbuf_close(extra);
+	trigram_close(tg);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 Tama Communications Corporation
+ *
+ * This file is part of GNU GLOBAL.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TRIGRAM_H_
+#define _TRIGRAM_H_
+
+#include <stdio.h>
+
+#include "strbuf.h"
+
+/**
+ * Suffix of the trigram index file of a tag file.
+ */
+#define TRIGRAM_SUFFIX	".trigram"
+
+/**
+ * An entry of the trigram table.
+ */
+typedef struct {
+	unsigned int trigram;		/**< three bytes (folded to lower case) */
+	unsigned int offset;		/**< offset of the posting list */
+	unsigned int count;		/**< number of keys in the posting list */
+} TRIGRAM_ENTRY;
+
+typedef struct {
+	FILE *ip;			/**< index file */
+	unsigned int nkeys;		/**< number of keys */
+	unsigned int ntrigrams;		/**< number of trigrams */
+	TRIGRAM_ENTRY *table;		/**< trigram table (sorted) */
+	long keyoffsets;		/**< position of the key offsets */
+	long keys;			/**< position of the keys */
+	long postings;			/**< position of the posting lists */
+	unsigned int nextra;		/**< number of extra keys */
+	long extras;			/**< position of the extra keys */
+	STRBUF *extra;			/**< extra keys (each terminated by '\0', sorted) */
+} TRIGRAM;
+
+TRIGRAM *trigram_open(const char *, int, unsigned long);
+int trigram_search(TRIGRAM *, const char *, int, STRBUF *);
+void trigram_close(TRIGRAM *);
+void trigram_make(const char *, const char *, unsigned long);
+void trigram_update(const char *, const char *, STRBUF *, unsigned long, unsigned long);
+
+#endif /* ! _TRIGRAM_H_ */
@@ -0,0 +1,246 @@
+#!/bin/sh
+#
+# Copyright (c) 2026 Tama Communications Corporation
+#
+# This file is part of GNU GLOBAL.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Check gtags and global on a small source tree.
+#
+# usage: check.sh [bindir]
+#
+#	bindir	top of the build directory (default .)
+#
+# The work directory (check.work) is removed if all checks pass.
+# Otherwise it is left for investigation and the exit status is 1.
+#
+bindir=`cd ${1:-.} && pwd`
+gtags=$bindir/gtags/gtags
+global=$bindir/global/global
+for p in $gtags $global; do
+	if [ ! -x $p ]; then
+		echo "check.sh: '$p' not found. Please build GLOBAL first." >&2
+		exit 1
+	fi
+done
+unset GTAGSLABEL GTAGSROOT GTAGSDBPATH GTAGSLIBPATH
+work=`pwd`/check.work
+rm -rf $work
+mkdir -p $work/src/lib $work/src/cmd || exit 1
+cd $work || exit 1
+echo 'default:' > plain.conf
+echo 'default:trigram_index:icase_index:' > index.conf
+GTAGSCONF=$work/plain.conf
+export GTAGSCONF
+
+cat > src/lib/util.c <<'EOF'
+int
+foo_bar(int x)
+{
+    return x + 1;
+}
+int
+Foo_Bar(int x)
+{
+    return foo_bar(x) * 2;
+}
+EOF
+cat > src/cmd/main.c <<'EOF'
+extern int foo_bar(int);
+int FOO_BAR = 3;
+int
+main(void)
+{
+    return foo_bar(FOO_BAR) + Foo_Bar(0) + helper();
+}
+EOF
+cat > src/helper.c <<'EOF'
+int
+helper(void)
+{
+    return foo_bar(1);
+}
+EOF
+
+failed=0
+pass() {
+	echo "PASS: $1"
+}
+fail() {
+	echo "FAIL: $1"
+	failed=1
+}
+# compare the output of a command with the expected one in 'expected'.
+expect() {
+	name=$1
+	shift
+	(cd src && "$@") > output 2>&1
+	if diff expected output > /dev/null; then
+		pass "$name"
+	else
+		fail "$name"
+		diff expected output
+	fi
+}
+# dump the tag files in the current directory.
+dump() {
+	for f in GPATH GTAGS GRTAGS; do
+		$gtags -d $f || return 1
+	done
+}
+# the results of the queries which are compared in some checks.
+queries() {
+	$global -xa '.*'
+	$global -rxa '.*'
+	$global -sxa '.*'
+	$global -x 'o_[bB]'
+	$global -xi 'o.b'
+	$global -rxi 'O.B'
+	$global -ci 'FO'
+}
+
+#
+# Round trip: make tag files and look up the symbols.
+#
+(cd src && $gtags -q) || fail "gtags"
+cat > expected <<'EOF'
+foo_bar             2 lib/util.c       foo_bar(int x)
+EOF
+expect "definition" $global -x foo_bar
+cat > expected <<'EOF'
+foo_bar             1 cmd/main.c       extern int foo_bar(int);
+foo_bar             6 cmd/main.c           return foo_bar(FOO_BAR) + Foo_Bar(0) + helper();
+foo_bar             4 helper.c             return foo_bar(1);
+foo_bar             9 lib/util.c           return foo_bar(x) * 2;
+EOF
+expect "reference" $global -rx foo_bar
+cat > expected <<'EOF'
+FOO_BAR             2 cmd/main.c       int FOO_BAR = 3;
+FOO_BAR             6 cmd/main.c           return foo_bar(FOO_BAR) + Foo_Bar(0) + helper();
+EOF
+expect "other symbol" $global -sx FOO_BAR
+cat > expected <<'EOF'
+foo_bar
+EOF
+expect "completion" $global -c fo
+
+#
+# The tag files made with --jobs are the same as those made serially.
+#
+(cd src && $gtags -q && dump) > dump.serial 2>&1
+(cd src && $gtags -q --jobs=3 && dump) > dump.jobs 2>&1
+if cmp -s dump.serial dump.jobs; then
+	pass "jobs"
+else
+	fail "jobs"
+	diff dump.serial dump.jobs
+fi
+
+#
+# gtags -i just after gtags doesn't change the tag files.
+#
+rm -rf saved
+mkdir saved
+(cd src && $gtags -q) && cp src/G* saved/
+(cd src && $gtags -qi) || fail "gtags -i"
+status=0
+for f in saved/*; do
+	cmp -s $f src/`basename $f` || status=1
+done
+[ `ls src/G* | wc -l` -eq `ls saved | wc -l` ] || status=1
+if [ $status = 0 ]; then
+	pass "gtags -i"
+else
+	fail "gtags -i"
+fi
+
+#
+# Sharded tag files give the same results as unsharded ones.
+#
+(cd src && queries) > queries.unsharded 2>&1
+(cd src && $gtags -q --shard && queries) > queries.sharded 2>&1
+if [ ! -d src/GSHARDS ]; then
+	fail "shard"
+elif cmp -s queries.unsharded queries.sharded; then
+	pass "shard"
+else
+	fail "shard"
+	diff queries.unsharded queries.sharded
+fi
+
+#
+# Regular expressions which are not anchored.
+#
+(cd src && $gtags -q) || fail "gtags"
+cat > expected <<'EOF'
+Foo_Bar             7 lib/util.c       Foo_Bar(int x)
+foo_bar             2 lib/util.c       foo_bar(int x)
+EOF
+expect "regex" $global -x 'o_[bB]'
+expect "regex at the end" $global -x 'ar$'
+cat > expected <<'EOF'
+foo_bar             1 cmd/main.c       extern int foo_bar(int);
+foo_bar             6 cmd/main.c           return foo_bar(FOO_BAR) + Foo_Bar(0) + helper();
+foo_bar             4 helper.c             return foo_bar(1);
+foo_bar             9 lib/util.c           return foo_bar(x) * 2;
+EOF
+expect "reference regex" $global -rx 'o.b'
+
+#
+# Case insensitive search.
+#
+cat > expected <<'EOF'
+Foo_Bar             7 lib/util.c       Foo_Bar(int x)
+foo_bar             2 lib/util.c       foo_bar(int x)
+EOF
+expect "ignore case" $global -xi FOO_BAR
+expect "regex ignoring case" $global -xi 'O.B'
+cat > expected <<'EOF'
+Foo_Bar             6 cmd/main.c           return foo_bar(FOO_BAR) + Foo_Bar(0) + helper();
+foo_bar             1 cmd/main.c       extern int foo_bar(int);
+foo_bar             6 cmd/main.c           return foo_bar(FOO_BAR) + Foo_Bar(0) + helper();
+foo_bar             4 helper.c             return foo_bar(1);
+foo_bar             9 lib/util.c           return foo_bar(x) * 2;
+EOF
+expect "reference ignoring case" $global -rxi 'o.b'
+cat > expected <<'EOF'
+Foo_Bar
+foo_bar
+EOF
+expect "completion ignoring case" $global -ci FO
+
+#
+# The results of the queries are the same with and without the trigram index
+# and the case-folded index.
+#
+(cd src && $gtags -q && queries) > queries.plain 2>&1
+(GTAGSCONF=$work/index.conf; export GTAGSCONF; cd src && $gtags -q && queries) > queries.index 2>&1
+if [ ! -f src/GTAGS.trigram -o ! -f src/GTAGS.fold ]; then
+	fail "index"
+elif cmp -s queries.plain queries.index; then
+	pass "index"
+else
+	fail "index"
+	diff queries.plain queries.index
+fi
+
+cd ..
+if [ $failed = 0 ]; then
+	rm -rf $work
+	echo "All checks passed."
+else
+	echo "Some checks failed. See $work."
+fi
+exit $failed